@@ -8,6 +8,7 @@
 #include "hal_timebase.h"
 #include "task_Exam.h"
 #include "flash_log.h"
+#include "isr_log.h"
 
 
 
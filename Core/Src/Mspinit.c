@@ -61,7 +61,7 @@ void HAL_UART_MspInit( UART_HandleTypeDef *huart )
     hdma_rx.Init.MemBurst = DMA_MBURST_SINGLE;
     hdma_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
     hdma_rx.Init.MemInc = DMA_MINC_ENABLE;
-    hdma_rx.Init.Mode = DMA_NORMAL;
+    hdma_rx.Init.Mode = DMA_CIRCULAR;   // 循环接收环，见 esp_rx_ring.
     hdma_rx.Init.PeriphBurst = DMA_PBURST_SINGLE;
     hdma_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_rx.Init.PeriphInc = DMA_PINC_DISABLE;
@@ -82,7 +82,9 @@ void HAL_UART_MspInit( UART_HandleTypeDef *huart )
     hdma_tx.Instance = DMA1_Stream4;
     hdma_tx.Init.Channel = DMA_CHANNEL_4;
     hdma_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
-    hdma_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    // FIFO 将存储器侧读取与 UART 逐字节请求解耦. 发送队列的分段来自调用方任意地址、任意长度，
+    // 无法保证突发传输所要求的长度整除与 1KB 边界对齐，存储器侧保持单次传输.
+    hdma_tx.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
     hdma_tx.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
     hdma_tx.Init.MemBurst = DMA_MBURST_SINGLE;
     hdma_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
@@ -1,12 +1,20 @@
 #include "main.h"
+#include "esp8266_at_engine.h"
+#include "boot_prof.h"
 
 
 int main( void )
 {
+	boot_prof_Init();
+
 	HAL_Init();
 
+	boot_prof_Mark(BOOT_PHASE_HAL_INIT, 0);
+
 	Log_Enable();
 
+	boot_prof_Mark(BOOT_PHASE_LOG_ENABLE, 0);
+
 	// 开启对BKPSRAM的访问.
 	{
 		__HAL_RCC_PWR_CLK_ENABLE();
@@ -43,8 +51,16 @@ int main( void )
     NVIC_SystemReset();
 	}
 
+	boot_prof_Mark(BOOT_PHASE_UART4_INIT, 0);
+
+	vIsrLog_TaskCreate();
+
 	vEspInit_TaskCreate();
 
+	vEspAt_TaskCreate();
+
+	boot_prof_Mark(BOOT_PHASE_SCHED_START, 0);
+
 	vTaskStartScheduler();
 
 	while(1)
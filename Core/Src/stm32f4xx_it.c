@@ -39,22 +39,16 @@
 #include "main.h"
 #include "stm32f4xx_it.h"
 #include "esp8266_driver.h"
+#include "esp8266_txq.h"
+#include "isr_log.h"
 
 /* Private variables ---------------------------------------------------------*/
 extern UART_HandleTypeDef esp8266_huart;
 
-extern volatile uint16_t recvData_len;
-
-extern uint8_t rx_flag;
-
-extern uint8_t esp8266_RecvBuffer[RECV_DATA_BUFFER];
-
-extern uint8_t recv_temp[RECV_DATA_BUFFER];
+extern DMA_HandleTypeDef  hdma_rx;
 
 extern DMA_HandleTypeDef  hdma_tx;
 
-extern TaskHandle_t xCurrentSendTaskHandle;
-
 extern ESP8266_HandleTypeDef hesp8266;
 
 
@@ -74,48 +68,58 @@ void UART4_IRQHandler ( void )
   // 检查是否有错误标志
   if (isrflags & (UART_FLAG_ORE | UART_FLAG_NE | UART_FLAG_FE))
   {
-      printf("UART ERROR! SR=0x%04X\n", isrflags);
+      esp8266_RxStats_ErrorFromISR(isrflags);
+
+      // 中断中不可调用 printf(阻塞且获取互斥量)，由排空任务延迟输出.
+      ISR_LOG(LOG_ERROR, "UART4", "UART ERROR! SR=0x%04lX", isrflags, 0);
 
       __HAL_UART_CLEAR_OREFLAG(&esp8266_huart);
       __HAL_UART_CLEAR_FEFLAG(&esp8266_huart);
       __HAL_UART_CLEAR_NEFLAG(&esp8266_huart);
 
-      HAL_UART_AbortReceive(&esp8266_huart);
-      HAL_UARTEx_ReceiveToIdle_DMA(&esp8266_huart, recv_temp, RECV_DATA_BUFFER);
+      // 循环 DMA 无需中止重启，清除标志后继续接收，避免重启窗口内丢字节.
   }
   HAL_UART_IRQHandler(&esp8266_huart); 
+
+  // 帧池归还句柄时挂起本中断，续发因帧池耗尽而滞留的数据.
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  esp8266_RxRing_KickFromISR(&xHigherPriorityTaskWoken);
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 } 
 
 void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
   if ( huart -> Instance == ESP_UART )
   {
-    EspRecvMsg_t msg;
+    UNUSED(Size); // 写位置由 DMA 计数器推导，见 esp8266_RxRing_UpdateFromISR().
 
-    msg.Data_Len = Size;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    rx_flag = RECV_DATA;
+    esp8266_RxRing_UpdateFromISR(&xHigherPriorityTaskWoken);
 
-    memcpy(msg.RecvData, recv_temp, msg.Data_Len);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  }
+}
 
-    // 清空缓冲区.
-    memset(recv_temp, 0x00, RECV_DATA_BUFFER);
 
+void HAL_UART_ErrorCallback( UART_HandleTypeDef *huart )
+{
+  if ( huart -> Instance == ESP_UART )
+  {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    if ( xQueueSendFromISR(hesp8266.xRecvQueue, &msg, &xHigherPriorityTaskWoken) != pdTRUE )
-    {
-      #if defined(__DEBUG_LEVEL_1__)
-        printf("Rx Queue Full! Data Dropped!\n");
-      #endif 
-    }
+    // DMA 发送错误时 HAL 已结束发送，由发送队列完成当前请求并启动下一个.
+    esp_txq_ErrorFromISR(&xHigherPriorityTaskWoken);
 
-    if ( HAL_UARTEx_ReceiveToIdle_DMA(&esp8266_huart, recv_temp, RECV_DATA_BUFFER) != HAL_OK )
+    // HAL 已因阻塞性错误中止接收，重新挂起接收环.
+    if ( huart -> RxState != HAL_UART_STATE_BUSY_RX )
     {
-      #if defined(__DEBUG_LEVEL_1__)
-        printf("Failed to restart ReceiveToIdle DMA!\n");
-      #endif // __DEBUG_LEVEL_1__
+      esp8266_RxRing_Restart();
     }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   }
 }
 
@@ -126,7 +130,8 @@ void HAL_UART_TxCpltCallback( UART_HandleTypeDef *huart )
   {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE; 
 
-    vTaskNotifyGiveFromISR(xCurrentSendTaskHandle, &xHigherPriorityTaskWoken);
+    // 接续下一分段 / 下一请求，并通知已完成请求的等待方.
+    esp_txq_TxCpltFromISR(&xHigherPriorityTaskWoken);
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   }
@@ -139,6 +144,12 @@ void DMA1_Stream4_IRQHandler( void )
 }
 
 
+void DMA1_Stream2_IRQHandler( void )
+{
+  HAL_DMA_IRQHandler( &hdma_rx ); 
+}
+
+
 
 /**
   * @brief  This function handles NMI exception.
@@ -0,0 +1,228 @@
+#include "at_matcher.h"
+
+
+#define AT_MATCH_NONE   ( 0xFF )
+
+
+/* ************************************************** */
+bool at_matcher_Build( at_matcher_t *pMatcher, const char * const *tokens, uint8_t count );
+void at_matcher_Reset( at_match_ctx_t *pCtx );
+uint32_t at_matcher_Feed( const at_matcher_t *pMatcher, at_match_ctx_t *pCtx, const uint8_t *data, uint16_t len );
+int8_t at_matcher_Find( const at_matcher_t *pMatcher, const char *token );
+/* ************************************************** */
+
+
+
+
+/**
+ * @brief 由模式串表构建匹配自动机（启动时调用一次）
+ *
+ * 先建立字典树，再按广度优先计算失败指针，并把失败转移直接填入 `next[][]`，
+ * 得到的 DFA 在匹配时每个输入字节只需一次查表，与模式串数量无关。
+ *
+ * @param[out] pMatcher 自动机
+ * @param[in]  tokens   模式串表（须为静态存储，下标即模式串编号）
+ * @param[in]  count    模式串数（不超过 AT_MATCH_MAX_TOKENS）
+ *
+ * @retval true  构建成功
+ * @retval false 参数非法，或状态数 / 字符类数超出上限（需调大对应宏）
+ */
+bool at_matcher_Build( at_matcher_t *pMatcher, const char * const *tokens, uint8_t count )
+{
+  if ( pMatcher == NULL || tokens == NULL || count == 0 || count > AT_MATCH_MAX_TOKENS )
+  {
+    return false;
+  }
+
+  uint8_t fail[AT_MATCH_MAX_STATES];
+  uint8_t queue[AT_MATCH_MAX_STATES];
+
+  memset(pMatcher, 0, sizeof(*pMatcher));
+  memset(pMatcher->next, AT_MATCH_NONE, sizeof(pMatcher->next));
+
+  pMatcher->tokens = tokens;
+  pMatcher->token_num = count;
+  pMatcher->state_num = 1;   // 状态 0 为根.
+  pMatcher->class_num = 1;   // 字符类 0 为“其它字符”.
+
+  // 字符类映射与字典树.
+  for ( uint8_t t = 0; t < count; t++ )
+  {
+    size_t len = strlen(tokens[t]);
+    uint8_t state = 0;
+
+    if ( len == 0 || len > 0xFF )
+    {
+      return false;
+    }
+
+    pMatcher->token_len[t] = (uint8_t)len;
+
+    for ( size_t i = 0; i < len; i++ )
+    {
+      uint8_t ch = (uint8_t)tokens[t][i];
+
+      if ( pMatcher->class_map[ch] == 0 )
+      {
+        if ( pMatcher->class_num >= AT_MATCH_MAX_CLASSES )
+        {
+          return false;
+        }
+
+        pMatcher->class_map[ch] = pMatcher->class_num++;
+      }
+
+      uint8_t cls = pMatcher->class_map[ch];
+
+      if ( pMatcher->next[state][cls] == AT_MATCH_NONE )
+      {
+        if ( pMatcher->state_num >= AT_MATCH_MAX_STATES )
+        {
+          return false;
+        }
+
+        pMatcher->next[state][cls] = pMatcher->state_num++;
+      }
+
+      state = pMatcher->next[state][cls];
+    }
+
+    pMatcher->out[state] |= ( 1UL << t );
+  }
+
+  // 广度优先: 失败指针 + 转移补全. 处理某状态时，其失败状态(深度更小)的转移已补全.
+  uint8_t head = 0, tail = 0;
+
+  for ( uint8_t c = 0; c < pMatcher->class_num; c++ )
+  {
+    uint8_t child = pMatcher->next[0][c];
+
+    if ( child == AT_MATCH_NONE )
+    {
+      pMatcher->next[0][c] = 0;
+    }
+    else
+    {
+      fail[child] = 0;
+      queue[tail++] = child;
+    }
+  }
+
+  while( head < tail )
+  {
+    uint8_t state = queue[head++];
+
+    for ( uint8_t c = 0; c < pMatcher->class_num; c++ )
+    {
+      uint8_t child = pMatcher->next[state][c];
+
+      if ( child == AT_MATCH_NONE )
+      {
+        pMatcher->next[state][c] = pMatcher->next[fail[state]][c];
+      }
+      else
+      {
+        fail[child] = pMatcher->next[fail[state]][c];
+        pMatcher->out[child] |= pMatcher->out[fail[child]];
+        queue[tail++] = child;
+      }
+    }
+  }
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 复位匹配进度（开始匹配一段新的输入）
+ */
+void at_matcher_Reset( at_match_ctx_t *pCtx )
+{
+  if ( pCtx == NULL )
+  {
+    return;
+  }
+
+  pCtx->state = 0;
+  pCtx->pos = 0;
+  pCtx->hits = 0;
+  memset(pCtx->offset, 0xFF, sizeof(pCtx->offset));
+}
+
+
+
+
+/**
+ * @brief 输入一段字节，单遍识别全部模式串
+ *
+ * @param[in]     pMatcher 已构建的自动机
+ * @param[in,out] pCtx     匹配进度
+ * @param[in]     data     输入
+ * @param[in]     len      长度
+ *
+ * @return 本次输入中新命中的模式串位图（此前已命中的不再重复报告）
+ */
+uint32_t at_matcher_Feed( const at_matcher_t *pMatcher, at_match_ctx_t *pCtx, const uint8_t *data, uint16_t len )
+{
+  if ( pMatcher == NULL || pCtx == NULL || data == NULL )
+  {
+    return 0;
+  }
+
+  uint8_t state = pCtx->state;
+  uint32_t fresh = 0;
+
+  for ( uint16_t i = 0; i < len; i++ )
+  {
+    state = pMatcher->next[state][pMatcher->class_map[data[i]]];
+
+    uint32_t out = pMatcher->out[state] & ~( pCtx->hits | fresh );
+
+    if ( out != 0 )
+    {
+      fresh |= out;
+
+      for ( uint8_t t = 0; out != 0; t++, out >>= 1 )
+      {
+        if ( out & 1UL )
+        {
+          pCtx->offset[t] = (uint16_t)( pCtx->pos + i + 1 - pMatcher->token_len[t] );
+        }
+      }
+    }
+  }
+
+  pCtx->state = state;
+  pCtx->pos += len;
+  pCtx->hits |= fresh;
+
+  return fresh;
+}
+
+
+
+
+/**
+ * @brief 查找模式串在表中的编号
+ *
+ * @return 编号；不在表中返回 -1
+ */
+int8_t at_matcher_Find( const at_matcher_t *pMatcher, const char *token )
+{
+  if ( pMatcher == NULL || token == NULL )
+  {
+    return -1;
+  }
+
+  for ( uint8_t t = 0; t < pMatcher->token_num; t++ )
+  {
+    if ( pMatcher->tokens[t] == token || strcmp(pMatcher->tokens[t], token) == 0 )
+    {
+      return (int8_t)t;
+    }
+  }
+
+  return -1;
+}
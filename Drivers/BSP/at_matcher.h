@@ -0,0 +1,78 @@
+#ifndef __AT_MATCHER_H
+#define __AT_MATCHER_H
+
+#include "stm32f4xx_hal.h"
+#include <string.h>
+#include <stdbool.h>
+
+
+/*  *********************************************    */
+// 按 esp8266_driver.c 的 esp_tokens[] 确定(9 个模式串: 53 个状态, 20 种字符). 增删模式串后构建失败时调大.
+#define AT_MATCH_MAX_TOKENS        ( 16 )     // 模式串数上限(不超过 32, 命中集合以 uint32_t 位图表示).
+#define AT_MATCH_MAX_STATES        ( 56 )     // 自动机状态数上限(字典树前缀数 + 1, 不超过全部模式串总长 + 1).
+#define AT_MATCH_MAX_CLASSES       ( 24 )     // 字符类上限(模式串中不同字符数 + 1).
+#define AT_MATCH_NO_OFFSET         ( 0xFFFF )
+/*  *********************************************    */
+
+#if ( AT_MATCH_MAX_TOKENS > 32 )
+  #error "AT_MATCH_MAX_TOKENS must be <= 32"
+#endif
+
+
+/**
+ * @brief 多模式匹配自动机（Aho-Corasick，预先展开为 DFA）
+ *
+ *  输入字节先经 class_map 映射为字符类(0 类为“不在任何模式串中出现的字符”)，
+ *  next[state][class] 为完整的状态转移(已合并失败指针)，每字节只查表一次；
+ *  out[state] 为到达该状态时结束的全部模式串位图(含经失败链可达的后缀模式).
+ */
+typedef struct
+{
+  const char * const *tokens;
+  uint8_t token_num;
+  uint8_t state_num;
+  uint8_t class_num;
+  uint8_t token_len[AT_MATCH_MAX_TOKENS];
+  uint8_t class_map[256];
+  uint8_t next[AT_MATCH_MAX_STATES][AT_MATCH_MAX_CLASSES];
+  uint32_t out[AT_MATCH_MAX_STATES];
+
+} at_matcher_t;
+
+
+/**
+ * @brief 匹配进度（可跨多次 at_matcher_Feed() 调用，输入可在任意字节处切分）
+ *
+ *  state：当前自动机状态.
+ *  pos：已输入的字节数.
+ *  hits：已命中的模式串位图.
+ *  offset：各模式串首次出现的起始偏移(相对第一次输入)，未命中为 AT_MATCH_NO_OFFSET.
+ */
+typedef struct
+{
+  uint8_t state;
+  uint16_t pos;
+  uint32_t hits;
+  uint16_t offset[AT_MATCH_MAX_TOKENS];
+
+} at_match_ctx_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  bool at_matcher_Build( at_matcher_t *pMatcher, const char * const *tokens, uint8_t count );
+
+  void at_matcher_Reset( at_match_ctx_t *pCtx );
+
+  uint32_t at_matcher_Feed( const at_matcher_t *pMatcher, at_match_ctx_t *pCtx, const uint8_t *data, uint16_t len );
+
+  int8_t at_matcher_Find( const at_matcher_t *pMatcher, const char *token );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __AT_MATCHER_H
@@ -59,11 +59,11 @@ bool at_get_string_between_quotes
   
 
   // 没有双引号与之匹配，返回.
-  if ( *start != '"' ) return false;
+  if ( start >= buf + len || *start != '"' ) return false;
 
   start++;
-  // 查找末尾双引号.
-  const uint8_t *end = strchr(start, '"');
+  // 查找末尾双引号(接收环中的帧不以 '\0' 结尾，必须按长度限定查找范围).
+  const uint8_t *end = memchr(start, '"', (size_t)(buf + len - start));
 
   // 未找到与之配对的双引号，返回.
   if ( end == NULL )
@@ -93,7 +93,7 @@ bool at_get_string_between_quotes
 /**
  * @brief 从原始 AT 响应缓冲区中提取 `"+key:"` 后首个连续十进制整数（无符号）
  *
- * 安全解析二进制响应帧（如 `LastReceivedFrame.RecvData`），不依赖 `\0` 终止符，
+ * 安全解析二进制响应帧（如 `LastReceivedFrame->RecvData`），不依赖 `\0` 终止符，
  * 严格基于显式长度 `buf_len` 进行边界检查，避免越界访问或 HardFault。
  *
  * @param[in]  buf       响应数据起始地址（`uint8_t*`，如 DMA 接收缓冲区）
@@ -145,13 +145,15 @@ bool at_get_num( const uint8_t *buf, uint16_t buf_len, const char *key, uint32_t
 
   pFound += len;
 
+  const uint8_t *pEnd = buf + buf_len;
+
   // 跳过前导空白.
-  while( *pFound == ' ' || *pFound == '\t' || *pFound == '\r' || *pFound == '\n' )
+  while( pFound < pEnd && ( *pFound == ' ' || *pFound == '\t' || *pFound == '\r' || *pFound == '\n' ) )
   {
     pFound++;
   }
 
-  if ( *pFound == '\0' )
+  if ( pFound >= pEnd || *pFound == '\0' )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("not get KeyVal in at_get_num.\n");
@@ -164,7 +166,7 @@ bool at_get_num( const uint8_t *buf, uint16_t buf_len, const char *key, uint32_t
   uint32_t value = 0;
   const uint8_t *qF = pFound;
 
-  while( *qF >= '0' && *qF <= '9' )
+  while( qF < pEnd && *qF >= '0' && *qF <= '9' )
   {
     uint32_t digit = *qF - '0';
 
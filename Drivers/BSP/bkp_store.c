@@ -0,0 +1,151 @@
+#include "bkp_store.h"
+
+
+typedef struct
+{
+  uint16_t offset;      // 相对 BKP_STORE_BASE 的偏移(4 字节对齐).
+  uint16_t capacity;    // 数据区容量(不含头部).
+
+} bkp_slot_layout_t;
+
+
+// 槽位布局表(只能在末尾追加). 每个槽位占用 头部(12 字节) + 容量，下一槽位的偏移不得小于该值.
+static const bkp_slot_layout_t slot_layout[BKP_SLOT_NUM] =
+{
+  /* BKP_SLOT_ESP_UART */ { 0x0000, 16 },
+  /* BKP_SLOT_ESP_WIFI */ { 0x0020, 104 },
+  /* BKP_SLOT_BOOT_PROF */ { 0x00A0, 196 },
+  /* BKP_SLOT_ESP_SESSION */ { 0x0170, 136 },
+  /* BKP_SLOT_ESP_DNS */ { 0x0210, 528 },
+};
+
+
+/*  **********************************   */
+bool bkp_store_Write( BkpSlot_t slot, const void *data, uint16_t len );
+bool bkp_store_Read( BkpSlot_t slot, void *data, uint16_t len );
+void bkp_store_Invalidate( BkpSlot_t slot );
+static uint32_t bkp_Crc32( const uint8_t *data, uint16_t len );
+/*  **********************************   */
+
+
+
+
+/**
+ * @brief 将数据写入备份 SRAM 槽位（VBAT 供电时可跨复位与掉电保存）
+ *
+ * 先清除魔数，写入数据与校验值后再写回魔数，写入过程中复位不会留下“看似有效”的半截数据。
+ *
+ * @note 依赖 main() 中已开启的 BKPSRAM 时钟与备份域写访问。
+ *
+ * @param[in] slot 槽位
+ * @param[in] data 数据
+ * @param[in] len  数据长度（不超过槽位容量）
+ *
+ * @retval true  写入成功
+ * @retval false 参数非法或超出槽位容量
+ */
+bool bkp_store_Write( BkpSlot_t slot, const void *data, uint16_t len )
+{
+  if ( slot >= BKP_SLOT_NUM || data == NULL || len == 0 || len > slot_layout[slot].capacity )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Wrong Param of bkp_store_Write.\n");
+    #endif // __DEBUG_LEVEL_1__
+
+    return false;
+  }
+
+  volatile BkpSlotHeader_t *pHeader = (volatile BkpSlotHeader_t *)( BKP_STORE_BASE + slot_layout[slot].offset );
+  uint8_t *pData = (uint8_t *)( BKP_STORE_BASE + slot_layout[slot].offset + sizeof(BkpSlotHeader_t) );
+
+  pHeader->magic = 0;
+
+  memcpy(pData, data, len);
+
+  pHeader->len = len;
+  pHeader->reserved = 0;
+  pHeader->crc = bkp_Crc32(pData, len);
+
+  __DSB();
+
+  pHeader->magic = BKP_SLOT_MAGIC;
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 从备份 SRAM 槽位读取数据
+ *
+ * @param[in]  slot 槽位
+ * @param[out] data 输出缓冲区
+ * @param[in]  len  期望长度（必须与写入时一致，结构体版本变化时自动视为无效）
+ *
+ * @retval true  读取成功且校验通过
+ * @retval false 槽位无效、长度不符或校验失败
+ */
+bool bkp_store_Read( BkpSlot_t slot, void *data, uint16_t len )
+{
+  if ( slot >= BKP_SLOT_NUM || data == NULL || len == 0 )
+  {
+    return false;
+  }
+
+  const BkpSlotHeader_t *pHeader = (const BkpSlotHeader_t *)( BKP_STORE_BASE + slot_layout[slot].offset );
+  const uint8_t *pData = (const uint8_t *)( BKP_STORE_BASE + slot_layout[slot].offset + sizeof(BkpSlotHeader_t) );
+
+  if ( pHeader->magic != BKP_SLOT_MAGIC || pHeader->len != len || len > slot_layout[slot].capacity )
+  {
+    return false;
+  }
+
+  if ( bkp_Crc32(pData, len) != pHeader->crc )
+  {
+    return false;
+  }
+
+  memcpy(data, pData, len);
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 使槽位失效
+ */
+void bkp_store_Invalidate( BkpSlot_t slot )
+{
+  if ( slot >= BKP_SLOT_NUM )
+  {
+    return;
+  }
+
+  volatile BkpSlotHeader_t *pHeader = (volatile BkpSlotHeader_t *)( BKP_STORE_BASE + slot_layout[slot].offset );
+
+  pHeader->magic = 0;
+}
+
+
+
+
+// CRC-32(多项式 0xEDB88320)，逐位计算，槽位数据很小，无需查表.
+static uint32_t bkp_Crc32( const uint8_t *data, uint16_t len )
+{
+  uint32_t crc = 0xFFFFFFFFUL;
+
+  for ( uint16_t i = 0; i < len; i++ )
+  {
+    crc ^= data[i];
+
+    for ( uint8_t j = 0; j < 8; j++ )
+    {
+      crc = ( crc >> 1 ) ^ ( 0xEDB88320UL & ( 0UL - ( crc & 1UL ) ) );
+    }
+  }
+
+  return ~crc;
+}
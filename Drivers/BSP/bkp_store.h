@@ -0,0 +1,67 @@
+#ifndef __BKP_STORE_H
+#define __BKP_STORE_H
+
+#include "stm32f4xx_hal.h"
+#include "flash_log.h"
+#include <stdbool.h>
+#include <string.h>
+
+
+/*  *********************************************    */
+#define BKP_STORE_BASE             ( BKPSRAM_BASE + 0x100UL )  // 前 256 字节保留给 Log_PanicWrite() 的 panic 记录.
+#define BKP_STORE_END              ( BKPSRAM_BASE + 0x1000UL ) // BKPSRAM 共 4KB.
+#define BKP_SLOT_MAGIC             ( 0x424B5053UL )            // "BKPS".
+/*  *********************************************    */
+
+
+/**
+ * @brief 备份 SRAM 存储槽位.
+ *
+ *  每个槽位占据固定的偏移与容量(见 bkp_store.c 中的布局表)，新增槽位只能追加在末尾，
+ *  以免改变既有槽位的位置导致升级后误读旧数据.
+ */
+typedef enum
+{
+  BKP_SLOT_ESP_UART = 0,     // ESP8266 协商得到的 UART 波特率.
+  BKP_SLOT_ESP_WIFI,         // ESP8266 上次成功入网的 BSSID / 信道 / IP 配置.
+  BKP_SLOT_BOOT_PROF,        // 最近一次完整启动的阶段时间线(boot_prof).
+  BKP_SLOT_ESP_SESSION,      // ESP8266 当前会话(入网 / TCP 链路)，供热复位后直接接管.
+  BKP_SLOT_ESP_DNS,          // DNS 缓存(esp8266_dns).
+
+  BKP_SLOT_NUM
+} BkpSlot_t;
+
+
+/**
+ * @brief 槽位头部. 数据紧随其后.
+ *
+ *  magic：BKP_SLOT_MAGIC，区分有效数据与上电随机内容.
+ *  len：数据长度.
+ *  crc：数据的 CRC32 校验值.
+ */
+typedef struct
+{
+  uint32_t magic;
+  uint16_t len;
+  uint16_t reserved;
+  uint32_t crc;
+
+} BkpSlotHeader_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  bool bkp_store_Write( BkpSlot_t slot, const void *data, uint16_t len );
+
+  bool bkp_store_Read( BkpSlot_t slot, void *data, uint16_t len );
+
+  void bkp_store_Invalidate( BkpSlot_t slot );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __BKP_STORE_H
@@ -0,0 +1,234 @@
+#include "boot_prof.h"
+
+
+/*  **********************************   */
+static BootTimeline_t boot_line = { 0 };
+
+static uint32_t prof_last_cyc = 0;     // 上次读取时的 DWT 周期计数.
+static uint32_t prof_rem_cyc = 0;      // 不足 1us 的剩余周期.
+static uint32_t prof_acc_us = 0;       // 累计微秒数.
+/*  **********************************   */
+
+
+/*  **********************************   */
+void boot_prof_Init( void );
+uint32_t boot_prof_NowUs( void );
+void boot_prof_Mark( uint8_t phase, uint8_t retries );
+void boot_prof_Finish( uint8_t phase );
+const BootTimeline_t *boot_prof_Get( void );
+bool boot_prof_LoadLast( BootTimeline_t *pOut );
+void boot_prof_Dump( const BootTimeline_t *pLine );
+static const char *boot_prof_PhaseName( uint8_t phase );
+/*  **********************************   */
+
+
+
+
+/**
+ * @brief 启动计时（在 main() 最开始、HAL_Init() 之前调用）
+ *
+ * 使能 DWT 周期计数器并清零，之后所有标记均以此刻为零点。
+ */
+void boot_prof_Init( void )
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  memset(&boot_line, 0, sizeof(boot_line));
+
+  prof_last_cyc = 0;
+  prof_rem_cyc = 0;
+  prof_acc_us = 0;
+}
+
+
+
+
+/**
+ * @brief 自 boot_prof_Init() 起的单调时间（微秒）
+ *
+ * 按两次读取之间的周期增量与当时的 SystemCoreClock 累加，因此跨越时钟切换时仍然连续；
+ * 32 位周期计数器在 168MHz 下约 25s 回绕一次，两次调用间隔不超过该值即可保持单调。
+ */
+uint32_t boot_prof_NowUs( void )
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+
+  uint32_t now = DWT->CYCCNT;
+  uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+
+  if ( cyc_per_us == 0 )
+  {
+    cyc_per_us = 1;
+  }
+
+  uint32_t delta = ( now - prof_last_cyc ) + prof_rem_cyc;
+
+  prof_last_cyc = now;
+  prof_acc_us += delta / cyc_per_us;
+  prof_rem_cyc = delta % cyc_per_us;
+
+  uint32_t us = prof_acc_us;
+
+  __set_PRIMASK(primask);
+
+  return us;
+}
+
+
+
+
+/**
+ * @brief 记录一个阶段结束
+ *
+ * @param[in] phase   BootPhase_t（ESP 状态机阶段用 BOOT_PHASE_ESP(state)）
+ * @param[in] retries 该阶段内的重试次数
+ *
+ * @note 时间线结束(boot_prof_Finish)后的标记被忽略；可在任务与中断外的任意上下文调用.
+ */
+void boot_prof_Mark( uint8_t phase, uint8_t retries )
+{
+  uint32_t us = boot_prof_NowUs();
+
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+
+  if ( !boot_line.finished )
+  {
+    if ( boot_line.count < BOOT_PROF_MAX_MARKS )
+    {
+      BootMark_t *pMark = &boot_line.marks[boot_line.count++];
+
+      pMark->phase = phase;
+      pMark->retries = retries;
+      pMark->at_us = us;
+    }
+    else if ( boot_line.dropped < 0xFF )
+    {
+      boot_line.dropped++;
+    }
+  }
+
+  __set_PRIMASK(primask);
+}
+
+
+
+
+/**
+ * @brief 记录最后一个阶段并结束时间线，写入 BKPSRAM（BKP_SLOT_BOOT_PROF）
+ *
+ * 仅第一次调用生效，之后的调用直接返回。
+ */
+void boot_prof_Finish( uint8_t phase )
+{
+  if ( boot_line.finished )
+  {
+    return;
+  }
+
+  boot_prof_Mark(phase, 0);
+
+  boot_line.finished = 1;
+
+  bkp_store_Write(BKP_SLOT_BOOT_PROF, &boot_line, sizeof(boot_line));
+
+  #if defined(__DEBUG_LEVEL_1__)
+    boot_prof_Dump(&boot_line);
+  #endif // __DEBUG_LEVEL_1__
+}
+
+
+
+
+/**
+ * @brief 本次启动的时间线（运行中可随时读取，未结束时 finished 为 0）
+ */
+const BootTimeline_t *boot_prof_Get( void )
+{
+  return &boot_line;
+}
+
+
+
+
+/**
+ * @brief 读取 BKPSRAM 中最近一次完整启动的时间线
+ *
+ * @retval true  读取成功
+ * @retval false 槽位无效（从未完成过一次启动，或备份域掉电）
+ */
+bool boot_prof_LoadLast( BootTimeline_t *pOut )
+{
+  if ( pOut == NULL )
+  {
+    return false;
+  }
+
+  return bkp_store_Read(BKP_SLOT_BOOT_PROF, pOut, sizeof(*pOut));
+}
+
+
+
+
+/**
+ * @brief 打印时间线（每阶段的结束时刻、本阶段耗时与重试次数）
+ */
+void boot_prof_Dump( const BootTimeline_t *pLine )
+{
+  if ( pLine == NULL )
+  {
+    return;
+  }
+
+  uint32_t prev = 0;
+
+  printf("=== Boot Timeline (%u marks, %u dropped) ===\n", pLine->count, pLine->dropped);
+
+  for ( uint8_t i = 0; i < pLine->count && i < BOOT_PROF_MAX_MARKS; i++ )
+  {
+    const BootMark_t *pMark = &pLine->marks[i];
+
+    printf("  %-16s @%8lu us  +%8lu us  retry %u\n", boot_prof_PhaseName(pMark->phase),
+              (unsigned long)pMark->at_us, (unsigned long)( pMark->at_us - prev ), pMark->retries);
+
+    prev = pMark->at_us;
+  }
+}
+
+
+
+
+static const char *boot_prof_PhaseName( uint8_t phase )
+{
+  static const char * const esp_names[] =
+  {
+    "ESP_CHECK_AT", "ESP_WARM_PROBE", "ESP_SET_BAUD", "ESP_SET_MODE", "ESP_FAST_CONN",
+    "ESP_CONN_WIFI", "ESP_GET_IP", "ESP_COMPLETE", "ESP_ERROR"
+  };
+
+  switch( phase )
+  {
+    case BOOT_PHASE_HAL_INIT:     return "HAL_Init";
+    case BOOT_PHASE_LOG_ENABLE:   return "Log_Enable";
+    case BOOT_PHASE_UART4_INIT:   return "UART4_Init";
+    case BOOT_PHASE_SCHED_START:  return "SchedStart";
+    case BOOT_PHASE_TCP_INIT:     return "tcp_Init";
+    case BOOT_PHASE_TCP_CONNECT:  return "tcp_Connect";
+    case BOOT_PHASE_FIRST_FETCH:  return "FirstFetch";
+    default: break;
+  }
+
+  if ( phase >= BOOT_PHASE_ESP_STATE_BASE
+          && phase < BOOT_PHASE_ESP_STATE_BASE + sizeof(esp_names) / sizeof(esp_names[0]) )
+  {
+    return esp_names[phase - BOOT_PHASE_ESP_STATE_BASE];
+  }
+
+  return "?";
+}
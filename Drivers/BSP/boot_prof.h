@@ -0,0 +1,96 @@
+#ifndef __BOOT_PROF_H
+#define __BOOT_PROF_H
+
+#include "stm32f4xx_hal.h"
+#include "bkp_store.h"
+#include <stdbool.h>
+#include <string.h>
+
+
+/*  *********************************************    */
+#define BOOT_PROF_MAX_MARKS        ( 24 )     // 单次启动最多记录的阶段数(超出部分丢弃并计数).
+/*  *********************************************    */
+
+
+/**
+ * @brief 启动阶段.
+ *
+ *  每个标记表示“该阶段在此刻结束”. ESP 初始化状态机的阶段与 EspInitState_t 一一对应，
+ *  由 BOOT_PHASE_ESP(state) 换算，状态机中的重复进入(如波特率协商失败回到 CHECK_AT)会分别记录.
+ */
+typedef enum
+{
+  BOOT_PHASE_HAL_INIT = 0,
+  BOOT_PHASE_LOG_ENABLE,        // 含日志扇区扫描.
+  BOOT_PHASE_UART4_INIT,
+  BOOT_PHASE_SCHED_START,       // 调度器启动前最后一刻.
+  BOOT_PHASE_ESP_STATE_BASE,    // + EspInitState_t.
+  BOOT_PHASE_TCP_INIT = BOOT_PHASE_ESP_STATE_BASE + 16,
+  BOOT_PHASE_TCP_CONNECT,
+  BOOT_PHASE_FIRST_FETCH,       // 首次 http_Get() 成功，时间线结束并写入 BKPSRAM.
+
+  BOOT_PHASE_NUM
+} BootPhase_t;
+
+#define BOOT_PHASE_ESP(state)      ( (uint8_t)( BOOT_PHASE_ESP_STATE_BASE + (uint8_t)(state) ) )
+
+
+/**
+ * @brief 单个阶段标记.
+ *
+ *  phase：BootPhase_t.
+ *  retries：该阶段内的重试次数.
+ *  at_us：自 boot_prof_Init() 起的时间(微秒).
+ */
+typedef struct
+{
+  uint8_t phase;
+  uint8_t retries;
+  uint16_t reserved;
+  uint32_t at_us;
+
+} BootMark_t;
+
+
+/**
+ * @brief 一次启动的时间线（同时作为 BKP_SLOT_BOOT_PROF 的存储格式）.
+ *
+ *  count：有效标记数.
+ *  dropped：因标记表已满被丢弃的标记数.
+ *  finished：是否已到达 BOOT_PHASE_FIRST_FETCH.
+ */
+typedef struct
+{
+  uint8_t count;
+  uint8_t dropped;
+  uint8_t finished;
+  uint8_t reserved;
+  BootMark_t marks[BOOT_PROF_MAX_MARKS];
+
+} BootTimeline_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  void boot_prof_Init( void );
+
+  uint32_t boot_prof_NowUs( void );
+
+  void boot_prof_Mark( uint8_t phase, uint8_t retries );
+
+  void boot_prof_Finish( uint8_t phase );
+
+  const BootTimeline_t *boot_prof_Get( void );
+
+  bool boot_prof_LoadLast( BootTimeline_t *pOut );
+
+  void boot_prof_Dump( const BootTimeline_t *pLine );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __BOOT_PROF_H
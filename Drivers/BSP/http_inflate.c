@@ -0,0 +1,873 @@
+#include "http_inflate.h"
+
+
+#define INF_ST_GZIP_HDR           ( 0U )     // gzip 固定头部 10 字节.
+#define INF_ST_GZIP_XLEN          ( 1U )     // FEXTRA 长度.
+#define INF_ST_GZIP_EXTRA         ( 2U )     // FEXTRA 内容(跳过).
+#define INF_ST_GZIP_NAME          ( 3U )     // FNAME(跳过至 '\0').
+#define INF_ST_GZIP_COMMENT       ( 4U )     // FCOMMENT(跳过至 '\0').
+#define INF_ST_GZIP_HCRC          ( 5U )     // FHCRC(跳过).
+#define INF_ST_ZLIB_HDR           ( 6U )     // zlib 头部(或裸 deflate).
+#define INF_ST_BLOCK              ( 7U )     // 块头 BFINAL + BTYPE.
+#define INF_ST_STORED_LEN         ( 8U )
+#define INF_ST_STORED_NLEN        ( 9U )
+#define INF_ST_STORED             ( 10U )
+#define INF_ST_TABLE              ( 11U )    // 动态块: HLIT / HDIST / HCLEN.
+#define INF_ST_CODELENS           ( 12U )    // 动态块: 码长码的码长.
+#define INF_ST_LENLENS            ( 13U )    // 动态块: 字面量 / 距离码的码长.
+#define INF_ST_CODES              ( 14U )
+#define INF_ST_LEN_EXTRA          ( 15U )
+#define INF_ST_DIST               ( 16U )
+#define INF_ST_DIST_EXTRA         ( 17U )
+#define INF_ST_TRAILER            ( 18U )
+#define INF_ST_STOP               ( 19U )    // 结束或出错(见 status).
+
+#define INF_STEP_PROGRESS         ( 0 )
+#define INF_STEP_NEED             ( 1 )
+#define INF_STEP_STOP             ( 2 )
+
+#define INF_DECODE_NEED           ( -1 )
+#define INF_DECODE_ERROR          ( -2 )
+
+
+/*  **********************************   */
+static const uint16_t inf_len_base[29] =
+{
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const uint8_t inf_len_extra[29] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t inf_dist_base[30] =
+{
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+  4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const uint8_t inf_dist_extra[30] =
+{
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static const uint8_t inf_codelen_order[19] =
+{
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// CRC32(0xEDB88320) 半字节表.
+static const uint32_t inf_crc_tab[16] =
+{
+  0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL, 0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+  0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL, 0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+/*  **********************************   */
+
+
+/*  **********************************   */
+void http_inflate_Init( http_inflate_t *pInf, uint8_t format, http_inflate_out_t on_out, void *ctx );
+http_inflate_status_t http_inflate_Feed( http_inflate_t *pInf, const uint8_t *data, uint16_t len );
+static int inflate_Step( http_inflate_t *pInf );
+static int inflate_Header( http_inflate_t *pInf );
+static int inflate_Dynamic( http_inflate_t *pInf );
+static int inflate_Trailer( http_inflate_t *pInf );
+static int inflate_Stop( http_inflate_t *pInf, http_inflate_status_t status );
+static uint32_t inflate_Take( http_inflate_t *pInf, uint8_t n );
+static int inflate_Decode( const http_inflate_t *pInf, const uint16_t *count, const uint16_t *symbol, uint8_t *pLen );
+static int inflate_Build( uint16_t *count, uint16_t *symbol, const uint8_t *length, uint16_t n );
+static void inflate_Fixed( http_inflate_t *pInf );
+static void inflate_Put( http_inflate_t *pInf, uint8_t b );
+static void inflate_Flush( http_inflate_t *pInf );
+static void inflate_Check( http_inflate_t *pInf, const uint8_t *data, uint16_t len );
+/*  **********************************   */
+
+
+
+
+/**
+ * @brief 初始化解码器（每个响应体之前调用一次）
+ *
+ * @param[out] pInf   解码器实例
+ * @param[in]  format HTTP_INFLATE_FMT_GZIP / HTTP_INFLATE_FMT_DEFLATE
+ * @param[in]  on_out 解码输出回调（可为 NULL，仅校验不输出）
+ * @param[in]  ctx    透传给回调的上下文指针
+ */
+void http_inflate_Init( http_inflate_t *pInf, uint8_t format, http_inflate_out_t on_out, void *ctx )
+{
+  if ( pInf == NULL )
+  {
+    return;
+  }
+
+  pInf->format = format;
+  pInf->state = ( format == HTTP_INFLATE_FMT_GZIP ) ? INF_ST_GZIP_HDR : INF_ST_ZLIB_HDR;
+  pInf->status = HTTP_INFLATE_OK;
+  pInf->zlib = 0;
+  pInf->last = 0;
+  pInf->flags = 0;
+  pInf->stream_wbits = 0;
+
+  pInf->bitbuf = 0;
+  pInf->bitcnt = 0;
+  pInf->count = 0;
+  pInf->max_dist = 0;
+
+  pInf->wpos = 0;
+  pInf->flush_pos = 0;
+
+  // gzip 为 CRC32(取反前的运行值)，zlib 为 Adler-32.
+  pInf->check = ( format == HTTP_INFLATE_FMT_GZIP ) ? 0xFFFFFFFFUL : 1UL;
+
+  pInf->in_total = 0;
+  pInf->out_total = 0;
+
+  pInf->on_out = on_out;
+  pInf->ctx = ctx;
+}
+
+
+
+
+/**
+ * @brief 输入一段压缩数据
+ *
+ * 数据全部进入位缓冲并尽可能解码，本次产生的输出在返回前全部交给 on_out。
+ * 数据流结束（或出错）后的输入被忽略。
+ *
+ * @return HTTP_INFLATE_OK：等待更多输入；HTTP_INFLATE_DONE：数据流结束且校验通过；其余为错误
+ */
+http_inflate_status_t http_inflate_Feed( http_inflate_t *pInf, const uint8_t *data, uint16_t len )
+{
+  uint16_t i = 0;
+
+  if ( pInf == NULL || ( data == NULL && len != 0 ) )
+  {
+    return HTTP_INFLATE_ERR_FORMAT;
+  }
+
+  while( pInf->state != INF_ST_STOP )
+  {
+    // 位缓冲至少保持 25 位(单步最多需要 16 位).
+    while( i < len && pInf->bitcnt <= 24 )
+    {
+      pInf->bitbuf |= (uint32_t)data[i++] << pInf->bitcnt;
+      pInf->bitcnt += 8;
+      pInf->in_total++;
+    }
+
+    int step = inflate_Step(pInf);
+
+    if ( step == INF_STEP_NEED && i >= len )
+    {
+      break;
+    }
+
+    if ( step == INF_STEP_STOP )
+    {
+      break;
+    }
+  }
+
+  inflate_Flush(pInf);
+
+  return pInf->status;
+}
+
+
+
+
+// 执行一步解码. 位数不足时不消费任何位并返回 INF_STEP_NEED.
+static int inflate_Step( http_inflate_t *pInf )
+{
+  int sym;
+  uint8_t n;
+
+  switch( pInf->state )
+  {
+    case INF_ST_GZIP_HDR:
+    case INF_ST_GZIP_XLEN:
+    case INF_ST_GZIP_EXTRA:
+    case INF_ST_GZIP_NAME:
+    case INF_ST_GZIP_COMMENT:
+    case INF_ST_GZIP_HCRC:
+    case INF_ST_ZLIB_HDR:
+      return inflate_Header(pInf);
+
+    case INF_ST_BLOCK:
+      if ( pInf->bitcnt < 3 )
+      {
+        return INF_STEP_NEED;
+      }
+
+      pInf->last = (uint8_t)inflate_Take(pInf, 1);
+
+      switch( inflate_Take(pInf, 2) )
+      {
+        case 0:
+          // 存储块: 丢弃当前字节的剩余位.
+          (void)inflate_Take(pInf, (uint8_t)( pInf->bitcnt & 7U ));
+          pInf->state = INF_ST_STORED_LEN;
+          break;
+
+        case 1:
+          inflate_Fixed(pInf);
+          pInf->state = INF_ST_CODES;
+          break;
+
+        case 2:
+          pInf->state = INF_ST_TABLE;
+          break;
+
+        default:
+          return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+      }
+
+      return INF_STEP_PROGRESS;
+
+    case INF_ST_STORED_LEN:
+      if ( pInf->bitcnt < 16 )
+      {
+        return INF_STEP_NEED;
+      }
+
+      pInf->stored_left = (uint16_t)inflate_Take(pInf, 16);
+      pInf->state = INF_ST_STORED_NLEN;
+      return INF_STEP_PROGRESS;
+
+    case INF_ST_STORED_NLEN:
+      if ( pInf->bitcnt < 16 )
+      {
+        return INF_STEP_NEED;
+      }
+
+      if ( (uint16_t)~inflate_Take(pInf, 16) != pInf->stored_left )
+      {
+        return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+      }
+
+      pInf->state = INF_ST_STORED;
+      return INF_STEP_PROGRESS;
+
+    case INF_ST_STORED:
+      while( pInf->stored_left > 0 && pInf->bitcnt >= 8 )
+      {
+        inflate_Put(pInf, (uint8_t)inflate_Take(pInf, 8));
+        pInf->stored_left--;
+      }
+
+      if ( pInf->stored_left > 0 )
+      {
+        return INF_STEP_NEED;
+      }
+
+      pInf->state = pInf->last ? INF_ST_TRAILER : INF_ST_BLOCK;
+      pInf->count = 0;
+      return INF_STEP_PROGRESS;
+
+    case INF_ST_TABLE:
+    case INF_ST_CODELENS:
+    case INF_ST_LENLENS:
+      return inflate_Dynamic(pInf);
+
+    case INF_ST_CODES:
+      sym = inflate_Decode(pInf, pInf->lit_count, pInf->lit_symbol, &n);
+
+      if ( sym == INF_DECODE_NEED )
+      {
+        return INF_STEP_NEED;
+      }
+
+      if ( sym == INF_DECODE_ERROR || sym > 285 )
+      {
+        return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+      }
+
+      (void)inflate_Take(pInf, n);
+
+      if ( sym < 256 )
+      {
+        inflate_Put(pInf, (uint8_t)sym);
+      }
+      else if ( sym == 256 )
+      {
+        pInf->state = pInf->last ? INF_ST_TRAILER : INF_ST_BLOCK;
+        pInf->count = 0;
+      }
+      else
+      {
+        pInf->sym_extra = (uint8_t)( sym - 257 );
+        pInf->state = INF_ST_LEN_EXTRA;
+      }
+
+      return INF_STEP_PROGRESS;
+
+    case INF_ST_LEN_EXTRA:
+      n = inf_len_extra[pInf->sym_extra];
+
+      if ( pInf->bitcnt < n )
+      {
+        return INF_STEP_NEED;
+      }
+
+      pInf->copy_len = (uint16_t)( inf_len_base[pInf->sym_extra] + inflate_Take(pInf, n) );
+      pInf->state = INF_ST_DIST;
+      return INF_STEP_PROGRESS;
+
+    case INF_ST_DIST:
+      sym = inflate_Decode(pInf, pInf->dist_count, pInf->dist_symbol, &n);
+
+      if ( sym == INF_DECODE_NEED )
+      {
+        return INF_STEP_NEED;
+      }
+
+      if ( sym == INF_DECODE_ERROR || sym > 29 )
+      {
+        return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+      }
+
+      (void)inflate_Take(pInf, n);
+
+      pInf->sym_extra = (uint8_t)sym;
+      pInf->state = INF_ST_DIST_EXTRA;
+      return INF_STEP_PROGRESS;
+
+    case INF_ST_DIST_EXTRA:
+      n = inf_dist_extra[pInf->sym_extra];
+
+      if ( pInf->bitcnt < n )
+      {
+        return INF_STEP_NEED;
+      }
+
+      pInf->copy_dist = (uint16_t)( inf_dist_base[pInf->sym_extra] + inflate_Take(pInf, n) );
+
+      if ( pInf->copy_dist > pInf->out_total )
+      {
+        return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+      }
+
+      if ( pInf->copy_dist > pInf->max_dist )
+      {
+        pInf->max_dist = pInf->copy_dist;
+      }
+
+      if ( pInf->copy_dist > HTTP_INFLATE_WINDOW )
+      {
+        return inflate_Stop(pInf, HTTP_INFLATE_ERR_WINDOW);
+      }
+
+      while( pInf->copy_len > 0 )
+      {
+        inflate_Put(pInf, pInf->window[( pInf->wpos - pInf->copy_dist ) & ( HTTP_INFLATE_WINDOW - 1 )]);
+        pInf->copy_len--;
+      }
+
+      pInf->state = INF_ST_CODES;
+      return INF_STEP_PROGRESS;
+
+    case INF_ST_TRAILER:
+      return inflate_Trailer(pInf);
+
+    default:
+      return INF_STEP_STOP;
+  }
+}
+
+
+
+
+// gzip / zlib 头部，逐字节读取.
+static int inflate_Header( http_inflate_t *pInf )
+{
+  if ( pInf->state == INF_ST_ZLIB_HDR )
+  {
+    if ( pInf->bitcnt < 16 )
+    {
+      return INF_STEP_NEED;
+    }
+
+    uint8_t cmf = (uint8_t)( pInf->bitbuf & 0xFFU );
+    uint8_t flg = (uint8_t)( ( pInf->bitbuf >> 8 ) & 0xFFU );
+
+    // 不少服务器对 "deflate" 发送裸数据流: 不符合 zlib 头部时按裸 deflate 解码，不消费任何位.
+    if ( ( cmf & 0x0FU ) == 8U && ( cmf >> 4 ) <= 7U && ( ( (uint16_t)cmf << 8 ) | flg ) % 31U == 0 && !( flg & 0x20U ) )
+    {
+      (void)inflate_Take(pInf, 16);
+
+      pInf->zlib = 1;
+      pInf->stream_wbits = (uint8_t)( ( cmf >> 4 ) + 8U );
+    }
+
+    pInf->state = INF_ST_BLOCK;
+    return INF_STEP_PROGRESS;
+  }
+
+  // 可选字段(FEXTRA / FNAME / FCOMMENT / FHCRC)不存在时直接跳至下一字段.
+  static const uint8_t opt_flag[] = { 0x04U, 0x04U, 0x08U, 0x10U, 0x02U };
+
+  if ( pInf->state != INF_ST_GZIP_HDR && !( pInf->flags & opt_flag[pInf->state - INF_ST_GZIP_XLEN] ) )
+  {
+    pInf->state = ( pInf->state == INF_ST_GZIP_XLEN ) ? INF_ST_GZIP_NAME
+                    : ( ( pInf->state == INF_ST_GZIP_HCRC ) ? INF_ST_BLOCK : (uint8_t)( pInf->state + 1U ) );
+    pInf->count = 0;
+    return INF_STEP_PROGRESS;
+  }
+
+  if ( pInf->bitcnt < 8 )
+  {
+    return INF_STEP_NEED;
+  }
+
+  uint8_t b = (uint8_t)inflate_Take(pInf, 8);
+
+  switch( pInf->state )
+  {
+    case INF_ST_GZIP_HDR:
+      // ID1 ID2 CM FLG MTIME(4) XFL OS.
+      if ( ( pInf->count == 0 && b != 0x1FU ) || ( pInf->count == 1 && b != 0x8BU ) || ( pInf->count == 2 && b != 8U ) )
+      {
+        return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+      }
+
+      if ( pInf->count == 3 )
+      {
+        pInf->flags = b;
+      }
+
+      if ( ++pInf->count == 10 )
+      {
+        pInf->count = 0;
+        pInf->state = INF_ST_GZIP_XLEN;
+      }
+      break;
+
+    case INF_ST_GZIP_XLEN:
+      // XLEN(小端).
+      if ( pInf->count++ == 0 )
+      {
+        pInf->stored_left = b;
+        break;
+      }
+
+      pInf->stored_left |= (uint16_t)( (uint16_t)b << 8 );
+      pInf->count = 0;
+      pInf->state = ( pInf->stored_left > 0 ) ? INF_ST_GZIP_EXTRA : INF_ST_GZIP_NAME;
+      break;
+
+    case INF_ST_GZIP_EXTRA:
+      if ( --pInf->stored_left == 0 )
+      {
+        pInf->state = INF_ST_GZIP_NAME;
+      }
+      break;
+
+    case INF_ST_GZIP_NAME:
+    case INF_ST_GZIP_COMMENT:
+      if ( b == 0 )
+      {
+        pInf->state++;
+      }
+      break;
+
+    case INF_ST_GZIP_HCRC:
+      if ( ++pInf->count == 2 )
+      {
+        pInf->count = 0;
+        pInf->state = INF_ST_BLOCK;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return INF_STEP_PROGRESS;
+}
+
+
+
+
+// 动态 Huffman 块的码表.
+static int inflate_Dynamic( http_inflate_t *pInf )
+{
+  int sym;
+  uint8_t n;
+
+  if ( pInf->state == INF_ST_TABLE )
+  {
+    if ( pInf->bitcnt < 14 )
+    {
+      return INF_STEP_NEED;
+    }
+
+    pInf->nlen = (uint16_t)( inflate_Take(pInf, 5) + 257U );
+    pInf->ndist = (uint16_t)( inflate_Take(pInf, 5) + 1U );
+    pInf->ncode = (uint16_t)( inflate_Take(pInf, 4) + 4U );
+
+    if ( pInf->nlen > 286 || pInf->ndist > 30 )
+    {
+      return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+    }
+
+    memset(pInf->lengths, 0, 19);
+
+    pInf->count = 0;
+    pInf->state = INF_ST_CODELENS;
+    return INF_STEP_PROGRESS;
+  }
+
+  if ( pInf->state == INF_ST_CODELENS )
+  {
+    while( pInf->count < pInf->ncode )
+    {
+      if ( pInf->bitcnt < 3 )
+      {
+        return INF_STEP_NEED;
+      }
+
+      pInf->lengths[inf_codelen_order[pInf->count++]] = (uint8_t)inflate_Take(pInf, 3);
+    }
+
+    // 码长码表暂存于距离码表中，读完码长后再构建真正的距离码表.
+    if ( inflate_Build(pInf->dist_count, pInf->dist_symbol, pInf->lengths, 19) != 0 )
+    {
+      return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+    }
+
+    pInf->count = 0;
+    pInf->state = INF_ST_LENLENS;
+    return INF_STEP_PROGRESS;
+  }
+
+  uint16_t total = (uint16_t)( pInf->nlen + pInf->ndist );
+
+  while( pInf->count < total )
+  {
+    sym = inflate_Decode(pInf, pInf->dist_count, pInf->dist_symbol, &n);
+
+    if ( sym == INF_DECODE_NEED )
+    {
+      return INF_STEP_NEED;
+    }
+
+    if ( sym < 0 )
+    {
+      return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+    }
+
+    if ( sym < 16 )
+    {
+      (void)inflate_Take(pInf, n);
+      pInf->lengths[pInf->count++] = (uint8_t)sym;
+      continue;
+    }
+
+    // 16: 重复前一码长 3~6 次；17: 0 重复 3~10 次；18: 0 重复 11~138 次.
+    uint8_t extra = ( sym == 16 ) ? 2 : ( ( sym == 17 ) ? 3 : 7 );
+
+    if ( pInf->bitcnt < n + extra )
+    {
+      return INF_STEP_NEED;
+    }
+
+    if ( sym == 16 && pInf->count == 0 )
+    {
+      return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+    }
+
+    (void)inflate_Take(pInf, n);
+
+    uint8_t rep_len = ( sym == 16 ) ? pInf->lengths[pInf->count - 1] : 0;
+    uint16_t rep = (uint16_t)( ( ( sym == 18 ) ? 11U : 3U ) + inflate_Take(pInf, extra) );
+
+    if ( pInf->count + rep > total )
+    {
+      return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+    }
+
+    while( rep-- > 0 )
+    {
+      pInf->lengths[pInf->count++] = rep_len;
+    }
+  }
+
+  // 必须有块结束码. 不完整的码表仅允许只有一个长度为 1 的码的情况.
+  if ( pInf->lengths[256] == 0 )
+  {
+    return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+  }
+
+  int err = inflate_Build(pInf->lit_count, pInf->lit_symbol, pInf->lengths, pInf->nlen);
+
+  if ( err < 0 || ( err > 0 && pInf->nlen != pInf->lit_count[0] + pInf->lit_count[1] ) )
+  {
+    return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+  }
+
+  err = inflate_Build(pInf->dist_count, pInf->dist_symbol, &pInf->lengths[pInf->nlen], pInf->ndist);
+
+  if ( err < 0 || ( err > 0 && pInf->ndist != pInf->dist_count[0] + pInf->dist_count[1] ) )
+  {
+    return inflate_Stop(pInf, HTTP_INFLATE_ERR_FORMAT);
+  }
+
+  pInf->state = INF_ST_CODES;
+  return INF_STEP_PROGRESS;
+}
+
+
+
+
+// 尾部: gzip 为 CRC32 + ISIZE(小端)，zlib 为 Adler-32(大端)，裸 deflate 无尾部.
+static int inflate_Trailer( http_inflate_t *pInf )
+{
+  uint8_t need = ( pInf->format == HTTP_INFLATE_FMT_GZIP ) ? 8U : ( pInf->zlib ? 4U : 0U );
+
+  if ( pInf->count == 0 )
+  {
+    (void)inflate_Take(pInf, (uint8_t)( pInf->bitcnt & 7U ));
+  }
+
+  while( pInf->count < need )
+  {
+    if ( pInf->bitcnt < 8 )
+    {
+      return INF_STEP_NEED;
+    }
+
+    pInf->trailer[pInf->count++] = (uint8_t)inflate_Take(pInf, 8);
+  }
+
+  // 校验覆盖全部输出.
+  inflate_Flush(pInf);
+
+  const uint8_t *t = pInf->trailer;
+
+  if ( pInf->format == HTTP_INFLATE_FMT_GZIP )
+  {
+    uint32_t crc = (uint32_t)t[0] | ( (uint32_t)t[1] << 8 ) | ( (uint32_t)t[2] << 16 ) | ( (uint32_t)t[3] << 24 );
+    uint32_t isize = (uint32_t)t[4] | ( (uint32_t)t[5] << 8 ) | ( (uint32_t)t[6] << 16 ) | ( (uint32_t)t[7] << 24 );
+
+    if ( crc != ~pInf->check || isize != pInf->out_total )
+    {
+      return inflate_Stop(pInf, HTTP_INFLATE_ERR_CHECK);
+    }
+  }
+  else if ( pInf->zlib )
+  {
+    uint32_t adler = ( (uint32_t)t[0] << 24 ) | ( (uint32_t)t[1] << 16 ) | ( (uint32_t)t[2] << 8 ) | (uint32_t)t[3];
+
+    if ( adler != pInf->check )
+    {
+      return inflate_Stop(pInf, HTTP_INFLATE_ERR_CHECK);
+    }
+  }
+
+  return inflate_Stop(pInf, HTTP_INFLATE_DONE);
+}
+
+
+
+
+static int inflate_Stop( http_inflate_t *pInf, http_inflate_status_t status )
+{
+  pInf->status = status;
+  pInf->state = INF_ST_STOP;
+
+  return INF_STEP_STOP;
+}
+
+
+
+
+// 从位缓冲取 n(<= 16) 位，调用前须确认位数足够.
+static uint32_t inflate_Take( http_inflate_t *pInf, uint8_t n )
+{
+  uint32_t v = pInf->bitbuf & ( ( 1UL << n ) - 1UL );
+
+  pInf->bitbuf >>= n;
+  pInf->bitcnt -= n;
+
+  return v;
+}
+
+
+
+
+// 规范 Huffman 码逐位解码(只读取不消费). 成功时返回符号并由 *pLen 给出码长.
+static int inflate_Decode( const http_inflate_t *pInf, const uint16_t *count, const uint16_t *symbol, uint8_t *pLen )
+{
+  uint32_t bits = pInf->bitbuf;
+  int code = 0, first = 0, index = 0;
+
+  for ( uint8_t len = 1; len <= 15; len++ )
+  {
+    if ( len > pInf->bitcnt )
+    {
+      return INF_DECODE_NEED;
+    }
+
+    code |= (int)( bits & 1U );
+    bits >>= 1;
+
+    int n = count[len];
+
+    if ( code - n < first )
+    {
+      *pLen = len;
+      return symbol[index + ( code - first )];
+    }
+
+    index += n;
+    first = ( first + n ) << 1;
+    code <<= 1;
+  }
+
+  return INF_DECODE_ERROR;
+}
+
+
+
+
+// 由码长构建规范 Huffman 码表. 返回 0 完整，> 0 不完整，< 0 码长超额.
+static int inflate_Build( uint16_t *count, uint16_t *symbol, const uint8_t *length, uint16_t n )
+{
+  uint16_t offs[16];
+  int left = 1;
+
+  memset(count, 0, 16 * sizeof(uint16_t));
+
+  for ( uint16_t s = 0; s < n; s++ )
+  {
+    count[length[s]]++;
+  }
+
+  if ( count[0] == n )
+  {
+    return 0;
+  }
+
+  for ( uint8_t len = 1; len < 16; len++ )
+  {
+    left = ( left << 1 ) - count[len];
+
+    if ( left < 0 )
+    {
+      return left;
+    }
+  }
+
+  offs[1] = 0;
+
+  for ( uint8_t len = 1; len < 15; len++ )
+  {
+    offs[len + 1] = (uint16_t)( offs[len] + count[len] );
+  }
+
+  for ( uint16_t s = 0; s < n; s++ )
+  {
+    if ( length[s] != 0 )
+    {
+      symbol[offs[length[s]]++] = s;
+    }
+  }
+
+  return left;
+}
+
+
+
+
+// 固定 Huffman 码表(RFC 1951 3.2.6).
+static void inflate_Fixed( http_inflate_t *pInf )
+{
+  uint16_t s = 0;
+
+  for ( ; s < 144; s++ ) pInf->lengths[s] = 8;
+  for ( ; s < 256; s++ ) pInf->lengths[s] = 9;
+  for ( ; s < 280; s++ ) pInf->lengths[s] = 7;
+  for ( ; s < 288; s++ ) pInf->lengths[s] = 8;
+
+  (void)inflate_Build(pInf->lit_count, pInf->lit_symbol, pInf->lengths, 288);
+
+  memset(pInf->lengths, 5, 30);
+
+  (void)inflate_Build(pInf->dist_count, pInf->dist_symbol, pInf->lengths, 30);
+}
+
+
+
+
+// 输出一个字节至窗口，窗口写满一圈时交给 on_out.
+static void inflate_Put( http_inflate_t *pInf, uint8_t b )
+{
+  pInf->window[pInf->wpos++] = b;
+  pInf->out_total++;
+
+  if ( pInf->wpos == HTTP_INFLATE_WINDOW )
+  {
+    inflate_Flush(pInf);
+
+    pInf->wpos = 0;
+    pInf->flush_pos = 0;
+  }
+}
+
+
+
+
+// 将窗口中尚未输出的部分交给 on_out 并计入校验值.
+static void inflate_Flush( http_inflate_t *pInf )
+{
+  uint16_t n = (uint16_t)( pInf->wpos - pInf->flush_pos );
+
+  if ( n == 0 )
+  {
+    return;
+  }
+
+  inflate_Check(pInf, &pInf->window[pInf->flush_pos], n);
+
+  if ( pInf->on_out )
+  {
+    pInf->on_out(pInf->ctx, &pInf->window[pInf->flush_pos], n);
+  }
+
+  pInf->flush_pos = pInf->wpos;
+}
+
+
+
+
+static void inflate_Check( http_inflate_t *pInf, const uint8_t *data, uint16_t len )
+{
+  if ( pInf->format == HTTP_INFLATE_FMT_GZIP )
+  {
+    uint32_t crc = pInf->check;
+
+    for ( uint16_t i = 0; i < len; i++ )
+    {
+      crc ^= data[i];
+      crc = ( crc >> 4 ) ^ inf_crc_tab[crc & 0x0FU];
+      crc = ( crc >> 4 ) ^ inf_crc_tab[crc & 0x0FU];
+    }
+
+    pInf->check = crc;
+  }
+  else if ( pInf->zlib )
+  {
+    uint32_t a = pInf->check & 0xFFFFU;
+    uint32_t b = pInf->check >> 16;
+
+    for ( uint16_t i = 0; i < len; i++ )
+    {
+      a = ( a + data[i] ) % 65521UL;
+      b = ( b + a ) % 65521UL;
+    }
+
+    pInf->check = ( b << 16 ) | a;
+  }
+}
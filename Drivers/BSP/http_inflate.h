@@ -0,0 +1,105 @@
+#ifndef __HTTP_INFLATE_H
+#define __HTTP_INFLATE_H
+
+#include "stm32f4xx_hal.h"
+#include <string.h>
+#include <stdbool.h>
+
+
+/*  *********************************************    */
+#define HTTP_INFLATE_WINDOW_BITS   ( 12U )    // 滑动窗口 2^n 字节(10~15，即 1KB~32KB). 解码后不超过窗口的响应总能完整解码.
+#define HTTP_INFLATE_WINDOW        ( 1U << HTTP_INFLATE_WINDOW_BITS )
+
+#define HTTP_INFLATE_FMT_GZIP      ( 0U )     // Content-Encoding: gzip (RFC 1952).
+#define HTTP_INFLATE_FMT_DEFLATE   ( 1U )     // Content-Encoding: deflate，自动识别 zlib 封装(RFC 1950)或裸 deflate.
+/*  *********************************************    */
+
+#if ( HTTP_INFLATE_WINDOW_BITS < 10 ) || ( HTTP_INFLATE_WINDOW_BITS > 15 )
+  #error "HTTP_INFLATE_WINDOW_BITS must be 10..15"
+#endif
+
+
+typedef enum
+{
+  HTTP_INFLATE_OK = 0,         // 解码中，等待更多输入.
+  HTTP_INFLATE_DONE,           // 数据流结束且校验通过.
+  HTTP_INFLATE_ERR_FORMAT,     // 头部 / 块格式非法.
+  HTTP_INFLATE_ERR_WINDOW,     // 回溯距离超出本地窗口(服务器使用了更大的窗口).
+  HTTP_INFLATE_ERR_CHECK       // 尾部 CRC32 / Adler-32 / 长度校验失败.
+} http_inflate_status_t;
+
+
+// 解码输出. data 指向滑动窗口内部，仅在回调期间有效.
+typedef void (*http_inflate_out_t)( void *ctx, const uint8_t *data, uint16_t len );
+
+
+/**
+ * @brief 流式 inflate 解码器.
+ *
+ *  输入可在任意字节处切分(按位缓存，状态在多次 http_inflate_Feed() 之间保持)，输出经滑动窗口
+ *  分段交给 on_out，不需要缓存整个响应体. 内存占用固定：窗口 HTTP_INFLATE_WINDOW 字节加约 1KB 码表.
+ *
+ *  in_total / out_total：已输入的压缩字节数 / 已输出的解码字节数.
+ *  stream_wbits：zlib 头声明的窗口位数(0 表示未声明，gzip 与裸 deflate 不携带).
+ *  max_dist：实际出现的最大回溯距离.
+ */
+typedef struct
+{
+  uint8_t state;
+  uint8_t format;
+  uint8_t zlib;
+  uint8_t last;                // 当前块为最后一块.
+  uint8_t flags;               // gzip 头部 FLG.
+  uint8_t sym_extra;           // 待读取附加位的长度 / 距离符号.
+  uint8_t stream_wbits;
+  http_inflate_status_t status;
+
+  uint32_t bitbuf;
+  uint8_t bitcnt;
+
+  uint16_t count;              // 头部字节 / 码长等的计数.
+  uint16_t stored_left;        // 存储块剩余字节数.
+  uint16_t copy_len;
+  uint16_t copy_dist;
+  uint16_t max_dist;
+
+  uint16_t nlen;               // 动态块: 字面量 / 长度码数.
+  uint16_t ndist;              // 动态块: 距离码数.
+  uint16_t ncode;              // 动态块: 码长码数.
+  uint8_t lengths[320];
+
+  uint16_t lit_count[16];
+  uint16_t lit_symbol[288];
+  uint16_t dist_count[16];
+  uint16_t dist_symbol[30];
+
+  uint8_t window[HTTP_INFLATE_WINDOW];
+  uint16_t wpos;               // 下一个输出字节在窗口中的位置.
+  uint16_t flush_pos;          // 尚未交给 on_out 的起始位置.
+
+  uint32_t check;              // CRC32(gzip) / Adler-32(zlib) 运行值.
+  uint8_t trailer[8];
+
+  uint32_t in_total;
+  uint32_t out_total;
+
+  http_inflate_out_t on_out;
+  void *ctx;
+
+} http_inflate_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  void http_inflate_Init( http_inflate_t *pInf, uint8_t format, http_inflate_out_t on_out, void *ctx );
+
+  http_inflate_status_t http_inflate_Feed( http_inflate_t *pInf, const uint8_t *data, uint16_t len );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __HTTP_INFLATE_H
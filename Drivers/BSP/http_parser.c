@@ -0,0 +1,571 @@
+#include "http_parser.h"
+
+
+#define PARSER_CHUNK_SIZE         ( 0U )    // 分块长度(十六进制).
+#define PARSER_CHUNK_EXT          ( 1U )    // 长度之后的扩展(";name=value")，忽略至行尾.
+#define PARSER_CHUNK_DATA         ( 2U )    // 分块数据.
+#define PARSER_CHUNK_DATA_END     ( 3U )    // 分块数据之后的 CRLF.
+
+
+/*  **********************************   */
+void http_parser_Init( http_parser_t *pParser, const http_parser_ops_t *ops, void *ctx );
+uint16_t http_parser_Feed( http_parser_t *pParser, const uint8_t *data, uint16_t len );
+bool http_parser_Finish( http_parser_t *pParser );
+static void parser_Reset( http_parser_t *pParser );
+static void parser_Line( http_parser_t *pParser );
+static void parser_StatusLine( http_parser_t *pParser );
+static void parser_HeaderLine( http_parser_t *pParser );
+static void parser_HeadersEnd( http_parser_t *pParser );
+static uint16_t parser_Body( http_parser_t *pParser, const uint8_t *data, uint16_t len );
+static uint16_t parser_Chunked( http_parser_t *pParser, const uint8_t *data, uint16_t len );
+static void parser_TrailerLine( http_parser_t *pParser );
+static void parser_Complete( http_parser_t *pParser );
+static bool parser_EqualCi( const char *a, const char *b );
+static bool parser_PrefixCi( const char *str, const char *prefix );
+static char *parser_Trim( char *str );
+/*  **********************************   */
+
+
+
+
+/**
+ * @brief 初始化解析器（每个响应之前调用一次）
+ *
+ * @param[out] pParser 解析器实例
+ * @param[in]  ops     消费方回调（可为 NULL，仅解析不投递）
+ * @param[in]  ctx     透传给回调的上下文指针
+ */
+void http_parser_Init( http_parser_t *pParser, const http_parser_ops_t *ops, void *ctx )
+{
+  if ( pParser == NULL )
+  {
+    return;
+  }
+
+  pParser->ops = ops;
+  pParser->ctx = ctx;
+  pParser->rx_bytes = 0;
+
+  parser_Reset(pParser);
+}
+
+
+
+
+/**
+ * @brief 输入一段响应字节
+ *
+ * 状态行、头部与分块尾部字段逐行识别（跨分片拼接）；响应体按 Content-Length 计数，或按分块
+ * 长度逐块解码（长度行、分隔符可在任意字节处被切分），数据部分直接以输入指针交给 `on_body`。
+ * 响应完整后停止消费。
+ *
+ * @param[in,out] pParser 解析器实例
+ * @param[in]     data    输入字节
+ * @param[in]     len     输入长度
+ *
+ * @return 已消费的字节数（小于 len 表示响应已完整或状态行非法，其余字节不属于本响应）
+ */
+uint16_t http_parser_Feed( http_parser_t *pParser, const uint8_t *data, uint16_t len )
+{
+  uint16_t i = 0;
+
+  if ( pParser == NULL || data == NULL )
+  {
+    return 0;
+  }
+
+  while( i < len && pParser->state != HTTP_PARSER_DONE && pParser->state != HTTP_PARSER_ERROR )
+  {
+    if ( pParser->state == HTTP_PARSER_BODY )
+    {
+      i += parser_Body(pParser, &data[i], (uint16_t)( len - i ));
+      continue;
+    }
+
+    char c = (char)data[i++];
+
+    if ( c == '\n' )
+    {
+      parser_Line(pParser);
+      pParser->line_len = 0;
+    }
+    else if ( c != '\r' )
+    {
+      if ( pParser->line_len < HTTP_PARSER_LINE_MAX - 1 )
+      {
+        pParser->line[pParser->line_len] = c;
+      }
+
+      if ( pParser->line_len < 0xFFFF )
+      {
+        pParser->line_len++;
+      }
+    }
+  }
+
+  pParser->rx_bytes += i;
+
+  return i;
+}
+
+
+
+
+/**
+ * @brief 连接已关闭：未给出长度的响应体以关闭作为结束
+ *
+ * @retval true  响应完整
+ * @retval false 响应不完整（头部未结束，或按长度 / 分块计尚有数据未到达）
+ */
+bool http_parser_Finish( http_parser_t *pParser )
+{
+  if ( pParser == NULL )
+  {
+    return false;
+  }
+
+  if ( pParser->state == HTTP_PARSER_BODY && !pParser->chunked && pParser->content_len == HTTP_PARSER_NO_LENGTH )
+  {
+    parser_Complete(pParser);
+  }
+
+  return ( pParser->state == HTTP_PARSER_DONE );
+}
+
+
+
+
+// 清除单个响应的解析状态(保留 ops / ctx / rx_bytes). 1xx 临时响应之后同样调用.
+static void parser_Reset( http_parser_t *pParser )
+{
+  pParser->state = HTTP_PARSER_STATUS;
+  pParser->line_len = 0;
+  pParser->status_code = 0;
+  pParser->conn_close = false;
+  pParser->chunked = false;
+  pParser->content_len = HTTP_PARSER_NO_LENGTH;
+  pParser->ka_timeout_s = 0;
+  pParser->content_enc = HTTP_PARSER_ENC_IDENTITY;
+  pParser->body_len = 0;
+  pParser->chunk_state = PARSER_CHUNK_SIZE;
+  pParser->chunk_digits = 0;
+  pParser->chunk_left = 0;
+}
+
+
+
+
+// 一行结束(不含行尾).
+static void parser_Line( http_parser_t *pParser )
+{
+  uint16_t n = ( pParser->line_len < HTTP_PARSER_LINE_MAX - 1 ) ? pParser->line_len : HTTP_PARSER_LINE_MAX - 1;
+
+  pParser->line[n] = '\0';
+
+  if ( pParser->state == HTTP_PARSER_STATUS )
+  {
+    // 状态行之前的空行忽略.
+    if ( pParser->line_len != 0 )
+    {
+      parser_StatusLine(pParser);
+    }
+  }
+  else if ( pParser->state == HTTP_PARSER_TRAILER )
+  {
+    // 尾部字段以空行结束.
+    if ( pParser->line_len == 0 )
+    {
+      parser_Complete(pParser);
+    }
+    else
+    {
+      parser_TrailerLine(pParser);
+    }
+  }
+  else if ( pParser->line_len == 0 )
+  {
+    parser_HeadersEnd(pParser);
+  }
+  else
+  {
+    parser_HeaderLine(pParser);
+  }
+}
+
+
+
+
+// "HTTP/1.x <code> <reason>".
+static void parser_StatusLine( http_parser_t *pParser )
+{
+  const char *p = pParser->line;
+
+  if ( strncmp(p, "HTTP/", 5) != 0 )
+  {
+    pParser->state = HTTP_PARSER_ERROR;
+    return;
+  }
+
+  // HTTP/1.0 默认不保持连接.
+  pParser->conn_close = ( strncmp(p, "HTTP/1.0", 8) == 0 );
+
+  while( *p != '\0' && *p != ' ' )
+  {
+    p++;
+  }
+
+  while( *p == ' ' )
+  {
+    p++;
+  }
+
+  if ( !isdigit((unsigned char)*p) )
+  {
+    pParser->state = HTTP_PARSER_ERROR;
+    return;
+  }
+
+  pParser->status_code = (uint16_t)atoi(p);
+  pParser->state = HTTP_PARSER_HEADER;
+
+  if ( pParser->ops && pParser->ops->on_status )
+  {
+    pParser->ops->on_status(pParser->ctx, pParser->status_code);
+  }
+}
+
+
+
+
+// "<name>: <value>". 识别与响应结束判定、连接复用相关的字段，全部字段均投递给 on_header.
+static void parser_HeaderLine( http_parser_t *pParser )
+{
+  char *colon = strchr(pParser->line, ':');
+
+  if ( colon == NULL )
+  {
+    return;  // 非法行(或被截断的续行)，忽略.
+  }
+
+  *colon = '\0';
+
+  char *name = parser_Trim(pParser->line);
+  char *value = parser_Trim(colon + 1);
+
+  if ( parser_EqualCi(name, "Content-Length") )
+  {
+    // 只接受纯十进制数字. 无数字、超出 int32_t 或行被截断(数值可能不完整)时无法据此判定响应结束，按格式非法处理.
+    const char *v = value;
+    int32_t n = 0;
+
+    for ( ; isdigit((unsigned char)*v); v++ )
+    {
+      if ( n > ( INT32_MAX - ( *v - '0' ) ) / 10 )
+      {
+        break;
+      }
+
+      n = n * 10 + ( *v - '0' );
+    }
+
+    if ( v == value || *v != '\0' || http_parser_LineTruncated(pParser) )
+    {
+      pParser->state = HTTP_PARSER_ERROR;
+      return;
+    }
+
+    pParser->content_len = n;
+  }
+  else if ( parser_EqualCi(name, "Connection") )
+  {
+    if ( parser_PrefixCi(value, "close") )
+    {
+      pParser->conn_close = true;
+    }
+    else if ( parser_PrefixCi(value, "keep-alive") )
+    {
+      pParser->conn_close = false;
+    }
+  }
+  else if ( parser_EqualCi(name, "Transfer-Encoding") )
+  {
+    pParser->chunked = ( strstr(value, "chunked") != NULL );
+  }
+  else if ( parser_EqualCi(name, "Content-Encoding") )
+  {
+    if ( parser_PrefixCi(value, "gzip") || parser_PrefixCi(value, "x-gzip") )
+    {
+      pParser->content_enc = HTTP_PARSER_ENC_GZIP;
+    }
+    else if ( parser_PrefixCi(value, "deflate") )
+    {
+      pParser->content_enc = HTTP_PARSER_ENC_DEFLATE;
+    }
+    else if ( !parser_PrefixCi(value, "identity") )
+    {
+      pParser->content_enc = HTTP_PARSER_ENC_OTHER;
+    }
+  }
+  else if ( parser_EqualCi(name, "Keep-Alive") )
+  {
+    const char *t = strstr(value, "timeout=");
+
+    if ( t != NULL )
+    {
+      pParser->ka_timeout_s = (uint16_t)atoi(t + 8);
+    }
+  }
+
+  if ( pParser->ops && pParser->ops->on_header )
+  {
+    pParser->ops->on_header(pParser->ctx, name, value);
+  }
+}
+
+
+
+
+// 空行: 头部结束. 1xx 为临时响应，其后还有最终响应；204 / 304 与 Content-Length: 0 无响应体.
+static void parser_HeadersEnd( http_parser_t *pParser )
+{
+  if ( pParser->status_code >= 100 && pParser->status_code < 200 )
+  {
+    parser_Reset(pParser);
+    return;
+  }
+
+  if ( pParser->ops && pParser->ops->on_headers_done )
+  {
+    pParser->ops->on_headers_done(pParser->ctx);
+  }
+
+  if ( pParser->status_code == 204 || pParser->status_code == 304
+        || ( !pParser->chunked && pParser->content_len == 0 ) )
+  {
+    parser_Complete(pParser);
+    return;
+  }
+
+  pParser->state = HTTP_PARSER_BODY;
+}
+
+
+
+
+// 响应体: 按长度截取本响应的部分并投递，返回消费的字节数.
+static uint16_t parser_Body( http_parser_t *pParser, const uint8_t *data, uint16_t len )
+{
+  uint16_t n = len;
+  bool done = false;
+
+  if ( pParser->chunked )
+  {
+    return parser_Chunked(pParser, data, len);
+  }
+
+  if ( pParser->content_len != HTTP_PARSER_NO_LENGTH )
+  {
+    uint32_t left = (uint32_t)pParser->content_len - pParser->body_len;
+
+    if ( n >= left )
+    {
+      n = (uint16_t)left;
+      done = true;
+    }
+  }
+
+  pParser->body_len += n;
+
+  if ( n > 0 && pParser->ops && pParser->ops->on_body )
+  {
+    pParser->ops->on_body(pParser->ctx, data, n);
+  }
+
+  if ( done )
+  {
+    parser_Complete(pParser);
+  }
+
+  return n;
+}
+
+
+
+
+// 分块编码: "<hex>[;ext]\r\n<data>\r\n" ... "0\r\n[trailer]\r\n". 只投递数据部分，
+// 长度为 0 的分块之后转入尾部字段(按行解析). 返回消费的字节数.
+static uint16_t parser_Chunked( http_parser_t *pParser, const uint8_t *data, uint16_t len )
+{
+  uint16_t i = 0;
+
+  while( i < len && pParser->state == HTTP_PARSER_BODY )
+  {
+    if ( pParser->chunk_state == PARSER_CHUNK_DATA )
+    {
+      uint16_t n = (uint16_t)( len - i );
+
+      if ( pParser->chunk_left < n )
+      {
+        n = (uint16_t)pParser->chunk_left;
+      }
+
+      pParser->body_len += n;
+      pParser->chunk_left -= n;
+
+      if ( pParser->ops && pParser->ops->on_body )
+      {
+        pParser->ops->on_body(pParser->ctx, &data[i], n);
+      }
+
+      i += n;
+
+      if ( pParser->chunk_left == 0 )
+      {
+        pParser->chunk_state = PARSER_CHUNK_DATA_END;
+      }
+
+      continue;
+    }
+
+    char c = (char)data[i++];
+
+    if ( pParser->chunk_state == PARSER_CHUNK_DATA_END )
+    {
+      if ( c == '\n' )
+      {
+        pParser->chunk_state = PARSER_CHUNK_SIZE;
+        pParser->chunk_digits = 0;
+        pParser->chunk_left = 0;
+      }
+      else if ( c != '\r' )
+      {
+        pParser->state = HTTP_PARSER_ERROR;
+      }
+
+      continue;
+    }
+
+    // 长度行.
+    if ( c == '\n' )
+    {
+      if ( pParser->chunk_digits == 0 )
+      {
+        pParser->state = HTTP_PARSER_ERROR;
+      }
+      else if ( pParser->chunk_left == 0 )
+      {
+        pParser->line_len = 0;
+        pParser->state = HTTP_PARSER_TRAILER;
+      }
+      else
+      {
+        pParser->chunk_state = PARSER_CHUNK_DATA;
+      }
+    }
+    else if ( pParser->chunk_state == PARSER_CHUNK_SIZE && isxdigit((unsigned char)c) )
+    {
+      if ( ++pParser->chunk_digits > HTTP_PARSER_CHUNK_DIGITS )
+      {
+        pParser->state = HTTP_PARSER_ERROR;
+        break;
+      }
+
+      pParser->chunk_left = ( pParser->chunk_left << 4 )
+                              | (uint32_t)( isdigit((unsigned char)c) ? c - '0' : tolower((unsigned char)c) - 'a' + 10 );
+    }
+    else if ( c == ';' || c == ' ' || c == '\t' )
+    {
+      pParser->chunk_state = PARSER_CHUNK_EXT;
+    }
+    else if ( c != '\r' && pParser->chunk_state != PARSER_CHUNK_EXT )
+    {
+      pParser->state = HTTP_PARSER_ERROR;
+    }
+  }
+
+  return i;
+}
+
+
+
+
+// 分块编码的尾部字段: 仅投递给 on_header，不影响已确定的长度 / 连接属性.
+static void parser_TrailerLine( http_parser_t *pParser )
+{
+  char *colon = strchr(pParser->line, ':');
+
+  if ( colon == NULL )
+  {
+    return;
+  }
+
+  *colon = '\0';
+
+  if ( pParser->ops && pParser->ops->on_header )
+  {
+    pParser->ops->on_header(pParser->ctx, parser_Trim(pParser->line), parser_Trim(colon + 1));
+  }
+}
+
+
+
+
+static void parser_Complete( http_parser_t *pParser )
+{
+  pParser->state = HTTP_PARSER_DONE;
+
+  if ( pParser->ops && pParser->ops->on_complete )
+  {
+    pParser->ops->on_complete(pParser->ctx);
+  }
+}
+
+
+
+
+// 不区分大小写的字符串比较.
+static bool parser_EqualCi( const char *a, const char *b )
+{
+  return parser_PrefixCi(a, b) && a[strlen(b)] == '\0';
+}
+
+
+
+
+// 不区分大小写的前缀比较.
+static bool parser_PrefixCi( const char *str, const char *prefix )
+{
+  while( *prefix != '\0' )
+  {
+    if ( tolower((unsigned char)*str) != tolower((unsigned char)*prefix) )
+    {
+      return false;
+    }
+
+    str++;
+    prefix++;
+  }
+
+  return true;
+}
+
+
+
+
+// 原地去除首尾空白.
+static char *parser_Trim( char *str )
+{
+  while( *str == ' ' || *str == '\t' )
+  {
+    str++;
+  }
+
+  size_t n = strlen(str);
+
+  while( n > 0 && ( str[n - 1] == ' ' || str[n - 1] == '\t' ) )
+  {
+    str[--n] = '\0';
+  }
+
+  return str;
+}
@@ -0,0 +1,131 @@
+#ifndef __HTTP_PARSER_H
+#define __HTTP_PARSER_H
+
+#include "stm32f4xx_hal.h"
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <stdbool.h>
+
+
+/*  *********************************************    */
+#define HTTP_PARSER_LINE_MAX       ( 96U )    // 状态行 / 头部行保留长度(超长部分截断，不影响后续解析).
+#define HTTP_PARSER_NO_LENGTH      ( -1L )    // 未给出 Content-Length.
+#define HTTP_PARSER_CHUNK_DIGITS   ( 8U )     // 分块长度的最大十六进制位数(32 位).
+
+#define HTTP_PARSER_ENC_IDENTITY   ( 0U )     // Content-Encoding: 未给出 / identity.
+#define HTTP_PARSER_ENC_GZIP       ( 1U )     // gzip / x-gzip.
+#define HTTP_PARSER_ENC_DEFLATE    ( 2U )     // deflate.
+#define HTTP_PARSER_ENC_OTHER      ( 3U )     // 其它(不支持的)编码.
+/*  *********************************************    */
+
+
+typedef enum
+{
+  HTTP_PARSER_STATUS = 0,      // 等待状态行.
+  HTTP_PARSER_HEADER,          // 头部行.
+  HTTP_PARSER_BODY,            // 响应体.
+  HTTP_PARSER_TRAILER,         // 分块编码的尾部字段(最后一个分块之后).
+  HTTP_PARSER_DONE,            // 响应已完整(其后的字节不再消费).
+  HTTP_PARSER_ERROR            // 状态行、Content-Length 或分块格式非法.
+} http_parser_state_t;
+
+
+/**
+ * @brief 解析结果消费方. 均可为 NULL.
+ *
+ *  on_status：状态行解析完成(1xx 临时响应同样投递，其后重新等待状态行).
+ *  on_header：一个头部字段(分块编码的尾部字段同样经此投递). name / value 已去除首尾空白并以 '\0' 结尾，仅在回调期间有效.
+ *  on_headers_done：头部结束，此时 content_len / chunked 等字段已确定.
+ *  on_body：一段响应体(分块编码已解码，不含分块长度行与分隔符). data 直接指向输入缓冲区(零拷贝)，仅在回调期间有效.
+ *  on_complete：响应完整(按 Content-Length / 最后一个分块及尾部字段，或无长度时由 http_parser_Finish() 触发).
+ */
+typedef struct
+{
+  void (*on_status)( void *ctx, uint16_t code );
+
+  void (*on_header)( void *ctx, const char *name, const char *value );
+
+  void (*on_headers_done)( void *ctx );
+
+  void (*on_body)( void *ctx, const uint8_t *data, uint16_t len );
+
+  void (*on_complete)( void *ctx );
+
+} http_parser_ops_t;
+
+
+/**
+ * @brief HTTP/1.x 响应流式解析器.
+ *
+ *  输入可在任意字节处切分，状态在多次 http_parser_Feed() 之间保持；每个字节只检查一次，
+ *  内存占用固定(一行的缓冲)，与响应大小无关.
+ *
+ *  status_code：状态码.
+ *  conn_close：响应后服务器将关闭连接(Connection: close 或 HTTP/1.0 且未声明 keep-alive).
+ *  chunked：Transfer-Encoding: chunked.
+ *  content_len：Content-Length，HTTP_PARSER_NO_LENGTH 表示未给出.
+ *  ka_timeout_s：Keep-Alive: timeout=<s>，0 表示未给出.
+ *  content_enc：Content-Encoding(HTTP_PARSER_ENC_*). 解析器只识别，不解压.
+ *  body_len：已投递的响应体字节数(分块编码下为解码后的长度).
+ *  rx_bytes：已输入的全部字节数.
+ */
+typedef struct
+{
+  http_parser_state_t state;
+
+  char line[HTTP_PARSER_LINE_MAX];
+  uint16_t line_len;
+
+  uint16_t status_code;
+  bool conn_close;
+  bool chunked;
+  int32_t content_len;
+  uint16_t ka_timeout_s;
+  uint8_t content_enc;
+  uint32_t body_len;
+  uint32_t rx_bytes;
+
+  uint8_t chunk_state;         // 分块编码子状态(长度行 / 扩展 / 数据 / 数据后的 CRLF).
+  uint8_t chunk_digits;        // 当前长度行已读的十六进制位数.
+  uint32_t chunk_left;         // 当前分块剩余的数据字节数.
+
+  const http_parser_ops_t *ops;
+  void *ctx;
+
+} http_parser_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  void http_parser_Init( http_parser_t *pParser, const http_parser_ops_t *ops, void *ctx );
+
+  uint16_t http_parser_Feed( http_parser_t *pParser, const uint8_t *data, uint16_t len );
+
+  bool http_parser_Finish( http_parser_t *pParser );
+
+  static inline bool http_parser_HeadersDone( const http_parser_t *pParser )
+  {
+    return ( pParser->state == HTTP_PARSER_BODY || pParser->state == HTTP_PARSER_TRAILER
+              || pParser->state == HTTP_PARSER_DONE );
+  }
+
+  static inline bool http_parser_IsComplete( const http_parser_t *pParser )
+  {
+    return ( pParser->state == HTTP_PARSER_DONE );
+  }
+
+  // 当前行是否超出 HTTP_PARSER_LINE_MAX 而被截断. 仅在 on_status / on_header 回调期间有意义.
+  static inline bool http_parser_LineTruncated( const http_parser_t *pParser )
+  {
+    return ( pParser->line_len >= HTTP_PARSER_LINE_MAX );
+  }
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __HTTP_PARSER_H
@@ -0,0 +1,198 @@
+#include "isr_log.h"
+
+
+// 事件环(多生产者/单消费者，生产者以短临界区互斥).
+static IsrLogRecord_t isr_log_ring[ISR_LOG_RING_SIZE];
+
+// 写入计数(仅在生产者临界区内修改)与读取计数(仅排空任务修改)，均为自由递增计数，取模得到下标.
+static volatile uint32_t isr_log_head = 0;
+static volatile uint32_t isr_log_tail = 0;
+
+// 事件环已满而被丢弃的记录数(仅在生产者临界区内修改).
+static volatile uint32_t isr_log_dropped = 0;
+
+static const char * const level_name[] = { "?", "D", "I", "W", "E" };
+
+
+/*  **********************************   */
+void isr_log_PushFromISR( uint8_t level, const char *tag, const char *fmt, uint32_t arg0, uint32_t arg1 );
+bool isr_log_Pop( IsrLogRecord_t *pRecord );
+uint32_t isr_log_GetDropped( void );
+ErrorStatus vIsrLog_TaskCreate( void );
+static void vtaskIsrLog_Drain( void *parameter );
+/*  **********************************   */
+
+
+
+
+/**
+ * @brief 在中断上下文中追加一条事件记录（不阻塞、执行时间固定）
+ *
+ * @details
+ *   仅拷贝 20 字节的记录并递增写计数，不做格式化、不访问外设、不获取任何互斥量，
+ *   因此不会像在中断中调用 `printf()`（经 `fputc()` 获取互斥量并阻塞发送）那样拉长中断或造成死锁。
+ *
+ * @note
+ *   - 多生产者安全：槽位的占用、填写与写计数的发布在 `taskENTER_CRITICAL_FROM_ISR()` 内完成，
+ *     不同优先级的中断（如 UART4 优先级 5 与 DMA1_Stream4 优先级 6）及任务上下文可并发调用；
+ *     调用者的优先级不得高于 configMAX_SYSCALL_INTERRUPT_PRIORITY；
+ *   - 事件环满时丢弃新记录并累加丢弃计数，不覆盖尚未排空的旧记录；
+ *   - 也可在任务上下文调用，但任务中应优先使用 `LOG_WRITE`。
+ *
+ * @param level 日志级别（LogLevel_t）
+ * @param tag   来源标识（字符串常量）
+ * @param fmt   格式字符串（字符串常量，最多两个 32 位参数）
+ * @param arg0  参数 0
+ * @param arg1  参数 1
+ */
+void isr_log_PushFromISR( uint8_t level, const char *tag, const char *fmt, uint32_t arg0, uint32_t arg1 )
+{
+  // 临界区仅覆盖一次 20 字节拷贝，屏蔽时间固定且很短.
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  uint32_t head = isr_log_head;
+
+  if ( ( head - isr_log_tail ) >= ISR_LOG_RING_SIZE )
+  {
+    isr_log_dropped++;
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+    return;
+  }
+
+  IsrLogRecord_t *pRecord = &isr_log_ring[head & ISR_LOG_RING_MASK];
+
+  pRecord->timeStamp = xTaskGetTickCountFromISR();
+  pRecord->level = level;
+  pRecord->tag = tag;
+  pRecord->fmt = fmt;
+  pRecord->arg0 = arg0;
+  pRecord->arg1 = arg1;
+
+  // 记录内容须先于写计数对消费者可见.
+  __DMB();
+
+  isr_log_head = head + 1;
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+
+
+
+/**
+ * @brief 从事件环取出一条记录（仅限排空任务这一个消费者调用）
+ *
+ * @param[out] pRecord 输出记录
+ *
+ * @retval true  取出成功
+ * @retval false 事件环为空
+ */
+bool isr_log_Pop( IsrLogRecord_t *pRecord )
+{
+  uint32_t tail = isr_log_tail;
+
+  if ( pRecord == NULL || tail == isr_log_head )
+  {
+    return false;
+  }
+
+  // 读取记录前确认写计数已更新.
+  __DMB();
+
+  *pRecord = isr_log_ring[tail & ISR_LOG_RING_MASK];
+
+  // 记录读取完毕后才释放槽位.
+  __DMB();
+
+  isr_log_tail = tail + 1;
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 获取因事件环已满而丢弃的记录数
+ */
+uint32_t isr_log_GetDropped( void )
+{
+  return isr_log_dropped;
+}
+
+
+
+
+/**
+ * @brief 创建中断日志排空任务（低优先级）
+ *
+ * @retval SUCCESS 创建成功
+ * @retval ERROR   创建失败（中断事件仍会写入事件环，但不会被输出）
+ */
+ErrorStatus vIsrLog_TaskCreate( void )
+{
+  BaseType_t err = xTaskCreate((TaskFunction_t)vtaskIsrLog_Drain,
+                                 "vtaskIsrLog",
+                                    ISR_LOG_TASK_DEPTH,
+                                      NULL,
+                                        ISR_LOG_TASK_PRIO,
+                                         NULL );
+
+  if ( err != pdPASS )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("IsrLog Task Create Failed! in isr_log.c\n");
+    #endif // __DEBUG_LEVEL_1__
+
+    return ERROR;
+  }
+
+  return SUCCESS;
+}
+
+
+
+
+// 周期性排空事件环: 格式化后输出至调试串口，较高级别的事件写入 Flash 日志.
+static void vtaskIsrLog_Drain( void *parameter )
+{
+  IsrLogRecord_t record;
+  LogType_t log;
+  uint32_t reported_dropped = 0;
+
+  (void)parameter;
+
+  for( ; ; )
+  {
+    while( isr_log_Pop(&record) )
+    {
+      memset(&log, 0, sizeof(log));
+
+      log.timeStamp = record.timeStamp;   // 保留事件发生时刻而非排空时刻.
+      log.level = (LogLevel_t)record.level;
+      strncpy(log.taskName, record.tag, sizeof(log.taskName) - 1);
+      snprintf(log.message, sizeof(log.message), record.fmt, record.arg0, record.arg1);
+
+      #if defined(__DEBUG_LEVEL_1__)
+        printf("[ISR %lu][%s] %s: %s\n", (unsigned long)log.timeStamp,
+                  level_name[( record.level <= LOG_ERROR ) ? record.level : 0], log.taskName, log.message);
+      #endif // __DEBUG_LEVEL_1__
+
+      if ( record.level >= ISR_LOG_FLASH_LEVEL )
+      {
+        Log_Flash_Write(&log);
+      }
+    }
+
+    uint32_t dropped = isr_log_dropped;
+
+    if ( dropped != reported_dropped )
+    {
+      LOG_WRITE(LOG_WARNING, "ISRLOG", "%lu isr records dropped.", (unsigned long)( dropped - reported_dropped ));
+
+      reported_dropped = dropped;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(ISR_LOG_DRAIN_PERIOD));
+  }
+}
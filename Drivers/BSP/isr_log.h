@@ -0,0 +1,82 @@
+#ifndef __ISR_LOG_H
+#define __ISR_LOG_H
+
+#include "stm32f4xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "flash_log.h"
+#include <stdbool.h>
+#include <string.h>
+
+
+/*  *********************************************    */
+#define ISR_LOG_RING_SIZE          ( 32UL )     // 事件环容量(条),必须为2的幂.
+#define ISR_LOG_RING_MASK          ( ISR_LOG_RING_SIZE - 1 )
+#define ISR_LOG_FLASH_LEVEL        ( LOG_WARNING ) // 不低于该级别的事件同时写入 Flash 日志.
+#define ISR_LOG_DRAIN_PERIOD       ( 50UL )     // 排空任务轮询周期(ms).
+#define ISR_LOG_TASK_DEPTH         ( 384 )
+#define ISR_LOG_TASK_PRIO          ( 1 )        // 仅高于空闲任务.
+/*  *********************************************    */
+
+#if ( ISR_LOG_RING_SIZE & ISR_LOG_RING_MASK ) != 0
+  #error "ISR_LOG_RING_SIZE must be a power of two."
+#endif
+
+
+/**
+ * @brief   中断事件记录（紧凑二进制格式，20 字节）
+ *
+ * @details 中断中只记录时间戳、级别、两个字符串常量指针与两个参数，不做任何格式化；
+ *          格式化、串口输出与 Flash 写入全部推迟到排空任务中完成。
+ *
+ *  timeStamp：事件发生时的系统节拍.
+ *  level：日志级别(LogLevel_t).
+ *  tag：来源标识(必须为字符串常量).
+ *  fmt：格式字符串(必须为字符串常量，最多引用两个 32 位整型参数，如 %lu / %lX).
+ *  arg0 / arg1：格式参数.
+ */
+typedef struct
+{
+  uint32_t timeStamp;
+  uint8_t level;
+  uint8_t pad[3];
+  const char *tag;
+  const char *fmt;
+  uint32_t arg0;
+  uint32_t arg1;
+
+} IsrLogRecord_t;
+
+
+/**
+ * @brief   在中断中记录一条延迟日志（可在 ISR 中调用的 LOG_WRITE 替代品）
+ *
+ *          使用示例：
+ *          ~~~c
+ *          ISR_LOG(LOG_ERROR, "UART4", "SR=0x%04lX", isrflags, 0);
+ *          ~~~
+ *
+ * @warning tag 与 fmt 只保存指针，必须为字符串常量；fmt 最多引用两个 uint32_t 参数.
+ */
+#define ISR_LOG(level, tag, fmt, arg0, arg1) \
+    isr_log_PushFromISR((uint8_t)(level), (tag), (fmt), (uint32_t)(arg0), (uint32_t)(arg1))
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  void isr_log_PushFromISR( uint8_t level, const char *tag, const char *fmt, uint32_t arg0, uint32_t arg1 );
+
+  bool isr_log_Pop( IsrLogRecord_t *pRecord );
+
+  uint32_t isr_log_GetDropped( void );
+
+  ErrorStatus vIsrLog_TaskCreate( void );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __ISR_LOG_H
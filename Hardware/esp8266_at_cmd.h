@@ -0,0 +1,229 @@
+#ifndef __ESP8266_AT_CMD_H
+#define __ESP8266_AT_CMD_H
+
+#include "esp8266_driver.h"
+
+
+/**
+ * 编译期 AT 命令.
+ *
+ *  常量命令：ESP_AT_CMD("AT+CIPMODE?") 展开为 `"AT+CIPMODE?\r\n"` 字面量及其长度两个实参，
+ *  字面量位于 Flash，经 esp8266_SendATConst() 由 DMA 直接从 Flash 发出，
+ *  不经过 esp8266_TxBuffer，也不调用 vsnprintf。命令过长在编译期报错(数组长度为负)。
+ *
+ *  带参数命令：按参数类型给出专用构建函数，结果缓冲区长度由 *_MAX 宏在编译期确定并校验，
+ *  数值参数直接转十进制，不经过 vsnprintf.
+ */
+
+
+/* ********************************************** */
+#define ESP_AT_STATIC_ASSERT(cond, name)    typedef char esp_at_assert_##name[(cond) ? 1 : -1]
+
+// 命令文本必须为字符串字面量(与 "\r\n" 拼接即保证这一点).
+#define ESP_AT_CMD(text)                                                              \
+          (const uint8_t *)( text "\r\n" ),                                           \
+          (uint16_t)( sizeof(char[( sizeof(text "\r\n") <= Tx_DATA_BUFFER ) ? 1 : -1]) \
+                        * ( sizeof(text "\r\n") - 1 ) )
+
+#define esp8266_SendATConst(text)           esp8266_SendRaw(ESP_AT_CMD(text))
+
+#define ESP_AT_HOST_MAX            ( 64 )   // 含结束符, 与 esp_tcp_link_t.Host 一致.
+
+#define ESP_AT_LINK_MAX            ( 4U )   // 多连接模式下最大链路号(单个十进制位, 各 *_MAX 按此计算).
+
+// 各带参数命令在最长参数下的长度(含 "\r\n"，不含结束符).
+#define ESP_AT_CIPSEND_MAX         ( sizeof("AT+CIPSEND=4,65535\r\n") - 1 )
+#define ESP_AT_CIPCLOSE_MAX        ( sizeof("AT+CIPCLOSE=4\r\n") - 1 )
+#define ESP_AT_CIPRECVDATA_MAX     ( sizeof("AT+CIPRECVDATA=4,65535\r\n") - 1 )
+#define ESP_AT_CIPSTART_MAX        ( sizeof("AT+CIPSTART=4,\"TCPv6\",\"\",65535\r\n") - 1 + ( ESP_AT_HOST_MAX - 1 ) )
+/* ********************************************** */
+
+
+ESP_AT_STATIC_ASSERT(ESP_AT_CIPSEND_MAX < Tx_DATA_BUFFER, cipsend_fits);
+ESP_AT_STATIC_ASSERT(ESP_AT_CIPCLOSE_MAX < Tx_DATA_BUFFER, cipclose_fits);
+ESP_AT_STATIC_ASSERT(ESP_AT_CIPRECVDATA_MAX < Tx_DATA_BUFFER, ciprecvdata_fits);
+ESP_AT_STATIC_ASSERT(ESP_AT_CIPSTART_MAX < Tx_DATA_BUFFER, cipstart_fits);
+
+
+// 无链路号时传入.
+#define ESP_AT_NO_LINK             ( 0xFF )
+
+// 链路号是否在 *_MAX 的计算范围内(allow_none: 是否接受 ESP_AT_NO_LINK).
+#define ESP_AT_LINK_OK(link_id, allow_none) \
+          ( ( (link_id) <= ESP_AT_LINK_MAX ) || ( (allow_none) && (link_id) == ESP_AT_NO_LINK ) )
+
+
+
+
+// 追加字符串, 返回新的写入位置.
+static inline char *esp_at_PutStr( char *p, const char *s )
+{
+  while( *s != '\0' )
+  {
+    *p++ = *s++;
+  }
+
+  return p;
+}
+
+
+
+
+// 追加十进制无符号数, 返回新的写入位置.
+static inline char *esp_at_PutUint( char *p, uint32_t v )
+{
+  char tmp[10];
+  uint8_t n = 0;
+
+  do
+  {
+    tmp[n++] = (char)( '0' + v % 10 );
+    v /= 10;
+  } while( v != 0 );
+
+  while( n > 0 )
+  {
+    *p++ = tmp[--n];
+  }
+
+  return p;
+}
+
+
+
+
+/**
+ * @brief 构建 `AT+CIPSEND=[<link_id>,]<len>\r\n`
+ *
+ * @param[out] out     缓冲区（至少 ESP_AT_CIPSEND_MAX 字节）
+ * @param[in]  link_id 链路号（0 ~ ESP_AT_LINK_MAX，单连接模式传 ESP_AT_NO_LINK）
+ * @param[in]  len     数据长度
+ *
+ * @return 命令长度；链路号超出范围返回 0
+ */
+static inline uint16_t esp_at_BuildCipSend( char out[ESP_AT_CIPSEND_MAX], uint8_t link_id, uint16_t len )
+{
+  if ( !ESP_AT_LINK_OK(link_id, true) )
+  {
+    return 0;
+  }
+
+  char *p = esp_at_PutStr(out, "AT+CIPSEND=");
+
+  if ( link_id != ESP_AT_NO_LINK )
+  {
+    p = esp_at_PutUint(p, link_id);
+    *p++ = ',';
+  }
+
+  p = esp_at_PutUint(p, len);
+  *p++ = '\r';
+  *p++ = '\n';
+
+  return (uint16_t)( p - out );
+}
+
+
+
+
+/**
+ * @brief 构建 `AT+CIPCLOSE=<link_id>\r\n`
+ *
+ * @return 命令长度；链路号超出 0 ~ ESP_AT_LINK_MAX 返回 0
+ */
+static inline uint16_t esp_at_BuildCipClose( char out[ESP_AT_CIPCLOSE_MAX], uint8_t link_id )
+{
+  if ( !ESP_AT_LINK_OK(link_id, false) )
+  {
+    return 0;
+  }
+
+  char *p = esp_at_PutStr(out, "AT+CIPCLOSE=");
+
+  p = esp_at_PutUint(p, link_id);
+  *p++ = '\r';
+  *p++ = '\n';
+
+  return (uint16_t)( p - out );
+}
+
+
+
+
+/**
+ * @brief 构建 `AT+CIPRECVDATA=[<link_id>,]<len>\r\n`（被动接收模式下读取模块缓存的数据）
+ *
+ * @param[out] out     缓冲区（至少 ESP_AT_CIPRECVDATA_MAX 字节）
+ * @param[in]  link_id 链路号（0 ~ ESP_AT_LINK_MAX，单连接模式传 ESP_AT_NO_LINK）
+ * @param[in]  len     本次最多读取的字节数
+ *
+ * @return 命令长度；链路号超出范围返回 0
+ */
+static inline uint16_t esp_at_BuildCipRecvData( char out[ESP_AT_CIPRECVDATA_MAX], uint8_t link_id, uint16_t len )
+{
+  if ( !ESP_AT_LINK_OK(link_id, true) )
+  {
+    return 0;
+  }
+
+  char *p = esp_at_PutStr(out, "AT+CIPRECVDATA=");
+
+  if ( link_id != ESP_AT_NO_LINK )
+  {
+    p = esp_at_PutUint(p, link_id);
+    *p++ = ',';
+  }
+
+  p = esp_at_PutUint(p, len);
+  *p++ = '\r';
+  *p++ = '\n';
+
+  return (uint16_t)( p - out );
+}
+
+
+
+
+/**
+ * @brief 构建 `AT+CIPSTART=[<link_id>,]"<type>","<host>",<port>\r\n`
+ *
+ * @param[out] out     缓冲区（至少 ESP_AT_CIPSTART_MAX 字节）
+ * @param[in]  link_id 链路号（0 ~ ESP_AT_LINK_MAX，单连接模式传 ESP_AT_NO_LINK）
+ * @param[in]  type    "TCP" / "TCPv6" / "UDP"
+ * @param[in]  host    主机名（长度须小于 ESP_AT_HOST_MAX）
+ * @param[in]  port    端口
+ *
+ * @return 命令长度；参数非法、链路号超出范围或主机名过长返回 0
+ */
+static inline uint16_t esp_at_BuildCipStart( char out[ESP_AT_CIPSTART_MAX], uint8_t link_id,
+                                              const char *type, const char *host, uint16_t port )
+{
+  if ( !ESP_AT_LINK_OK(link_id, true) || type == NULL || host == NULL
+        || strlen(type) > 5 || strlen(host) >= ESP_AT_HOST_MAX )
+  {
+    return 0;
+  }
+
+  char *p = esp_at_PutStr(out, "AT+CIPSTART=");
+
+  if ( link_id != ESP_AT_NO_LINK )
+  {
+    p = esp_at_PutUint(p, link_id);
+    *p++ = ',';
+  }
+
+  *p++ = '"';
+  p = esp_at_PutStr(p, type);
+  p = esp_at_PutStr(p, "\",\"");
+  p = esp_at_PutStr(p, host);
+  *p++ = '"';
+  *p++ = ',';
+  p = esp_at_PutUint(p, port);
+  *p++ = '\r';
+  *p++ = '\n';
+
+  return (uint16_t)( p - out );
+}
+
+
+#endif // __ESP8266_AT_CMD_H
@@ -0,0 +1,332 @@
+#include "esp8266_at_engine.h"
+
+
+extern ESP8266_HandleTypeDef hesp8266;
+
+extern SemaphoreHandle_t xMutexEsp;
+
+
+/* ********************************************** */
+static QueueHandle_t xAtQueue[2] = { NULL, NULL };   // 下标即 esp_at_prio_t.
+
+static SemaphoreHandle_t xAtPending = NULL;          // 两条通道中待处理命令的总数.
+/* ********************************************** */
+
+
+/* ********************************************** */
+ErrorStatus vEspAt_TaskCreate( void );
+bool esp_at_Prepare( esp_at_cmd_t *pCmd, uint32_t timeout_ms, const char *format, ... );
+bool esp_at_Submit( esp_at_cmd_t *pCmd, esp_at_prio_t prio );
+esp_at_result_t esp_at_Wait( esp_at_cmd_t *pCmd );
+esp_at_result_t esp_at_Exec( esp_at_cmd_t *pCmd, esp_at_prio_t prio );
+static void vtaskEspAt_Dispatch( void *parameter );
+static void esp_at_Process( esp_at_cmd_t *pCmd );
+static void esp_at_Complete( esp_at_cmd_t *pCmd, esp_at_result_t result );
+/* ********************************************** */
+
+
+
+
+/**
+ * @brief 创建 AT 命令队列与调度任务
+ *
+ * @retval SUCCESS 创建成功
+ * @retval ERROR   队列或任务创建失败（此时 esp_at_Submit() 恒返回 false，阻塞式接口不受影响）
+ */
+ErrorStatus vEspAt_TaskCreate( void )
+{
+  xAtQueue[ESP_AT_PRIO_NORMAL] = xQueueCreate(ESP_AT_QUEUE_LEN, sizeof(esp_at_cmd_t *));
+  xAtQueue[ESP_AT_PRIO_HIGH] = xQueueCreate(ESP_AT_QUEUE_LEN, sizeof(esp_at_cmd_t *));
+  xAtPending = xSemaphoreCreateCounting(2 * ESP_AT_QUEUE_LEN, 0);
+
+  if ( xAtQueue[ESP_AT_PRIO_NORMAL] == NULL || xAtQueue[ESP_AT_PRIO_HIGH] == NULL || xAtPending == NULL )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("AT Queue Create Failed! in esp8266_at_engine.c\n");
+    #endif // __DEBUG_LEVEL_1__
+
+    return ERROR;
+  }
+
+  BaseType_t err = xTaskCreate((TaskFunction_t)vtaskEspAt_Dispatch,
+                                 "vtaskEspAt",
+                                    ESP_AT_TASK_DEPTH,
+                                      NULL,
+                                        ESP_AT_TASK_PRIO,
+                                         NULL );
+
+  if ( err != pdPASS )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("EspAt Task Create Failed! in esp8266_at_engine.c\n");
+    #endif // __DEBUG_LEVEL_1__
+
+    return ERROR;
+  }
+
+  return SUCCESS;
+}
+
+
+
+
+/**
+ * @brief 填充命令描述符（默认以 "OK" / "ERROR" 结束，完成时通知当前任务）
+ *
+ * 需要其他结束标志（如 ">"、"SEND OK"）或完成回调时，在本函数之后、提交之前直接修改对应字段。
+ *
+ * @param[out] pCmd       描述符
+ * @param[in]  timeout_ms 自提交起的总时限（排队 + 执行，毫秒）
+ * @param[in]  format     命令格式串
+ *
+ * @retval true  成功
+ * @retval false 参数非法或命令过长
+ */
+bool esp_at_Prepare( esp_at_cmd_t *pCmd, uint32_t timeout_ms, const char *format, ... )
+{
+  if ( pCmd == NULL || format == NULL || timeout_ms == 0 )
+  {
+    return false;
+  }
+
+  va_list args;
+
+  va_start( args, format );
+
+  int len = vsnprintf(pCmd->cmd, sizeof(pCmd->cmd), format, args);
+
+  va_end(args);
+
+  if ( len <= 0 || len >= (int)sizeof(pCmd->cmd) )
+  {
+    LOG_WRITE(LOG_WARNING, "AT", "AT Command Too Long or Format Error!");
+
+    return false;
+  }
+
+  pCmd->ok_token = "OK";
+  pCmd->err_token = "ERROR";
+  pCmd->timeout_ms = timeout_ms;
+  pCmd->deadline = 0;
+  pCmd->notify_task = xTaskGetCurrentTaskHandle();
+  pCmd->callback = NULL;
+  pCmd->ctx = NULL;
+  pCmd->result = ESP_AT_PENDING;
+  pCmd->response[0] = '\0';
+  pCmd->resp_len = 0;
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 提交命令（不阻塞）
+ *
+ * 命令按通道排队，由 AT 调度任务逐条执行：高优先级通道非空时总是先取高优先级命令，
+ * 因此短查询不会排在耗时的 `AT+CIPSTART` 之后。正在执行的命令不会被抢占（模块同一时刻只处理一条命令）。
+ *
+ * @param[in,out] pCmd 已填充的描述符（完成前必须保持有效）
+ * @param[in]     prio 通道
+ *
+ * @retval true  已入队
+ * @retval false 参数非法、引擎未创建或通道已满
+ */
+bool esp_at_Submit( esp_at_cmd_t *pCmd, esp_at_prio_t prio )
+{
+  if ( pCmd == NULL || pCmd->ok_token == NULL || prio > ESP_AT_PRIO_HIGH || xAtPending == NULL )
+  {
+    return false;
+  }
+
+  pCmd->result = ESP_AT_PENDING;
+  pCmd->deadline = xTaskGetTickCount() + pdMS_TO_TICKS(pCmd->timeout_ms);
+
+  if ( xQueueSend(xAtQueue[prio], &pCmd, 0) != pdTRUE )
+  {
+    LOG_WRITE(LOG_WARNING, "AT", "AT queue %u full.", (unsigned)prio);
+
+    return false;
+  }
+
+  xSemaphoreGive(xAtPending);
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 阻塞等待命令完成（仅限描述符中 notify_task 指定的任务调用）
+ *
+ * 调度任务保证每条命令在截止时刻之后尽快完成（排队中过期的命令直接以 `ESP_AT_EXPIRED` 完成），
+ * 因此本函数无需额外超时参数。
+ *
+ * @return 执行结果
+ */
+esp_at_result_t esp_at_Wait( esp_at_cmd_t *pCmd )
+{
+  if ( pCmd == NULL )
+  {
+    return ESP_AT_SEND_ERROR;
+  }
+
+  // 同一任务可能有多条命令在途，通知可能来自其它命令，需复查结果.
+  while( pCmd->result == ESP_AT_PENDING )
+  {
+    ulTaskNotifyTakeIndexed(ESP_AT_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+  }
+
+  return pCmd->result;
+}
+
+
+
+
+/**
+ * @brief 提交并等待完成（同步用法）
+ *
+ * 引擎未创建，或调用者已持有 `xMutexEsp`（调度任务取不到互斥量，排队只会等到过期）时，
+ * 命令在调用者上下文中直接执行，结果与经调度任务执行一致。
+ */
+esp_at_result_t esp_at_Exec( esp_at_cmd_t *pCmd, esp_at_prio_t prio )
+{
+  if ( pCmd != NULL && pCmd->ok_token != NULL && xMutexEsp != NULL
+        && ( xAtPending == NULL || xSemaphoreGetMutexHolder(xMutexEsp) == xTaskGetCurrentTaskHandle() ) )
+  {
+    pCmd->notify_task = NULL;
+    pCmd->result = ESP_AT_PENDING;
+    pCmd->deadline = xTaskGetTickCount() + pdMS_TO_TICKS(pCmd->timeout_ms);
+
+    esp_at_Process(pCmd);
+
+    return pCmd->result;
+  }
+
+  if ( !esp_at_Submit(pCmd, prio) )
+  {
+    return ESP_AT_SEND_ERROR;
+  }
+
+  return esp_at_Wait(pCmd);
+}
+
+
+
+
+// AT 调度任务: 先高优先级通道、后普通通道，逐条执行.
+static void vtaskEspAt_Dispatch( void *parameter )
+{
+  (void)parameter;
+
+  for( ; ; )
+  {
+    xSemaphoreTake(xAtPending, portMAX_DELAY);
+
+    esp_at_cmd_t *pCmd = NULL;
+
+    if ( xQueueReceive(xAtQueue[ESP_AT_PRIO_HIGH], &pCmd, 0) != pdTRUE )
+    {
+      xQueueReceive(xAtQueue[ESP_AT_PRIO_NORMAL], &pCmd, 0);
+    }
+
+    if ( pCmd != NULL )
+    {
+      esp_at_Process(pCmd);
+    }
+  }
+}
+
+
+
+
+// 执行一条命令. 持有 xMutexEsp 期间完成 发送 -> 等待结束标志 -> 拷贝响应，与阻塞式接口互斥.
+static void esp_at_Process( esp_at_cmd_t *pCmd )
+{
+  TickType_t xRemain = pCmd->deadline - xTaskGetTickCount();
+
+  if ( (int32_t)xRemain <= 0 || xMutexEsp == NULL )
+  {
+    esp_at_Complete(pCmd, ESP_AT_EXPIRED);
+    return;
+  }
+
+  if ( xSemaphoreTakeRecursive(xMutexEsp, xRemain) != pdPASS )
+  {
+    esp_at_Complete(pCmd, ESP_AT_EXPIRED);
+    return;
+  }
+
+  esp_at_result_t result = ESP_AT_SEND_ERROR;
+
+  if ( esp8266_SendAT("%s", pCmd->cmd) )
+  {
+    bool failed = false;
+
+    xRemain = pCmd->deadline - xTaskGetTickCount();
+
+    if ( (int32_t)xRemain <= 0 )
+    {
+      xRemain = 1;
+    }
+
+    void *pHit = esp8266_WaitResponseEx(pCmd->ok_token, pCmd->err_token, xRemain * portTICK_PERIOD_MS, &failed);
+
+    // FAIL / ERROR / busy 提前结束时返回 NULL 且 failed 置位，须先于超时判定.
+    result = failed ? ESP_AT_FAIL : ( ( pHit == NULL ) ? ESP_AT_TIMEOUT : ESP_AT_OK );
+
+    const EspRxFrame_t *pResp = hesp8266.LastReceivedFrame;
+    uint16_t len = ( pResp != NULL ) ? pResp->Data_Len : 0;
+
+    if ( len > sizeof(pCmd->response) - 1 )
+    {
+      len = sizeof(pCmd->response) - 1;
+    }
+
+    if ( len > 0 )
+    {
+      memcpy(pCmd->response, pResp->RecvData, len);
+    }
+
+    pCmd->response[len] = '\0';
+    pCmd->resp_len = len;
+
+    esp8266_DropLastFrame();
+  }
+
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  #if defined(__DEBUG_LEVEL_1__)
+    if ( result != ESP_AT_OK )
+    {
+      printf("AT \"%s\" result %d.\n", pCmd->cmd, (int)result);
+    }
+  #endif // __DEBUG_LEVEL_1__
+
+  esp_at_Complete(pCmd, result);
+}
+
+
+
+
+static void esp_at_Complete( esp_at_cmd_t *pCmd, esp_at_result_t result )
+{
+  // 结果一经写入，等待方即可能返回并释放描述符，须先取出通知对象.
+  TaskHandle_t notify_task = pCmd->notify_task;
+
+  if ( pCmd->callback != NULL )
+  {
+    pCmd->result = result;
+    pCmd->callback(pCmd, pCmd->ctx);
+    return;
+  }
+
+  pCmd->result = result;
+
+  if ( notify_task != NULL )
+  {
+    xTaskNotifyGiveIndexed(notify_task, ESP_AT_NOTIFY_INDEX);
+  }
+}
@@ -0,0 +1,96 @@
+#ifndef __ESP8266_AT_ENGINE_H
+#define __ESP8266_AT_ENGINE_H
+
+#include "esp8266_driver.h"
+#include "semphr.h"
+
+
+/* ********************************************** */
+#define ESP_AT_CMD_MAX            ( Tx_DATA_BUFFER - 3 )  // 命令文本最大长度(不含 "\r\n").
+#define ESP_AT_RESP_MAX           ( 256 )      // 描述符内保存的响应行长度上限.
+#define ESP_AT_QUEUE_LEN          ( 8 )        // 每条通道可排队的命令数.
+#define ESP_AT_NOTIFY_INDEX       ( 1 )        // 完成通知使用的任务通知下标(0 号被 UART 发送完成占用).
+
+#define ESP_AT_TASK_DEPTH         ( 512 )
+#define ESP_AT_TASK_PRIO          ( 6 )
+/* ********************************************** */
+
+#if ( configTASK_NOTIFICATION_ARRAY_ENTRIES <= ESP_AT_NOTIFY_INDEX )
+  #error "configTASK_NOTIFICATION_ARRAY_ENTRIES must be at least 2 for the AT engine."
+#endif
+
+
+// 排队通道. 高优先级通道总是先于普通通道被取出.
+typedef enum
+{
+  ESP_AT_PRIO_NORMAL = 0,   // 建立连接、发送数据等耗时命令.
+  ESP_AT_PRIO_HIGH          // 状态查询等短命令.
+} esp_at_prio_t;
+
+
+typedef enum
+{
+  ESP_AT_PENDING = 0,       // 排队或执行中.
+  ESP_AT_OK,                // 收到成功结束标志.
+  ESP_AT_FAIL,              // 收到失败结束标志.
+  ESP_AT_TIMEOUT,           // 执行中超过截止时间.
+  ESP_AT_EXPIRED,           // 轮到执行时已超过截止时间，命令未发出.
+  ESP_AT_SEND_ERROR         // 命令发送失败.
+} esp_at_result_t;
+
+
+typedef struct esp_at_cmd esp_at_cmd_t;
+
+// 完成回调. 在 AT 任务上下文中执行，不得阻塞.
+typedef void (*esp_at_done_cb_t)( esp_at_cmd_t *pCmd, void *ctx );
+
+
+/**
+ * @brief AT 命令描述符（由调用者提供存储，提交后至完成前不得释放或修改）
+ *
+ *  cmd：命令文本(不含 "\r\n").
+ *  ok_token / err_token：成功 / 失败结束标志(字符串常量)，err_token 可为 NULL.
+ *  timeout_ms：自提交起的总时限(排队 + 执行).
+ *  deadline：截止时刻(系统节拍)，由 esp_at_Submit() 按 timeout_ms 计算.
+ *  notify_task：完成时以 ESP_AT_NOTIFY_INDEX 号任务通知唤醒的任务(可为 NULL).
+ *  callback / ctx：完成回调(可为 NULL). 与 notify_task 二者择一，设置回调后不再发送任务通知.
+ *  result：执行结果.
+ *  response / resp_len：命令的响应行(已去除 +IPD 负载与 URC)，以 '\0' 结尾.
+ */
+struct esp_at_cmd
+{
+  char cmd[ESP_AT_CMD_MAX];
+  const char *ok_token;
+  const char *err_token;
+  uint32_t timeout_ms;
+  TickType_t deadline;
+  TaskHandle_t notify_task;
+  esp_at_done_cb_t callback;
+  void *ctx;
+
+  volatile esp_at_result_t result;
+  char response[ESP_AT_RESP_MAX];
+  uint16_t resp_len;
+};
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  ErrorStatus vEspAt_TaskCreate( void );
+
+  bool esp_at_Prepare( esp_at_cmd_t *pCmd, uint32_t timeout_ms, const char *format, ... );
+
+  bool esp_at_Submit( esp_at_cmd_t *pCmd, esp_at_prio_t prio );
+
+  esp_at_result_t esp_at_Wait( esp_at_cmd_t *pCmd );
+
+  esp_at_result_t esp_at_Exec( esp_at_cmd_t *pCmd, esp_at_prio_t prio );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __ESP8266_AT_ENGINE_H
@@ -0,0 +1,162 @@
+#include "esp8266_at_script.h"
+
+
+extern ESP8266_HandleTypeDef hesp8266;
+
+extern SemaphoreHandle_t xMutexEsp;
+
+
+/* ********************************************** */
+esp_at_script_result_t esp_at_RunScript( const esp_at_step_t *steps, uint8_t count, esp_at_script_report_t *pReport );
+bool at_CheckNumEq( const void *arg );
+/* ********************************************** */
+
+
+
+
+/**
+ * @brief 在一次互斥量持有期间连续执行一段 AT 脚本
+ *
+ * 脚本为步骤表，每步 {命令, 结束标志, 条件检查, 满足/不满足时的下一步}：
+ *   - 查询步骤（如 `AT+CIPMUX?`）配合条件检查，仅当结果与期望不符时才跳到对应的写入步骤（如 `AT+CIPMUX=0`），
+ *     符合时直接越过写入步骤；
+ *   - 所有步骤背靠背执行，整段脚本只获取一次 `xMutexEsp`，其他任务的命令不会插入中间；
+ *   - 每步耗时记入 `pReport->step_ms[]`，便于评估启动 / 重连初始化的耗时分布。
+ *
+ * @param[in]  steps   步骤表（通常为 static const，位于 Flash）
+ * @param[in]  count   步骤数（不超过 ESP_AT_SCRIPT_MAX_STEPS）
+ * @param[out] pReport 执行报告（可为 NULL）
+ *
+ * @return 执行结果，见 esp_at_script_result_t
+ *
+ * @note 从步骤 0 开始执行；步骤可向后跳转，但总执行步数不超过 2 * count，防止脚本成环.
+ */
+esp_at_script_result_t esp_at_RunScript( const esp_at_step_t *steps, uint8_t count, esp_at_script_report_t *pReport )
+{
+  esp_at_script_report_t report;
+
+  memset(&report, 0, sizeof(report));
+
+  if ( steps == NULL || count == 0 || count > ESP_AT_SCRIPT_MAX_STEPS )
+  {
+    report.result = ESP_AT_SCRIPT_BAD_SCRIPT;
+    goto RunScript_Exit;
+  }
+
+  TickType_t xStart = xTaskGetTickCount();
+
+  if ( xSemaphoreTakeRecursive(xMutexEsp, 500) != pdPASS )
+  {
+    report.result = ESP_AT_SCRIPT_SEND_ERROR;
+    goto RunScript_Exit;
+  }
+
+  uint8_t index = 0;
+  uint8_t budget = (uint8_t)( 2 * count );
+
+  while( index != ESP_AT_SCRIPT_END )
+  {
+    if ( index >= count || budget-- == 0 )
+    {
+      report.result = ESP_AT_SCRIPT_BAD_SCRIPT;
+      break;
+    }
+
+    const esp_at_step_t *pStep = &steps[index];
+    TickType_t xStepStart = xTaskGetTickCount();
+    bool failed = false;
+
+    report.last_step = index;
+    report.executed++;
+
+    if ( !esp8266_SendAT("%s", pStep->cmd) )
+    {
+      report.result = ESP_AT_SCRIPT_SEND_ERROR;
+      break;
+    }
+
+    void *pHit = esp8266_WaitResponseEx(pStep->expect, "ERROR", pStep->timeout_ms, &failed);
+
+    report.step_ms[index] = (uint16_t)( ( xTaskGetTickCount() - xStepStart ) * portTICK_PERIOD_MS );
+
+    if ( pHit == NULL || failed )
+    {
+      esp8266_DropLastFrame();
+
+      report.result = ESP_AT_SCRIPT_NO_RESPONSE;
+      break;
+    }
+
+    bool satisfied = ( pStep->check == NULL ) ? true : pStep->check(pStep->arg);
+
+    esp8266_DropLastFrame();
+
+    uint8_t next = satisfied ? pStep->next_ok : pStep->next_fail;
+
+    if ( next == ESP_AT_SCRIPT_ABORT )
+    {
+      report.result = ESP_AT_SCRIPT_CHECK_FAIL;
+      break;
+    }
+
+    index = next;
+  }
+
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  report.total_ms = ( xTaskGetTickCount() - xStart ) * portTICK_PERIOD_MS;
+
+  #if defined(__DEBUG_LEVEL_1__)
+    printf("AT script: result %d, %u steps, %lu ms.\n", (int)report.result, report.executed, (unsigned long)report.total_ms);
+
+    for ( uint8_t i = 0; i < count; i++ )
+    {
+      if ( report.step_ms[i] != 0 )
+      {
+        printf("  [%u] %-16s %u ms\n", i, steps[i].cmd, report.step_ms[i]);
+      }
+    }
+  #endif // __DEBUG_LEVEL_1__
+
+  if ( report.result != ESP_AT_SCRIPT_OK )
+  {
+    LOG_WRITE(LOG_WARNING, "AT", "Script failed at step %u (%s): %d", report.last_step, steps[report.last_step].cmd, (int)report.result);
+  }
+
+RunScript_Exit:
+  if ( pReport != NULL )
+  {
+    *pReport = report;
+  }
+
+  return report.result;
+}
+
+
+
+
+/**
+ * @brief 通用条件检查: 响应中 "+<key>:<value>" 的值等于期望值
+ *
+ * @param[in] arg 指向 esp_at_num_cond_t
+ *
+ * @retval true  值相等
+ * @retval false 值不等或未找到该键
+ */
+bool at_CheckNumEq( const void *arg )
+{
+  const esp_at_num_cond_t *pCond = (const esp_at_num_cond_t *)arg;
+  uint32_t value = 0;
+
+  if ( pCond == NULL || hesp8266.LastReceivedFrame == NULL )
+  {
+    return false;
+  }
+
+  if ( !at_get_num(hesp8266.LastReceivedFrame->RecvData, hesp8266.LastReceivedFrame->Data_Len, pCond->key, &value) )
+  {
+    return false;
+  }
+
+  return ( value == pCond->value );
+}
@@ -0,0 +1,94 @@
+#ifndef __ESP8266_AT_SCRIPT_H
+#define __ESP8266_AT_SCRIPT_H
+
+#include "esp8266_driver.h"
+#include "semphr.h"
+
+
+/* ********************************************** */
+#define ESP_AT_SCRIPT_MAX_STEPS   ( 16 )       // 单个脚本的最大步骤数.
+#define ESP_AT_SCRIPT_END         ( 0xFE )     // 跳转目标: 脚本成功结束.
+#define ESP_AT_SCRIPT_ABORT       ( 0xFF )     // 跳转目标: 脚本失败结束.
+/* ********************************************** */
+
+
+// 步骤条件检查. 在响应仍被持有时调用(只读 hesp8266.LastReceivedFrame)，返回 true 表示条件满足.
+typedef bool (*esp_at_check_t)( const void *arg );
+
+
+/**
+ * @brief 脚本步骤.
+ *
+ *  cmd：命令文本.
+ *  expect：成功结束标志("ERROR" 恒为失败结束标志).
+ *  timeout_ms：等待结束标志的时限.
+ *  check / arg：条件检查(可为 NULL，此时收到 expect 即视为满足).
+ *  next_ok：满足时的下一步(步骤下标 / ESP_AT_SCRIPT_END).
+ *  next_fail：不满足时的下一步(步骤下标 / ESP_AT_SCRIPT_ABORT)，常用于跳到条件写入步骤.
+ */
+typedef struct
+{
+  const char *cmd;
+  const char *expect;
+  uint16_t timeout_ms;
+  esp_at_check_t check;
+  const void *arg;
+  uint8_t next_ok;
+  uint8_t next_fail;
+
+} esp_at_step_t;
+
+
+// at_CheckNumEq() 的参数: 响应中 "+<key>:<value>" 的值等于 value.
+typedef struct
+{
+  const char *key;
+  uint32_t value;
+
+} esp_at_num_cond_t;
+
+
+typedef enum
+{
+  ESP_AT_SCRIPT_OK = 0,
+  ESP_AT_SCRIPT_SEND_ERROR,      // 命令发送失败(含互斥量获取失败).
+  ESP_AT_SCRIPT_NO_RESPONSE,     // 超时或收到 "ERROR".
+  ESP_AT_SCRIPT_CHECK_FAIL,      // 条件不满足且 next_fail 为 ESP_AT_SCRIPT_ABORT.
+  ESP_AT_SCRIPT_BAD_SCRIPT       // 跳转越界或执行步数超限(脚本成环).
+} esp_at_script_result_t;
+
+
+/**
+ * @brief 脚本执行报告.
+ *
+ *  result：执行结果.
+ *  last_step：最后执行的步骤下标(失败时即失败步骤).
+ *  executed：实际执行的步骤数(被条件跳过的写入步骤不计).
+ *  step_ms：各步骤耗时(发送至收到结束标志，毫秒)，未执行的步骤为 0.
+ *  total_ms：脚本总耗时(含互斥量获取).
+ */
+typedef struct
+{
+  esp_at_script_result_t result;
+  uint8_t last_step;
+  uint8_t executed;
+  uint16_t step_ms[ESP_AT_SCRIPT_MAX_STEPS];
+  uint32_t total_ms;
+
+} esp_at_script_report_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  esp_at_script_result_t esp_at_RunScript( const esp_at_step_t *steps, uint8_t count, esp_at_script_report_t *pReport );
+
+  bool at_CheckNumEq( const void *arg );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __ESP8266_AT_SCRIPT_H
@@ -0,0 +1,518 @@
+#include "esp8266_demux.h"
+#include "bsp_usart_debug.h"
+
+
+/* ********************************************** */
+typedef struct
+{
+  const char *text;
+  uint8_t len;
+  esp_urc_t urc;
+
+} demux_urc_entry_t;
+
+
+// 无链路号前缀的 URC(整行精确匹配).
+static const demux_urc_entry_t urc_table[] =
+{
+  { "ready",           5,  ESP_URC_READY           },
+  { "WIFI CONNECTED",  14, ESP_URC_WIFI_CONNECTED  },
+  { "WIFI GOT IP",     11, ESP_URC_WIFI_GOT_IP     },
+  { "WIFI DISCONNECT", 15, ESP_URC_WIFI_DISCONNECT },
+  { "CLOSED",          6,  ESP_URC_LINK_CLOSED     }
+};
+/* ********************************************** */
+
+
+/* ********************************************** */
+static void demux_EmitLine( esp_demux_t *pDemux, uint32_t end_pos );
+static bool demux_ParseIpdHeader( esp_demux_t *pDemux );
+static bool demux_ParseRecvHeader( esp_demux_t *pDemux );
+static bool demux_ParseIpdNotify( esp_demux_t *pDemux, const uint8_t *line, uint16_t len, uint8_t *pLink );
+static bool demux_ParseUint( const uint8_t **pp, const uint8_t *end, uint32_t *out_val );
+/* ********************************************** */
+
+
+
+
+/**
+ * @brief 初始化接收字节流分流器
+ *
+ * @param[out] pDemux 分流器实例
+ * @param[in]  ops    三类消费方回调（允许个别回调为 NULL，对应数据被丢弃）
+ * @param[in]  ctx    透传给回调的上下文指针
+ */
+void esp_demux_Init( esp_demux_t *pDemux, const esp_demux_ops_t *ops, void *ctx )
+{
+  if ( pDemux == NULL )
+  {
+    return;
+  }
+
+  pDemux->ops = ops;
+  pDemux->ctx = ctx;
+
+  esp_demux_Reset(pDemux);
+}
+
+
+
+
+/**
+ * @brief 复位分流器状态（丢弃半行与未完成的 +IPD 负载）
+ *
+ * 用于接收环重启、清空接收队列等字节流不连续的场景。
+ */
+void esp_demux_Reset( esp_demux_t *pDemux )
+{
+  if ( pDemux == NULL )
+  {
+    return;
+  }
+
+  pDemux->state = ESP_DEMUX_STATE_LINE;
+  pDemux->line_len = 0;
+  pDemux->line_pos = 0;
+  pDemux->link_id = ESP_DEMUX_NO_LINK;
+  pDemux->remain = 0;
+  pDemux->recv_link = ESP_DEMUX_NO_LINK;
+  pDemux->recv_len = 0;
+  pDemux->notify_len = 0;
+}
+
+
+
+
+/**
+ * @brief 向分流器输入一段接收字节，按协议结构分发给对应消费方
+ *
+ * 字节流被划分为三类：
+ *   - `+IPD,[<id>,]<len>:` 之后按声明长度计数的负载 → `on_payload`（直接传递输入指针，不拷贝，不解析内容，
+ *     因此负载中出现的 "OK"、"\r\n" 等字节不会被误判为响应）；
+ *   - 被动接收模式下 `+CIPRECVDATA:<len>,` 之后的负载同样按长度计数交给 `on_payload`，链路号取自
+ *     `esp_demux_ExpectRecv()`；不带负载的 `+IPD,[<id>,]<len>` 通知行作为 `ESP_URC_RECV_PENDING` 投递；
+ *   - 与 `urc_table` 或 `<id>,CONNECT` / `<id>,CLOSED` 精确匹配的行 → `on_urc`；
+ *   - 其余非空行与 '>' 提示符 → `on_response`。
+ *
+ * @note
+ *   - 输入可在任意字节处切分（IDLE 帧边界、环回绕切分均可），状态在调用之间保持；
+ *   - 行内容会被暂存于 `line[]`（最长 `ESP_DEMUX_LINE_MAX`），超长行按片段投递给 `on_response`；
+ *   - `stream_pos` 为 `data[0]` 在字节流中的位置，`on_response` 据此报告每行原始字节的位置；
+ *   - 本函数不加锁，同一实例只能由一个任务驱动。
+ *
+ * @param[in,out] pDemux 分流器实例
+ * @param[in]     data   输入字节
+ * @param[in]     len    输入长度
+ * @param[in]     stream_pos data[0] 在字节流中的位置
+ */
+void esp_demux_Feed( esp_demux_t *pDemux, const uint8_t *data, uint16_t len, uint32_t stream_pos )
+{
+  if ( pDemux == NULL || data == NULL )
+  {
+    return;
+  }
+
+  uint16_t i = 0;
+
+  while( i < len )
+  {
+    switch( pDemux->state )
+    {
+      case ESP_DEMUX_STATE_RAW:
+        {
+          if ( pDemux->ops && pDemux->ops->on_payload )
+          {
+            pDemux->ops->on_payload(pDemux->ctx, ESP_DEMUX_NO_LINK, &data[i], (uint16_t)( len - i ), ESP_DEMUX_REMAIN_STREAM);
+          }
+
+          i = len;
+          break;
+        }
+
+      case ESP_DEMUX_STATE_IPD_DATA:
+        {
+          uint16_t n = (uint16_t)( len - i );
+
+          if ( n > pDemux->remain )
+          {
+            n = (uint16_t)pDemux->remain;
+          }
+
+          pDemux->remain -= n;
+
+          if ( pDemux->ops && pDemux->ops->on_payload )
+          {
+            pDemux->ops->on_payload(pDemux->ctx, pDemux->link_id, &data[i], n, pDemux->remain);
+          }
+
+          i += n;
+
+          if ( pDemux->remain == 0 )
+          {
+            pDemux->state = ESP_DEMUX_STATE_LINE;
+          }
+          break;
+        }
+
+      case ESP_DEMUX_STATE_IPD_HEADER:
+        {
+          uint8_t c = data[i++];
+
+          if ( c == ':' )
+          {
+            if ( !demux_ParseIpdHeader(pDemux) )
+            {
+              // 头部格式非法，按普通行继续收集.
+              pDemux->line[pDemux->line_len++] = c;
+              pDemux->state = ESP_DEMUX_STATE_LINE;
+            }
+            break;
+          }
+
+          pDemux->line[pDemux->line_len++] = c;
+
+          if ( c == '\n' )
+          {
+            pDemux->state = ESP_DEMUX_STATE_LINE;
+            demux_EmitLine(pDemux, stream_pos + i);
+          }
+          else if ( pDemux->line_len >= ESP_DEMUX_IPD_HDR_MAX )
+          {
+            pDemux->state = ESP_DEMUX_STATE_LINE;
+          }
+          break;
+        }
+
+      case ESP_DEMUX_STATE_RECV_HEADER:
+        {
+          uint8_t c = data[i++];
+
+          pDemux->line[pDemux->line_len++] = c;
+
+          if ( c == '\n' )
+          {
+            pDemux->state = ESP_DEMUX_STATE_LINE;
+            demux_EmitLine(pDemux, stream_pos + i);
+          }
+          else if ( pDemux->line_len > 13 && ( c == ',' || c == ':' ) )
+          {
+            if ( !demux_ParseRecvHeader(pDemux) )
+            {
+              pDemux->state = ESP_DEMUX_STATE_LINE;
+            }
+          }
+          else if ( pDemux->line_len >= ESP_DEMUX_RECV_HDR_MAX )
+          {
+            pDemux->state = ESP_DEMUX_STATE_LINE;
+          }
+          break;
+        }
+
+      default:
+        {
+          uint8_t c = data[i++];
+
+          // 提示符 '>' 之后不跟换行，需在行首单独识别.
+          if ( pDemux->line_len == 0 && c == '>' )
+          {
+            if ( pDemux->ops && pDemux->ops->on_response )
+            {
+              pDemux->ops->on_response(pDemux->ctx, &c, 1, stream_pos + i - 1, 1);
+            }
+            break;
+          }
+
+          if ( c == '\n' )
+          {
+            demux_EmitLine(pDemux, stream_pos + i);
+            break;
+          }
+
+          if ( pDemux->line_len >= ESP_DEMUX_LINE_MAX )
+          {
+            // 超长行: 先投递已缓存片段.
+            if ( pDemux->ops && pDemux->ops->on_response )
+            {
+              pDemux->ops->on_response(pDemux->ctx, pDemux->line, pDemux->line_len, pDemux->line_pos, pDemux->line_len);
+            }
+            pDemux->line_len = 0;
+          }
+
+          if ( pDemux->line_len == 0 )
+          {
+            pDemux->line_pos = stream_pos + i - 1;
+          }
+
+          pDemux->line[pDemux->line_len++] = c;
+
+          if ( pDemux->line_len == 5 && memcmp(pDemux->line, "+IPD,", 5) == 0 )
+          {
+            pDemux->state = ESP_DEMUX_STATE_IPD_HEADER;
+          }
+          else if ( pDemux->line_len == 12 && memcmp(pDemux->line, "+CIPRECVDATA", 12) == 0 )
+          {
+            pDemux->state = ESP_DEMUX_STATE_RECV_HEADER;
+          }
+          break;
+        }
+    }
+  }
+}
+
+
+
+
+/**
+ * @brief 切换透传(原始字节流)模式
+ *
+ * 进入后所有输入字节原样交给 `on_payload`（链路号 `ESP_DEMUX_NO_LINK`，remain 为 `ESP_DEMUX_REMAIN_STREAM`），
+ * 不识别响应行与 URC；退出时复位为行收集状态。
+ *
+ * @param[in,out] pDemux 分流器实例
+ * @param[in]     enable true 进入透传，false 退出透传
+ */
+void esp_demux_SetRaw( esp_demux_t *pDemux, bool enable )
+{
+  if ( pDemux == NULL )
+  {
+    return;
+  }
+
+  esp_demux_Reset(pDemux);
+
+  if ( enable )
+  {
+    pDemux->state = ESP_DEMUX_STATE_RAW;
+  }
+}
+
+
+
+
+/**
+ * @brief 指定下一条 AT+CIPRECVDATA 响应所属的链路（在发送该命令之前调用）
+ *
+ * 响应头 `+CIPRECVDATA:<len>,` 不携带链路号，其负载以此处指定的链路号交给 `on_payload`；
+ * 同时清零 `recv_len`，响应处理完毕后即为模块实际返回的字节数。
+ *
+ * @param[in,out] pDemux  分流器实例
+ * @param[in]     link_id 链路号（单连接模式传 `ESP_DEMUX_NO_LINK`）
+ */
+void esp_demux_ExpectRecv( esp_demux_t *pDemux, uint8_t link_id )
+{
+  if ( pDemux == NULL )
+  {
+    return;
+  }
+
+  pDemux->recv_link = link_id;
+  pDemux->recv_len = 0;
+}
+
+
+
+
+// 行结束: 去除首尾空白后分类投递. end_pos 为行尾之后(即 '\n' 之后)的字节流位置.
+static void demux_EmitLine( esp_demux_t *pDemux, uint32_t end_pos )
+{
+  const uint8_t *line = pDemux->line;
+  uint16_t len = pDemux->line_len;
+  uint16_t span = (uint16_t)( end_pos - pDemux->line_pos );
+
+  pDemux->line_len = 0;
+
+  while( len > 0 && ( line[len - 1] == '\r' || line[len - 1] == ' ' ) )
+  {
+    len--;
+  }
+
+  while( len > 0 && *line == ' ' )
+  {
+    line++;
+    len--;
+  }
+
+  if ( len == 0 || pDemux->ops == NULL )
+  {
+    return;
+  }
+
+  esp_urc_t urc = ESP_URC_NONE;
+  uint8_t link_id = ESP_DEMUX_NO_LINK;
+
+  if ( len > 5 && memcmp(line, "+IPD,", 5) == 0 )
+  {
+    // 被动接收模式的数据到达通知(不带 ':' 与负载).
+    if ( demux_ParseIpdNotify(pDemux, line, len, &link_id) )
+    {
+      urc = ESP_URC_RECV_PENDING;
+    }
+  }
+  else if ( len > 2 && line[0] >= '0' && line[0] <= '9' && line[1] == ',' )
+  {
+    // 多连接模式: "<id>,CONNECT" / "<id>,CLOSED".
+    if ( len == 9 && memcmp(&line[2], "CONNECT", 7) == 0 )
+    {
+      urc = ESP_URC_LINK_CONNECT;
+      link_id = line[0] - '0';
+    }
+    else if ( len == 8 && memcmp(&line[2], "CLOSED", 6) == 0 )
+    {
+      urc = ESP_URC_LINK_CLOSED;
+      link_id = line[0] - '0';
+    }
+  }
+  else
+  {
+    for ( uint8_t i = 0; i < sizeof(urc_table) / sizeof(urc_table[0]); i++ )
+    {
+      if ( len == urc_table[i].len && memcmp(line, urc_table[i].text, len) == 0 )
+      {
+        urc = urc_table[i].urc;
+        break;
+      }
+    }
+  }
+
+  if ( urc != ESP_URC_NONE )
+  {
+    if ( pDemux->ops->on_urc )
+    {
+      pDemux->ops->on_urc(pDemux->ctx, urc, link_id, line, len);
+    }
+  }
+  else if ( pDemux->ops->on_response )
+  {
+    pDemux->ops->on_response(pDemux->ctx, line, len, pDemux->line_pos, span);
+  }
+}
+
+
+
+
+// 解析 line[] 中的 "+IPD,<len>" 或 "+IPD,<id>,<len>"，成功后进入负载状态.
+static bool demux_ParseIpdHeader( esp_demux_t *pDemux )
+{
+  const uint8_t *p = &pDemux->line[5];
+  const uint8_t *end = &pDemux->line[pDemux->line_len];
+  uint32_t first = 0, second = 0;
+
+  if ( !demux_ParseUint(&p, end, &first) )
+  {
+    return false;
+  }
+
+  if ( p < end && *p == ',' )
+  {
+    p++;
+
+    if ( !demux_ParseUint(&p, end, &second) || first > 9 )
+    {
+      return false;
+    }
+
+    pDemux->link_id = (uint8_t)first;
+    pDemux->remain = second;
+  }
+  else
+  {
+    pDemux->link_id = ESP_DEMUX_NO_LINK;
+    pDemux->remain = first;
+  }
+
+  if ( p != end )
+  {
+    return false;
+  }
+
+  pDemux->line_len = 0;
+  pDemux->state = ( pDemux->remain > 0 ) ? ESP_DEMUX_STATE_IPD_DATA : ESP_DEMUX_STATE_LINE;
+
+  return true;
+}
+
+
+
+
+// 解析 line[] 中的 "+CIPRECVDATA:<len>," (部分固件为 "+CIPRECVDATA,<len>:")，成功后进入负载状态.
+static bool demux_ParseRecvHeader( esp_demux_t *pDemux )
+{
+  const uint8_t *p = &pDemux->line[13];
+  const uint8_t *end = &pDemux->line[pDemux->line_len - 1];
+  uint32_t n = 0;
+
+  if ( ( pDemux->line[12] != ':' && pDemux->line[12] != ',' ) || !demux_ParseUint(&p, end, &n) || p != end )
+  {
+    return false;
+  }
+
+  pDemux->link_id = pDemux->recv_link;
+  pDemux->remain = n;
+  pDemux->recv_len = n;
+
+  pDemux->line_len = 0;
+  pDemux->state = ( n > 0 ) ? ESP_DEMUX_STATE_IPD_DATA : ESP_DEMUX_STATE_LINE;
+
+  return true;
+}
+
+
+
+
+// 解析被动接收模式的通知行 "+IPD,<len>" 或 "+IPD,<id>,<len>".
+static bool demux_ParseIpdNotify( esp_demux_t *pDemux, const uint8_t *line, uint16_t len, uint8_t *pLink )
+{
+  const uint8_t *p = &line[5];
+  const uint8_t *end = &line[len];
+  uint32_t first = 0, second = 0;
+
+  if ( !demux_ParseUint(&p, end, &first) )
+  {
+    return false;
+  }
+
+  if ( p < end && *p == ',' )
+  {
+    p++;
+
+    if ( !demux_ParseUint(&p, end, &second) || first > 9 )
+    {
+      return false;
+    }
+
+    *pLink = (uint8_t)first;
+    pDemux->notify_len = second;
+  }
+  else
+  {
+    *pLink = ESP_DEMUX_NO_LINK;
+    pDemux->notify_len = first;
+  }
+
+  return ( p == end );
+}
+
+
+
+
+static bool demux_ParseUint( const uint8_t **pp, const uint8_t *end, uint32_t *out_val )
+{
+  const uint8_t *p = *pp;
+  uint32_t value = 0;
+
+  while( p < end && *p >= '0' && *p <= '9' )
+  {
+    value = value * 10 + ( *p - '0' );
+    p++;
+  }
+
+  if ( p == *pp )
+  {
+    return false;
+  }
+
+  *pp = p;
+  *out_val = value;
+
+  return true;
+}
@@ -0,0 +1,116 @@
+#ifndef __ESP8266_DEMUX_H
+#define __ESP8266_DEMUX_H
+
+#include "stm32f4xx_hal.h"
+#include <stdbool.h>
+#include <string.h>
+
+
+/* ********************************************** */
+#define ESP_DEMUX_LINE_MAX       256    // 单行响应/URC 最大长度(超出部分按片段投递).
+#define ESP_DEMUX_IPD_HDR_MAX    24     // "+IPD,<id>,<len>:" 头部最大长度.
+#define ESP_DEMUX_NO_LINK        0xFF   // 单连接模式下无链路号.
+#define ESP_DEMUX_REMAIN_STREAM  0xFFFFFFFFUL  // 透传模式下负载长度未知(on_payload 的 remain 取该值).
+#define ESP_DEMUX_RECV_HDR_MAX   24     // "+CIPRECVDATA:<len>," 头部最大长度.
+/* ********************************************** */
+
+
+// 未请求结果码(URC)类型.
+typedef enum
+{
+  ESP_URC_NONE = 0,
+  ESP_URC_READY,              // "ready"：模块(重新)启动完成.
+  ESP_URC_WIFI_CONNECTED,     // "WIFI CONNECTED".
+  ESP_URC_WIFI_GOT_IP,        // "WIFI GOT IP".
+  ESP_URC_WIFI_DISCONNECT,    // "WIFI DISCONNECT".
+  ESP_URC_LINK_CONNECT,       // "<id>,CONNECT"(多连接模式).
+  ESP_URC_LINK_CLOSED,        // "CLOSED" 或 "<id>,CLOSED".
+  ESP_URC_RECV_PENDING        // "+IPD,[<id>,]<len>"(被动接收模式，不带负载)：模块缓存中有待读取的数据.
+} esp_urc_t;
+
+
+/**
+ * @brief 分流器输出回调. 三类数据分别交给各自的消费方.
+ *
+ *  on_response：命令响应行(已去除行尾 "\r\n"). 提示符 '>' 作为长度为 1 的独立行投递.
+ *               pos / span 为该行原始字节(含首尾空白与 "\r\n")在输入字节流中的位置与长度，
+ *               调用方可据此直接引用输入缓冲区中的原始数据而不拷贝 line.
+ *  on_payload：+IPD 负载片段. data 直接指向输入缓冲区(零拷贝)，remain 为该 +IPD 尚未到达的字节数，
+ *              remain == 0 表示本次 +IPD 负载已完整；透传模式下 remain 恒为 ESP_DEMUX_REMAIN_STREAM.
+ *  on_urc：未请求结果码. line 为原始行内容.
+ *
+ *  回调均在调用 esp_demux_Feed() 的上下文中同步执行，指针仅在回调期间有效.
+ */
+typedef struct
+{
+  void (*on_response)( void *ctx, const uint8_t *line, uint16_t len, uint32_t pos, uint16_t span );
+
+  void (*on_payload)( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain );
+
+  void (*on_urc)( void *ctx, esp_urc_t urc, uint8_t link_id, const uint8_t *line, uint16_t len );
+
+} esp_demux_ops_t;
+
+
+typedef enum
+{
+  ESP_DEMUX_STATE_LINE = 0,
+  ESP_DEMUX_STATE_IPD_HEADER,
+  ESP_DEMUX_STATE_IPD_DATA,
+  ESP_DEMUX_STATE_RECV_HEADER, // "+CIPRECVDATA" 头部(被动接收模式下 AT+CIPRECVDATA 的响应).
+  ESP_DEMUX_STATE_RAW          // 透传(CIPMODE=1)：全部字节均为负载，不做任何解析.
+} esp_demux_state_t;
+
+
+/**
+ * @brief 接收字节流分流器.
+ *
+ *  状态在多次 esp_demux_Feed() 调用之间保持，因此跨越 IDLE 帧边界的行、+IPD 头部与负载均可被正确拼接;
+ *  每个输入字节只被检查一次，不回扫已处理数据.
+ *
+ *  recv_link / recv_len：被动接收模式下最近一次 AT+CIPRECVDATA 所读取的链路号与模块实际返回的长度
+ *  (响应头不携带链路号，由 esp_demux_ExpectRecv() 预先指定).
+ *  notify_len：最近一条 ESP_URC_RECV_PENDING 通知中的数据长度.
+ *  line_pos：line[0] 在输入字节流中的位置(由 esp_demux_Feed() 的 stream_pos 推算).
+ */
+typedef struct
+{
+  esp_demux_state_t state;
+
+  uint8_t  line[ESP_DEMUX_LINE_MAX];
+  uint16_t line_len;
+  uint32_t line_pos;
+
+  uint8_t  link_id;
+  uint32_t remain;
+
+  uint8_t  recv_link;
+  uint32_t recv_len;
+  uint32_t notify_len;
+
+  const esp_demux_ops_t *ops;
+  void *ctx;
+
+} esp_demux_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  void esp_demux_Init( esp_demux_t *pDemux, const esp_demux_ops_t *ops, void *ctx );
+
+  void esp_demux_Reset( esp_demux_t *pDemux );
+
+  void esp_demux_Feed( esp_demux_t *pDemux, const uint8_t *data, uint16_t len, uint32_t stream_pos );
+
+  void esp_demux_SetRaw( esp_demux_t *pDemux, bool enable );
+
+  void esp_demux_ExpectRecv( esp_demux_t *pDemux, uint8_t link_id );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __ESP8266_DEMUX_H
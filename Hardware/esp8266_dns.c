@@ -0,0 +1,397 @@
+#include "esp8266_dns.h"
+#include "esp8266_at_engine.h"
+
+
+/* ********************************************** */
+static EspDnsRecord_t dns_rec[ESP_DNS_CACHE_SIZE];        // 整表即 BKP_SLOT_ESP_DNS 的内容.
+static TickType_t dns_expire[ESP_DNS_CACHE_SIZE];         // 有效期截止时刻(系统节拍，不跨复位).
+static uint32_t dns_last_use[ESP_DNS_CACHE_SIZE];         // 最近使用序号(LRU).
+static uint32_t dns_use_seq = 0;
+
+static uint32_t dns_ttl_s = ESP_DNS_TTL_S;
+static uint32_t dns_neg_ttl_s = ESP_DNS_NEG_TTL_S;
+
+static esp_at_cmd_t dns_refresh_cmd;                      // 后台刷新描述符(同一时刻至多一条).
+static char dns_refresh_host[ESP_AT_HOST_MAX];
+static volatile bool dns_refresh_busy = false;
+/* ********************************************** */
+
+
+#define DNS_STATE_EMPTY           ( 0U )
+#define DNS_STATE_POSITIVE        ( 1U )
+#define DNS_STATE_NEGATIVE        ( 2U )
+
+
+/* ********************************************** */
+void esp_dns_Init( void );
+void esp_dns_SetTtl( uint32_t ttl_s, uint32_t neg_ttl_s );
+esp_dns_result_t esp_dns_Lookup( const char *Host, char *out_ip, uint8_t ip_size );
+void esp_dns_Store( const char *Host, const char *Ip );
+void esp_dns_Forget( const char *Host );
+bool esp_dns_RefreshAsync( const char *Host );
+bool esp_dns_ParseIp( const char *resp, uint16_t len, char out_ip[ESP_DNS_IP_LEN] );
+static int8_t dns_Find( const char *Host, uint32_t hash );
+static uint32_t dns_Hash( const char *Host );
+static void dns_RefreshDone( esp_at_cmd_t *pCmd, void *ctx );
+/* ********************************************** */
+
+
+
+
+/**
+ * @brief 从 BKPSRAM 恢复缓存（在 esp8266_tcp_Init() 中调用）
+ *
+ * 系统节拍不跨复位，留存的成功记录一律视为已过期（ESP_DNS_STALE）：可立即用于建立连接，
+ * 同时在后台重新解析；失败记录直接丢弃。
+ */
+void esp_dns_Init( void )
+{
+  vTaskSuspendAll();
+
+  if ( !bkp_store_Read(BKP_SLOT_ESP_DNS, dns_rec, sizeof(dns_rec)) )
+  {
+    memset(dns_rec, 0, sizeof(dns_rec));
+  }
+
+  TickType_t xNow = xTaskGetTickCount();
+
+  for ( uint8_t i = 0; i < ESP_DNS_CACHE_SIZE; i++ )
+  {
+    if ( dns_rec[i].State != DNS_STATE_POSITIVE )
+    {
+      memset(&dns_rec[i], 0, sizeof(dns_rec[i]));
+    }
+
+    dns_expire[i] = xNow;
+    dns_last_use[i] = 0;
+  }
+
+  ( void )xTaskResumeAll();
+}
+
+
+
+
+/**
+ * @brief 设置成功 / 失败记录的有效期（秒，0 表示保持原值），仅影响此后写入的记录
+ */
+void esp_dns_SetTtl( uint32_t ttl_s, uint32_t neg_ttl_s )
+{
+  if ( ttl_s != 0 )
+  {
+    dns_ttl_s = ttl_s;
+  }
+
+  if ( neg_ttl_s != 0 )
+  {
+    dns_neg_ttl_s = neg_ttl_s;
+  }
+}
+
+
+
+
+/**
+ * @brief 查询缓存
+ *
+ * @param[in]  Host    主机名（不区分大小写）
+ * @param[out] out_ip  命中（含过期）时写入 IPv4 字符串
+ * @param[in]  ip_size out_ip 容量（至少 ESP_DNS_IP_LEN）
+ *
+ * @return ESP_DNS_HIT / ESP_DNS_STALE：out_ip 有效；ESP_DNS_NEGATIVE：近期解析失败；ESP_DNS_MISS：无记录
+ */
+esp_dns_result_t esp_dns_Lookup( const char *Host, char *out_ip, uint8_t ip_size )
+{
+  esp_dns_result_t res = ESP_DNS_MISS;
+
+  if ( Host == NULL || out_ip == NULL || ip_size < ESP_DNS_IP_LEN )
+  {
+    return ESP_DNS_MISS;
+  }
+
+  vTaskSuspendAll();
+
+  int8_t idx = dns_Find(Host, dns_Hash(Host));
+
+  if ( idx >= 0 )
+  {
+    bool fresh = ( (int32_t)( dns_expire[idx] - xTaskGetTickCount() ) > 0 );
+
+    dns_last_use[idx] = ++dns_use_seq;
+
+    if ( dns_rec[idx].State == DNS_STATE_POSITIVE )
+    {
+      memcpy(out_ip, dns_rec[idx].Ip, ESP_DNS_IP_LEN);
+      res = fresh ? ESP_DNS_HIT : ESP_DNS_STALE;
+    }
+    else if ( fresh )
+    {
+      res = ESP_DNS_NEGATIVE;
+    }
+  }
+
+  ( void )xTaskResumeAll();
+
+  return res;
+}
+
+
+
+
+/**
+ * @brief 写入解析结果并同步至 BKPSRAM
+ *
+ * @param[in] Host 主机名
+ * @param[in] Ip   IPv4 字符串；NULL 表示解析失败（写入失败记录）
+ */
+void esp_dns_Store( const char *Host, const char *Ip )
+{
+  if ( Host == NULL || strlen(Host) >= ESP_AT_HOST_MAX || ( Ip != NULL && strlen(Ip) >= ESP_DNS_IP_LEN ) )
+  {
+    return;
+  }
+
+  uint32_t hash = dns_Hash(Host);
+
+  vTaskSuspendAll();
+
+  int8_t idx = dns_Find(Host, hash);
+  bool found = ( idx >= 0 );
+
+  if ( !found )
+  {
+    // 优先使用空条目，否则淘汰最久未使用的条目.
+    idx = 0;
+
+    for ( uint8_t i = 0; i < ESP_DNS_CACHE_SIZE; i++ )
+    {
+      if ( dns_rec[i].State == DNS_STATE_EMPTY )
+      {
+        idx = (int8_t)i;
+        break;
+      }
+
+      if ( dns_last_use[i] < dns_last_use[idx] )
+      {
+        idx = (int8_t)i;
+      }
+    }
+  }
+
+  // 失败记录不覆盖仍可使用的旧结果(例如后台刷新时网络暂时不可用).
+  if ( Ip != NULL || !found || dns_rec[idx].State != DNS_STATE_POSITIVE )
+  {
+    memset(&dns_rec[idx], 0, sizeof(dns_rec[idx]));
+
+    dns_rec[idx].Hash = hash;
+    strcpy(dns_rec[idx].Host, Host);
+
+    if ( Ip != NULL )
+    {
+      strcpy(dns_rec[idx].Ip, Ip);
+    }
+
+    dns_rec[idx].State = ( Ip != NULL ) ? DNS_STATE_POSITIVE : DNS_STATE_NEGATIVE;
+    dns_expire[idx] = xTaskGetTickCount() + pdMS_TO_TICKS(( ( Ip != NULL ) ? dns_ttl_s : dns_neg_ttl_s ) * 1000UL);
+  }
+
+  dns_last_use[idx] = ++dns_use_seq;
+
+  bkp_store_Write(BKP_SLOT_ESP_DNS, dns_rec, sizeof(dns_rec));
+
+  ( void )xTaskResumeAll();
+}
+
+
+
+
+/**
+ * @brief 删除记录（缓存地址连接失败时调用，下次重新解析）
+ */
+void esp_dns_Forget( const char *Host )
+{
+  if ( Host == NULL )
+  {
+    return;
+  }
+
+  vTaskSuspendAll();
+
+  int8_t idx = dns_Find(Host, dns_Hash(Host));
+
+  if ( idx >= 0 )
+  {
+    memset(&dns_rec[idx], 0, sizeof(dns_rec[idx]));
+    dns_last_use[idx] = 0;
+
+    bkp_store_Write(BKP_SLOT_ESP_DNS, dns_rec, sizeof(dns_rec));
+  }
+
+  ( void )xTaskResumeAll();
+}
+
+
+
+
+/**
+ * @brief 经 AT 引擎在后台重新解析（不阻塞，结果由完成回调写入缓存）
+ *
+ * @retval true  已提交
+ * @retval false 已有刷新在途、主机名非法或 AT 引擎不可用
+ */
+bool esp_dns_RefreshAsync( const char *Host )
+{
+  if ( Host == NULL || strlen(Host) >= ESP_AT_HOST_MAX || dns_refresh_busy )
+  {
+    return false;
+  }
+
+  if ( !esp_at_Prepare(&dns_refresh_cmd, ESP_DNS_QUERY_TIMEOUT, "AT+CIPDOMAIN=\"%s\"", Host) )
+  {
+    return false;
+  }
+
+  strcpy(dns_refresh_host, Host);
+
+  dns_refresh_cmd.callback = dns_RefreshDone;
+  dns_refresh_cmd.ctx = dns_refresh_host;
+  dns_refresh_busy = true;
+
+  if ( !esp_at_Submit(&dns_refresh_cmd, ESP_AT_PRIO_NORMAL) )
+  {
+    dns_refresh_busy = false;
+    return false;
+  }
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 从 AT+CIPDOMAIN 的响应中提取 IPv4 地址（兼容 `+CIPDOMAIN:1.2.3.4` 与带引号的新版格式）
+ *
+ * @retval true  提取成功且为合法的点分十进制地址
+ * @retval false 未找到或格式非法
+ */
+bool esp_dns_ParseIp( const char *resp, uint16_t len, char out_ip[ESP_DNS_IP_LEN] )
+{
+  const char *p = (const char *)memmem((const uint8_t *)resp, len, "+CIPDOMAIN:", 11);
+
+  if ( p == NULL )
+  {
+    return false;
+  }
+
+  const char *pEnd = resp + len;
+  uint8_t n = 0, dots = 0, digits = 0;
+  uint16_t octet = 0;
+
+  p += 11;
+
+  if ( p < pEnd && *p == '"' )
+  {
+    p++;
+  }
+
+  for ( ; p < pEnd && ( ( *p >= '0' && *p <= '9' ) || *p == '.' ); p++ )
+  {
+    if ( n >= ESP_DNS_IP_LEN - 1 )
+    {
+      return false;
+    }
+
+    if ( *p == '.' )
+    {
+      if ( digits == 0 || ++dots > 3 )
+      {
+        return false;
+      }
+
+      digits = 0;
+      octet = 0;
+    }
+    else if ( ++digits > 3 || ( octet = (uint16_t)( octet * 10 + ( *p - '0' ) ) ) > 255 )
+    {
+      return false;
+    }
+
+    out_ip[n++] = *p;
+  }
+
+  out_ip[n] = '\0';
+
+  return ( dots == 3 && digits != 0 );
+}
+
+
+
+
+// 按散列与主机名(不区分大小写)查找条目，未找到返回 -1. 须在调度器挂起期间调用.
+static int8_t dns_Find( const char *Host, uint32_t hash )
+{
+  for ( uint8_t i = 0; i < ESP_DNS_CACHE_SIZE; i++ )
+  {
+    if ( dns_rec[i].State == DNS_STATE_EMPTY || dns_rec[i].Hash != hash )
+    {
+      continue;
+    }
+
+    const char *a = dns_rec[i].Host;
+    const char *b = Host;
+
+    while( *a != '\0' && tolower((unsigned char)*a) == tolower((unsigned char)*b) )
+    {
+      a++;
+      b++;
+    }
+
+    if ( *a == '\0' && *b == '\0' )
+    {
+      return (int8_t)i;
+    }
+  }
+
+  return -1;
+}
+
+
+
+
+// FNV-1a(32 位)，主机名按小写计算.
+static uint32_t dns_Hash( const char *Host )
+{
+  uint32_t hash = 2166136261UL;
+
+  while( *Host != '\0' )
+  {
+    hash ^= (uint8_t)tolower((unsigned char)*Host++);
+    hash *= 16777619UL;
+  }
+
+  return hash;
+}
+
+
+
+
+// 后台刷新完成(AT 任务上下文). 失败时保留旧地址(仍为过期状态)，下次使用时再次刷新.
+static void dns_RefreshDone( esp_at_cmd_t *pCmd, void *ctx )
+{
+  char ip[ESP_DNS_IP_LEN];
+
+  if ( pCmd->result == ESP_AT_OK && esp_dns_ParseIp(pCmd->response, pCmd->resp_len, ip) )
+  {
+    esp_dns_Store((const char *)ctx, ip);
+  }
+  else
+  {
+    // 仅记录失败，不覆盖旧地址(见 esp_dns_Store()).
+    esp_dns_Store((const char *)ctx, NULL);
+
+    LOG_WRITE(LOG_WARNING, "DNS", "Refresh %s failed: %d", (const char *)ctx, (int)pCmd->result);
+  }
+
+  dns_refresh_busy = false;
+}
@@ -0,0 +1,69 @@
+#ifndef __ESP8266_DNS_H
+#define __ESP8266_DNS_H
+
+#include "esp8266_driver.h"
+#include "esp8266_at_cmd.h"
+#include "bkp_store.h"
+#include <ctype.h>
+
+
+/* ********************************************** */
+#define ESP_DNS_CACHE_SIZE        ( 6 )        // 缓存条目数(满时淘汰最久未使用的条目).
+#define ESP_DNS_IP_LEN            ( 16 )       // "255.255.255.255" + '\0'.
+#define ESP_DNS_TTL_S             ( 600UL )    // 解析成功的默认有效期(秒). CIPDOMAIN 不返回记录的 TTL.
+#define ESP_DNS_NEG_TTL_S         ( 30UL )     // 解析失败的默认有效期(秒)，期间不再重复查询.
+#define ESP_DNS_QUERY_TIMEOUT     ( 5000UL )   // 后台刷新 AT+CIPDOMAIN 的总时限(ms).
+/* ********************************************** */
+
+
+typedef enum
+{
+  ESP_DNS_MISS = 0,        // 无记录，需要解析.
+  ESP_DNS_HIT,             // 有效期内的解析结果.
+  ESP_DNS_STALE,           // 已过期(或复位前留存)的解析结果，可先行使用并在后台刷新.
+  ESP_DNS_NEGATIVE         // 有效期内的解析失败记录.
+} esp_dns_result_t;
+
+
+/**
+ * @brief 缓存记录（同时作为 BKP_SLOT_ESP_DNS 的存储格式，整表写入）.
+ *
+ *  Hash：主机名(不区分大小写)的 FNV-1a 散列，查找时先比较散列再比较主机名.
+ *  Host / Ip：主机名与解析结果.
+ *  State：0 空 / 1 成功 / 2 失败.
+ */
+typedef struct
+{
+  uint32_t Hash;
+  char Host[ESP_AT_HOST_MAX];
+  char Ip[ESP_DNS_IP_LEN];
+  uint8_t State;
+  uint8_t reserved[3];
+
+} EspDnsRecord_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  void esp_dns_Init( void );
+
+  void esp_dns_SetTtl( uint32_t ttl_s, uint32_t neg_ttl_s );
+
+  esp_dns_result_t esp_dns_Lookup( const char *Host, char *out_ip, uint8_t ip_size );
+
+  void esp_dns_Store( const char *Host, const char *Ip );
+
+  void esp_dns_Forget( const char *Host );
+
+  bool esp_dns_RefreshAsync( const char *Host );
+
+  bool esp_dns_ParseIp( const char *resp, uint16_t len, char out_ip[ESP_DNS_IP_LEN] );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __ESP8266_DNS_H
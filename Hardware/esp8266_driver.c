@@ -1,6 +1,9 @@
 #include "esp8266_driver.h"
 #include "esp8266_tcp.h"
 #include "esp_http.h"
+#include "esp8266_at_cmd.h"
+#include "esp8266_txq.h"
+#include "boot_prof.h"
 
 
 /* Global Ver.*/
@@ -17,18 +20,41 @@ extern DMA_HandleTypeDef  hdma_rx;
 
 extern DMA_HandleTypeDef  hdma_tx;
 
-uint8_t rx_flag = NO_DATA;
-
 uint8_t esp8266_TxBuffer[Tx_DATA_BUFFER] = { 0 };
 
-uint8_t recv_temp[RECV_DATA_BUFFER] = { 0 };
+// DMA循环接收环. 尾部额外的 RECV_DATA_BUFFER 字节为回绕展开区,DMA 永不写入该区域.
+uint8_t esp_rx_ring[ESP_RX_RING_SIZE + RECV_DATA_BUFFER] = { 0 };
+
+static volatile uint32_t rx_stream_head = 0;   // DMA 已写入(且已被中断记账)的累计字节数.
+static volatile uint32_t rx_frame_start = 0;   // 当前尚未发布的帧在字节流中的起点.
+static volatile uint32_t rx_stream_done = 0;   // 已被分流器处理完毕的字节流位置(用于计算被动接收的可用额度).
+static volatile uint16_t rx_dma_pos = 0;       // 上次记账时 DMA 在环内的写位置.
+static volatile uint32_t rx_idle_mark = 0;     // 最近一次 IDLE 事件时的字节流位置(此前的数据均为已结束的帧).
+static volatile bool rx_publish_stalled = false; // 帧池耗尽导致发布暂停，待句柄归还后由 esp8266_RxRing_KickFromISR() 续发.
+
+static esp_demux_t esp_demux;                   // 接收字节流分流器,仅在持有 xMutexEsp 时驱动.
+
+// 响应结束标志. 顺序须与 EspToken_t 一致.
+static const char * const esp_tokens[ESP_TOK_NUM] =
+{
+  "OK", "ERROR", "FAIL", "busy ", "SEND OK", "SEND FAIL", ">", "CONNECT", "ALREADY CONNECTED"
+};
+
+ESP_AT_STATIC_ASSERT(ESP_TOK_NUM <= AT_MATCH_MAX_TOKENS, esp_tokens_fit_matcher);
+
+static at_matcher_t esp_matcher;                // 由 esp_tokens[] 构建的多模式匹配自动机.
+static at_match_ctx_t esp_match_ctx;            // 与 LastReceivedFrame 同步推进的匹配进度.
+static bool esp_matcher_ready = false;
+
+static EspRxStats_t rx_stats = { 0 };           // 接收通路统计(中断与任务共享,临界区内访问).
+static uint64_t rx_stats_frame_bytes = 0;       // 已投递帧的累计字节数(用于计算平均帧长).
+static uint64_t rx_stats_isr_cycles = 0;        // RxEvent 中断累计耗时(DWT 周期).
 
-volatile uint16_t recvData_len;
+static EspSession_t esp_session = { 0 };        // 当前会话镜像(BKP_SLOT_ESP_SESSION).
 /* ********************************************** */
 
 
 /* ********************************************** */
-TaskHandle_t xCurrentSendTaskHandle = NULL;
 
 
 
@@ -42,6 +68,22 @@ static uint32_t usart_timeout_Calculate( uint16_t data_len );
 static void esp8266Handle_Initial( ESP8266_HandleTypeDef *hpesp8266 );
 static BaseType_t esp8266_ClearRecvQueue_Manual( void );
 static void FlushRecvQueue( void );
+static bool esp8266_RxRing_MapFrame( EspRxFrame_t *pFrame );
+static void esp8266_RxRing_CopyOut( uint32_t index, uint32_t stream_pos, uint16_t len );
+static void esp8266_ReleaseResponse( void );
+static void esp8266_DWT_Init( void );
+static bool esp8266_TryBaudRate( uint32_t baud, uint32_t origin );
+static bool esp8266_BaudEchoTest( void );
+static bool esp8266_WifiFastJoin( const EspWifiCache_t *pCache );
+static bool esp8266_WarmProbe( const EspSession_t *pSess, bool *pLinked );
+static void esp8266_SessionSave( void );
+static void esp8266_WifiCacheSave( EspWifiCache_t *pCache );
+static void esp8266_ProcessFrame( EspRxFrame_t *pFrame );
+static void esp8266_RxRing_PublishFromISR( bool is_idle, BaseType_t *pxHigherPriorityTaskWoken );
+static void esp8266_OnResponse( void *ctx, const uint8_t *line, uint16_t len, uint32_t pos, uint16_t span );
+static void esp8266_OnPayload( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain );
+static void esp8266_OnUrc( void *ctx, esp_urc_t urc, uint8_t link_id, const uint8_t *line, uint16_t len );
+static void *esp8266_MatchToken( int8_t tok, const char *token, uint16_t token_len );
 bool at_extractString_between_quotes
 ( 
   ESP8266_HandleTypeDef *hpesp8266, 
@@ -52,6 +94,14 @@ bool at_extractString_between_quotes
 );
 bool at_extractNum( ESP8266_HandleTypeDef *hpesp8266, const char *key, uint32_t *out_val, BaseType_t mode );
 bool at_extractField( ESP8266_HandleTypeDef *hpesp8266, at_field_type_t type, uint8_t index, const uint8_t **pReturn, uint16_t *pLen, BaseType_t mode );
+
+
+static const esp_demux_ops_t esp_demux_ops = 
+{
+  esp8266_OnResponse,
+  esp8266_OnPayload,
+  esp8266_OnUrc
+};
 /* ********************************************** */
 
 
@@ -78,18 +128,46 @@ void vtask8266_Init( void *parameter )
 
   EspInitState_t currentState = INIT_STATE_CHECK_AT;
 
+  TickType_t xBootTick = xTaskGetTickCount();
+
+  // 上次成功入网的参数(同一 SSID 且 IP 配置完整时才走快速路径).
+  EspWifiCache_t wifi_cache;
+  bool cache_valid = bkp_store_Read(BKP_SLOT_ESP_WIFI, &wifi_cache, sizeof(wifi_cache))
+                        && strcmp(wifi_cache.Ssid, hesp8266.WifiSSID) == 0
+                          && wifi_cache.Bssid[0] != '\0' && wifi_cache.Ip[0] != '\0'
+                            && wifi_cache.Gateway[0] != '\0' && wifi_cache.Netmask[0] != '\0';
+
+  if ( !cache_valid )
+  {
+    memset(&wifi_cache, 0, sizeof(wifi_cache));
+  }
+
+  // MCU 热复位前的会话. 模块未随之复位时仍处于入网状态，探测确认后即可跳过整个入网流程.
+  bool session_valid = bkp_store_Read(BKP_SLOT_ESP_SESSION, &esp_session, sizeof(esp_session))
+                          && strcmp(esp_session.Ssid, hesp8266.WifiSSID) == 0 && esp_session.Ip[0] != '\0';
+  bool session_linked = false;
+
+  if ( !session_valid )
+  {
+    memset(&esp_session, 0, sizeof(esp_session));
+  }
+
   #if defined(__DEBUG_LEVEL_1__)
     printf("Esp8266 Init Start.\n");
   #endif // __DEBUG_LEVEL_1__
 
 
+  uint8_t state_retries = 0;
+
   while( (currentState != INIT_STATE_ERROR) && (currentState != INIT_STATE_COMPLETE) )
   {
+    EspInitState_t prevState = currentState;
+
     switch(currentState)
     {
       case INIT_STATE_CHECK_AT:      
         {
-          if ( esp8266_SendAT("AT") )
+          if ( esp8266_SendATConst("AT") )
           {
             void *pReady = esp8266_WaitResponse("OK", 250);
 
@@ -97,13 +175,20 @@ void vtask8266_Init( void *parameter )
             {
               esp8266_DropLastFrame();
               printf("AT Check OK.\n");
-              currentState = INIT_STATE_SET_MODE;
+              currentState = session_valid ? INIT_STATE_WARM_PROBE : INIT_STATE_SET_BAUD;
               hesp8266.RetryCount = 0;
             }
             else 
             {
               printf("AT Test Failed!\n");
               hesp8266.RetryCount++;
+
+              // 沿用的持久化速率不可用(模块已断电复位)，回落至默认速率.
+              if ( esp8266_huart.Init.BaudRate != ESP_UART_BAUDRATE )
+              {
+                printf("Fall back to %lu baud.\n", (unsigned long)ESP_UART_BAUDRATE);
+                esp8266_UART_SetBaudRate(ESP_UART_BAUDRATE);
+              }
             }
           }
           else 
@@ -115,6 +200,52 @@ void vtask8266_Init( void *parameter )
           break;
         }
       
+      case INIT_STATE_WARM_PROBE:
+        {
+          // 仅尝试一次: 会话任一项不符即放弃，走完整流程.
+          if ( esp8266_WarmProbe(&esp_session, &session_linked) )
+          {
+            strncpy(hesp8266.Wifi_Ipv4, esp_session.Ip, WIFI_IPV4_LENGTH - 1);
+            hesp8266.Wifi_Ipv4[WIFI_IPV4_LENGTH - 1] = '\0';
+            hesp8266.CurrentMode = (EspWifiMode_t)esp_session.Mode;
+            hesp8266.WarmStart = true;
+
+            printf("Warm start: session reused. Ipv4: %s%s\n", hesp8266.Wifi_Ipv4, session_linked ? " (TCP link alive)" : "");
+            currentState = INIT_STATE_COMPLETE;
+          }
+          else 
+          {
+            printf("Warm probe mismatch, fall back to full init.\n");
+
+            bkp_store_Invalidate(BKP_SLOT_ESP_SESSION);
+            memset(&esp_session, 0, sizeof(esp_session));
+            session_valid = false;
+            session_linked = false;
+            currentState = INIT_STATE_SET_BAUD;
+          }
+
+          hesp8266.RetryCount = 0;
+          break;
+        }
+
+      case INIT_STATE_SET_BAUD:
+        {
+          if ( esp8266_NegotiateBaudRate() )
+          {
+            printf("UART Baud: %lu.\n", (unsigned long)esp8266_huart.Init.BaudRate);
+            currentState = INIT_STATE_SET_MODE;
+            hesp8266.RetryCount = 0;
+          }
+          else 
+          {
+            // 链路已丢失，重新探测.
+            printf("Baud Negotiation Lost Link!\n");
+            currentState = INIT_STATE_CHECK_AT;
+            hesp8266.RetryCount++;
+          }
+          break;
+        }
+
       case INIT_STATE_SET_MODE:
         {
           if ( esp8266_ConnectModeChange(hesp8266.TargetMode) == hesp8266.TargetMode )
@@ -126,7 +257,7 @@ void vtask8266_Init( void *parameter )
               esp8266_DropLastFrame();
               printf("Wifi Mode Set OK.\n");
               hesp8266.CurrentMode = hesp8266.TargetMode;
-              currentState = INIT_STATE_CONNECT_WIFI;
+              currentState = cache_valid ? INIT_STATE_FAST_CONNECT : INIT_STATE_CONNECT_WIFI;
               hesp8266.RetryCount = 0;
             }
             else 
@@ -143,6 +274,33 @@ void vtask8266_Init( void *parameter )
           break;
         }
 
+      case INIT_STATE_FAST_CONNECT:
+        {
+          if ( esp8266_WifiFastJoin(&wifi_cache) )
+          {
+            strncpy(hesp8266.Wifi_Ipv4, wifi_cache.Ip, WIFI_IPV4_LENGTH - 1);
+            hesp8266.Wifi_Ipv4[WIFI_IPV4_LENGTH - 1] = '\0';
+            hesp8266.FastJoin = true;
+
+            printf("Wifi Fast Join OK. Ipv4: %s\n", hesp8266.Wifi_Ipv4);
+            currentState = INIT_STATE_COMPLETE;
+          }
+          else 
+          {
+            // 热点更换信道 / 重启或租约失效，放弃缓存走完整流程.
+            printf("Wifi Fast Join Failed, fall back to full connect.\n");
+            LOG_WRITE(LOG_WARNING, "ESP", "Fast join to %s failed, cache dropped.", wifi_cache.Bssid);
+
+            bkp_store_Invalidate(BKP_SLOT_ESP_WIFI);
+            memset(&wifi_cache, 0, sizeof(wifi_cache));
+            cache_valid = false;
+            currentState = INIT_STATE_CONNECT_WIFI;
+          }
+
+          hesp8266.RetryCount = 0;
+          break;
+        }
+
       case INIT_STATE_CONNECT_WIFI:
         {
           char *patCommand = (char *)pvPortMalloc(128);
@@ -165,9 +323,18 @@ void vtask8266_Init( void *parameter )
 
   
 
+          // 完整流程依赖 DHCP 取得地址. 快速重连的恢复命令可能未成功，旧版本也可能已将 DHCP 关闭写入 Flash，入网前显式开启.
+          if ( esp8266_SendATConst("AT+CWDHCP_CUR=1,1") )
+          {
+            esp8266_WaitResponse("OK", 1000);
+          }
+
+          esp8266_DropLastFrame();
+
           if ( esp8266_SendAT("%s", patCommand) )
           {
-            void *pConnectOK = esp8266_WaitResponse("WIFI GOT IP", 15000); // WIFI连接时间较长.
+            // "WIFI CONNECTED" / "WIFI GOT IP" 为 URC，由分流器单独处理，命令本身以 "OK" 结束.
+            void *pConnectOK = esp8266_WaitResponse("OK", ESP_WIFI_FULL_JOIN_TIMEOUT); // WIFI连接时间较长.
             if ( pConnectOK != NULL )
             {
               esp8266_DropLastFrame();
@@ -194,7 +361,7 @@ Free:
 
       case INIT_STATE_GET_IP:
         {
-          if ( esp8266_SendAT("AT+CIPSTA?") )
+          if ( esp8266_SendATConst("AT+CIPSTA?") )
           {
             void *pResponse = esp8266_WaitResponse("+CIPSTA:", 5000);
             if ( pResponse != NULL )
@@ -202,6 +369,9 @@ Free:
               // 成功获取到IP信息.
               printf("Got IP Address Information\n");
 
+              // 网关与掩码供下次快速重连使用，须在消费该帧之前提取.
+              at_extractString_between_quotes(&hesp8266, "+CIPSTA:gateway", wifi_cache.Gateway, WIFI_IPCFG_LENGTH, pdFALSE);
+              at_extractString_between_quotes(&hesp8266, "+CIPSTA:netmask", wifi_cache.Netmask, WIFI_IPCFG_LENGTH, pdFALSE);
               at_extractString_between_quotes(&hesp8266, "+CIPSTA:ip", hesp8266.Wifi_Ipv4, WIFI_IPV4_LENGTH, pdTRUE);
 
               printf("Ipv4: %s\n", hesp8266.Wifi_Ipv4);
@@ -230,6 +400,17 @@ Free:
         }
     }
 
+    // 启动时间线: 每次状态迁移记录上一状态的结束时刻与停留期间的重试次数.
+    if ( currentState != prevState )
+    {
+      boot_prof_Mark(BOOT_PHASE_ESP(prevState), state_retries);
+      state_retries = 0;
+    }
+    else if ( state_retries < 0xFF )
+    {
+      state_retries++;
+    }
+
     if ( hesp8266.RetryCount >= MAX_RETRY_COUNT)
     {
       for(; ;); // 用于调试. 
@@ -243,7 +424,7 @@ Free:
 
     if ( (currentState != INIT_STATE_COMPLETE) && (currentState != INIT_STATE_ERROR) && hesp8266.RetryCount != 0 )
     {
-      HAL_Delay(pdMS_TO_TICKS(1000));  // 延迟1s后尝试重新初始化对应状态.
+      vTaskDelay(pdMS_TO_TICKS(1000));  // 延迟1s后尝试重新初始化对应状态.
     }
 
     if ( currentState == INIT_STATE_ERROR )
@@ -256,13 +437,48 @@ Free:
 
   if ( currentState == INIT_STATE_COMPLETE )
   {
+    hesp8266.OnlineMs = ( xTaskGetTickCount() - xBootTick ) * portTICK_PERIOD_MS;
+
+    if ( hesp8266.WarmStart )
+    {
+      printf("Online in %lu ms (warm start).\n", (unsigned long)hesp8266.OnlineMs);
+      LOG_WRITE(LOG_INFO, "ESP", "Online in %lu ms (warm start, link %s).", (unsigned long)hesp8266.OnlineMs, session_linked ? "kept" : "none");
+    }
+    else if ( hesp8266.FastJoin )
+    {
+      printf("Online in %lu ms (fast path, last full path %lu ms).\n", (unsigned long)hesp8266.OnlineMs, (unsigned long)wifi_cache.FullOnlineMs);
+      LOG_WRITE(LOG_INFO, "ESP", "Online in %lu ms (fast path, last full path %lu ms).", (unsigned long)hesp8266.OnlineMs, (unsigned long)wifi_cache.FullOnlineMs);
+    }
+    else 
+    {
+      printf("Online in %lu ms (full path).\n", (unsigned long)hesp8266.OnlineMs);
+      LOG_WRITE(LOG_INFO, "ESP", "Online in %lu ms (full path).", (unsigned long)hesp8266.OnlineMs);
+
+      wifi_cache.FullOnlineMs = hesp8266.OnlineMs;
+      esp8266_WifiCacheSave(&wifi_cache);
+    }
+
     // 调试部分****************************
     const LogStatus_t* log_status = Log_GetStatus();
 
+    // 链路信息在 tcp_Init 复位前取出，接管成功后由 tcp 层重新写回.
+    EspSession_t prev_session = esp_session;
+
+    esp8266_SessionSave();
+
     esp8266_tcp_Init();
 
+    if ( session_linked )
+    {
+      esp8266_tcp_Adopt(prev_session.Host, prev_session.RemoteIp, prev_session.Port);
+    }
+
+    boot_prof_Mark(BOOT_PHASE_TCP_INIT, 0);
+
     esp8266_tcp_Connect("api.weatherbit.io", 80, TCP);
 
+    boot_prof_Mark(BOOT_PHASE_TCP_CONNECT, 0);
+
     const esp_tcp_handle_t *pState = esp8266_tcp_getState();
 
     printf("\n=== ESP8266 TCP Connection State ===\n");
@@ -310,7 +526,7 @@ Free:
  *
  * 本函数是标准 `memmem()` 的轻量级嵌入式替代实现，专为 ESP8266 AT 响应解析设计：
  * 它不依赖 `\0` 结尾，仅基于显式长度进行安全搜索，避免因未终止字符串导致的越界访问。
- * 典型用于在 `LastReceivedFrame.RecvData` 中查找 `"OK"`, `"+IPD:"`, `"\"value\"` 等固定模式。
+ * 典型用于在 `LastReceivedFrame->RecvData` 中查找 `"OK"`, `"+IPD:"`, `"\"value\"` 等固定模式。
  *
  * @note
  *   - 搜索范围严格限定在 `[haystack, haystack + stack_len)` 内，**绝不越界读取**；
@@ -399,10 +615,9 @@ void*  memmem(
  *     并自动追加 `\r\n` 结尾（符合 AT 协议规范），末尾显式置 `\0`；
  *   - 发送长度上限为 `Tx_DATA_BUFFER - 3`（预留 `\r`, `\n`, `\0` 空间），超长或格式化失败立即返回 `false`；
  *   - 使用递归互斥量 `xMutexEsp` 保护临界区（防止多任务并发发送），获取超时 500ms；
- *   - 成功启动 DMA 后，将当前任务句柄存入 `xCurrentSendTaskHandle`，供 UART TX 完成中断回调使用；
- *   - 调用 `ulTaskNotifyTake()` 等待发送完成通知，超时则主动调用 `HAL_UART_AbortTransmit()` 终止 DMA；
+ *   - 命令作为单段请求提交到发送队列（esp8266_txq），由 `esp_txq_Wait()` 等待发送完成通知，
+ *     超时则由队列取消该请求并中止仍在进行的 DMA 传输；
  *   - 所有错误路径（互斥量失败、格式化失败、HAL 错误、超时）均会：
- *       • 清理 `xCurrentSendTaskHandle`；
  *       • 释放互斥量；
  *       • 记录对应级别日志（`LOG_DEBUG` 或 `LOG_WARNING`）；
  *   - **非阻塞但同步语义**：函数返回 `true` 表示 DMA 已成功启动且收到完成通知（即字节已移入硬件 FIFO）；
@@ -420,7 +635,7 @@ void*  memmem(
  *   - 若 UART 外设处于异常状态（如 `gState != HAL_UART_STATE_READY`），`HAL_UART_Transmit_DMA()` 可能直接返回 `HAL_ERROR`；
  *   - 本函数不校验 ESP8266 是否在线或响应能力 —— 它只负责“发出去”，响应处理由 `esp8266_WaitResponse()` 独立承担。
  *
- * @see usart_timeout_Calculate(), esp8266_WaitResponse(), HAL_UART_TxCpltCallback()
+ * @see usart_timeout_Calculate(), esp8266_WaitResponse(), esp_txq_Submit()
  */
 bool esp8266_SendAT( const char* format, ... )
 {
@@ -436,8 +651,7 @@ bool esp8266_SendAT( const char* format, ... )
 
   va_start( args, format );
 
-  memset(esp8266_TxBuffer, 0, Tx_DATA_BUFFER);
-
+  // vsnprintf 自行写入结束符，无需预先清零整个缓冲区.
   int len = vsnprintf( esp8266_TxBuffer, Tx_DATA_BUFFER, format, args );
 
   va_end(args);
@@ -461,12 +675,12 @@ bool esp8266_SendAT( const char* format, ... )
     esp8266_TxBuffer[len + 2] = '\0'; 
     len += 2;   // 发送长度增加 2
 
-    xCurrentSendTaskHandle = xTaskGetCurrentTaskHandle();
+    esp_tx_req_t req;
 
-    HAL_StatusTypeDef status = 
-                HAL_UART_Transmit_DMA(&esp8266_huart, esp8266_TxBuffer, len);
+    esp_txq_Prepare(&req);
+    esp_txq_AddSeg(&req, esp8266_TxBuffer, (uint16_t)len);
 
-    if ( status != HAL_OK )
+    if ( !esp_txq_Submit(&req) )
     {
       #if defined(__DEBUG_LEVEL_1__)
         printf("AT Send Error!\n");
@@ -477,39 +691,170 @@ bool esp8266_SendAT( const char* format, ... )
       goto exit;
     }
 
-    if ( ulTaskNotifyTake(pdTRUE, usart_timeout_Calculate(len)) > 0 )
+    // 超时由发送队列取消(中止仍在进行的 DMA 传输).
+    if ( esp_txq_Wait(&req, usart_timeout_Calculate(len)) )
     {
-      // 成功接收到通知.
       xSemaphoreGiveRecursive(xMutexEsp);
 
-      xCurrentSendTaskHandle = NULL;
-
       return true;
     }
     
-    // 发送超时.
     #if defined(__DEBUG_LEVEL_1__)
       printf("AT Command Send Timeout.\n");
     #endif // __DEBUG_LEVEL_1__
 
-    __disable_irq();
-    HAL_UART_StateTypeDef currentState = esp8266_huart.gState;
-    __enable_irq();
+    goto exit;
+  }
+
+
+exit:
+  xSemaphoreGiveRecursive(xMutexEsp);
+  return false;
+}
+
+
+
+
+/**
+ * @brief 通过 DMA 发送原始字节（不追加 "\r\n"，不经过 `esp8266_TxBuffer` 拷贝）
+ *
+ * 用于 `AT+CIPSEND` 之后的负载以及透传模式下的数据。数据作为单段请求经发送队列直接由 DMA 发出，
+ * 阻塞至发送完成通知或超时，因此 `data` 只需在调用期间有效。
+ *
+ * @param[in] data 待发送数据（SRAM 或 Flash）
+ * @param[in] len  数据长度
+ *
+ * @retval true  发送完成
+ * @retval false 参数非法、互斥量获取失败、DMA 启动失败或发送超时
+ */
+bool esp8266_SendRaw( const uint8_t *data, uint16_t len )
+{
+  if ( data == NULL || len == 0 )
+  {
+    return false;
+  }
+
+  esp_tx_seg_t seg = { data, len };
+
+  return esp8266_SendRawV(&seg, 1);
+}
+
+
+
+
+/**
+ * @brief 通过 DMA 依次发送多个分段（聚集发送，各分段均不拷贝）
+ *
+ * 分段按 `ESP_TXQ_MAX_SEGS` 分批，全部批次先一次性提交到发送队列，再只等待最后一批完成：
+ * 批内与批间均由发送完成中断直接衔接，DMA 在批次之间不会空闲等待任务调度. 批次多于 `ESP_TX_BATCH_MAX`
+ * 时复用最早的请求描述符(复用前等待其完成). 整个过程持有 `xMutexEsp`，其他任务的 AT 命令不会插入到分段之间.
+ * 长度为 0 的分段被跳过.
+ *
+ * @param[in] segs    分段表（各段只需在调用期间有效，可位于 Flash）
+ * @param[in] seg_num 分段数
+ *
+ * @retval true  全部发送完成
+ * @retval false 参数非法、互斥量获取失败、DMA 启动失败或发送超时
+ */
+bool esp8266_SendRawV( const esp_tx_seg_t *segs, uint8_t seg_num )
+{
+  // 请求描述符须保持到发送完成，整组不宜放在调用者栈上，静态分配并由 xMutexEsp 保护.
+  static esp_tx_req_t batch[ESP_TX_BATCH_MAX];
+
+  if ( segs == NULL || seg_num == 0 )
+  {
+    return false;
+  }
+
+  if ( xSemaphoreTakeRecursive(xMutexEsp, 500) != pdPASS )
+  {
+    LOG_WRITE(LOG_DEBUG, "NULL", "SendRaw() get Mutex failed\n");
+
+    return false;
+  }
+
+  uint32_t bytes = 0;
 
-    // 取消可能还在进行的DMA传输.
-    if ( currentState == HAL_UART_STATE_BUSY_TX )
+  for ( uint8_t k = 0; k < seg_num; k++ )
+  {
+    bytes += ( segs[k].data != NULL ) ? segs[k].len : 0;
+  }
+
+  uint32_t timeout_ms = usart_timeout_Calculate((uint16_t)( bytes > 0xFFFFU ? 0xFFFFU : bytes ));
+
+  esp_tx_req_t *pLast = NULL;
+  bool result = true;
+  uint8_t used = 0;
+  uint8_t slot = 0;
+  uint8_t i = 0;
+
+  while( result && i < seg_num )
+  {
+    esp_tx_req_t *pReq = &batch[slot];
+
+    // 描述符一轮用尽后，复用前须等待其上一次提交完成.
+    if ( used == ESP_TX_BATCH_MAX && !esp_txq_Wait(pReq, timeout_ms) )
+    {
+      result = false;
+      break;
+    }
+
+    esp_txq_Prepare(pReq);
+
+    for ( ; i < seg_num && pReq->seg_num < ESP_TXQ_MAX_SEGS; i++ )
     {
-      HAL_UART_AbortTransmit(&esp8266_huart);
+      if ( segs[i].data != NULL && segs[i].len > 0 )
+      {
+        esp_txq_AddSeg(pReq, segs[i].data, segs[i].len);
+      }
     }
 
-    goto exit;
+    if ( pReq->seg_num == 0 )
+    {
+      break;
+    }
+
+    if ( !esp_txq_Submit(pReq) )
+    {
+      result = false;
+      break;
+    }
+
+    pLast = pReq;
+    used = ( used < ESP_TX_BATCH_MAX ) ? used + 1 : used;
+    slot = ( slot + 1 ) % ESP_TX_BATCH_MAX;
+  }
+
+  // 批次按提交顺序发送，最后一批完成即全部完成.
+  if ( result && pLast != NULL )
+  {
+    result = esp_txq_Wait(pLast, timeout_ms);
   }
 
+  // 任一批次出错即整体失败，仍在队列中的批次一并撤下.
+  for ( uint8_t k = 0; k < used; k++ )
+  {
+    if ( batch[k].state == ESP_TXQ_QUEUED || batch[k].state == ESP_TXQ_ACTIVE )
+    {
+      esp_txq_Cancel(&batch[k]);
+    }
+
+    if ( batch[k].state == ESP_TXQ_ERROR )
+    {
+      result = false;
+    }
+  }
+
+  #if defined(__DEBUG_LEVEL_1__)
+    if ( !result )
+    {
+      printf("Raw Send Error!\n");
+    }
+  #endif // __DEBUG_LEVEL_1__
 
-exit:
-  xCurrentSendTaskHandle = NULL;
   xSemaphoreGiveRecursive(xMutexEsp);
-  return false;
+
+  return result;
 }
 
 
@@ -606,37 +951,68 @@ EspWifiMode_t esp8266_ConnectModeChange( EspWifiMode_t Mode )
 
 
 /**
- * @brief 阻塞等待 ESP8266 模块返回包含指定子串的 AT 响应帧
+ * @brief 阻塞等待 ESP8266 模块返回包含指定子串的 AT 响应
  *
- * 本函数从 FreeRTOS 队列 `hesp8266.xRecvQueue` 中接收一帧完整响应数据（`EspRecvMsg_t`），
- * 并在该帧的 `RecvData[]` 缓冲区中使用 `memmem()` 安全搜索目标字符串 `expected`。
+ * 本函数从 FreeRTOS 队列 `hesp8266.xRecvQueue` 中逐个接收帧句柄（`EspRxFrame_t *`），映射为指向
+ * DMA 接收环的帧视图后交给分流器 `esp_demux_Feed()`：+IPD 负载直接流向已注册的负载消费方，URC 更新事件位，
+ * 只有命令响应行被记入响应视图 `hesp8266.LastReceivedFrame`（直接指向接收环，不拷贝）。每收到一帧即在累积的响应行中搜索 `expected`。
  * 成功匹配后，立即将 `hesp8266.LastFrameValid` 标记为 `LastRecvFrame_Valid`，防止上层
- * 多次调用时重复解析同一帧；若超时或未匹配，则返回 NULL。
+ * 多次调用时重复解析同一响应；若超时或未匹配，则返回 NULL。
  *
  * @note
  *   - 调用前必须确保 `hesp8266.LastFrameValid == LastRecvFrame_Used`，否则函数立即返回 NULL；
  *     此设计强制要求上层在解析完一帧后调用 `esp8266_DropLastFrame()` 主动释放帧所有权；
- *   - 搜索基于显式长度（`Data_Len`），不依赖 `\0` 终止符，完全兼容二进制响应（如 `+IPD,0,5:Hello`）；
+ *   - 由于负载与 URC 已被分流，负载中出现的 "OK" 等字节不会造成误匹配，`expected` 也不应再是 "+IPD," / "WIFI GOT IP"
+ *     之类的非响应内容（URC 请使用 `esp8266_WaitEvent()`）；
  *   - 使用 `xSemaphoreTakeRecursive(xMutexEsp, 200)` 保护队列接收临界区，超时 200ms 防死锁；
- *   - 若 `xQueueReceive()` 超时（即 `xTicksToWait` 耗尽），函数终止并返回 NULL；
+ *   - `timeout_ms` 为总时限：每次取帧只等待剩余时间，超时即返回 NULL；
+ *   - 若 `expected` 不是命令的最终结果（不属于 `ESP_TOK_FINAL_MASK`，如 `"+CIPSTA:"`），命中后继续累积后续帧，
+ *     直至 OK / ERROR / SEND OK 等最终结果到达，保证被 IDLE 切分的多帧响应作为一个整体交给 `at_extract*()`；
+ *     最终结果未在时限内到达时仍按成功返回已累积的内容；
+ *   - 若帧数据在被取出前已被 DMA 覆盖（接收环整圈回绕），该帧被丢弃，分流器复位后继续等待；
  *   - 所有调试日志受 `__DEBUG_LEVEL_1__` 控制，不影响 Release 构建体积与性能；
  *   - 本函数**不可在中断上下文（ISR）中调用**（`xSemaphoreTakeRecursive` / `xQueueReceive` 非 ISR-safe）。
  *
- * @param[in]  expected     待搜索的目标子串（如 `"OK"`, `"+IPD:"`, `"WIFI GOT IP"`），必须非 NULL 且非空
+ * @param[in]  expected     待搜索的目标子串（如 `"OK"`, `">"`, `"SEND OK"`），必须非 NULL 且非空
  * @param[in]  timeout_ms   总等待超时时间（毫秒），建议：AT 命令响应设 200~500ms；TCP 连接设 5000~15000ms
  *
- * @retval non-NULL    指向 `LastReceivedFrame.RecvData` 中首次匹配位置的指针（即 `&RecvData[i]`）
+ * @retval non-NULL    指向 `LastReceivedFrame->RecvData` 中首次匹配位置的指针（即 `&RecvData[i]`）
  * @retval NULL        ① 参数非法；② 上一帧未释放（`LastFrameValid == Valid`）；③ 队列接收超时；④ `memmem` 未找到
  *
  * @warning
- *   - 返回的指针**仅在当前帧生命周期内有效**：一旦调用 `esp8266_DropLastFrame()` 或下一帧覆盖缓冲区，该地址失效；
- *   - 若需长期持有匹配内容，请立即 `memcpy` 到自有缓冲区；
- *   - 不检查 `expected` 是否在合法内存区域 —— 若传入非法地址，`memmem()` 将触发 HardFault；
- *   - 本函数不修改 `LastReceivedFrame.Data_Len` 或 `RecvData[]` 内容，仅读取。
+ *   - 返回的指针**仅在当前响应生命周期内有效**：一旦调用 `esp8266_DropLastFrame()`，该地址失效；
+ *   - 若需跨越 `esp8266_DropLastFrame()` 继续使用，请以 `esp8266_RetainLastFrame()` 借用响应视图；
+ *   - 不检查 `expected` 是否在合法内存区域 —— 若传入非法地址，`memmem()` 将触发 HardFault。
  *
  */
 void *esp8266_WaitResponse( const char* expected, uint32_t timeout_ms )
 {
+  return esp8266_WaitResponseEx(expected, NULL, timeout_ms, NULL);
+}
+
+
+
+
+/**
+ * @brief 同 `esp8266_WaitResponse()`，但同时识别失败结束标志（如 "ERROR"、"FAIL"）
+ *
+ * 命令以失败结束时无需空等到超时：累积的响应行中先出现 `failed` 即返回，并置 `*pFailed = true`。
+ *
+ * @param[in]  expected   成功结束标志
+ * @param[in]  failed     失败结束标志（可为 NULL，此时与 `esp8266_WaitResponse()` 等价）
+ * @param[in]  timeout_ms 总等待超时时间（毫秒）
+ * @param[out] pFailed    命中的是否为失败标志（可为 NULL）
+ *
+ * @retval non-NULL 指向 `LastReceivedFrame->RecvData` 中命中位置的指针（响应被持有，须 `esp8266_DropLastFrame()`）
+ * @retval NULL     参数非法、上一帧未释放或超时
+ */
+void *esp8266_WaitResponseEx( const char* expected, const char *failed, uint32_t timeout_ms, bool *pFailed )
+{
+  if ( pFailed != NULL )
+  {
+    *pFailed = false;
+  }
+
   if ( expected == NULL || strlen(expected) == 0 )
   {
     #if defined(__DEBUG_LEVEL_1__)
@@ -660,22 +1036,68 @@ void *esp8266_WaitResponse( const char* expected, uint32_t timeout_ms )
   }
 
   uint16_t hayNeed_len = strlen(expected);
+  uint16_t failed_len = ( failed != NULL ) ? strlen(failed) : 0;
+
+  // 结束标志在表中时直接查询自动机的命中结果，否则回退到 memmem().
+  int8_t expected_tok = esp_matcher_ready ? at_matcher_Find(&esp_matcher, expected) : -1;
+  int8_t failed_tok = ( esp_matcher_ready && failed_len > 0 ) ? at_matcher_Find(&esp_matcher, failed) : -1;
 
+  // 期望标志不是命令的最终结果(如 "+CIPSTA:")时进入累积模式: 命中后继续收集后续帧，直至最终结果到达，
+  // 以免同一响应的剩余行(被 IDLE 切分到后续帧)因响应已被持有而丢失.
+  bool accumulate = esp_matcher_ready && ( expected_tok < 0 || ( ( 1UL << expected_tok ) & ESP_TOK_FINAL_MASK ) == 0 );
+  bool seen = false;
+
+  TickType_t xStart = xTaskGetTickCount();
   TickType_t xTicksToWait = pdMS_TO_TICKS(timeout_ms);
 
-  while( xTicksToWait > 0 )
+  if ( xSemaphoreTakeRecursive(xMutexEsp, 200) != pdPASS )
+  {
+    return NULL;
+  }
+
+  // 丢弃等待开始前零散到达、未被任何等待方认领的响应行.
+  esp8266_ReleaseResponse();
+
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  for( ; ; )
   {
-    BaseType_t err = xSemaphoreTakeRecursive(xMutexEsp, 200);
+    TickType_t xElapsed = xTaskGetTickCount() - xStart;
 
-    if ( err != pdPASS )
+    if ( xElapsed >= xTicksToWait )
+    {
+      break;
+    }
+
+    if ( xSemaphoreTakeRecursive(xMutexEsp, 200) != pdPASS )
+    {
       return NULL;
+    }
 
-    if ( xQueueReceive(hesp8266.xRecvQueue, &hesp8266.LastReceivedFrame, xTicksToWait) == pdTRUE )
+    EspRxFrame_t *pFrame = NULL;
+
+    // 每次只等待剩余时间，保证总时长不超过 timeout_ms.
+    if ( xQueueReceive(hesp8266.xRecvQueue, &pFrame, xTicksToWait - xElapsed) != pdTRUE )
     {
+      // 队列接收超时.
+      #if defined(__DEBUG_LEVEL_1__)
+        printf("Queue Recv Timeout!\n");
+      #endif 
+
+      xSemaphoreGiveRecursive(xMutexEsp);
+      break;
+    }
+
+    // 分流后仅命令响应行记入 LastReceivedFrame.
+    esp8266_ProcessFrame(pFrame);
 
-      void *pSearch = memmem(hesp8266.LastReceivedFrame.RecvData, hesp8266.LastReceivedFrame.Data_Len, expected, hayNeed_len);
+    void *pSearch = esp8266_MatchToken(expected_tok, expected, hayNeed_len);
 
-      if ( pSearch != NULL )
+    if ( pSearch != NULL )
+    {
+      seen = true;
+
+      if ( !accumulate || ( esp_match_ctx.hits & ESP_TOK_FINAL_MASK ) )
       {
         // 成功找到相关子串.
         hesp8266.LastFrameValid = LastRecvFrame_Valid;
@@ -684,21 +1106,47 @@ void *esp8266_WaitResponse( const char* expected, uint32_t timeout_ms )
 
         return pSearch;
       }
-      else 
+    }
+    else if ( failed_len > 0 && ( pSearch = esp8266_MatchToken(failed_tok, failed, failed_len) ) != NULL )
+    {
+      if ( pFailed != NULL )
       {
-        // 没找到，继续等待下一帧数据.
-        continue;
+        *pFailed = true;
       }
+
+      hesp8266.LastFrameValid = LastRecvFrame_Valid;
+
+      xSemaphoreGiveRecursive(xMutexEsp);
+
+      return pSearch;
     }
-    else 
+    else if ( esp_match_ctx.hits & ESP_TOK_FAIL_MASK )
     {
-      // 队列接收超时.
-      #if defined(__DEBUG_LEVEL_1__)
-        printf("Queue Recv Timeout!\n");
-      #endif 
+      // ERROR / FAIL / busy: 命令已结束，不再等待至超时. 响应不被持有，内容仍可供调用者检查.
+      if ( pFailed != NULL )
+      {
+        *pFailed = true;
+      }
 
-      break;
+      xSemaphoreGiveRecursive(xMutexEsp);
+
+      return NULL;
     }
+
+    // 没找到(或累积模式下尚未收到最终结果)，继续等待下一帧数据.
+    xSemaphoreGiveRecursive(xMutexEsp);
+  }
+
+  if ( seen && xSemaphoreTakeRecursive(xMutexEsp, 200) == pdPASS )
+  {
+    // 期望内容已收到，仅最终结果未在时限内到达: 按成功返回已累积的响应.
+    void *pSearch = esp8266_MatchToken(expected_tok, expected, hayNeed_len);
+
+    hesp8266.LastFrameValid = LastRecvFrame_Valid;
+
+    xSemaphoreGiveRecursive(xMutexEsp);
+
+    return ( pSearch != NULL ) ? pSearch : hesp8266.LastReceivedFrame->RecvData;
   }
 
   // 等待超时.
@@ -706,8 +1154,6 @@ void *esp8266_WaitResponse( const char* expected, uint32_t timeout_ms )
     printf("WaitResponse Timeout!\n");
   #endif // __DEBUG_LEVEL_1__
 
-  xSemaphoreGiveRecursive(xMutexEsp);
-
   return NULL;
 }
 
@@ -715,86 +1161,1419 @@ void *esp8266_WaitResponse( const char* expected, uint32_t timeout_ms )
 
 
 /**
- * @brief 初始化 ESP8266 专用 UART4 外设（含 DMA 接收与中断协同机制）
- *
- * 配置 UART4 为 ESP8266 通信通道，采用 **HAL_UARTEx_ReceiveToIdle_DMA** 模式实现高效、低功耗的帧接收：
- * - 利用 UART IDLE 线空闲中断检测一帧数据结束（替代固定长度超时），天然适配变长 AT 响应；
- * - DMA 自动将接收到的数据流写入 `recv_temp[]` 缓冲区，无需 CPU 干预；
- * - 启用 `UART_IT_IDLE` 和 `UART_IT_TC` 中断，分别用于帧结束识别和发送完成通知；
- * - 配置 DMA1_Stream4 服务 UART4_RX，并设置合理中断优先级（DMA: 6 > UART: 5），避免接收丢失。
+ * @brief 等待 URC / 接收事件（如 "WIFI GOT IP"、"CLOSED"、+IPD 负载接收完整）
  *
- * @note
- *   - `HAL_UARTEx_ReceiveToIdle_DMA()` 要求：DMA 缓冲区必须足够容纳单帧最大长度（`RECV_DATA_BUFFER`），
- *     且在 IDLE 中断触发后，需由 `UART4_IRQHandler` 调用 `HAL_UARTEx_ReceiveToIdle_IT()` 重启下一次接收；
- *   - `__HAL_UART_CLEAR_FLAG(&huart, UART_FLAG_TC)` 在初始化末尾显式清除 TC 标志，防止后续首次发送时误触发 TC 中断；
- *   - 所有外设时钟（UART4、DMA1）均通过 `__HAL_RCC_*_CLK_ENABLE()` 显式开启，符合 STM32CubeMX 最佳实践；
- *   - 初始化成功后打印 `"ESP8266 USART Init OK"`（仅 DEBUG_LEVEL_1+），便于产线快速验证；
- *   - 失败时返回 `false`，上层（如 `vtask8266_Init()`）应执行错误恢复（如复位模块或重试）。
+ * 先检查已记录的事件位，未命中时继续从接收队列取帧并驱动分流器，直至 `mask` 中任一事件发生或超时。
+ * 命中的事件位被取走（清除），未命中的事件位保持不变。
  *
- * @retval true  UART4 及关联 DMA/中断成功初始化，可立即用于 `esp8266_SendAT()` 和 AT 响应解析
- * @retval false 初始化失败：HAL_UART_Init() 或 HAL_UARTEx_ReceiveToIdle_DMA() 返回 `HAL_ERROR`/`HAL_BUSY`
+ * @param[in] mask        关注的事件位（ESP_EVT_* 的组合）
+ * @param[in] timeout_ms  超时时间（毫秒）
  *
- * @warning
- *   - **必须确保 `recv_temp[]` 缓冲区生命周期全局有效且未被其他任务修改** —— DMA 直接访问该地址；
- *   - `UART4_IRQn` 和 `DMA1_Stream4_IRQn` 的中断服务函数（ISR）**必须已正确实现**：
- *       • `UART4_IRQHandler` 中需调用 `HAL_UART_IRQHandler()` → 触发 `HAL_UARTEx_RxEventCallback()`；
- *       • `DMA1_Stream4_IRQHandler` 中需调用 `HAL_DMA_IRQHandler()` → 完成传输处理；
- *   - 若 `RECV_DATA_BUFFER` 小于 ESP8266 单次响应长度（如大 JSON 或固件升级包），将导致 DMA 溢出 —— 此函数不校验缓冲区是否足够；
- *   - 本函数**不启动 UART 发送 DMA**，发送始终使用 `HAL_UART_Transmit_DMA()` 按需触发（见 `esp8266_SendAT()`）。
+ * @retval 非 0  实际发生（并已清除）的事件位
+ * @retval 0     超时或互斥量获取失败
  *
- * @see esp8266_SendAT(), HAL_UARTEx_ReceiveToIdle_DMA(), UART4_IRQHandler(), DMA1_Stream4_IRQHandler()
+ * @note 等待期间到达的命令响应行同样记入 `LastReceivedFrame`（若其未被持有）。
+ */
+uint32_t esp8266_WaitEvent( uint32_t mask, uint32_t timeout_ms )
+{
+  TickType_t xStart = xTaskGetTickCount();
+  TickType_t xTicksToWait = pdMS_TO_TICKS(timeout_ms);
+
+  for( ; ; )
+  {
+    if ( xSemaphoreTakeRecursive(xMutexEsp, 200) != pdPASS )
+    {
+      return 0;
+    }
+
+    uint32_t hit = hesp8266.UrcEvents & mask;
+
+    if ( hit != 0 )
+    {
+      hesp8266.UrcEvents &= ~hit;
+
+      xSemaphoreGiveRecursive(xMutexEsp);
+
+      return hit;
+    }
+
+    TickType_t xElapsed = xTaskGetTickCount() - xStart;
+
+    if ( xElapsed >= xTicksToWait )
+    {
+      xSemaphoreGiveRecursive(xMutexEsp);
+
+      break;
+    }
+
+    EspRxFrame_t *pFrame = NULL;
+
+    if ( xQueueReceive(hesp8266.xRecvQueue, &pFrame, xTicksToWait - xElapsed) == pdTRUE )
+    {
+      esp8266_ProcessFrame(pFrame);
+    }
+
+    xSemaphoreGiveRecursive(xMutexEsp);
+  }
+
+  #if defined(__DEBUG_LEVEL_1__)
+    printf("WaitEvent Timeout!\n");
+  #endif // __DEBUG_LEVEL_1__
+
+  return 0;
+}
+
+
+
+
+/**
+ * @brief 不阻塞地处理接收队列中已积压的帧，并取走 `mask` 中已发生的事件位
+ *
+ * 用于空闲期间到达的 URC（如对端关闭空闲连接时的 "CLOSED"）：无任务等待时这些帧只在队列中排队，
+ * 复用连接之前先调用本函数，使连接状态与模块一致。
+ *
+ * @retval 非 0  已发生（并已清除）的事件位
+ * @retval 0     无事件或互斥量获取失败
+ */
+uint32_t esp8266_PollEvent( uint32_t mask )
+{
+  if ( xSemaphoreTakeRecursive(xMutexEsp, 200) != pdPASS )
+  {
+    return 0;
+  }
+
+  EspRxFrame_t *pFrame = NULL;
+
+  while( xQueueReceive(hesp8266.xRecvQueue, &pFrame, 0) == pdTRUE )
+  {
+    esp8266_ProcessFrame(pFrame);
+  }
+
+  uint32_t hit = hesp8266.UrcEvents & mask;
+
+  hesp8266.UrcEvents &= ~hit;
+
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  return hit;
+}
+
+
+
+
+/**
+ * @brief 被动接收模式下单次读取可安全接收的字节数（接收通路的信用额度）
+ *
+ * `AT+CIPRECVDATA` 的响应以整段突发到达，须同时满足：
+ *   - 接收环：尚未被分流器处理的字节加上本次响应不超过一圈（预留 `ESP_RECV_PULL_MARGIN`），否则未处理的帧会被 DMA 覆盖；
+ *   - 帧池：按最大帧长折算的空闲句柄数（预留一个给响应尾部的 "OK"），否则数据滞留至句柄归还；
+ *   - 固件单次读取上限 `ESP_RECV_PULL_MAX`。
+ *
+ * @return 可读取的字节数（0 表示消费方尚未跟上，应稍后再读）
+ */
+uint16_t esp8266_RxCredit( void )
+{
+  EspFramePoolStats_t pool;
+
+  esp_frame_GetPoolStats(&pool);
+
+  uint32_t in_flight = esp8266_RxRing_StreamPos() - rx_stream_done;
+  uint32_t credit = ESP_RECV_PULL_MAX;
+
+  if ( (int32_t)in_flight < 0 )
+  {
+    in_flight = 0;  // 接收环刚重启，字节流位置已对齐.
+  }
+
+  uint32_t ring_free = ( in_flight + ESP_RECV_PULL_MARGIN < ESP_RX_RING_SIZE ) ? ( ESP_RX_RING_SIZE - ESP_RECV_PULL_MARGIN - in_flight ) : 0;
+  uint16_t free_frames = (uint16_t)( pool.Capacity - pool.InUse );
+  uint32_t pool_free = ( free_frames > 1 ) ? (uint32_t)( free_frames - 1 ) * RECV_DATA_BUFFER : 0;
+
+  if ( ring_free < credit )
+  {
+    credit = ring_free;
+  }
+
+  if ( pool_free < credit )
+  {
+    credit = pool_free;
+  }
+
+  return (uint16_t)credit;
+}
+
+
+
+
+/**
+ * @brief 被动接收模式（`AT+CIPRECVMODE=1`）下从模块缓存读取一段数据
+ *
+ * 先处理已积压的帧以更新消费进度，再按 `min(max_len, esp8266_RxCredit())` 发送 `AT+CIPRECVDATA`；
+ * 响应中的数据经分流器按 `link_id` 交给已注册的负载消费方（与 +IPD 负载相同，remain 归零时置 `ESP_EVT_PAYLOAD_DONE`）。
+ * 实际返回少于请求长度即表示模块缓存已读空，清除该链路的 `RecvPending` 位。
+ *
+ * @param[in]  link_id    链路号（单连接模式传 `ESP_DEMUX_NO_LINK`）
+ * @param[in]  max_len    调用方本次最多接受的字节数（消费方自身的背压）
+ * @param[out] pActual    实际读取的字节数（额度为 0 时不发送命令，返回 true 且为 0）
+ * @param[in]  timeout_ms 等待 "OK" 的时限
+ *
+ * @retval true  读取完成（模块缓存为空时固件回复 ERROR，同样视为完成）
+ * @retval false 参数非法、互斥量获取失败、发送失败或超时
+ */
+bool esp8266_RecvPull( uint8_t link_id, uint16_t max_len, uint16_t *pActual, uint32_t timeout_ms )
+{
+  if ( pActual == NULL )
+  {
+    return false;
+  }
+
+  *pActual = 0;
+
+  if ( xSemaphoreTakeRecursive(xMutexEsp, portMAX_DELAY) != pdPASS )
+  {
+    return false;
+  }
+
+  EspRxFrame_t *pFrame = NULL;
+
+  while( xQueueReceive(hesp8266.xRecvQueue, &pFrame, 0) == pdTRUE )
+  {
+    esp8266_ProcessFrame(pFrame);
+  }
+
+  uint16_t credit = esp8266_RxCredit();
+  uint16_t len = ( max_len < credit ) ? max_len : credit;
+
+  if ( len == 0 )
+  {
+    xSemaphoreGiveRecursive(xMutexEsp);
+
+    return true;
+  }
+
+  char cmd[ESP_AT_CIPRECVDATA_MAX];
+  uint16_t cmd_len = esp_at_BuildCipRecvData(cmd, link_id, len);
+  bool failed = false;
+  bool ok = false;
+
+  if ( cmd_len == 0 )
+  {
+    xSemaphoreGiveRecursive(xMutexEsp);
+
+    return false;
+  }
+
+  esp_demux_ExpectRecv(&esp_demux, link_id);
+
+  if ( esp8266_SendRaw((const uint8_t *)cmd, cmd_len) )
+  {
+    ok = ( esp8266_WaitResponseEx("OK", "ERROR", timeout_ms, &failed) != NULL );
+
+    esp8266_DropLastFrame();
+  }
+
+  *pActual = (uint16_t)( ( esp_demux.recv_len < len ) ? esp_demux.recv_len : len );
+
+  if ( ok && ( failed || *pActual < len ) )
+  {
+    hesp8266.RecvPending &= (uint8_t)~ESP_RECV_PENDING_BIT(link_id);
+  }
+
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  if ( !ok )
+  {
+    LOG_WRITE(LOG_WARNING, "ESP", "CIPRECVDATA(%u) failed.", len);
+  }
+
+  return ok;
+}
+
+
+
+
+/**
+ * @brief 清除指定的事件位（在发起可能产生该事件的操作之前调用，避免读到陈旧事件）
+ *
+ * @param[in] mask 待清除的事件位（ESP_EVT_* 的组合）
+ */
+void esp8266_ClearEvent( uint32_t mask )
+{
+  if ( xSemaphoreTakeRecursive(xMutexEsp, portMAX_DELAY) == pdPASS )
+  {
+    hesp8266.UrcEvents &= ~mask;
+
+    xSemaphoreGiveRecursive(xMutexEsp);
+  }
+}
+
+
+
+
+/**
+ * @brief 注册 +IPD 负载消费方
+ *
+ * 负载数据由分流器直接从接收环投递给 `sink`（零拷贝），回调在取帧任务上下文中同步执行，且持有 `xMutexEsp`，
+ * 回调内不得阻塞。传入 NULL 注销，此后到达的负载被丢弃。
+ *
+ * @param[in] sink 负载回调（可为 NULL）
+ * @param[in] ctx  透传给回调的上下文指针
+ */
+void esp8266_SetPayloadSink( esp_payload_sink_t sink, void *ctx )
+{
+  if ( xSemaphoreTakeRecursive(xMutexEsp, portMAX_DELAY) == pdPASS )
+  {
+    hesp8266.PayloadSink = sink;
+    hesp8266.PayloadCtx = ctx;
+
+    xSemaphoreGiveRecursive(xMutexEsp);
+  }
+}
+
+
+
+
+/**
+ * @brief 注册 URC 消费方（可选，事件位与 `hesp8266.Status` 的更新不依赖该回调）
+ *
+ * @param[in] cb  URC 回调（可为 NULL）
+ * @param[in] ctx 透传给回调的上下文指针
+ */
+void esp8266_SetUrcCallback( esp_urc_cb_t cb, void *ctx )
+{
+  if ( xSemaphoreTakeRecursive(xMutexEsp, portMAX_DELAY) == pdPASS )
+  {
+    hesp8266.UrcCallback = cb;
+    hesp8266.UrcCtx = ctx;
+
+    xSemaphoreGiveRecursive(xMutexEsp);
+  }
+}
+
+
+
+
+/**
+ * @brief 切换接收分流器的透传模式
+ *
+ * 透传模式（`AT+CIPMODE=1` 且已进入 `AT+CIPSEND` 数据态）下模块不再输出 `+IPD` 封装与响应行，
+ * 全部接收字节直接交给已注册的负载消费方。退出透传后必须调用本函数恢复按行解析。
+ *
+ * @param[in] enable true 进入透传，false 退出透传
+ */
+void esp8266_SetRawMode( bool enable )
+{
+  if ( xSemaphoreTakeRecursive(xMutexEsp, portMAX_DELAY) == pdPASS )
+  {
+    esp_demux_SetRaw(&esp_demux, enable);
+
+    xSemaphoreGiveRecursive(xMutexEsp);
+  }
+}
+
+
+
+
+// 映射并分流一帧，随后归还帧句柄. 调用者须持有 xMutexEsp.
+static void esp8266_ProcessFrame( EspRxFrame_t *pFrame )
+{
+  if ( esp8266_RxRing_MapFrame(pFrame) )
+  {
+    esp_demux_Feed(&esp_demux, pFrame->RecvData, pFrame->Data_Len, pFrame->StreamPos);
+  }
+  else 
+  {
+    // 帧已被 DMA 覆盖(消费过慢)，字节流出现缺口，丢弃分流器中的半行/半负载.
+    esp_demux_Reset(&esp_demux);
+  }
+
+  rx_stream_done = pFrame->StreamPos + pFrame->Data_Len;
+
+  esp_frame_Release(pFrame);
+}
+
+
+
+
+// 命令响应行: 记入响应视图 LastReceivedFrame(接收环上的一段字节流，行原样留在环内，不拷贝).
+// 仅当视图与该行之间夹有 URC / +IPD 负载(已被消费)，或视图跨越环尾时，才将该行移至视图末尾以保持视图连续.
+static void esp8266_OnResponse( void *ctx, const uint8_t *line, uint16_t len, uint32_t pos, uint16_t span )
+{
+  ESP8266_HandleTypeDef *hpesp8266 = (ESP8266_HandleTypeDef *)ctx;
+  EspRxFrame_t *pResp = hpesp8266->LastReceivedFrame;
+
+  if ( hpesp8266->LastFrameValid == LastRecvFrame_Valid )
+  {
+    // 当前响应仍被解析方持有，不得覆盖. 迟到的响应行只能丢弃，计入 ResponseDrops 以便排查.
+    taskENTER_CRITICAL();
+    rx_stats.ResponseDrops++;
+    taskEXIT_CRITICAL();
+
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Response line dropped (frame held): %.*s\n", (int)(len > 32 ? 32 : len), (const char *)line);
+    #endif // __DEBUG_LEVEL_1__
+
+    return;
+  }
+
+  // 视图已满，或 DMA 即将绕回视图起点: 仅保留最新行.
+  if ( pResp != NULL && pResp->Data_Len > 0
+        && ( pResp->Data_Len + span > ESP_RESP_VIEW_MAX
+              || esp8266_RxRing_StreamPos() - pResp->StreamPos > ESP_RX_RING_SIZE - RECV_DATA_BUFFER ) )
+  {
+    pResp->StreamPos = pos;
+    pResp->Data_Len = 0;
+
+    taskENTER_CRITICAL();
+    rx_stats.ResponseDrops++;
+    taskEXIT_CRITICAL();
+
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Response view full, earlier lines dropped.\n");
+    #endif // __DEBUG_LEVEL_1__
+
+    at_matcher_Reset(&esp_match_ctx);
+  }
+
+  if ( pResp == NULL )
+  {
+    pResp = esp_frame_Alloc(pos, 0);
+
+    if ( pResp == NULL )
+    {
+      taskENTER_CRITICAL();
+      rx_stats.ResponseDrops++;
+      taskEXIT_CRITICAL();
+
+      #if defined(__DEBUG_LEVEL_1__)
+        printf("No frame handle for response, line dropped.\n");
+      #endif // __DEBUG_LEVEL_1__
+
+      return;
+    }
+
+    hpesp8266->LastReceivedFrame = pResp;
+  }
+
+  uint32_t index = ( pResp->StreamPos & ESP_RX_RING_MASK ) + pResp->Data_Len;
+
+  esp8266_RxRing_CopyOut(index, pos, span);
+
+  pResp->RecvData = &esp_rx_ring[pResp->StreamPos & ESP_RX_RING_MASK];
+  pResp->Data_Len += span;
+
+  // 记入的同时单遍识别全部结束标志，等待方无需反复扫描整个响应.
+  if ( esp_matcher_ready )
+  {
+    at_matcher_Feed(&esp_matcher, &esp_match_ctx, &esp_rx_ring[index], span);
+  }
+}
+
+
+
+
+static void esp8266_OnPayload( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain )
+{
+  ESP8266_HandleTypeDef *hpesp8266 = (ESP8266_HandleTypeDef *)ctx;
+
+  if ( hpesp8266->PayloadSink != NULL )
+  {
+    hpesp8266->PayloadSink(hpesp8266->PayloadCtx, link_id, data, len, remain);
+  }
+  else 
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Drop %u bytes of +IPD payload.\n", len);
+    #endif // __DEBUG_LEVEL_1__
+  }
+
+  if ( remain == 0 )
+  {
+    hpesp8266->UrcEvents |= ESP_EVT_PAYLOAD_DONE;
+  }
+}
+
+
+
+
+static void esp8266_OnUrc( void *ctx, esp_urc_t urc, uint8_t link_id, const uint8_t *line, uint16_t len )
+{
+  ESP8266_HandleTypeDef *hpesp8266 = (ESP8266_HandleTypeDef *)ctx;
+
+  (void)line;
+  (void)len;
+
+  switch( urc )
+  {
+    case ESP_URC_READY:
+      hpesp8266->UrcEvents |= ESP_EVT_READY;
+      break;
+
+    case ESP_URC_WIFI_CONNECTED:
+      hpesp8266->Status = ESP_STATUS_CONNECTED_TO_AP;
+      hpesp8266->UrcEvents |= ESP_EVT_WIFI_CONNECTED;
+      break;
+
+    case ESP_URC_WIFI_GOT_IP:
+      hpesp8266->Status = ESP_STATUS_GOT_IP;
+      hpesp8266->UrcEvents |= ESP_EVT_WIFI_GOT_IP;
+      break;
+
+    case ESP_URC_WIFI_DISCONNECT:
+      hpesp8266->Status = ESP_STATUS_DISCONNECTED;
+      hpesp8266->UrcEvents |= ESP_EVT_WIFI_DISCONNECT;
+      break;
+
+    case ESP_URC_LINK_CONNECT:
+      hpesp8266->UrcEvents |= ESP_EVT_LINK_CONNECT;
+      break;
+
+    case ESP_URC_LINK_CLOSED:
+      hpesp8266->UrcEvents |= ESP_EVT_LINK_CLOSED;
+      break;
+
+    case ESP_URC_RECV_PENDING:
+      hpesp8266->RecvPending |= ESP_RECV_PENDING_BIT(link_id);
+      hpesp8266->UrcEvents |= ESP_EVT_RECV_PENDING;
+      break;
+
+    default:
+      return;
+  }
+
+  #if defined(__DEBUG_LEVEL_1__)
+    printf("URC %d (link %u).\n", (int)urc, link_id);
+  #endif // __DEBUG_LEVEL_1__
+
+  if ( hpesp8266->UrcCallback != NULL )
+  {
+    hpesp8266->UrcCallback(hpesp8266->UrcCtx, urc, link_id);
+  }
+}
+
+
+
+
+/**
+ * @brief 当前响应中是否出现了指定结束标志（自动机在响应行追加时已单遍识别，此处仅查询位图）
+ *
+ * 用于在 `esp8266_WaitResponse()` 返回后区分结果（如 "CONNECT" / "ERROR" / "FAIL"），无需再次扫描响应.
+ * 持有与释放规则同 `LastReceivedFrame`，调用 `esp8266_DropLastFrame()` 后结果清空。
+ */
+bool esp8266_ResponseHas( EspToken_t tok )
+{
+  if ( tok >= ESP_TOK_NUM )
+  {
+    return false;
+  }
+
+  if ( !esp_matcher_ready )
+  {
+    const EspRxFrame_t *pResp = hesp8266.LastReceivedFrame;
+
+    return ( pResp != NULL ) && memmem(pResp->RecvData, pResp->Data_Len, esp_tokens[tok], strlen(esp_tokens[tok])) != NULL;
+  }
+
+  return ( esp_match_ctx.hits & ( 1UL << tok ) ) != 0;
+}
+
+
+
+
+/**
+ * @brief 获取当前响应中已出现的全部结束标志（bit n 对应 EspToken_t n）
+ */
+uint32_t esp8266_ResponseTokens( void )
+{
+  return esp_match_ctx.hits;
+}
+
+
+
+
+// 在当前响应中定位结束标志: 表内标志查自动机结果，表外标志回退到 memmem(). 调用者须持有 xMutexEsp.
+static void *esp8266_MatchToken( int8_t tok, const char *token, uint16_t token_len )
+{
+  const EspRxFrame_t *pResp = hesp8266.LastReceivedFrame;
+
+  if ( pResp == NULL )
+  {
+    return NULL;
+  }
+
+  if ( tok >= 0 )
+  {
+    if ( ( esp_match_ctx.hits & ( 1UL << tok ) ) == 0 || esp_match_ctx.offset[tok] >= pResp->Data_Len )
+    {
+      return NULL;
+    }
+
+    return &pResp->RecvData[esp_match_ctx.offset[tok]];
+  }
+
+  return memmem(pResp->RecvData, pResp->Data_Len, token, token_len);
+}
+
+
+
+
+/**
+ * @brief 初始化 ESP8266 专用 UART4 外设（含 DMA 接收与中断协同机制）
+ *
+ * 配置 UART4 为 ESP8266 通信通道，采用 **HAL_UARTEx_ReceiveToIdle_DMA** 模式实现高效、低功耗的帧接收：
+ * - 利用 UART IDLE 线空闲中断检测一帧数据结束（替代固定长度超时），天然适配变长 AT 响应；
+ * - DMA1_Stream2 以循环模式将接收到的数据流持续写入接收环 `esp_rx_ring[]`，全程无需重启 DMA；
+ * - 中断仅发布 (StreamPos, Data_Len) 帧描述符，解析方直接在接收环上读取，不再逐帧拷贝；
+ * - 启用 `UART_IT_IDLE` 和 `UART_IT_TC` 中断，分别用于帧结束识别和发送完成通知；
+ * - 配置 DMA1_Stream4 服务 UART4_TX（优先级 6），DMA1_Stream2 服务 UART4_RX（与 UART4 同为 5）。
+ *
+ * @note
+ *   - 循环模式下 `HAL_UARTEx_ReceiveToIdle_DMA()` 仅在此处调用一次；HT/TC/IDLE 事件均进入
+ *     `HAL_UARTEx_RxEventCallback()`，由 `esp8266_RxRing_UpdateFromISR()` 统一记账并发布帧描述符；
+ *   - `__HAL_UART_CLEAR_FLAG(&huart, UART_FLAG_TC)` 在初始化末尾显式清除 TC 标志，防止后续首次发送时误触发 TC 中断；
+ *   - 所有外设时钟（UART4、DMA1）均通过 `__HAL_RCC_*_CLK_ENABLE()` 显式开启，符合 STM32CubeMX 最佳实践；
+ *   - 初始化成功后打印 `"ESP8266 USART Init OK"`（仅 DEBUG_LEVEL_1+），便于产线快速验证；
+ *   - 失败时返回 `false`，上层（如 `vtask8266_Init()`）应执行错误恢复（如复位模块或重试）。
+ *
+ * @retval true  UART4 及关联 DMA/中断成功初始化，可立即用于 `esp8266_SendAT()` 和 AT 响应解析
+ * @retval false 初始化失败：HAL_UART_Init() 或 HAL_UARTEx_ReceiveToIdle_DMA() 返回 `HAL_ERROR`/`HAL_BUSY`
+ *
+ * @warning
+ *   - **必须确保 `esp_rx_ring[]` 生命周期全局有效且除回绕展开区外不被其他任务修改** —— DMA 直接访问该地址；
+ *   - `UART4_IRQn` 和 `DMA1_Stream4_IRQn` 的中断服务函数（ISR）**必须已正确实现**：
+ *       • `UART4_IRQHandler` 中需调用 `HAL_UART_IRQHandler()` → 触发 `HAL_UARTEx_RxEventCallback()`；
+ *       • `DMA1_Stream4_IRQHandler` 中需调用 `HAL_DMA_IRQHandler()` → 完成传输处理；
+ *   - 超过 `RECV_DATA_BUFFER` 的连续数据会被切分为多帧发布；消费方若落后 DMA 超过一整圈（`ESP_RX_RING_SIZE`），对应帧将被判定失效；
+ *   - 本函数**不启动 UART 发送 DMA**，发送始终使用 `HAL_UART_Transmit_DMA()` 按需触发（见 `esp8266_SendAT()`）。
+ *
+ * @see esp8266_SendAT(), HAL_UARTEx_ReceiveToIdle_DMA(), UART4_IRQHandler(), DMA1_Stream4_IRQHandler()
  * @see HAL_UARTEx_RxEventCallback(), HAL_UART_TxCpltCallback()
  */
-bool UART4_Init( void )
+bool UART4_Init( void )
+{
+  __HAL_RCC_UART4_CLK_ENABLE();
+
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  esp8266_huart.Instance = ESP_UART;
+  // 热复位后模块通常仍运行在上次协商的速率上，优先沿用持久化速率.
+  EspUartCfg_t uart_cfg;
+
+  if ( bkp_store_Read(BKP_SLOT_ESP_UART, &uart_cfg, sizeof(uart_cfg)) )
+  {
+    esp8266_huart.Init.BaudRate = uart_cfg.BaudRate;
+  }
+  else 
+  {
+    esp8266_huart.Init.BaudRate = ESP_UART_BAUDRATE;
+  }
+
+  esp8266_huart.Init.Mode = ESP_UART_MODE;
+  esp8266_huart.Init.Parity = ESP_UART_PARITY;
+  esp8266_huart.Init.StopBits = ESP_UART_STOPBITS;
+  esp8266_huart.Init.WordLength = ESP_UART_WORDLENGTH;
+  esp8266_huart.Init.HwFlowCtl = ESP_UART_HwFLOW;
+
+  esp8266_DWT_Init();  // 用于统计 RxEvent 中断耗时.
+
+  if ( HAL_UART_Init(&esp8266_huart) != HAL_OK )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("UART Init Failed in esp8266_driver.c\n");
+    #endif // __DEBUG_LEVEL_1__
+
+    #if defined(__DEBUG_LEVEL_2__)
+      Debug_LED_Dis(DEBUG_INIT_FAILED, RTOS_VER);
+    #endif //__DEBUG_LEVEL_2__
+
+    return false;
+  }
+
+  // 循环模式下 DMA 只需启动一次，此后由 HT/TC/IDLE 事件推进接收环写位置.
+  if ( HAL_UARTEx_ReceiveToIdle_DMA(&esp8266_huart, esp_rx_ring, ESP_RX_RING_SIZE) != HAL_OK )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Failed to start ReceiveToIdle DMA!\n");
+    #endif
+
+    return false;
+  }
+
+  __HAL_UART_ENABLE_IT(&esp8266_huart, UART_IT_IDLE); // 显示使能IDLE中断.
+  __HAL_UART_ENABLE_IT(&esp8266_huart, UART_IT_TC);  // 发送完成中断.
+
+  __HAL_UART_CLEAR_FLAG(&esp8266_huart, UART_FLAG_TC);
+
+  HAL_NVIC_SetPriority(UART4_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(UART4_IRQn);
+
+  HAL_NVIC_SetPriority(DMA1_Stream4_IRQn, 6, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+
+  // RX DMA 与 UART4 同优先级，保证接收环记账不会被彼此抢占.
+  HAL_NVIC_SetPriority(DMA1_Stream2_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream2_IRQn);
+
+  printf("ESP8266 USART Init OK\n");
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 接收环记账（中断上下文），根据 DMA 当前写位置发布新的帧描述符
+ *
+ * 由 `HAL_UARTEx_RxEventCallback()` 在 HT / TC / IDLE 三类事件中调用：
+ *   - 写位置统一由 DMA 剩余计数 `NDTR` 推导，不依赖回调参数 `Size`，避免 TC 后紧随 IDLE 时的重复计数；
+ *   - 仅 IDLE 事件（一帧结束）才发布描述符；HT/TC 事件只推进写位置，除非未发布数据已达单帧上限
+ *     `RECV_DATA_BUFFER`，此时按上限切分发布，保证任意帧的回绕展开量不超过展开区大小；
+ *   - 每帧从帧池分配一个句柄（`esp_frame_AllocFromISR()`），队列中仅传递 4 字节指针；
+ *     帧池耗尽时暂停发布，数据保留在接收环中；句柄归还时帧池挂起 `ESP_FRAME_KICK_IRQn`，
+ *     由 `esp8266_RxRing_KickFromISR()` 续发（不依赖后续收到新数据）。
+ *
+ * @param[out] pxHigherPriorityTaskWoken 透传给 `xQueueSendFromISR()`，由调用者决定是否触发上下文切换
+ *
+ * @warning 仅可在 UART4 / DMA1_Stream2 中断上下文调用（二者同优先级，不会相互嵌套）。
+ */
+void esp8266_RxRing_UpdateFromISR( BaseType_t *pxHigherPriorityTaskWoken )
 {
-  __HAL_RCC_UART4_CLK_ENABLE();
+  uint32_t cyc_start = DWT->CYCCNT;
+
+  uint16_t pos = (uint16_t)( ( ESP_RX_RING_SIZE - __HAL_DMA_GET_COUNTER(esp8266_huart.hdmarx) ) & ESP_RX_RING_MASK );
+  uint16_t delta = (uint16_t)( ( pos - rx_dma_pos ) & ESP_RX_RING_MASK );
+
+  rx_dma_pos = pos;
+  rx_stream_head += delta;
+
+  bool is_idle = ( HAL_UARTEx_GetRxEventType(&esp8266_huart) == HAL_UART_RXEVENT_IDLE );
+
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  rx_stats.RxBytes += delta;
+
+  if ( delta > 0 )
+  {
+    rx_stats.LastRxTick = xTaskGetTickCountFromISR();
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if ( is_idle )
+  {
+    rx_idle_mark = rx_stream_head;
+  }
+
+  esp8266_RxRing_PublishFromISR(is_idle, pxHigherPriorityTaskWoken);
+
+  uint32_t cycles = DWT->CYCCNT - cyc_start;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  rx_stats.IsrCount++;
+  rx_stats_isr_cycles += cycles;
+
+  if ( cycles > rx_stats.IsrCyclesMax )
+  {
+    rx_stats.IsrCyclesMax = cycles;
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+
+
+
+// 将接收环中已结束的帧(及达到单帧上限的数据)发布为帧描述符. 仅在 UART4 / DMA1_Stream2 中断上下文调用.
+static void esp8266_RxRing_PublishFromISR( bool is_idle, BaseType_t *pxHigherPriorityTaskWoken )
+{
+  rx_publish_stalled = false;
+
+  while( hesp8266.xRecvQueue != NULL && rx_stream_head != rx_frame_start )
+  {
+    uint32_t pending = rx_stream_head - rx_frame_start;
+
+    // 最近一次 IDLE 之前的数据属于已结束的帧(帧池耗尽时滞留下来的)，可直接发布.
+    uint32_t ended = is_idle ? pending : ( ( (int32_t)( rx_idle_mark - rx_frame_start ) > 0 ) ? rx_idle_mark - rx_frame_start : 0 );
+
+    if ( ended == 0 && pending < RECV_DATA_BUFFER )
+    {
+      break;  // 帧尚未结束，等待后续事件.
+    }
+
+    uint32_t limit = ( ended > 0 ) ? ended : pending;
+    uint16_t frame_len = (uint16_t)( ( limit > RECV_DATA_BUFFER ) ? RECV_DATA_BUFFER : limit );
+
+    EspRxFrame_t *pFrame = esp_frame_AllocFromISR(rx_frame_start, frame_len);
+    if ( pFrame == NULL )
+    {
+      // 帧池耗尽: 数据仍留在接收环中，句柄归还时由 esp8266_RxRing_KickFromISR() 续发.
+      rx_stats.PoolExhausted++;
+      rx_publish_stalled = true;
+      break;
+    }
+
+    rx_frame_start += frame_len;
+
+    if ( xQueueSendFromISR(hesp8266.xRecvQueue, &pFrame, pxHigherPriorityTaskWoken) != pdTRUE )
+    {
+      esp_frame_ReleaseFromISR(pFrame);
+
+      rx_stats.QueueFullDrops++;
+
+      ISR_LOG(LOG_WARNING, "ESP", "Rx Queue Full! %lu bytes dropped.", frame_len, 0);
+    }
+    else 
+    {
+      rx_stats.RxFrames++;
+      rx_stats_frame_bytes += frame_len;
+
+      if ( frame_len > rx_stats.MaxFrameLen )
+      {
+        rx_stats.MaxFrameLen = frame_len;
+      }
+    }
+  }
+}
+
+
+
+
+/**
+ * @brief 帧池耗尽后续发滞留数据（中断上下文，由 `UART4_IRQHandler()` 调用）
+ *
+ * 帧句柄归还时帧池挂起 `ESP_FRAME_KICK_IRQn`（UART4），本函数在该中断中检查发布是否因帧池耗尽而暂停，
+ * 是则立即续发，避免响应末尾（"OK" / "SEND OK" / 最后一段 +IPD）滞留到下一次收到数据才被处理.
+ *
+ * @param[out] pxHigherPriorityTaskWoken 透传给 `xQueueSendFromISR()`
+ */
+void esp8266_RxRing_KickFromISR( BaseType_t *pxHigherPriorityTaskWoken )
+{
+  if ( rx_publish_stalled )
+  {
+    esp8266_RxRing_PublishFromISR(false, pxHigherPriorityTaskWoken);
+  }
+}
+
+
+
+
+/**
+ * @brief 记录 UART 接收错误（中断上下文，由 `UART4_IRQHandler()` 在清除错误标志前调用）
+ *
+ * @param[in] isrflags 进入中断时读取的 UART SR 寄存器值
+ */
+void esp8266_RxStats_ErrorFromISR( uint32_t isrflags )
+{
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  if ( isrflags & UART_FLAG_ORE )
+  {
+    rx_stats.OverrunErrors++;
+  }
+
+  if ( isrflags & UART_FLAG_FE )
+  {
+    rx_stats.FramingErrors++;
+  }
+
+  if ( isrflags & UART_FLAG_NE )
+  {
+    rx_stats.NoiseErrors++;
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+
+
+
+/**
+ * @brief 获取接收通路统计快照
+ *
+ * 用于区分一次失败的请求究竟来自 UART 溢出（`OverrunErrors`）、队列/帧池饱和（`QueueFullDrops` / `PoolExhausted`）、
+ * 解析过慢（`OverwrittenFrames`）还是模块静默（`LastRxTick` 长时间不变），并据此调整缓冲区尺寸。
+ *
+ * @param[out] pStats 输出统计信息（平均值在此处计算）
+ */
+void esp8266_GetRxStats( EspRxStats_t *pStats )
+{
+  if ( pStats == NULL )
+  {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+
+  *pStats = rx_stats;
+
+  pStats->MeanFrameLen = ( rx_stats.RxFrames > 0 ) ? (uint16_t)( rx_stats_frame_bytes / rx_stats.RxFrames ) : 0;
+  pStats->IsrCyclesMean = ( rx_stats.IsrCount > 0 ) ? (uint32_t)( rx_stats_isr_cycles / rx_stats.IsrCount ) : 0;
+
+  taskEXIT_CRITICAL();
+}
+
+
+
+
+/**
+ * @brief 清零接收通路统计
+ */
+void esp8266_ResetRxStats( void )
+{
+  taskENTER_CRITICAL();
+
+  memset(&rx_stats, 0, sizeof(rx_stats));
+  rx_stats_frame_bytes = 0;
+  rx_stats_isr_cycles = 0;
+
+  taskEXIT_CRITICAL();
+}
+
+
+
+
+/**
+ * @brief 重新启动接收环（用于 HAL 因错误中止了 DMA 接收之后）
+ *
+ * 重启后 DMA 从环下标 0 开始写入，因此将字节流位置向上对齐到 `ESP_RX_RING_SIZE` 的整数倍，
+ * 以保持 “StreamPos & ESP_RX_RING_MASK == 环下标” 的映射关系；尚未发布的残余数据被丢弃。
+ *
+ * @note 可在中断上下文调用（由 `HAL_UART_ErrorCallback()` 触发）。
+ */
+void esp8266_RxRing_Restart( void )
+{
+  HAL_UART_AbortReceive(&esp8266_huart);
+
+  // 任务上下文调用时(如 esp8266_UART_SetBaudRate())，须防止 UART4 / 帧池恢复中断读到半更新的位置与统计.
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  rx_stream_head = ( rx_stream_head + ESP_RX_RING_MASK ) & ~(uint32_t)ESP_RX_RING_MASK;
+  rx_frame_start = rx_stream_head;
+  rx_stream_done = rx_stream_head;
+  rx_dma_pos = 0;
+  rx_idle_mark = rx_stream_head;
+  rx_publish_stalled = false;
+
+  rx_stats.DmaRestarts++;
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if ( HAL_UARTEx_ReceiveToIdle_DMA(&esp8266_huart, esp_rx_ring, ESP_RX_RING_SIZE) != HAL_OK )
+  {
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    rx_stats.DmaRestartFails++;
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+    ISR_LOG(LOG_ERROR, "ESP", "Failed to restart RxDMA! RxState=%lu", esp8266_huart.RxState, 0);
+  }
+}
+
+
+
+
+/**
+ * @brief 获取 DMA 实时写位置对应的字节流绝对位置（包含尚未被中断记账的字节）
+ *
+ * @retval 自接收启动以来 DMA 写入的累计字节数
+ */
+uint32_t esp8266_RxRing_StreamPos( void )
+{
+  taskENTER_CRITICAL();
+
+  uint16_t pos = (uint16_t)( ( ESP_RX_RING_SIZE - __HAL_DMA_GET_COUNTER(esp8266_huart.hdmarx) ) & ESP_RX_RING_MASK );
+  uint32_t stream_pos = rx_stream_head + ( ( pos - rx_dma_pos ) & ESP_RX_RING_MASK );
+
+  taskEXIT_CRITICAL();
+
+  return stream_pos;
+}
+
+
+
+
+/**
+ * @brief 将帧句柄映射为接收环上的连续帧视图（任务上下文）
+ *
+ * 帧未跨越环尾时直接指向环内数据（零拷贝）；跨越环尾时仅把回绕到环首的那部分字节复制到
+ * 环尾之后的展开区，使视图在内存中保持连续，供 `memmem()` / `at_get_*()` 等线性解析函数直接使用。
+ *
+ * @param[in,out] pFrame 中断发布的帧句柄，成功后 `RecvData` 指向连续帧数据
+ *
+ * @retval true  映射成功
+ * @retval false 帧数据已被 DMA 覆盖（消费方落后超过一整圈）
+ */
+static bool esp8266_RxRing_MapFrame( EspRxFrame_t *pFrame )
+{
+  uint32_t index = pFrame->StreamPos & ESP_RX_RING_MASK;
+
+  if ( ( esp8266_RxRing_StreamPos() - pFrame->StreamPos ) > ESP_RX_RING_SIZE )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Rx frame overwritten before parse!\n");
+    #endif // __DEBUG_LEVEL_1__
+
+    taskENTER_CRITICAL();
+    rx_stats.OverwrittenFrames++;
+    taskEXIT_CRITICAL();
+
+    return false;
+  }
+
+  if ( index + pFrame->Data_Len > ESP_RX_RING_SIZE )
+  {
+    memcpy(&esp_rx_ring[ESP_RX_RING_SIZE], esp_rx_ring, index + pFrame->Data_Len - ESP_RX_RING_SIZE);
+  }
+
+  pFrame->RecvData = &esp_rx_ring[index];
+
+  return true;
+}
+
+
+
+
+// 将字节流 [stream_pos, stream_pos + len) 放到接收环下标 index 处(index 可落入回绕展开区).
+// 数据已在该位置(视图与行在环内连续)时不做任何拷贝；目标位于源之前(移走夹在中间的已消费字节)时按 memmove 处理.
+static void esp8266_RxRing_CopyOut( uint32_t index, uint32_t stream_pos, uint16_t len )
+{
+  while( len > 0 )
+  {
+    uint32_t src = stream_pos & ESP_RX_RING_MASK;
+    uint16_t n = (uint16_t)( ( len < ESP_RX_RING_SIZE - src ) ? len : ESP_RX_RING_SIZE - src );
+
+    if ( index != src )
+    {
+      memmove(&esp_rx_ring[index], &esp_rx_ring[src], n);
+    }
+
+    index += n;
+    stream_pos += n;
+    len -= n;
+  }
+}
+
+
+
+
+/**
+ * @brief 切换 MCU 侧 UART4 波特率（模块侧须已通过 AT+UART_CUR 切换）
+ *
+ * 中止接收后以新速率重新初始化 UART，重启接收环并清空接收队列，旧速率下残留的数据被丢弃。
+ *
+ * @param[in] baud 新波特率
+ *
+ * @retval true  切换成功
+ * @retval false HAL_UART_Init() 失败或互斥量获取失败
+ *
+ * @note 调用前须确保没有正在进行的发送（`esp8266_SendAT()` 返回时发送已完成）。
+ */
+bool esp8266_UART_SetBaudRate( uint32_t baud )
+{
+  if ( xSemaphoreTakeRecursive(xMutexEsp, portMAX_DELAY) != pdPASS )
+  {
+    return false;
+  }
+
+  HAL_UART_AbortReceive(&esp8266_huart);
+
+  esp8266_huart.Init.BaudRate = baud;
+
+  HAL_StatusTypeDef status = HAL_UART_Init(&esp8266_huart);
+
+  esp8266_RxRing_Restart();
+
+  __HAL_UART_ENABLE_IT(&esp8266_huart, UART_IT_TC);
+  __HAL_UART_CLEAR_FLAG(&esp8266_huart, UART_FLAG_TC);
 
-  __HAL_RCC_DMA1_CLK_ENABLE();
+  esp8266_ClearRecvQueue_Manual();
 
-  esp8266_huart.Instance = ESP_UART;
-  esp8266_huart.Init.BaudRate = ESP_UART_BAUDRATE;
-  esp8266_huart.Init.Mode = ESP_UART_MODE;
-  esp8266_huart.Init.Parity = ESP_UART_PARITY;
-  esp8266_huart.Init.StopBits = ESP_UART_STOPBITS;
-  esp8266_huart.Init.WordLength = ESP_UART_WORDLENGTH;
-  esp8266_huart.Init.HwFlowCtl = ESP_UART_HwFLOW;
+  xSemaphoreGiveRecursive(xMutexEsp);
 
-  if ( HAL_UART_Init(&esp8266_huart) != HAL_OK )
+  if ( status != HAL_OK )
   {
     #if defined(__DEBUG_LEVEL_1__)
-      printf("UART Init Failed in esp8266_driver.c\n");
+      printf("UART ReInit Failed at %lu baud.\n", (unsigned long)baud);
     #endif // __DEBUG_LEVEL_1__
 
-    #if defined(__DEBUG_LEVEL_2__)
-      Debug_LED_Dis(DEBUG_INIT_FAILED, RTOS_VER);
-    #endif //__DEBUG_LEVEL_2__
+    return false;
+  }
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 协商 ESP8266 UART 链路速率（初始化状态机 INIT_STATE_SET_BAUD）
+ *
+ * 依次尝试持久化速率与 `ESP_UART_BAUD_CANDIDATES` 中高于当前速率的候选值：
+ *   1. 以当前速率发送 `AT+UART_CUR=<baud>,8,1,0,<flow>`（不写入模块 Flash，模块断电后回到默认速率），等待 "OK"；
+ *   2. MCU 侧切换到新速率，连续 `ESP_UART_BAUD_ECHO_ROUNDS` 次 "AT" 回显测试，且期间不得出现 FE/NE 错误；
+ *   3. 测试失败则盲发切回原速率的命令并回到原速率，继续尝试下一候选。
+ * 成功的速率写入备份 SRAM（`BKP_SLOT_ESP_UART`），下次启动由 `UART4_Init()` 直接沿用。
+ *
+ * @retval true  链路可用（已提升速率，或全部失败后仍停留在原速率）
+ * @retval false 回落后链路仍不可用，需要重新探测
+ *
+ * @note RTS/CTS 受 `ESP_UART_FLOWCTRL_ENABLE` 控制，当前 UART4 接线不支持硬件流控.
+ */
+bool esp8266_NegotiateBaudRate( void )
+{
+  static const uint32_t candidates[] = ESP_UART_BAUD_CANDIDATES;
+  uint32_t origin = esp8266_huart.Init.BaudRate;
+  EspUartCfg_t cfg;
+
+  bool has_saved = bkp_store_Read(BKP_SLOT_ESP_UART, &cfg, sizeof(cfg));
+
+  if ( has_saved && cfg.BaudRate == origin && origin != ESP_UART_BAUDRATE )
+  {
+    return true;  // 已沿用持久化速率(热复位)，无需重新协商.
+  }
 
+  for ( int8_t i = -1; i < (int8_t)( sizeof(candidates) / sizeof(candidates[0]) ); i++ )
+  {
+    uint32_t baud = ( i < 0 ) ? ( has_saved ? cfg.BaudRate : 0 ) : candidates[i];
+
+    if ( baud <= origin || ( i >= 0 && has_saved && baud == cfg.BaudRate ) )
+    {
+      continue;
+    }
+
+    if ( esp8266_TryBaudRate(baud, origin) )
+    {
+      cfg.BaudRate = baud;
+      cfg.FlowCtl = ESP_UART_FLOWCTRL_ENABLE;
+      memset(cfg.pad, 0, sizeof(cfg.pad));
+
+      bkp_store_Write(BKP_SLOT_ESP_UART, &cfg, sizeof(cfg));
+
+      LOG_WRITE(LOG_INFO, "ESP", "UART baud %lu.", (unsigned long)baud);
+
+      return true;
+    }
+
+    if ( !esp8266_BaudEchoTest() )
+    {
+      bkp_store_Invalidate(BKP_SLOT_ESP_UART);
+
+      LOG_WRITE(LOG_ERROR, "ESP", "Link lost after baud %lu.", (unsigned long)baud);
+
+      return false;
+    }
+  }
+
+  // 无可用的更高速率，保持原速率.
+  bkp_store_Invalidate(BKP_SLOT_ESP_UART);
+
+  return true;
+}
+
+
+
+
+// 尝试切换到指定速率. 失败时恢复至原速率(链路是否可用由调用者确认).
+static bool esp8266_TryBaudRate( uint32_t baud, uint32_t origin )
+{
+  if ( !esp8266_SendAT("AT+UART_CUR=%lu,8,1,0,%u", (unsigned long)baud, ESP_UART_FLOWCTRL_ENABLE ? 3U : 0U) )
+  {
     return false;
   }
 
-  if ( HAL_UARTEx_ReceiveToIdle_DMA(&esp8266_huart, recv_temp, RECV_DATA_BUFFER) != HAL_OK )
+  if ( esp8266_WaitResponse("OK", 250) == NULL )
   {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("Failed to start ReceiveToIdle DMA!\n");
-    #endif
+    return false;  // 模块拒绝(固件不支持该速率)，仍处于原速率.
+  }
+
+  esp8266_DropLastFrame();
 
+  vTaskDelay(pdMS_TO_TICKS(ESP_UART_BAUD_SETTLE_MS));
+
+  if ( esp8266_UART_SetBaudRate(baud) && esp8266_BaudEchoTest() )
+  {
+    return true;
+  }
+
+  #if defined(__DEBUG_LEVEL_1__)
+    printf("Baud %lu unstable, fall back to %lu.\n", (unsigned long)baud, (unsigned long)origin);
+  #endif // __DEBUG_LEVEL_1__
+
+  // 模块可能已处于新速率: 盲发切回命令后回到原速率.
+  esp8266_SendAT("AT+UART_CUR=%lu,8,1,0,0", (unsigned long)origin);
+
+  vTaskDelay(pdMS_TO_TICKS(ESP_UART_BAUD_SETTLE_MS));
+
+  esp8266_UART_SetBaudRate(origin);
+
+  return false;
+}
+
+
+
+
+// 回显测试: 连续若干次 "AT" 均收到 "OK"，且期间无帧错误/噪声错误.
+static bool esp8266_BaudEchoTest( void )
+{
+  EspRxStats_t before, after;
+
+  esp8266_GetRxStats(&before);
+
+  for ( uint8_t i = 0; i < ESP_UART_BAUD_ECHO_ROUNDS; i++ )
+  {
+    if ( !esp8266_SendATConst("AT") || esp8266_WaitResponse("OK", 100) == NULL )
+    {
+      return false;
+    }
+
+    esp8266_DropLastFrame();
+  }
+
+  esp8266_GetRxStats(&after);
+
+  return ( after.FramingErrors == before.FramingErrors ) && ( after.NoiseErrors == before.NoiseErrors );
+}
+
+
+
+
+// 快速重连: 先以缓存的 IP 配置关闭 DHCP，再指定 BSSID 入网，跳过全信道扫描与 DHCP 交互.
+// 使用 _CUR 形式只改当前配置: AT 1.x 的 AT+CIPSTA= 会把静态地址(即 DHCP 关闭)写入 Flash，掉电后仍然生效.
+static bool esp8266_WifiFastJoin( const EspWifiCache_t *pCache )
+{
+  if ( !esp8266_SendAT("AT+CIPSTA_CUR=\"%s\",\"%s\",\"%s\"", pCache->Ip, pCache->Gateway, pCache->Netmask) 
+          || esp8266_WaitResponse("OK", 1000) == NULL )
+  {
+    esp8266_DropLastFrame();
     return false;
   }
 
-  __HAL_UART_ENABLE_IT(&esp8266_huart, UART_IT_IDLE); // 显示使能IDLE中断.
-  __HAL_UART_ENABLE_IT(&esp8266_huart, UART_IT_TC);  // 发送完成中断.
+  esp8266_DropLastFrame();
 
-  __HAL_UART_CLEAR_FLAG(&esp8266_huart, UART_FLAG_TC);
+  if ( esp8266_SendAT("AT+CWJAP=\"%s\",\"%s\",\"%s\"", hesp8266.WifiSSID, hesp8266.WifiPassword, pCache->Bssid) 
+          && esp8266_WaitResponse("OK", ESP_WIFI_FAST_JOIN_TIMEOUT) != NULL )
+  {
+    esp8266_DropLastFrame();
+    return true;
+  }
 
-  HAL_NVIC_SetPriority(UART4_IRQn, 5, 0);
-  HAL_NVIC_EnableIRQ(UART4_IRQn);
+  esp8266_DropLastFrame();
 
-  HAL_NVIC_SetPriority(DMA1_Stream4_IRQn, 6, 0);
-  HAL_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+  // 恢复 DHCP，完整流程照常获取地址.
+  if ( esp8266_SendATConst("AT+CWDHCP_CUR=1,1") )
+  {
+    esp8266_WaitResponse("OK", 1000);
+  }
 
-  printf("ESP8266 USART Init OK\n");
+  esp8266_DropLastFrame();
 
-  return true;
+  return false;
+}
+
+
+
+
+// 完整流程入网后记录 BSSID / 信道 / IP 配置(网关与掩码已在 GET_IP 阶段提取).
+static void esp8266_WifiCacheSave( EspWifiCache_t *pCache )
+{
+  // +CWJAP:"<ssid>","<bssid>",<channel>,<rssi>
+  if ( !esp8266_SendATConst("AT+CWJAP?") )
+  {
+    return;
+  }
+
+  const uint8_t *pResp = (const uint8_t *)esp8266_WaitResponse("+CWJAP:", 1000);
+  const uint8_t *pField = NULL;
+  uint16_t field_len = 0;
+  bool ok = false;
+
+  if ( pResp != NULL )
+  {
+    uint16_t remain = (uint16_t)( hesp8266.LastReceivedFrame->Data_Len - ( pResp - hesp8266.LastReceivedFrame->RecvData ) );
+
+    if ( at_get_field(pResp, remain, AT_FIELD_IN_QUOTES, 2, &pField, &field_len) && field_len == WIFI_BSSID_LENGTH - 1 )
+    {
+      memcpy(pCache->Bssid, pField, field_len);
+      pCache->Bssid[field_len] = '\0';
+      ok = true;
+    }
+
+    if ( ok && at_get_field(pResp, remain, AT_FIELD_BETWEEN_COMMA, 2, &pField, &field_len) )
+    {
+      pCache->Channel = 0;
+
+      for ( uint16_t i = 0; i < field_len && pField[i] >= '0' && pField[i] <= '9'; i++ )
+      {
+        pCache->Channel = (uint8_t)( pCache->Channel * 10 + ( pField[i] - '0' ) );
+      }
+    }
+  }
+
+  esp8266_DropLastFrame();
+
+  if ( !ok || pCache->Gateway[0] == '\0' || pCache->Netmask[0] == '\0' )
+  {
+    LOG_WRITE(LOG_WARNING, "ESP", "Wifi cache not saved, incomplete link info.");
+    return;
+  }
+
+  strncpy(pCache->Ssid, hesp8266.WifiSSID, WIFI_SSID_LENGTH - 1);
+  pCache->Ssid[WIFI_SSID_LENGTH - 1] = '\0';
+  strncpy(pCache->Ip, hesp8266.Wifi_Ipv4, WIFI_IPCFG_LENGTH - 1);
+  pCache->Ip[WIFI_IPCFG_LENGTH - 1] = '\0';
+
+  bkp_store_Write(BKP_SLOT_ESP_WIFI, pCache, sizeof(*pCache));
+
+  #if defined(__DEBUG_LEVEL_1__)
+    printf("Wifi cache saved: %s ch%u %s.\n", pCache->Bssid, pCache->Channel, pCache->Ip);
+  #endif // __DEBUG_LEVEL_1__
+}
+
+
+
+
+// 热复位探测: 模块仍关联在会话记录的 SSID 上且已获取地址时成立；单连接链路与记录一致时 *pLinked 置位.
+static bool esp8266_WarmProbe( const EspSession_t *pSess, bool *pLinked )
+{
+  const uint8_t *pField = NULL;
+  uint16_t field_len = 0;
+  bool ok = false;
+
+  *pLinked = false;
+
+  // +CWJAP:"<ssid>","<bssid>",<channel>,<rssi>
+  if ( !esp8266_SendATConst("AT+CWJAP?") )
+  {
+    return false;
+  }
+
+  const uint8_t *pResp = (const uint8_t *)esp8266_WaitResponse("+CWJAP:", 1000);
+
+  if ( pResp != NULL )
+  {
+    uint16_t remain = (uint16_t)( hesp8266.LastReceivedFrame->Data_Len - ( pResp - hesp8266.LastReceivedFrame->RecvData ) );
+
+    ok = at_get_field(pResp, remain, AT_FIELD_IN_QUOTES, 1, &pField, &field_len)
+            && field_len == strlen(pSess->Ssid) && memcmp(pField, pSess->Ssid, field_len) == 0;
+  }
+
+  esp8266_DropLastFrame();
+
+  if ( !ok || !esp8266_SendATConst("AT+CIPSTATUS") )
+  {
+    return false;
+  }
+
+  // STATUS:<stat>  2: 已获取 IP  3: 已建立连接  4: 连接已断开  5: 未入网.
+  // +CIPSTATUS:<id>,"<type>","<remote_ip>",<remote_port>,<local_port>,<tetype>
+  pResp = (const uint8_t *)esp8266_WaitResponse("STATUS:", 1000);
+  ok = false;
+
+  if ( pResp != NULL )
+  {
+    uint16_t remain = (uint16_t)( hesp8266.LastReceivedFrame->Data_Len - ( pResp - hesp8266.LastReceivedFrame->RecvData ) );
+    uint8_t stat = ( remain > 7 ) ? (uint8_t)( pResp[7] - '0' ) : 0;
+
+    ok = ( stat >= 2 && stat <= 4 );
+
+    const uint8_t *pLink = ( stat == 3 && pSess->Linked ) ? (const uint8_t *)memmem(pResp, remain, "+CIPSTATUS:", 11) : NULL;
+
+    if ( pLink != NULL )
+    {
+      remain = (uint16_t)( remain - ( pLink - pResp ) );
+
+      if ( at_get_field(pLink, remain, AT_FIELD_IN_QUOTES, 2, &pField, &field_len)
+              && field_len == strlen(pSess->RemoteIp) && memcmp(pField, pSess->RemoteIp, field_len) == 0
+                && at_get_field(pLink, remain, AT_FIELD_BETWEEN_COMMA, 3, &pField, &field_len) )
+      {
+        uint32_t port = 0;
+
+        for ( uint16_t i = 0; i < field_len && pField[i] >= '0' && pField[i] <= '9'; i++ )
+        {
+          port = port * 10 + ( pField[i] - '0' );
+        }
+
+        *pLinked = ( port == pSess->Port );
+      }
+    }
+  }
+
+  esp8266_DropLastFrame();
+
+  return ok;
+}
+
+
+
+
+// 入网完成后记录会话(链路字段由 esp8266_SessionSetLink() 维护).
+static void esp8266_SessionSave( void )
+{
+  memset(&esp_session, 0, sizeof(esp_session));
+
+  strncpy(esp_session.Ssid, hesp8266.WifiSSID, WIFI_SSID_LENGTH - 1);
+  strncpy(esp_session.Ip, hesp8266.Wifi_Ipv4, WIFI_IPCFG_LENGTH - 1);
+  esp_session.Mode = (uint8_t)hesp8266.CurrentMode;
+
+  bkp_store_Write(BKP_SLOT_ESP_SESSION, &esp_session, sizeof(esp_session));
+}
+
+
+
+
+/**
+ * @brief 更新会话中的单连接 TCP 链路（供 MCU 热复位后接管）
+ *
+ * @param[in] Host     目标主机；NULL 表示链路已关闭
+ * @param[in] RemoteIp 对端地址
+ * @param[in] Port     对端端口
+ *
+ * @note 会话尚未建立(入网未完成)时忽略. 可在持有 xMutexEsp 的回调中调用，不阻塞.
+ */
+void esp8266_SessionSetLink( const char *Host, const char *RemoteIp, uint16_t Port )
+{
+  if ( esp_session.Ssid[0] == '\0' )
+  {
+    return;
+  }
+
+  esp_session.Linked = 0;
+  esp_session.Port = 0;
+  memset(esp_session.Host, 0, sizeof(esp_session.Host));
+  memset(esp_session.RemoteIp, 0, sizeof(esp_session.RemoteIp));
+
+  if ( Host != NULL && RemoteIp != NULL && RemoteIp[0] != '\0' )
+  {
+    esp_session.Linked = 1;
+    esp_session.Port = Port;
+    strncpy(esp_session.Host, Host, sizeof(esp_session.Host) - 1);
+    strncpy(esp_session.RemoteIp, RemoteIp, sizeof(esp_session.RemoteIp) - 1);
+  }
+
+  bkp_store_Write(BKP_SLOT_ESP_SESSION, &esp_session, sizeof(esp_session));
+}
+
+
+
+
+/**
+ * @brief 当前会话（入网参数与单连接链路）
+ */
+const EspSession_t *esp8266_SessionGet( void )
+{
+  return &esp_session;
+}
+
+
+
+
+// 使能 DWT 周期计数器(若已被调试器/其他模块使能则不影响).
+static void esp8266_DWT_Init( void )
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 
@@ -833,7 +2612,7 @@ static uint32_t usart_timeout_Calculate( uint16_t data_len )
   assert( data_len > 0 );
 
   uint32_t per_Frame = 10;  // 一帧数据大小(+停止位 起始位).
-  uint32_t per_bit_us = 1000000 / ESP_UART_BAUDRATE;  // 1帧数据传输时间 us.
+  uint32_t per_bit_us = 1000000 / esp8266_huart.Init.BaudRate;  // 1帧数据传输时间 us.
   uint32_t transfer_time = data_len * per_Frame * per_bit_us;
 
   // 增加50%的余量，并将其转换为ms.
@@ -850,38 +2629,29 @@ static uint32_t usart_timeout_Calculate( uint16_t data_len )
  * @brief 释放当前持有的最后一帧 AT 响应数据，标记其为“已消费”，并清空缓冲区内容
  *
  * 该函数用于显式告知驱动层：“上一帧响应数据已完成解析，可安全覆盖”。
- * 它将 `hesp8266.LastFrameValid` 置为 `LastRecvFrame_Used`，并调用 `memset()` 彻底清零
- * `hesp8266.LastReceivedFrame` 结构体（含 `RecvData[]` 缓冲区与 `Data_Len`），防止残留数据
- * 干扰后续解析（如旧 `+IPD` 数据未清导致误匹配）。
+ * 它将 `hesp8266.LastFrameValid` 置为 `LastRecvFrame_Used`，并归还响应视图句柄 `hesp8266.LastReceivedFrame`。
  *
  * @note
- *   - 此函数**必须在成功解析一帧响应后手动调用**（例如：提取完 `"OK"`、解析完 `"+CIPSTART:"` 或 `"+IPD,"` 后）；
+ *   - 此函数**必须在成功解析一帧响应后手动调用**（例如：提取完 `"OK"`、解析完 `"+CIPSTA:"` 后）；
  *   - 若未调用本函数，`esp8266_WaitResponse()` 将拒绝接收新帧（返回 NULL），避免重复解析同一帧；
- *   - 使用递归互斥量 `xMutexEsp` 保护临界区，确保多任务/中断安全（DMA 接收与解析不冲突）；
- *   - 清零操作使用 `sizeof(EspRecvMsg_t)`，精确覆盖整个结构体（含 padding），杜绝未初始化字节。
+ *   - 使用递归互斥量 `xMutexEsp` 保护临界区，确保多任务安全。
  *
  * @warning
- *   - ❗ 调用前请确保 `LastReceivedFrame.RecvData` 中的数据**已全部提取完毕**（如 `out_val` 已 memcpy）；
+ *   - ❗ 调用前请确保 `LastReceivedFrame->RecvData` 中的数据**已全部提取完毕**，或已通过 `esp8266_RetainLastFrame()` 借用；
  *     返回的指针（如 `esp8266_WaitResponse()` 的结果）在调用本函数后立即失效！
  *   - ❗ **严禁在 UART RX IDLE 中断或 DMA 回调中直接调用** —— `xSemaphoreTakeRecursive()` 不可在中断上下文使用；
  *     如需在中断中触发清理，请通过 `xTaskNotifyGive()` 唤醒解析任务后由任务调用。
- *   - ❗ 若 `xSemaphoreTakeRecursive()` 失败（极罕见），本函数静默返回，**不会清空数据** —— 上层需保证互斥量已正确创建且未损坏。
  *
  * @see esp8266_WaitResponse(), at_extractString_between_quotes(), at_extractNum()
  */
 void esp8266_DropLastFrame(void)
 {
-    if ( hesp8266.LastFrameValid == LastRecvFrame_Used )
-    {
-      return;
-    }
-
     if (xSemaphoreTakeRecursive(xMutexEsp, portMAX_DELAY) == pdPASS)
     {
         hesp8266.LastFrameValid = LastRecvFrame_Used;
 
-        //清空数据
-        memset(&hesp8266.LastReceivedFrame, 0, sizeof(EspRecvMsg_t));
+        // 归还视图句柄(若仍被借用，则待借用方释放后回收).
+        esp8266_ReleaseResponse();
 
         xSemaphoreGiveRecursive(xMutexEsp);
     }
@@ -890,6 +2660,42 @@ void esp8266_DropLastFrame(void)
 
 
 
+/**
+ * @brief 借用当前持有的响应视图（引用计数 +1）
+ *
+ * 借用后即可调用 `esp8266_DropLastFrame()` 让驱动继续接收新的响应，而调用者仍可
+ * 直接在接收环上解析该响应，无需拷贝。使用完毕后必须调用 `esp_frame_Release()` 归还。
+ *
+ * @retval non-NULL 借用到的视图句柄
+ * @retval NULL     当前未持有有效响应
+ *
+ * @warning 视图数据位于接收环内，DMA 绕行一整圈后即被覆盖，借用时间应尽量短.
+ */
+EspRxFrame_t *esp8266_RetainLastFrame( void )
+{
+  if ( hesp8266.LastReceivedFrame == NULL || hesp8266.LastFrameValid == LastRecvFrame_Used )
+  {
+    return NULL;
+  }
+
+  return esp_frame_Retain(hesp8266.LastReceivedFrame);
+}
+
+
+
+
+// 归还响应视图句柄并复位匹配进度. 调用者须持有 xMutexEsp.
+static void esp8266_ReleaseResponse( void )
+{
+  esp_frame_Release(hesp8266.LastReceivedFrame);
+  hesp8266.LastReceivedFrame = NULL;
+
+  at_matcher_Reset(&esp_match_ctx);
+}
+
+
+
+
 /**
  * @brief 初始化 ESP8266 句柄结构体（HAL 层抽象对象）的默认状态与运行时资源
  *
@@ -897,7 +2703,7 @@ void esp8266_DropLastFrame(void)
  *   1. 重置所有状态字段至安全初始值（如 RetryCount=0, Status=DISCONNECTED）；
  *   2. 安全拷贝预定义的 WiFi 凭据（WIFI_SSID / WIFI_PASSWORD）到句柄缓冲区，
  *      使用 strncpy + 显式 '\0' 终止，防止缓冲区溢出与未终止字符串风险；
- *   3. 创建用于接收 AT 响应数据帧的 FreeRTOS 队列（xRecvQueue），大小为 DATA_QUEUE_LENGTH；
+ *   3. 创建用于传递接收帧句柄指针的 FreeRTOS 队列（xRecvQueue），大小为 DATA_QUEUE_LENGTH；
  *      若创建失败，记录调试日志并立即返回（不中断上层流程）；
  *   4. 不初始化硬件资源（UART/DMA/IRQ），此职责由 UART4_Init() 独立承担；
  *   5. 不创建互斥量（xMutexEsp）或任务句柄，这些由 vtask8266_Init() 在上下文安全后完成。
@@ -924,11 +2730,30 @@ static void esp8266Handle_Initial( ESP8266_HandleTypeDef *hpesp8266 )
 
   hpesp8266->RetryCount = 0;
   hpesp8266->MaxRetry = 3;
+  hpesp8266->OnlineMs = 0;
+  hpesp8266->FastJoin = false;
+  hpesp8266->WarmStart = false;
   hpesp8266->Status = ESP_STATUS_DISCONNECTED;
   hpesp8266->CurrentMode = ESP_WIFI_ERROR;
   hpesp8266->TargetMode = STATION_SOFTAP;
-  hpesp8266->LastReceivedFrame.Data_Len = 0;
+  hpesp8266->LastReceivedFrame = NULL;
   hpesp8266->LastFrameValid = LastRecvFrame_Used;
+  hpesp8266->UrcEvents = 0;
+  hpesp8266->PayloadSink = NULL;
+  hpesp8266->PayloadCtx = NULL;
+  hpesp8266->RecvPending = 0;
+  hpesp8266->UrcCallback = NULL;
+  hpesp8266->UrcCtx = NULL;
+
+  esp_demux_Init(&esp_demux, &esp_demux_ops, hpesp8266);
+
+  esp_matcher_ready = at_matcher_Build(&esp_matcher, esp_tokens, ESP_TOK_NUM);
+  at_matcher_Reset(&esp_match_ctx);
+
+  if ( !esp_matcher_ready )
+  {
+    LOG_WRITE(LOG_WARNING, "NULL", "Token matcher build failed, fall back to memmem.");
+  }
 
   memset(hpesp8266->Wifi_Ipv4, 0, sizeof(hpesp8266->Wifi_Ipv4));
 
@@ -938,7 +2763,7 @@ static void esp8266Handle_Initial( ESP8266_HandleTypeDef *hpesp8266 )
   strncpy(hpesp8266->WifiPassword, WIFI_PASSWORD, sizeof(hpesp8266->WifiPassword) - 1);
   hpesp8266->WifiPassword[sizeof(hpesp8266->WifiPassword) - 1] = '\0';
 
-  hpesp8266->xRecvQueue = xQueueCreate(DATA_QUEUE_LENGTH, sizeof(EspRecvMsg_t));
+  hpesp8266->xRecvQueue = xQueueCreate(DATA_QUEUE_LENGTH, sizeof(EspRxFrame_t *));
 
   if ( hpesp8266->xRecvQueue == NULL )
   {
@@ -987,7 +2812,7 @@ static void esp8266Handle_Initial( ESP8266_HandleTypeDef *hpesp8266 )
  *
  * @warning
  *   - 此函数**不检查 `LastFrameValid` 状态** —— 调用者须确保 `LastReceivedFrame` 当前有效且未被覆盖；
- *   - 若 `hpesp8266->LastReceivedFrame.Data_Len == 0` 或数据未以 `\0` 结尾，`at_get_string_between_quotes()`
+ *   - 若 `hpesp8266->LastReceivedFrame->Data_Len == 0` 或数据未以 `\0` 结尾，`at_get_string_between_quotes()`
  *     行为取决于其内部实现（建议其使用 `memmem` + 显式长度，而非 `strstr`）；
  *   - `out_len` 必须 ≥ 1，否则无法写入终止符 `\0`，导致未定义行为。
  *
@@ -1011,7 +2836,7 @@ bool at_extractString_between_quotes
     return false;
   }
 
-  if ( hpesp8266->LastFrameValid == LastRecvFrame_Used )
+  if ( hpesp8266->LastFrameValid == LastRecvFrame_Used || hpesp8266->LastReceivedFrame == NULL )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("Not Valid Frame in at_extractString_between_quotes.\n");
@@ -1021,8 +2846,8 @@ bool at_extractString_between_quotes
     return false;
   }
 
-  bool result = at_get_string_between_quotes(hpesp8266->LastReceivedFrame.RecvData, 
-                                    hpesp8266->LastReceivedFrame.Data_Len, 
+  bool result = at_get_string_between_quotes(hpesp8266->LastReceivedFrame->RecvData, 
+                                    hpesp8266->LastReceivedFrame->Data_Len, 
                                         key, out_val, out_len);
   
   if ( result == false )
@@ -1048,7 +2873,7 @@ bool at_extractString_between_quotes
 /**
  * @brief 从 ESP8266 最新接收帧中提取指定键（key）后紧跟的无符号整数值
  *
- * 基于 `at_get_num()` 解析 `LastReceivedFrame.RecvData` 中形如 `"+KEY:123"` 的数字字段，
+ * 基于 `at_get_num()` 解析 `LastReceivedFrame->RecvData` 中形如 `"+KEY:123"` 的数字字段，
  * 专用于获取 AT 响应中的状态码、ID、端口、长度等整型参数。
  *
  * @note
@@ -1082,7 +2907,7 @@ bool at_extractNum( ESP8266_HandleTypeDef *hpesp8266, const char *key, uint32_t
     return false; 
   }
 
-  if ( hpesp8266->LastFrameValid == LastRecvFrame_Used )
+  if ( hpesp8266->LastFrameValid == LastRecvFrame_Used || hpesp8266->LastReceivedFrame == NULL )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("Not Valid Frame in at_extractNum.\n");
@@ -1092,7 +2917,7 @@ bool at_extractNum( ESP8266_HandleTypeDef *hpesp8266, const char *key, uint32_t
     return false;
   }
 
-  bool result = at_get_num(hpesp8266->LastReceivedFrame.RecvData, hesp8266.LastReceivedFrame.Data_Len, key, out_val);
+  bool result = at_get_num(hpesp8266->LastReceivedFrame->RecvData, hpesp8266->LastReceivedFrame->Data_Len, key, out_val);
 
   if ( result == false )
   {
@@ -1126,7 +2951,7 @@ bool at_extractField( ESP8266_HandleTypeDef *hpesp8266, at_field_type_t type, ui
     return false;
   } 
 
-  if ( hpesp8266->LastFrameValid == LastRecvFrame_Used )
+  if ( hpesp8266->LastFrameValid == LastRecvFrame_Used || hpesp8266->LastReceivedFrame == NULL )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("Not Valid Frame in at_extractField.\n");
@@ -1136,7 +2961,7 @@ bool at_extractField( ESP8266_HandleTypeDef *hpesp8266, at_field_type_t type, ui
     return false;
   }
 
-  bool res = at_get_field(hpesp8266->LastReceivedFrame.RecvData, hpesp8266->LastReceivedFrame.Data_Len, type, index, pReturn, pLen);
+  bool res = at_get_field(hpesp8266->LastReceivedFrame->RecvData, hpesp8266->LastReceivedFrame->Data_Len, type, index, pReturn, pLen);
 
   if ( res == false )
   {
@@ -1178,16 +3003,21 @@ bool at_extractField( ESP8266_HandleTypeDef *hpesp8266, at_field_type_t type, ui
  */
 static BaseType_t esp8266_ClearRecvQueue_Manual( void )
 {
-  EspRecvMsg_t dummy;
+  EspRxFrame_t *dummy = NULL;
 
   if ( xSemaphoreTakeRecursive(xMutexEsp, portMAX_DELAY) == pdPASS )
   {
 Clear:    // 持续从队列中取出数据直到为空
     while( xQueueReceive(hesp8266.xRecvQueue, &dummy, 0) == pdTRUE )
     {
-      UNUSED(dummy);
+      esp_frame_Release(dummy);
     }
 
+    rx_stream_done = rx_frame_start;
+
+    // 字节流已不连续，丢弃分流器中的半行/半负载.
+    esp_demux_Reset(&esp_demux);
+
     xSemaphoreGiveRecursive(xMutexEsp);
   }
   else 
@@ -14,6 +14,12 @@
 #include <assert.h>
 #include "queue.h"
 #include "flash_log.h"
+#include "esp8266_frame.h"
+#include "esp8266_demux.h"
+#include "isr_log.h"
+#include "bkp_store.h"
+#include "at_matcher.h"
+#include "esp8266_txq.h"
 
 
 /* ********************************************** */
@@ -29,6 +35,19 @@
 #define ESP_UART_WORDLENGTH  UART_WORDLENGTH_8B
 #define ESP_UART_HwFLOW      UART_HWCONTROL_NONE
 #define ESP_UART             UART4
+
+// 初始化阶段通过 AT+UART_CUR 提升链路速率. 候选速率按从高到低尝试，失败自动回落.
+#define ESP_UART_BAUD_CANDIDATES   { 921600UL, 460800UL, 230400UL }
+#define ESP_UART_BAUD_ECHO_ROUNDS  3      // 切换后需连续通过的 "AT" 回显测试次数.
+#define ESP_UART_BAUD_SETTLE_MS    20     // 模块回复 OK 后切换速率所需时间.
+
+// RTS/CTS 硬件流控. STM32F407 的 UART4 不具备 RTS/CTS 引脚(仅 USART1/2/3/6 支持)，
+// 当前接线下必须保持为 0；链路迁移至带流控的 USART 后方可开启.
+#define ESP_UART_FLOWCTRL_ENABLE   0
+
+#if ESP_UART_FLOWCTRL_ENABLE
+  #error "UART4 has no RTS/CTS lines; move the ESP8266 link to USART1/2/3/6 before enabling flow control."
+#endif
 /* ********************************************** */
 
 
@@ -49,15 +68,31 @@
 
 /* ********************************************** */
 #define COMMAND_BUFFER         128
-#define RECV_DATA_BUFFER       1368
+#define RECV_DATA_BUFFER       1368   // 单帧最大长度(同时作为接收环回绕展开区大小).
 #define Tx_DATA_BUFFER         128
-#define RECV_DATA              (0xFF)
-#define NO_DATA                (0xFE)
-#define DATA_QUEUE_LENGTH      4
+#define DATA_QUEUE_LENGTH      ESP_FRAME_POOL_SIZE   // 队列仅传递帧句柄指针.
+
+#define ESP_RESP_VIEW_MAX      RECV_DATA_BUFFER   // 命令响应视图最大长度(跨越环尾的部分展开至回绕展开区).
+#define ESP_TX_BATCH_MAX       8      // esp8266_SendRawV() 可同时在途的发送请求数(每个最多 ESP_TXQ_MAX_SEGS 段).
+
+#define ESP_RX_RING_SIZE       4096   // DMA循环接收环大小,必须为2的幂.
+#define ESP_RX_RING_MASK       (ESP_RX_RING_SIZE - 1)
+
+#define ESP_RECV_PULL_MAX      2048   // 被动接收模式下单次 AT+CIPRECVDATA 的读取上限(固件限制).
+#define ESP_RECV_PULL_MARGIN   64     // 为响应头、"OK" 及期间可能到达的 URC 预留的接收环空间.
+
+#if ( ESP_RX_RING_SIZE & ESP_RX_RING_MASK ) != 0
+  #error "ESP_RX_RING_SIZE must be a power of two."
+#endif
 
 #define WIFI_IPV4_LENGTH       40
 #define WIFI_PASSWORD_LENGTH   65
 #define WIFI_SSID_LENGTH       33
+#define WIFI_BSSID_LENGTH      18     // "xx:xx:xx:xx:xx:xx".
+#define WIFI_IPCFG_LENGTH      16     // 点分十进制 IPv4.
+
+#define ESP_WIFI_FAST_JOIN_TIMEOUT   8000   // 快速重连(指定 BSSID，静态 IP)的 AT+CWJAP 时限(ms).
+#define ESP_WIFI_FULL_JOIN_TIMEOUT   15000  // 完整连接(扫描 + DHCP)的 AT+CWJAP 时限(ms).
 
 // WIFI模式枚举.
 typedef enum {
@@ -81,29 +116,141 @@ typedef enum {
 // 初始化状态枚举.
 typedef enum {
   INIT_STATE_CHECK_AT,
+  INIT_STATE_WARM_PROBE,
+  INIT_STATE_SET_BAUD,
   INIT_STATE_SET_MODE,
+  INIT_STATE_FAST_CONNECT,
   INIT_STATE_CONNECT_WIFI,
   INIT_STATE_GET_IP,
   INIT_STATE_COMPLETE,
   INIT_STATE_ERROR
 } EspInitState_t;
 
+// 持久化的 UART 链路配置(BKP_SLOT_ESP_UART).
+typedef struct {
+  uint32_t BaudRate;
+  uint8_t FlowCtl;
+  uint8_t pad[3];
+} EspUartCfg_t;
+
+// 持久化的上次成功入网参数(BKP_SLOT_ESP_WIFI)，用于跳过扫描与 DHCP 的快速重连.
+typedef struct {
+  char Ssid[WIFI_SSID_LENGTH];
+  char Bssid[WIFI_BSSID_LENGTH];
+  uint8_t Channel;
+  char Ip[WIFI_IPCFG_LENGTH];
+  char Gateway[WIFI_IPCFG_LENGTH];
+  char Netmask[WIFI_IPCFG_LENGTH];
+  uint32_t FullOnlineMs;    // 最近一次完整路径的上电至入网耗时，用于与快速路径对比.
+} EspWifiCache_t;
+
+// 持久化的当前会话(BKP_SLOT_ESP_SESSION). MCU 热复位后模块仍在运行，探测确认后直接沿用.
+typedef struct {
+  char Ssid[WIFI_SSID_LENGTH];
+  char Ip[WIFI_IPCFG_LENGTH];
+  uint8_t Mode;             // EspWifiMode_t.
+  uint8_t Linked;           // 单连接模式下是否有 TCP 链路.
+  uint16_t Port;
+  char Host[64];
+  char RemoteIp[18];
+} EspSession_t;
+
+
+// URC / 接收事件位(见 esp8266_WaitEvent()).
+#define ESP_EVT_READY            ( 1UL << 0 )
+#define ESP_EVT_WIFI_CONNECTED   ( 1UL << 1 )
+#define ESP_EVT_WIFI_GOT_IP      ( 1UL << 2 )
+#define ESP_EVT_WIFI_DISCONNECT  ( 1UL << 3 )
+#define ESP_EVT_LINK_CONNECT     ( 1UL << 4 )
+#define ESP_EVT_LINK_CLOSED      ( 1UL << 5 )
+#define ESP_EVT_PAYLOAD_DONE     ( 1UL << 6 )   // 一次 +IPD 负载已完整接收.
+#define ESP_EVT_RECV_PENDING     ( 1UL << 7 )   // 被动接收模式下模块缓存中有待读取的数据.
+
+// RecvPending 中链路对应的位(单连接模式无链路号，使用 bit7).
+#define ESP_RECV_PENDING_BIT(link)  ( (uint8_t)( ( (link) == ESP_DEMUX_NO_LINK ) ? 0x80U : ( 1U << ( (link) & 0x07U ) ) ) )
+
+
+// 响应结束标志(多模式匹配自动机的模式串表下标，见 esp_tokens[]).
+typedef enum {
+  ESP_TOK_OK = 0,
+  ESP_TOK_ERROR,
+  ESP_TOK_FAIL,
+  ESP_TOK_BUSY,               // "busy p..." / "busy s...": 模块忙，命令未被执行.
+  ESP_TOK_SEND_OK,
+  ESP_TOK_SEND_FAIL,
+  ESP_TOK_PROMPT,             // ">".
+  ESP_TOK_CONNECT,
+  ESP_TOK_ALREADY_CONNECTED,
+  ESP_TOK_NUM
+} EspToken_t;
+
+// 连接关闭("CLOSED" / "<id>,CLOSED")由分流器作为 URC 路由，不进入响应行，故不设结束标志；
+// 关闭只能经 URC 通路(ESP_URC_LINK_CLOSED 回调 / ESP_EVT_LINK_CLOSED 事件)观察.
+
+// 等待任意响应时，命中即提前结束的失败标志.
+#define ESP_TOK_FAIL_MASK   ( ( 1UL << ESP_TOK_ERROR ) | ( 1UL << ESP_TOK_FAIL ) | ( 1UL << ESP_TOK_BUSY ) )
+
+// 命令的最终结果. 期望标志不属于此集合时，esp8266_WaitResponse() 收集响应直至最终结果到达.
+#define ESP_TOK_FINAL_MASK  ( ESP_TOK_FAIL_MASK | ( 1UL << ESP_TOK_OK ) | ( 1UL << ESP_TOK_SEND_OK ) | \
+                              ( 1UL << ESP_TOK_SEND_FAIL ) | ( 1UL << ESP_TOK_PROMPT ) )
+
 
 typedef enum {
   LastRecvFrame_Valid,  // 接收到的最新数据帧仍未被解析.
   LastRecvFrame_Used    // 接收到的最新数据帧已被解析.
 } FrameStatus_t;
 
- 
+
+/**
+ * @brief 接收通路(UART4 / DMA1_Stream2 / RxEvent 中断)统计信息.
+ *
+ *  RxBytes：DMA 写入接收环的累计字节数.
+ *  RxFrames：成功投递到接收队列的帧数.
+ *  QueueFullDrops：接收队列已满而被丢弃的帧数.
+ *  PoolExhausted：帧池耗尽导致延迟发布的次数(数据仍留在接收环中).
+ *  OverwrittenFrames：解析前已被 DMA 覆盖的帧数(消费方落后超过一整圈).
+ *  ResponseDrops：响应视图仍被解析方持有、已满或无可用帧句柄而被丢弃的响应行数.
+ *  OverrunErrors / FramingErrors / NoiseErrors：UART ORE / FE / NE 错误次数.
+ *  DmaRestarts / DmaRestartFails：接收 DMA 重启次数 / 重启失败次数.
+ *  MaxFrameLen / MeanFrameLen：投递帧的最大 / 平均长度.
+ *  IsrCount：RxEvent 中断处理次数.
+ *  IsrCyclesMax / IsrCyclesMean：RxEvent 中断处理耗时(DWT 周期数)最大值 / 平均值.
+ *  LastRxTick：最近一次收到数据时的系统节拍(用于判断模块是否静默).
+ */
 typedef struct
 {
-  uint8_t RecvData[RECV_DATA_BUFFER];
+  uint32_t RxBytes;
+  uint32_t RxFrames;
+  uint32_t QueueFullDrops;
+  uint32_t PoolExhausted;
+  uint32_t OverwrittenFrames;
+  uint32_t ResponseDrops;
+
+  uint32_t OverrunErrors;
+  uint32_t FramingErrors;
+  uint32_t NoiseErrors;
+  uint32_t DmaRestarts;
+  uint32_t DmaRestartFails;
+
+  uint16_t MaxFrameLen;
+  uint16_t MeanFrameLen;
+
+  uint32_t IsrCount;
+  uint32_t IsrCyclesMax;
+  uint32_t IsrCyclesMean;
 
-  size_t Data_Len;
+  TickType_t LastRxTick;
 
-} EspRecvMsg_t;
+} EspRxStats_t;
 
 
+// +IPD 负载消费方. data 仅在回调期间有效，remain == 0 表示本次 +IPD 负载结束.
+typedef void (*esp_payload_sink_t)( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain );
+
+// URC 消费方.
+typedef void (*esp_urc_cb_t)( void *ctx, esp_urc_t urc, uint8_t link_id );
+
+ 
 /**
  * @brief Esp8266模块结构体.
  *  
@@ -123,12 +270,28 @@ typedef struct
  * 
  *  EspStatus_t Status：ESP8266的当前工作状态.参数见 EspStatus_t.
  * 
- *  QueueHandle_t  xRecvQueue：ESP8266 AT响应回送数据队列.该队列用于接收ESP8266返回的数据.
+ *  QueueHandle_t  xRecvQueue：ESP8266 接收帧队列.队列项为帧句柄指针(EspRxFrame_t *)，由分流器消费.
  * 
- *  EspRecvMsg_t LastReceivedFrame：队列中最新一帧的数据.
+ *  EspRxFrame_t *LastReceivedFrame：命令响应视图句柄，无响应时为 NULL. 视图直接指向接收环，
+ *            由分流出的响应行原始字节(每行以 "\r\n" 结尾)组成，不含 +IPD 负载与 URC.
+ *
+ *  uint32_t UrcEvents：已发生但尚未被 esp8266_WaitEvent() 取走的事件位(ESP_EVT_*).
+ *
+ *  PayloadSink / PayloadCtx：+IPD 负载消费方. 未注册时负载被丢弃.
+ *
+ *  uint8_t RecvPending：被动接收模式下模块缓存中仍有数据的链路集合(见 ESP_RECV_PENDING_BIT)，
+ *            由 "+IPD,<len>" 通知置位，esp8266_RecvPull() 读空后清除.
+ *
+ *  UrcCallback / UrcCtx：URC 消费方(可选).
  * 
  *  FrameStatus_t LastFrameValid：读取到的最新一帧数据是否已被解析.
  * 
+ *  uint32_t OnlineMs：初始化任务启动至获取 IP 的耗时(ms).
+ *
+ *  bool FastJoin：本次入网是否经由快速重连路径.
+ *
+ *  bool WarmStart：本次启动是否直接沿用了模块上仍然有效的会话(MCU 热复位).
+ * 
  *  uint8_t RetryCount：初始化重置计数.
  * 
  *  uint8_t MaxRetry：初始化最多重试次数.
@@ -143,9 +306,20 @@ typedef struct
   EspWifiMode_t TargetMode;
   EspStatus_t Status;  
   QueueHandle_t  xRecvQueue;
-  EspRecvMsg_t LastReceivedFrame;
+  EspRxFrame_t *LastReceivedFrame;
   FrameStatus_t LastFrameValid;
 
+  volatile uint32_t UrcEvents;
+  esp_payload_sink_t PayloadSink;
+  void *PayloadCtx;
+  volatile uint8_t RecvPending;
+  esp_urc_cb_t UrcCallback;
+  void *UrcCtx;
+
+  uint32_t OnlineMs;
+  bool FastJoin;
+  bool WarmStart;
+
   uint8_t RetryCount;      
   uint8_t MaxRetry;        
 
@@ -162,6 +336,14 @@ typedef struct
 
   ErrorStatus vEspInit_TaskCreate( void );
 
+  bool esp8266_UART_SetBaudRate( uint32_t baud );
+
+  bool esp8266_NegotiateBaudRate( void );
+
+  void esp8266_SessionSetLink( const char *Host, const char *RemoteIp, uint16_t Port );
+
+  const EspSession_t *esp8266_SessionGet( void );
+
   void vtask8266_Init( void *parameter );
 
   EspWifiMode_t esp8266_ConnectModeChange( EspWifiMode_t Mode );
@@ -170,8 +352,50 @@ typedef struct
 
   void *esp8266_WaitResponse( const char* expected, uint32_t timeout_ms ); // 等待响应.
 
+  void *esp8266_WaitResponseEx( const char* expected, const char *failed, uint32_t timeout_ms, bool *pFailed );
+
   void esp8266_DropLastFrame(void); // 丢弃当前数据帧.
 
+  EspRxFrame_t *esp8266_RetainLastFrame( void ); // 借用当前数据帧.
+
+  bool esp8266_ResponseHas( EspToken_t tok );
+
+  uint32_t esp8266_ResponseTokens( void );
+
+  void esp8266_SetPayloadSink( esp_payload_sink_t sink, void *ctx );
+
+  void esp8266_SetUrcCallback( esp_urc_cb_t cb, void *ctx );
+
+  void esp8266_SetRawMode( bool enable );
+
+  bool esp8266_SendRaw( const uint8_t *data, uint16_t len );
+
+  bool esp8266_SendRawV( const esp_tx_seg_t *segs, uint8_t seg_num );
+
+  uint32_t esp8266_WaitEvent( uint32_t mask, uint32_t timeout_ms );
+
+  uint32_t esp8266_PollEvent( uint32_t mask );
+
+  uint16_t esp8266_RxCredit( void );
+
+  bool esp8266_RecvPull( uint8_t link_id, uint16_t max_len, uint16_t *pActual, uint32_t timeout_ms );
+
+  void esp8266_ClearEvent( uint32_t mask );
+
+  void esp8266_RxRing_UpdateFromISR( BaseType_t *pxHigherPriorityTaskWoken );
+
+  void esp8266_RxRing_KickFromISR( BaseType_t *pxHigherPriorityTaskWoken );
+
+  void esp8266_RxRing_Restart( void );
+
+  uint32_t esp8266_RxRing_StreamPos( void );
+
+  void esp8266_RxStats_ErrorFromISR( uint32_t isrflags );
+
+  void esp8266_GetRxStats( EspRxStats_t *pStats );
+
+  void esp8266_ResetRxStats( void );
+
 
   bool at_extractString_between_quotes
   ( 
@@ -0,0 +1,245 @@
+#include "esp8266_frame.h"
+#include "bsp_usart_debug.h"
+
+
+/* ********************************************** */
+static EspRxFrame_t frame_pool[ESP_FRAME_POOL_SIZE];
+
+static EspFramePoolStats_t pool_stats = { ESP_FRAME_POOL_SIZE, 0, 0, 0, 0 };
+
+static bool pool_starved = false;     // 出现过分配失败，下一次归还时通知接收环续发.
+/* ********************************************** */
+
+
+/* ********************************************** */
+static void frame_Put( EspRxFrame_t *pFrame );
+
+static EspRxFrame_t *frame_Get( uint32_t stream_pos, uint16_t data_len );
+/* ********************************************** */
+
+
+
+
+/**
+ * @brief 从帧池中分配一个接收帧句柄（中断上下文）
+ *
+ * 线性扫描固定大小的帧池，取第一个引用计数为 0 的句柄，并将其引用计数置 1。
+ * 句柄只描述接收环中的一段数据（位置 + 长度），分配过程不涉及任何数据拷贝。
+ *
+ * @note
+ *   - 池为静态数组且以引用计数 0 表示空闲，无需显式初始化，可在调度器启动前安全使用；
+ *   - 扫描在 `taskENTER_CRITICAL_FROM_ISR()` 保护下进行，池容量很小（`ESP_FRAME_POOL_SIZE`），临界区时间有界；
+ *   - 分配失败时仅累加 `AllocFailed`，由调用者决定保留数据等待下次重试。
+ *
+ * @param[in] stream_pos 帧首字节在接收字节流中的绝对位置
+ * @param[in] data_len   帧长度
+ *
+ * @retval non-NULL 分配成功的帧句柄（引用计数为 1）
+ * @retval NULL     帧池耗尽
+ */
+EspRxFrame_t *esp_frame_AllocFromISR( uint32_t stream_pos, uint16_t data_len )
+{
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  EspRxFrame_t *pFrame = frame_Get(stream_pos, data_len);
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  return pFrame;
+}
+
+
+
+
+/**
+ * @brief 从帧池中分配一个帧句柄（任务上下文）
+ *
+ * 与 `esp_frame_AllocFromISR()` 相同，供驱动为命令响应视图（接收环上的一段字节流）申请句柄。
+ *
+ * @param[in] stream_pos 视图首字节在接收字节流中的绝对位置
+ * @param[in] data_len   视图长度
+ *
+ * @retval non-NULL 分配成功的帧句柄（引用计数为 1）
+ * @retval NULL     帧池耗尽
+ */
+EspRxFrame_t *esp_frame_Alloc( uint32_t stream_pos, uint16_t data_len )
+{
+  taskENTER_CRITICAL();
+
+  EspRxFrame_t *pFrame = frame_Get(stream_pos, data_len);
+
+  taskEXIT_CRITICAL();
+
+  return pFrame;
+}
+
+
+
+
+/**
+ * @brief 归还一次帧句柄引用（中断上下文）
+ *
+ * @param[in] pFrame 帧句柄（允许为 NULL）
+ */
+void esp_frame_ReleaseFromISR( EspRxFrame_t *pFrame )
+{
+  if ( pFrame == NULL )
+  {
+    return;
+  }
+
+  UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+  frame_Put(pFrame);
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+
+
+
+/**
+ * @brief 借用帧句柄（引用计数 +1）
+ *
+ * 解析方在需要跨越 `esp8266_DropLastFrame()` 继续访问帧数据时调用，
+ * 借用期间句柄不会被帧池回收。借用结束后必须调用 `esp_frame_Release()`。
+ *
+ * @param[in] pFrame 帧句柄（必须为当前有效句柄）
+ *
+ * @retval pFrame 原样返回，便于链式书写；参数非法时返回 NULL
+ *
+ * @warning 句柄只保证不被回收，接收环中的数据在 DMA 绕行一整圈后仍会被覆盖，借用时间应尽量短.
+ */
+EspRxFrame_t *esp_frame_Retain( EspRxFrame_t *pFrame )
+{
+  if ( pFrame == NULL || pFrame->RefCount == 0 )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Retain on free frame in esp8266_frame.c\n");
+    #endif // __DEBUG_LEVEL_1__
+
+    return NULL;
+  }
+
+  taskENTER_CRITICAL();
+
+  pFrame->RefCount++;
+
+  taskEXIT_CRITICAL();
+
+  return pFrame;
+}
+
+
+
+
+/**
+ * @brief 归还一次帧句柄引用（任务上下文），引用计数归零时句柄回到帧池
+ *
+ * @param[in] pFrame 帧句柄（允许为 NULL）
+ */
+void esp_frame_Release( EspRxFrame_t *pFrame )
+{
+  if ( pFrame == NULL )
+  {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+
+  frame_Put(pFrame);
+
+  taskEXIT_CRITICAL();
+}
+
+
+
+
+/**
+ * @brief 获取帧池占用统计快照
+ *
+ * @param[out] pStats 输出统计信息
+ */
+void esp_frame_GetPoolStats( EspFramePoolStats_t *pStats )
+{
+  if ( pStats == NULL )
+  {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+
+  *pStats = pool_stats;
+
+  taskEXIT_CRITICAL();
+}
+
+
+
+
+// 调用者须已处于临界区.
+static void frame_Put( EspRxFrame_t *pFrame )
+{
+  if ( pFrame->RefCount == 0 )
+  {
+    return;  // 重复释放，忽略.
+  }
+
+  pFrame->RefCount--;
+
+  if ( pFrame->RefCount == 0 )
+  {
+    pFrame->RecvData = NULL;
+    pFrame->Data_Len = 0;
+
+    pool_stats.InUse--;
+
+    // 发布方因帧池耗尽而暂停: 挂起接收中断，由其续发滞留在接收环中的数据.
+    if ( pool_starved )
+    {
+      pool_starved = false;
+      NVIC_SetPendingIRQ(ESP_FRAME_KICK_IRQn);
+    }
+  }
+}
+
+
+
+
+// 取第一个空闲句柄. 调用者须已处于临界区.
+static EspRxFrame_t *frame_Get( uint32_t stream_pos, uint16_t data_len )
+{
+  EspRxFrame_t *pFrame = NULL;
+
+  for ( uint16_t i = 0; i < ESP_FRAME_POOL_SIZE; i++ )
+  {
+    if ( frame_pool[i].RefCount == 0 )
+    {
+      pFrame = &frame_pool[i];
+      pFrame->RefCount = 1;
+      break;
+    }
+  }
+
+  if ( pFrame != NULL )
+  {
+    pFrame->RecvData = NULL;
+    pFrame->Data_Len = data_len;
+    pFrame->StreamPos = stream_pos;
+
+    pool_stats.InUse++;
+    pool_stats.TotalAlloc++;
+
+    if ( pool_stats.InUse > pool_stats.HighWater )
+    {
+      pool_stats.HighWater = pool_stats.InUse;
+    }
+  }
+  else
+  {
+    pool_stats.AllocFailed++;
+    pool_starved = true;
+  }
+
+  return pFrame;
+}
@@ -0,0 +1,81 @@
+#ifndef __ESP8266_FRAME_H
+#define __ESP8266_FRAME_H
+
+#include "stm32f4xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+
+
+/* ********************************************** */
+#define ESP_FRAME_POOL_SIZE      16     // 帧句柄池容量(同时决定接收队列深度).
+#define ESP_FRAME_KICK_IRQn      UART4_IRQn  // 帧池由耗尽恢复时挂起的中断(接收环所在的 UART)，用于续发滞留数据.
+/* ********************************************** */
+
+
+/**
+ * @brief 接收帧句柄（来自固定大小的帧池，引用计数管理生命周期）.
+ *
+ *  uint8_t *RecvData：帧视图起始地址，指向 DMA 接收环内部（由 esp8266_WaitResponse() 映射后有效）.
+ *  uint16_t Data_Len：帧长度（不超过 RECV_DATA_BUFFER）.
+ *  uint32_t StreamPos：帧首字节在接收字节流中的绝对位置.
+ *  uint8_t RefCount：引用计数. 0 表示该句柄空闲，可被中断重新分配.
+ *
+ *  驱动持有的命令响应视图同样是一个句柄，描述接收环上的一段字节流（见 esp8266_OnResponse()）.
+ *
+ *  中断分配句柄时引用计数为 1（归队列/驱动所有）；解析方通过 esp_frame_Retain() 借用，
+ *  使用完毕后 esp_frame_Release() 归还，无需拷贝帧数据.
+ */
+typedef struct
+{
+  uint8_t *RecvData;
+  uint16_t Data_Len;
+  uint32_t StreamPos;
+  volatile uint8_t RefCount;
+
+} EspRxFrame_t;
+
+
+/**
+ * @brief 帧池统计信息.
+ *
+ *  Capacity：池容量.
+ *  InUse：当前被占用（队列中或被借用）的句柄数.
+ *  HighWater：自启动以来 InUse 的最大值.
+ *  TotalAlloc：累计成功分配次数.
+ *  AllocFailed：池耗尽导致分配失败的次数.
+ */
+typedef struct
+{
+  uint16_t Capacity;
+  uint16_t InUse;
+  uint16_t HighWater;
+  uint32_t TotalAlloc;
+  uint32_t AllocFailed;
+
+} EspFramePoolStats_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  EspRxFrame_t *esp_frame_AllocFromISR( uint32_t stream_pos, uint16_t data_len );
+
+  EspRxFrame_t *esp_frame_Alloc( uint32_t stream_pos, uint16_t data_len );
+
+  void esp_frame_ReleaseFromISR( EspRxFrame_t *pFrame );
+
+  EspRxFrame_t *esp_frame_Retain( EspRxFrame_t *pFrame );
+
+  void esp_frame_Release( EspRxFrame_t *pFrame );
+
+  void esp_frame_GetPoolStats( EspFramePoolStats_t *pStats );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __ESP8266_FRAME_H
@@ -1,13 +1,30 @@
 #include "esp8266_tcp.h"
 #include "stm32f4xx_hal.h"
 #include "esp8266_driver.h"
+#include "esp8266_at_script.h"
+#include "esp8266_at_cmd.h"
+#include "esp8266_dns.h"
+#include "esp8266_at_engine.h"
 
 extern ESP8266_HandleTypeDef hesp8266;
 
 extern UART_HandleTypeDef esp8266_huart;
 
+extern SemaphoreHandle_t xMutexEsp;
+
 static esp_tcp_handle_t htcp8266;
 
+// 多连接模式链路表(下标即链路号)，仅在 tcp_mux 为 true 时使用.
+static esp_tcp_link_t tcp_links[ESP_TCP_MAX_LINKS];
+
+ESP_AT_STATIC_ASSERT(ESP_TCP_MAX_LINKS - 1 <= ESP_AT_LINK_MAX, tcp_links_fit_at_cmd);
+
+// 模块当前是否处于 CIPMUX=1. 单连接接口与透传要求 CIPMUX=0，链路表接口要求 CIPMUX=1，按需切换.
+static bool tcp_mux = false;
+
+// 模块当前是否处于被动接收模式(CIPRECVMODE=1).
+static bool tcp_passive = false;
+
 /* ************************* */
 static const char host_weather[ESP_TCP_WEATHER_HOST_LEN] = { 0 };
 
@@ -22,12 +39,75 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
 
 esp_tcp_err_t esp8266_tcp_Disconnect( void );
 
+esp_tcp_err_t esp8266_tcp_Adopt( const char *Host, const char *RemoteIp, uint16_t Port );
+
 esp_tcp_err_t esp8266_tcp_Send( const uint8_t *data, uint16_t data_len );
 
-esp_tcp_err_t esp8266_tcp_DNSResolve( const char *Host, char *out_ip_str, uint8_t *out_ip_size );
+esp_tcp_err_t esp8266_tcp_SendV( const esp_tx_seg_t *segs, uint8_t seg_num );
+
+esp_tcp_err_t esp8266_tcp_DNSResolve( const char *Host, char *out_ip_str, uint8_t out_ip_size );
+
+static void tcp_OnUrc( void *ctx, esp_urc_t urc, uint8_t link_id );
+
+static void tcp_PassthroughSink( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain );
+
+static void tcp_LinkSink( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain );
+
+static esp_tcp_err_t tcp_SetMux( bool enable );
+
+static void tcp_ResetLinks( void );
+
+static bool tcp_AnyLinkOpen( void );
+
+static bool tcp_CheckSSID( const void *arg );
+
+static void tcp_PullLinks( uint8_t link_mask );
+
+static const char *tcp_DnsTarget( const char *Host, char *ip_buf, esp_dns_result_t *pRes );
+
+static bool tcp_ParseStatusIp( const char *resp, char *out_ip, uint8_t out_size );
+
+static esp_tcp_err_t tcp_SendChunk( const esp_tx_seg_t *segs, uint8_t seg_num, uint16_t len );
 /* ************************* */
 
 
+// 透传会话: 包装调用者的负载消费方并统计接收字节数.
+static struct
+{
+  esp_payload_sink_t sink;
+  void *ctx;
+  volatile uint32_t rx_bytes;
+
+} tcp_pt = { NULL, NULL, 0 };
+
+
+static const esp_at_num_cond_t tcp_cond_mux_off = { "CIPMUX", 0 };
+static const esp_at_num_cond_t tcp_cond_mode_normal = { "CIPMODE", 0 };
+
+#if ESP_TCP_RECV_PASSIVE
+  static const esp_at_num_cond_t tcp_cond_recv_passive = { "CIPRECVMODE", 1 };
+
+  #define TCP_INIT_AFTER_MODE     ( 5 )
+#else
+  // 默认的主动接收模式无需查询(旧固件不支持 CIPRECVMODE).
+  #define TCP_INIT_AFTER_MODE     ESP_AT_SCRIPT_END
+#endif
+
+// 初始化脚本: 校验 WIFI 关联，仅在查询结果不符时才下发 CIPMUX=0 / CIPMODE=0 / CIPRECVMODE=1.
+static const esp_at_step_t tcp_init_script[] =
+{
+  /* 0 */ { "AT+CWJAP?",    "OK", ESP_TCP_CMD_TIMEOUT, tcp_CheckSSID, NULL,                  1,                   ESP_AT_SCRIPT_ABORT },
+  /* 1 */ { "AT+CIPMUX?",   "OK", ESP_TCP_CMD_TIMEOUT, at_CheckNumEq, &tcp_cond_mux_off,     3,                   2                   },
+  /* 2 */ { "AT+CIPMUX=0",  "OK", ESP_TCP_CMD_TIMEOUT, NULL,          NULL,                  3,                   ESP_AT_SCRIPT_ABORT },
+  /* 3 */ { "AT+CIPMODE?",  "OK", ESP_TCP_CMD_TIMEOUT, at_CheckNumEq, &tcp_cond_mode_normal, TCP_INIT_AFTER_MODE, 4                   },
+  /* 4 */ { "AT+CIPMODE=0", "OK", ESP_TCP_CMD_TIMEOUT, NULL,          NULL,                  TCP_INIT_AFTER_MODE, ESP_AT_SCRIPT_ABORT },
+#if ESP_TCP_RECV_PASSIVE
+  /* 5 */ { "AT+CIPRECVMODE?",  "OK", ESP_TCP_CMD_TIMEOUT, at_CheckNumEq, &tcp_cond_recv_passive, ESP_AT_SCRIPT_END, 6                   },
+  /* 6 */ { "AT+CIPRECVMODE=1", "OK", ESP_TCP_CMD_TIMEOUT, NULL,          NULL,                   ESP_AT_SCRIPT_END, ESP_AT_SCRIPT_ABORT }
+#endif
+};
+
+
 /**
  * @brief 获取当前 TCP 连接状态的只读句柄
  *
@@ -51,7 +131,7 @@ const esp_tcp_handle_t* esp8266_tcp_getState()
  *
  * 本函数完成 TCP 通信前的关键 AT 指令配置，确保 ESP8266 处于稳定、可预测的工作状态：
  *   -  验证 WiFi 已成功关联至预设 SSID（通过 `AT+CWJAP?` + `WifiSSID` 字符串比对）
- *   -  强制设置为单连接模式（`AT+CIPMUX=0`），避免多连接 ID 管理复杂性
+ *   -  设置为单连接模式（`AT+CIPMUX=0`）作为默认模式；首次调用 `esp8266_tcp_Open()` 时再切换为多连接
  *   -  切换至普通数据传输模式（`AT+CIPMODE=0`），禁用透传（Transparent Mode）
  *   -  （注：TCP 超时 `AT+CIPSTO` 移至 `connect()` 中按需设置，提升灵活性）
  *
@@ -67,157 +147,45 @@ const esp_tcp_handle_t* esp8266_tcp_getState()
  *         - @ref ESP_TCP_ERR_NO_RESPONSE   : AT 命令有响应但无有效数据（解析失败/固件不兼容）；
  *
  * @note
- *   - 本函数是**线程安全的**（内部使用 `xMutexEsp` 保护 UART 通信），但调用者应避免并发调用；
+ *   - 各项查询与条件写入由 `tcp_init_script` 描述，经 `esp_at_RunScript()` 在一次 `xMutexEsp` 持有期间连续执行，
+ *     仅当查询结果不符时才下发 `AT+CIPMUX=0` / `AT+CIPMODE=0`，各步耗时见调试输出；
  *   - 初始化后，`htcp8266` 结构体被完全清零并进入 `DISCONNECTED` 状态，可供后续 `connect()` 安全使用；
  *   - 错误日志通过 `LOG_WRITE()` 输出，调试信息在 `__DEBUG_LEVEL_1__` 宏启用时打印到 USART；
  */
 esp_tcp_err_t esp8266_tcp_Init( void )
 {
-  void *pResponse = NULL;
-  bool res_a, res_b, reb_c;
-  uint32_t out_val = 0xFF;
-  char temp_outChar[30];
-
-  // 判断网络是否连接上.
-  if ( esp8266_SendAT("AT+CWJAP?") )
-  {
-    if ( esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) )
-    {
-      char temp_outChar[33];
-
-      reb_c = at_extractString_between_quotes(&hesp8266, "+CWJAP:", temp_outChar, sizeof(temp_outChar), pdTRUE);
+  esp_at_script_report_t report;
 
-      if ( !reb_c )
-      {
-        esp8266_DropLastFrame();
-
-        goto TCP_Init_ExtractNum_Err;
-      }
-
-      if ( strcmp(hesp8266.WifiSSID, temp_outChar) )
-      {
-        // 网络未连接上 或 连接状态与状态机管理状态不匹配.
-        #if defined(__DEBUG_LEVEL_1__)
-          printf("WIFI Connect Error.(esp8266_tcp_Init).\n");
-        #endif 
-
-        LOG_WRITE(LOG_ERROR, "NULL", "WIFI Connect Error.(esp8266_tcp_Init).");
-
-        return ESP_TCP_ERR_CONNECT_FAIL;
-      } 
-    }
-    else 
-    {
-      esp8266_DropLastFrame();
-
-      goto TCP_Init_Wait_Err;
-    }
-  }
-  else 
-  {
-    goto TCP_Init_ATSend_Err;
-  }
-
-
-  // 判断并设置为单连接模式.
-  if ( !esp8266_SendAT("AT+CIPMUX?") )
-  {
-TCP_Init_ATSend_Err:
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("SendAT Error in esp8266_tcp_Init.\n");
-    #endif // __DEBUG_LEVEL_1__
-
-    LOG_WRITE(LOG_WARNING, "NULL", "esp8266_tcp_Init SendAT Failed.");
-
-    return ESP_TCP_ERR_TIMEOUT;  // AT命令发送失败(超时).
-  } 
-
-  pResponse = esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT);
-
-  if ( pResponse != NULL )
+  switch( esp_at_RunScript(tcp_init_script, sizeof(tcp_init_script) / sizeof(tcp_init_script[0]), &report) )
   {
-    res_b = at_extractNum(&hesp8266, "CIPMUX", &out_val, pdTRUE);
-
-    if ( res_b && out_val == 0 )
-    {
-      // 已经为单连接模式.
-    }
-
-    // 断开多连接模式(设置为单连接模式).
-    if ( res_b && out_val == 1 )
-    {
-      if ( !esp8266_SendAT("AT+CIPMUX=0") )  goto TCP_Init_ATSend_Err;
-
-      if ( !esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) ) 
-      {
-        esp8266_DropLastFrame();
-        goto TCP_Init_Wait_Err;
-      }
-    }
+    case ESP_AT_SCRIPT_OK:
+      break;
 
-    if ( !res_b || ( out_val != 1 && out_val != 0 ) )
-    {
-TCP_Init_ExtractNum_Err:
+    case ESP_AT_SCRIPT_CHECK_FAIL:
+      // 网络未连接上 或 连接状态与状态机管理状态不匹配.
       #if defined(__DEBUG_LEVEL_1__)
-        printf("at_extractNum called error in esp8266_tcp_Init\n");
+        printf("WIFI Connect Error.(esp8266_tcp_Init).\n");
       #endif 
 
-      LOG_WRITE(LOG_WARNING, "NULL", "at_extractNum failed in esp8266_tcp_Init");
-
-      return ESP_TCP_ERR_NO_RESPONSE;
-    } 
-  }
-  else 
-  {
-TCP_Init_Wait_Err:
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("WaitResponse Timeout in esp8266_tcp_Init.\n");
-    #endif
-
-    LOG_WRITE(LOG_WARNING, "NULL", "WaitResponse Timeout in esp8266_tcp_Init.");
-
-    return ESP_TCP_ERR_NO_RESPONSE;
-  } 
+      LOG_WRITE(LOG_ERROR, "NULL", "WIFI Connect Error.(esp8266_tcp_Init).");
 
+      return ESP_TCP_ERR_CONNECT_FAIL;
 
-  // 判断并设置为普通传输模式（不使用WIFI透传模式）.
-  if ( esp8266_SendAT("AT+CIPMODE?") )
-  {
-    if ( esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) )
-    {
-      res_a = at_extractNum(&hesp8266, "CIPMODE", &out_val, pdTRUE);
-
-      if ( res_a && out_val == 0 )
-      {
-        // 已经处于普通传输模式.
-      }
+    case ESP_AT_SCRIPT_SEND_ERROR:
+      LOG_WRITE(LOG_WARNING, "NULL", "esp8266_tcp_Init SendAT Failed.");
 
-      if ( res_a && out_val == 1 )
-      {
-        if ( !esp8266_SendAT("AT+CIPMODE=0") ) goto TCP_Init_ATSend_Err;
+      return ESP_TCP_ERR_TIMEOUT;  // AT命令发送失败(超时).
 
-        if ( !esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) ) 
-        {
-          esp8266_DropLastFrame();
-          goto TCP_Init_Wait_Err; 
-        }
-      }
+    default:
+      LOG_WRITE(LOG_WARNING, "NULL", "WaitResponse Timeout in esp8266_tcp_Init.");
 
-      if ( !res_a || ( out_val != 1 && out_val != 0 ) )
-      {
-        goto TCP_Init_ExtractNum_Err;
-      }
-    }
-    else 
-    {
-      goto TCP_Init_Wait_Err;
-    }
-  }
-  else 
-  {
-    goto TCP_Init_ATSend_Err;
+      return ESP_TCP_ERR_NO_RESPONSE;
   }
 
+  tcp_mux = false;
+  tcp_passive = ( ESP_TCP_RECV_PASSIVE != 0 );
+  tcp_ResetLinks();
+
   htcp8266.is_Connected = false;
   htcp8266.conn_ID = 0; // 单连接模式conn_ID恒为0.
   htcp8266.remain = 0xFF;
@@ -227,6 +195,12 @@ TCP_Init_Wait_Err:
 
   strncpy(host_weather, ESP_TCP_HOST_WEATHER, sizeof(host_weather) - 1);
 
+  // 恢复复位前的 DNS 缓存.
+  esp_dns_Init();
+
+  // 对端关闭连接时("CLOSED")同步复位本地连接状态.
+  esp8266_SetUrcCallback(tcp_OnUrc, NULL);
+
   #if defined(__DEBUG_LEVEL_1__)
     printf("TCP Init OK: CIPMUX=0, CIPMODE=0, CIPSTO=180, IP=%s\n", hesp8266.Wifi_Ipv4);
   #endif
@@ -259,6 +233,23 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
     return ESP_TCP_ERR_BUSY;
   }
 
+  // 单连接接口要求 CIPMUX=0，链路表中仍有连接时不能切换.
+  if ( tcp_mux )
+  {
+    if ( tcp_AnyLinkOpen() )
+    {
+      LOG_WRITE(LOG_INFO, "TCP", "Multi-link sockets still open.");
+
+      return ESP_TCP_ERR_BUSY;
+    }
+
+    esp_tcp_err_t mux_err = tcp_SetMux(false);
+    if ( mux_err != ESP_TCP_OK )
+    {
+      return mux_err;
+    }
+  }
+
   // 模式检查.
   if ( Mode == TCPv6 )
   {
@@ -269,11 +260,28 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
     conn_type = "TCP";
   }
 
+  // CIPSTART / CIPSTATUS 经 AT 调度任务执行: 每条命令的 发送 -> 结束标志 在调度任务中整体持有 xMutexEsp，
+  // 其它排队命令(如后台 DNS 刷新)不会插入其间；等待期间本任务不持有互斥量.
+  esp_at_cmd_t at;
+  char ip_buf[ESP_DNS_IP_LEN];
+  esp_dns_result_t dns = ESP_DNS_MISS;
+  const char *target = NULL;
+
+TCP_Connect_Retry:
+  // 有缓存地址时直接以 IP 连接，省去模块内部的域名解析.
+  target = tcp_DnsTarget(Host, ip_buf, &dns);
+
+  if ( dns == ESP_DNS_NEGATIVE )
+  {
+    LOG_WRITE(LOG_WARNING, "TCP", "DNS for %s failed recently.", Host);
+
+    return ESP_TCP_ERR_CONNECT_FAIL;
+  }
 
   // 构造命令.
-  char at_cmd[128];
-  int len = snprintf(at_cmd, sizeof(at_cmd), "AT+CIPSTART=\"%s\",\"%s\",%u", conn_type, Host, Port);
-  if ( len <= 0 || len >= (int)sizeof(at_cmd) )
+  char at_cmd[ESP_AT_CIPSTART_MAX];
+  uint16_t len = esp_at_BuildCipStart(at_cmd, ESP_AT_NO_LINK, conn_type, target, Port);
+  if ( len == 0 || !esp_at_Prepare(&at, ESP_TCP_CON_TIMEOUT, "%.*s", (int)( len - 2 ), at_cmd) )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("ATCmd buffer overflow in esp8266_tcp_Connect.\n");
@@ -286,8 +294,10 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
 
 
   htcp8266.state = ESP_TCP_STATE_CONNECTING;
-  // 发送命令.
-  if ( !esp8266_SendAT("%s", at_cmd) )
+
+  esp_at_result_t res = esp_at_Exec(&at, ESP_AT_PRIO_NORMAL);
+
+  if ( res == ESP_AT_SEND_ERROR || res == ESP_AT_EXPIRED )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("ATSend failed in esp8266_tcp_Connect.\n");
@@ -300,12 +310,14 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
     return ESP_TCP_ERR_TIMEOUT;
   } 
 
-
   // 命令解析.
-  HAL_Delay(5); // 适当延时.
-  void *pResponse = esp8266_WaitResponse("OK", ESP_TCP_CON_TIMEOUT);
-  if ( pResponse == NULL )
+  if ( res != ESP_AT_OK )
   {
+    // ERROR 会使命令立即结束，据此区分“被拒绝”与“无响应”.
+    bool refused = ( res == ESP_AT_FAIL ) || strstr(at.response, "FAIL") != NULL;
+
+    bool dns_fail = ( target == Host ) && strstr(at.response, "DNS Fail") != NULL;
+
     htcp8266.state = ESP_TCP_STATE_DISCONNECTED;
 
     #if defined(__DEBUG_LEVEL_1__)
@@ -314,39 +326,49 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
 
     LOG_WRITE(LOG_WARNING, "NULL", "WaitRes failed in esp8266_tcp_Connect.");
 
-    esp8266_DropLastFrame();
+    if ( dns_fail )
+    {
+      esp_dns_Store(Host, NULL);
+    }
+    else if ( target != Host )
+    {
+      // 缓存地址可能已失效(服务迁移)，丢弃后按域名重试一次.
+      LOG_WRITE(LOG_INFO, "TCP", "Cached %s for %s failed, retry by name.", target, Host);
 
-    return ESP_TCP_ERR_NO_RESPONSE;
+      esp_dns_Forget(Host);
+
+      goto TCP_Connect_Retry;
+    }
+
+    return refused ? ESP_TCP_ERR_CONNECT_FAIL : ESP_TCP_ERR_NO_RESPONSE;
   } 
 
-  const uint8_t *response_buf = hesp8266.LastReceivedFrame.RecvData;
-  uint16_t response_buf_len = hesp8266.LastReceivedFrame.Data_Len;
-  if ( memmem(response_buf, response_buf_len, (const void *)"CONNECT", 7) )
+  if ( strstr(at.response, "CONNECT") != NULL && strstr(at.response, "FAIL") == NULL )
   {
-    // 连接成功.
-    uint8_t flag = 0;
-    uint8_t *pReturn = NULL;
-    uint16_t pLen = 0;
-    esp8266_DropLastFrame();
-
-    if ( !esp8266_SendAT("AT+CIPSTATUS") ) 
+    // 连接成功. 对端地址查询为短命令，走高优先级通道.
+    if ( esp_at_Prepare(&at, ESP_TCP_CMD_TIMEOUT, "AT+CIPSTATUS") && esp_at_Exec(&at, ESP_AT_PRIO_HIGH) == ESP_AT_OK )
+    {
+      tcp_ParseStatusIp(at.response, htcp8266.remote_IP, sizeof(htcp8266.remote_IP));
+    }
+    else
     {
       // 查询信息失败，但是连接是成功了的，不能直接返回.
       #if defined(__DEBUG_LEVEL_1__)
-        printf("AT+CIPSTATE? send error.\n");
+        printf("AT+CIPSTATUS query error.\n");
       #endif       
 
-      LOG_WRITE(LOG_WARNING, "NULL", "AT+CIPSTATE? send error.");
-    } else  flag = 1;
+      LOG_WRITE(LOG_WARNING, "NULL", "AT+CIPSTATUS query error.");
+    }
 
-    if ( flag && !esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) )
+    // 由模块按域名解析时，CIPSTATUS 中的对端地址即为解析结果.
+    if ( target == Host && htcp8266.remote_IP[0] != '\0' && strcmp(Host, htcp8266.remote_IP) != 0 )
     {
-      return ESP_TCP_ERR_NO_RESPONSE;
+      esp_dns_Store(Host, htcp8266.remote_IP);
     }
-
-    if ( at_extractField(&hesp8266, AT_FIELD_IN_QUOTES, 2, &pReturn, &pLen, pdTRUE) )
+    else if ( dns == ESP_DNS_STALE )
     {
-      memcpy(htcp8266.remote_IP, pReturn, pLen);
+      // 连接建立后再提交后台刷新，刷新命令不会排在 CIPSTART 之前拖慢连接.
+      esp_dns_RefreshAsync(Host);
     }
 
     htcp8266.is_Connected = true;
@@ -355,7 +377,8 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
     htcp8266.state = ESP_TCP_STATE_CONNECTED;
     strncpy(htcp8266.Host, Host, sizeof(htcp8266.Host) - 1);
     htcp8266.Host[sizeof(htcp8266.Host) - 1] = '\0';
-    esp8266_DropLastFrame();
+
+    esp8266_SessionSetLink(htcp8266.Host, htcp8266.remote_IP, htcp8266.Port);
 
     #if defined(__DEBUG_LEVEL_1__)
       printf("TCP Successfully connect to %s\n", Host);
@@ -364,25 +387,6 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
     return ESP_TCP_OK;
   }
 
-  if ( memmem(response_buf, response_buf_len, (const void *)"ERROR", 5) != NULL || 
-          memmem(response_buf, response_buf_len, (const void *)"FAIL", 4) != NULL )
-  {
-    htcp8266.state = ESP_TCP_STATE_DISCONNECTED;
-
-    // 连接失败.
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("TCP Connect Failed.\n");
-    #endif
-
-    esp8266_DropLastFrame();
-
-    LOG_WRITE(LOG_ERROR, "NULL", "TCP CONN FAILED.");
-
-    return ESP_TCP_ERR_CONNECT_FAIL;
-  }
-
-  esp8266_DropLastFrame();
-
   htcp8266.state = ESP_TCP_STATE_DISCONNECTED;
 
   LOG_WRITE(LOG_ERROR, "NULL", "Unexpected Error in esp8266_tcp_Connect.");
@@ -431,7 +435,7 @@ esp_tcp_err_t esp8266_tcp_Disconnect( void )
 
   htcp8266.state = ESP_TCP_STATE_DISCONNECTING;
 
-  if ( !esp8266_SendAT("AT+CIPCLOSE") )
+  if ( !esp8266_SendATConst("AT+CIPCLOSE") )
   {
     htcp8266.state = ESP_TCP_STATE_CONNECTED;
 
@@ -458,6 +462,8 @@ esp_tcp_err_t esp8266_tcp_Disconnect( void )
     return ESP_TCP_ERR_NO_RESPONSE;
   } 
 
+  esp8266_DropLastFrame();
+
   // 成功断开连接. 状态复位.
   htcp8266.conn_ID = 0xFF;
   htcp8266.is_Connected = false;
@@ -466,6 +472,51 @@ esp_tcp_err_t esp8266_tcp_Disconnect( void )
   memset(htcp8266.remote_IP, 0, sizeof(htcp8266.remote_IP));
   memset(htcp8266.Host, 0, sizeof(htcp8266.Host));
 
+  esp8266_SessionSetLink(NULL, NULL, 0);
+
+  return ESP_TCP_OK;
+}
+
+
+
+
+/**
+ * @brief 接管 MCU 热复位前建立、模块上仍然存活的单连接 TCP 链路
+ *
+ * 不发送任何 AT 命令，仅按记录恢复 `htcp8266`；链路是否存活由调用方事先通过
+ * `AT+CIPSTATUS` 确认（见驱动初始化状态机 INIT_STATE_WARM_PROBE）。
+ *
+ * @pre 已调用 `esp8266_tcp_Init()`。
+ *
+ * @return ESP_TCP_OK 成功；
+ *         ESP_TCP_ERR_INVALID_ARGS 参数非法；
+ *         ESP_TCP_ERR_BUSY 已有连接或处于多连接模式
+ */
+esp_tcp_err_t esp8266_tcp_Adopt( const char *Host, const char *RemoteIp, uint16_t Port )
+{
+  if ( Host == NULL || RemoteIp == NULL || Host[0] == '\0' || RemoteIp[0] == '\0' || Port == 0 )
+  {
+    return ESP_TCP_ERR_INVALID_ARGS;
+  }
+
+  if ( tcp_mux || htcp8266.is_Connected )
+  {
+    return ESP_TCP_ERR_BUSY;
+  }
+
+  htcp8266.is_Connected = true;
+  htcp8266.conn_ID = 0;
+  htcp8266.Port = Port;
+  htcp8266.state = ESP_TCP_STATE_CONNECTED;
+  strncpy(htcp8266.Host, Host, sizeof(htcp8266.Host) - 1);
+  htcp8266.Host[sizeof(htcp8266.Host) - 1] = '\0';
+  strncpy(htcp8266.remote_IP, RemoteIp, sizeof(htcp8266.remote_IP) - 1);
+  htcp8266.remote_IP[sizeof(htcp8266.remote_IP) - 1] = '\0';
+
+  esp8266_SessionSetLink(htcp8266.Host, htcp8266.remote_IP, htcp8266.Port);
+
+  LOG_WRITE(LOG_INFO, "TCP", "Adopted live link to %s:%u", htcp8266.Host, htcp8266.Port);
+
   return ESP_TCP_OK;
 }
 
@@ -480,13 +531,13 @@ esp_tcp_err_t esp8266_tcp_Disconnect( void )
  * 2. 检查 TCP 连接状态（要求 htcp8266.is_Connected == true && htcp8266.state == ESP_TCP_STATE_CONNECTED）；  
  * 3. 发送 "AT+CIPSEND=<len>" 命令；  
  * 4. 等待模块返回 ">" 提示符（表示进入透传模式）；  
- * 5. 调用 HAL_UART_Transmit() 同步发送原始数据帧；  
+ * 5. 经发送队列由 DMA 直接从 data 发送原始数据帧（不拷贝，等待期间任务让出 CPU）；  
  * 6. 等待模块返回 "SEND OK" 确认发送成功。
  * 
  * ⚠️ 注意事项：
- *   - 当前 HAL_UART_Transmit() 调用为裸调用，**未加互斥锁**。若在多任务/中断上下文中调用本函数，
- *     请确保 UART 外设访问的线程安全性 —— 后续版本将在此处引入临界区保护（如 osMutexWait / HAL_NVIC_DisableIRQ 等）；
- *   - data_len 严格限制在 [1, 65535] 范围内（ESP8266 AT 固件对单次 CIPSEND 长度的硬性限制）；
+ *   - 负载经 esp8266_SendRaw() 发送，与 AT 命令共用 `xMutexEsp` 与发送队列；
+ *   - data_len 取值 [1, 65535]；固件单次 CIPSEND 最多接受 ESP_TCP_SEND_MAX（2048）字节，
+ *     更长的数据由 `esp8266_tcp_SendV()` 拆为多次 CIPSEND 依次发出（期间一直持有 `xMutexEsp`）；
  *   - 调用前必须确保 ESP8266 已完成初始化、Wi-Fi 关联、TCP 连接建立且处于稳定通信状态；
  *   - 本函数为阻塞实现，超时由 ESP_TCP_CMD_TIMEOUT 统一控制（单位：ms），超时将返回对应错误码。
  * 
@@ -496,8 +547,7 @@ esp_tcp_err_t esp8266_tcp_Disconnect( void )
  * @return     ESP_TCP_OK                成功发送并收到 "SEND OK"
  * @return     ESP_TCP_ERR_INVALID_ARGS  data 为 NULL，或 data_len 为 0 或 > 65535
  * @return     ESP_TCP_ERR_CONNECT_FAIL  未检测到有效 TCP 连接（is_Connected == false 或 state != ESP_TCP_STATE_CONNECTED）
- * @return     ESP_TCP_ERR_CMD_BUILD_ERROR  AT 命令字符串构建失败（snprintf 异常）
- * @return     ESP_TCP_ERR_TIMEOUT       AT 命令发送超时（esp8266_SendAT 失败）
+ * @return     ESP_TCP_ERR_TIMEOUT       AT 命令或负载发送超时
  * @return     ESP_TCP_ERR_NO_RESPONSE   等待 ">" 或 "SEND OK" 响应超时，或响应解析失败
  * @return     ESP_TCP_ERR_UNKNOWN       （内部保留，当前逻辑不返回）
  * 
@@ -516,72 +566,111 @@ esp_tcp_err_t esp8266_tcp_Send( const uint8_t *data, uint16_t data_len )
     return ESP_TCP_ERR_INVALID_ARGS;
   } 
 
-  if ( ( htcp8266.is_Connected == false ) || ( htcp8266.state != ESP_TCP_STATE_CONNECTED ) )
+  esp_tx_seg_t seg = { data, data_len };
+
+  return esp8266_tcp_SendV(&seg, 1);
+}
+
+
+
+
+/**
+ * @brief 经 AT+CIPSEND 发送多个分段（聚集发送，负载不拷贝）
+ *
+ * 流程与 `esp8266_tcp_Send()` 相同：">" 之后经 `esp8266_SendRawV()` 由 DMA 依次直接发送各分段.
+ * 适用于由常量片段与调用者缓冲区拼接而成的报文（如 HTTP 请求行 / 头部 / 请求体）.
+ * 总长超过 ESP_TCP_SEND_MAX 时拆为多次 CIPSEND，每次至多 ESP_TCP_SEND_MAX 字节、ESP_TXQ_MAX_SEGS 段，
+ * 单个分段可跨越两次发送；任一次失败即中止，已发出的部分无法撤回.
+ *
+ * @param[in] segs    分段表（只需在调用期间有效，长度为 0 的分段被跳过）
+ * @param[in] seg_num 分段数
+ *
+ * @return 同 `esp8266_tcp_Send()`；分段总长为 0 或超过 65535 时返回 ESP_TCP_ERR_INVALID_ARGS
+ */
+esp_tcp_err_t esp8266_tcp_SendV( const esp_tx_seg_t *segs, uint8_t seg_num )
+{
+  uint32_t data_len = 0;
+
+  for ( uint8_t i = 0; segs != NULL && i < seg_num; i++ )
+  {
+    data_len += segs[i].len;
+  }
+
+  if ( data_len > 65535 || data_len == 0 )
   {
     #if defined(__DEBUG_LEVEL_1__)
-      printf("No Connect Detected.Send Failed.\n");
+      printf("Wrong Param of esp8266_tcp_SendV.\n");
     #endif 
 
-    LOG_WRITE(LOG_WARNING, "NULL", "No Connect Detected.Send Failed.");
-    return ESP_TCP_ERR_CONNECT_FAIL;
+    LOG_WRITE(LOG_WARNING, "NULL", "Wrong Param of esp8266_tcp_SendV.");
+    return ESP_TCP_ERR_INVALID_ARGS;
   } 
 
-  char cmd[32];
-
-  int len = snprintf(cmd, sizeof(cmd), "AT+CIPSEND=%u", data_len);
-  if ( len <= 0 || len >= (int)sizeof(cmd) )
+  if ( ( htcp8266.is_Connected == false ) || ( htcp8266.state != ESP_TCP_STATE_CONNECTED ) )
   {
     #if defined(__DEBUG_LEVEL_1__)
-      printf("cmd build failed in esp8266_tcp_Send.\n");
-    #endif     
+      printf("No Connect Detected.Send Failed.\n");
+    #endif 
 
-    LOG_WRITE(LOG_ERROR, "NULL", "cmd build failed in esp8266_tcp_Send.");
-    return ESP_TCP_ERR_CMD_BUILD_ERROR;
+    LOG_WRITE(LOG_WARNING, "NULL", "No Connect Detected.Send Failed.");
+    return ESP_TCP_ERR_CONNECT_FAIL;
   } 
 
-
-  if ( !esp8266_SendAT("%s", cmd) )
+  // 各次 CIPSEND -> '>' -> 数据 -> SEND OK 之间不得插入其它命令(如 AT 调度任务的后台查询).
+  if ( xSemaphoreTakeRecursive(xMutexEsp, pdMS_TO_TICKS(ESP_TCP_CMD_TIMEOUT)) != pdPASS )
   {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("At Send error in esp8266_tcp_Send.\n");
-    #endif    
-    
-    LOG_WRITE(LOG_ERROR, "NULL", "At Send error in esp8266_tcp_Send.");
     return ESP_TCP_ERR_TIMEOUT;
   }
 
+  esp_tcp_err_t err = ESP_TCP_OK;
 
-  uint8_t *pReturn = (uint8_t *)esp8266_WaitResponse(">", ESP_TCP_CMD_TIMEOUT);
-  if ( pReturn == NULL )
+  esp_tx_seg_t chunk[ESP_TXQ_MAX_SEGS];
+
+  uint8_t idx = 0;
+
+  uint16_t off = 0;
+
+  while ( err == ESP_TCP_OK && idx < seg_num )
   {
-    esp8266_DropLastFrame();
+    uint8_t chunk_num = 0;
 
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("wait error in esp8266_tcp_Send.\n");
-    #endif  
-    
-    LOG_WRITE(LOG_ERROR, "NULL", "wait error in esp8266_tcp_Send.");
-    return ESP_TCP_ERR_NO_RESPONSE;
-  }
+    uint16_t chunk_len = 0;
 
-  esp8266_DropLastFrame();
+    // 按 ESP_TCP_SEND_MAX / ESP_TXQ_MAX_SEGS 切出一次 CIPSEND 的负载，分段可跨越两次发送.
+    while ( idx < seg_num && chunk_num < ESP_TXQ_MAX_SEGS && chunk_len < ESP_TCP_SEND_MAX )
+    {
+      uint16_t take = segs[idx].len - off;
 
-  // 阻塞式发送确保数据发送完全.
-  HAL_UART_Transmit(&esp8266_huart, data, data_len, ESP_TCP_CMD_TIMEOUT);
-  HAL_Delay(2);
+      if ( take > ESP_TCP_SEND_MAX - chunk_len )
+      {
+        take = ESP_TCP_SEND_MAX - chunk_len;
+      }
 
-  void *pRes = esp8266_WaitResponse("+IPD,", ESP_TCP_CMD_TIMEOUT);
-  if ( !pRes )
-  {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("Not Recv +IPD in esp8266_tcp_Send.\n");
-    #endif  
-    
-    LOG_WRITE(LOG_ERROR, "NULL", "Not Recv +IPD in esp8266_tcp_Send.");
-    return ESP_TCP_ERR_NO_RESPONSE;    
+      if ( take > 0 )
+      {
+        chunk[chunk_num].data = segs[idx].data + off;
+        chunk[chunk_num].len = take;
+        chunk_num++;
+        chunk_len += take;
+        off += take;
+      }
+
+      if ( off == segs[idx].len )
+      {
+        idx++;
+        off = 0;
+      }
+    }
+
+    if ( chunk_len > 0 )
+    {
+      err = tcp_SendChunk(chunk, chunk_num, chunk_len);
+    }
   }
 
-  return ESP_TCP_OK;
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  return err;
 }
 
 
@@ -604,10 +693,12 @@ esp_tcp_err_t esp8266_tcp_Send( const uint8_t *data, uint16_t data_len )
  * @retval ESP_TCP_ERR_CMD_BUILD_ERROR  AT 命令构造失败（缓冲区溢出或格式异常）
  * @retval ESP_TCP_ERR_TIMEOUT          AT 指令超时（发送失败、无 OK 响应、或无法提取 IP 字段）
  * @retval ESP_TCP_ERR_NO_RESPONSE      等待模块响应时发生通信中断或无有效响应
+ * @retval ESP_TCP_ERR_CONNECT_FAIL     DNS 缓存中有近期的解析失败记录（未发送查询）
  *
  * @note
- *   - 本函数是**可重入的（reentrant）**：内部静态缓冲区 `at_cmd[128]` 在每次调用结束前均被清零，不保留跨调用状态；
- *   - 调用安全性依赖于底层 `esp8266_SendAT()` 和 `esp8266_WaitResponse()` 的可重入实现（即 UART 访问已加锁或为独占通道）；
+ *   - 先查 DNS 缓存（esp8266_dns）：有效期内直接返回；已过期的照常返回并在后台刷新；未命中时才发送 AT+CIPDOMAIN，结果写回缓存；
+ *   - 本函数是**可重入的（reentrant）**：命令描述符位于调用者栈上，不保留跨调用状态；
+ *   - AT+CIPDOMAIN 经 AT 调度任务（esp8266_at_engine）的高优先级通道执行，发送与等待结束标志在调度任务中整体持有 `xMutexEsp`；
  *   - `Host` 中仅允许字母、数字、点（`.`）和连字符（`-`），不支持下划线、通配符、IPv6 或国际化域名（IDN）；
  *   - 对于纯 IP 输入，函数执行严格校验（sscanf + 范围检查），非法 IP（如 "256.1.1.1"、"192.168.1"）将返回 ESP_TCP_ERR_TIMEOUT；
  *   - 日志等级由 `__DEBUG_LEVEL_1__` 和 `LOG_WRITE()` 宏控制，生产环境建议关闭调试输出以节省资源。
@@ -619,7 +710,7 @@ esp_tcp_err_t esp8266_tcp_Send( const uint8_t *data, uint16_t data_len )
  *       printf("Resolved IP: %s\n", ip_buf); // e.g., "172.20.10.5"
  *   }
  */
-esp_tcp_err_t esp8266_tcp_DNSResolve( const char *Host, char *out_ip_str, uint8_t *out_ip_size )
+esp_tcp_err_t esp8266_tcp_DNSResolve( const char *Host, char *out_ip_str, uint8_t out_ip_size )
 {
   if ( !Host || !out_ip_str || out_ip_size == 0 )
   {
@@ -671,9 +762,36 @@ esp_tcp_err_t esp8266_tcp_DNSResolve( const char *Host, char *out_ip_str, uint8_
   }
 
 
-  static char at_cmd[128];
-  int len = snprintf(at_cmd, sizeof(at_cmd), "AT+CIPDOMAIN=\"%s\"", Host);
-  if ( len <= 0 || len >= (int)sizeof(at_cmd) )
+  // 先查缓存: 过期的地址照常返回，同时在后台重新解析.
+  char ip_buf[ESP_DNS_IP_LEN];
+
+  switch( esp_dns_Lookup(Host, ip_buf, sizeof(ip_buf)) )
+  {
+    case ESP_DNS_STALE:
+      esp_dns_RefreshAsync(Host);
+      /* fall through */
+
+    case ESP_DNS_HIT:
+      if ( strlen(ip_buf) >= out_ip_size )
+      {
+        return ESP_TCP_ERR_CMD_BUILD_ERROR;
+      }
+
+      strcpy(out_ip_str, ip_buf);
+      return ESP_TCP_OK;
+
+    case ESP_DNS_NEGATIVE:
+      return ESP_TCP_ERR_CONNECT_FAIL;
+
+    default:
+      break;
+  }
+
+
+  // 域名查询为短命令，经 AT 调度任务的高优先级通道执行，不会排在耗时的 CIPSTART 之后.
+  esp_at_cmd_t at;
+
+  if ( !esp_at_Prepare(&at, ESP_TCP_CMD_TIMEOUT, "AT+CIPDOMAIN=\"%s\"", Host) )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("ATCmd Build Faild in esp8266_tcp_DNSResolve.\n");
@@ -684,67 +802,1039 @@ esp_tcp_err_t esp8266_tcp_DNSResolve( const char *Host, char *out_ip_str, uint8_
   }
 
 
-  if ( !esp8266_SendAT("%s", at_cmd) )
+  esp_at_result_t res = esp_at_Exec(&at, ESP_AT_PRIO_HIGH);
+
+  if ( res == ESP_AT_SEND_ERROR || res == ESP_AT_EXPIRED )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("AT send error in esp8266_tcp_DNSResolve.\n");
     #endif     
 
     LOG_WRITE(LOG_ERROR, "NULL", "AT send error in esp8266_tcp_DNSResolve.");
-    memset(at_cmd, 0, sizeof(at_cmd));
     return ESP_TCP_ERR_TIMEOUT;
   } 
 
 
-  void *pReturn = esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT);
-  if ( !pReturn )
+  if ( res != ESP_AT_OK )
   {
+    // 模块明确答复失败("DNS Fail" / ERROR)时记入失败缓存，一段时间内不再查询.
+    if ( res == ESP_AT_FAIL )
+    {
+      esp_dns_Store(Host, NULL);
+    }
+
     #if defined(__DEBUG_LEVEL_1__)
       printf("wait error in esp8266_tcp_DNSResolve.\n");
     #endif         
 
     LOG_WRITE(LOG_ERROR, "NULL", "wait error in esp8266_tcp_DNSResolve.");
-    memset(at_cmd, 0, sizeof(at_cmd));
-    return ESP_TCP_ERR_NO_RESPONSE;;
+    return ESP_TCP_ERR_NO_RESPONSE;
   }
 
 
-  uint8_t *pRet = NULL;
-  uint16_t size = 0;
-  bool res = at_extractField(&hesp8266, AT_FIELD_AFTER_COLON, 1, &pRet, &size, pdTRUE);
-  if ( !res )
+  // 提取并校验 IPv4 地址(兼容带引号的新版响应格式).
+  bool ok = esp_dns_ParseIp(at.response, at.resp_len, ip_buf);
+
+  if ( !ok || strlen(ip_buf) >= out_ip_size )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("extract error in esp8266_tcp_DNSResolve.\n");
     #endif            
 
     LOG_WRITE(LOG_ERROR, "NULL", "extract error in esp8266_tcp_DNSResolve.");
-    memset(at_cmd, 0, sizeof(at_cmd));
+    memset(out_ip_str, 0, out_ip_size);
     return ESP_TCP_ERR_TIMEOUT;
   }
-  memcpy(out_ip_str, pRet, size);
-  out_ip_str[size] = '\0';
 
-  // 额外校验所得是否为正确Ipv4地址.
-  uint8_t a,b,c,d;
-  if (sscanf(out_ip_str, "%hhu.%hhu.%hhu.%hhu", &a,&b,&c,&d) != 4 ||
-      a > 255 || b > 255 || c > 255 || d > 255) 
+  strcpy(out_ip_str, ip_buf);
+
+  esp_dns_Store(Host, ip_buf);
+
+  return ESP_TCP_OK;
+}
+
+
+
+
+/**
+ * @brief 进入透传（CIPMODE=1）会话，用于大块数据的双向原始字节流传输
+ *
+ * 普通模式下每个数据包都带 `+IPD,<n>:` 封装，每次发送都需要 `AT+CIPSEND=<n>` 与 `>` 往返；
+ * 透传模式下两方向均为原始字节流：
+ *   1. `AT+CIPMODE=1`，等待 "OK"；
+ *   2. `AT+CIPSEND`（不带长度），等待 ">"；
+ *   3. 分流器切换为原始模式，接收字节全部交给 `sink`。
+ *
+ * @pre 已通过 `esp8266_tcp_Connect()` 建立单连接 TCP 链路（`ESP_TCP_STATE_CONNECTED`）。
+ *
+ * @param[in] sink 接收数据消费方（remain 恒为 `ESP_DEMUX_REMAIN_STREAM`），不可为 NULL
+ * @param[in] ctx  透传给 sink 的上下文
+ *
+ * @return ESP_TCP_OK 成功进入透传；其余错误码含义同 `esp8266_tcp_Send()`
+ *
+ * @note 透传期间不可调用任何 AT 接口（包括 `esp8266_tcp_Send()`），必须先 `esp8266_tcp_PassthroughExit()`。
+ */
+esp_tcp_err_t esp8266_tcp_PassthroughEnter( esp_payload_sink_t sink, void *ctx )
+{
+  if ( sink == NULL )
+  {
+    return ESP_TCP_ERR_INVALID_ARGS;
+  }
+
+  if ( ( htcp8266.is_Connected == false ) || ( htcp8266.state != ESP_TCP_STATE_CONNECTED ) )
   {
     #if defined(__DEBUG_LEVEL_1__)
-      printf("Invalid IP format: %s.\n", out_ip_str);
-    #endif           
+      printf("No Connect Detected.Passthrough Failed.\n");
+    #endif 
 
-    LOG_WRITE(LOG_ERROR, "NULL", "Invalid IP format: %s", out_ip_str);
-    memset(at_cmd, 0, sizeof(at_cmd));
-    memset(out_ip_str, 0, out_ip_size);
+    return ESP_TCP_ERR_CONNECT_FAIL;
+  }
+
+  if ( !esp8266_SendATConst("AT+CIPMODE=1") )
+  {
     return ESP_TCP_ERR_TIMEOUT;
   }
 
-  memset(at_cmd, 0, sizeof(at_cmd));
+  if ( !esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) )
+  {
+    LOG_WRITE(LOG_WARNING, "NULL", "CIPMODE=1 no response.");
+    return ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  esp8266_DropLastFrame();
+
+  tcp_pt.sink = sink;
+  tcp_pt.ctx = ctx;
+  tcp_pt.rx_bytes = 0;
+
+  esp8266_SetPayloadSink(tcp_PassthroughSink, NULL);
+
+  if ( !esp8266_SendATConst("AT+CIPSEND") || !esp8266_WaitResponse(">", ESP_TCP_CMD_TIMEOUT) )
+  {
+    esp8266_DropLastFrame();
+    esp8266_SetPayloadSink(NULL, NULL);
+
+    // 回到普通传输模式.
+    if ( esp8266_SendATConst("AT+CIPMODE=0") && esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) )
+    {
+      esp8266_DropLastFrame();
+    }
+
+    LOG_WRITE(LOG_ERROR, "NULL", "Passthrough CIPSEND failed.");
+    return ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  esp8266_DropLastFrame();
+
+  // 此后接收字节不再带 +IPD 封装.
+  esp8266_SetRawMode(true);
+
+  htcp8266.state = ESP_TCP_STATE_PASSTHROUGH;
+
+  return ESP_TCP_OK;
+}
+
+
+
+
+/**
+ * @brief 透传会话中发送原始数据（无 AT 往返，DMA 直接发送调用者缓冲区）
+ *
+ * @param[in] data     数据
+ * @param[in] data_len 长度
+ *
+ * @return ESP_TCP_OK / ESP_TCP_ERR_INVALID_ARGS / ESP_TCP_ERR_CONNECT_FAIL（未处于透传）/ ESP_TCP_ERR_TIMEOUT
+ *
+ * @warning 数据不得恰好为 "+++"，否则模块将退出透传.
+ */
+esp_tcp_err_t esp8266_tcp_PassthroughWrite( const uint8_t *data, uint16_t data_len )
+{
+  if ( data == NULL || data_len == 0 )
+  {
+    return ESP_TCP_ERR_INVALID_ARGS;
+  }
+
+  if ( htcp8266.state != ESP_TCP_STATE_PASSTHROUGH )
+  {
+    return ESP_TCP_ERR_CONNECT_FAIL;
+  }
+
+  return esp8266_SendRaw(data, data_len) ? ESP_TCP_OK : ESP_TCP_ERR_TIMEOUT;
+}
+
+
+
+
+/**
+ * @brief 透传会话中依次发送多个分段（聚集发送，各分段由 DMA 直接发送）
+ *
+ * @return ESP_TCP_OK / ESP_TCP_ERR_INVALID_ARGS / ESP_TCP_ERR_CONNECT_FAIL（未处于透传）/ ESP_TCP_ERR_TIMEOUT
+ */
+esp_tcp_err_t esp8266_tcp_PassthroughWriteV( const esp_tx_seg_t *segs, uint8_t seg_num )
+{
+  if ( segs == NULL || seg_num == 0 )
+  {
+    return ESP_TCP_ERR_INVALID_ARGS;
+  }
+
+  if ( htcp8266.state != ESP_TCP_STATE_PASSTHROUGH )
+  {
+    return ESP_TCP_ERR_CONNECT_FAIL;
+  }
+
+  return esp8266_SendRawV(segs, seg_num) ? ESP_TCP_OK : ESP_TCP_ERR_TIMEOUT;
+}
+
+
+
+
+/**
+ * @brief 透传会话中驱动接收，直到连续 `idle_ms` 无新数据或总计超过 `timeout_ms`
+ *
+ * 透传模式下没有 `+IPD` 长度与 "CLOSED" 提示，只能以空闲超时判断一次响应接收完毕；
+ * 数据在本函数内同步交给进入透传时注册的 sink。
+ *
+ * @param[in] idle_ms    空闲判定时间（毫秒）
+ * @param[in] timeout_ms 总超时（毫秒）
+ *
+ * @return 本次调用期间收到的字节数
+ */
+uint32_t esp8266_tcp_PassthroughReceive( uint32_t idle_ms, uint32_t timeout_ms )
+{
+  if ( htcp8266.state != ESP_TCP_STATE_PASSTHROUGH )
+  {
+    return 0;
+  }
+
+  TickType_t xStart = xTaskGetTickCount();
+  uint32_t start_bytes = tcp_pt.rx_bytes;
+  uint32_t last_bytes = start_bytes;
+
+  for( ; ; )
+  {
+    // 无关注事件，仅用于在 idle_ms 内取帧并分流.
+    esp8266_WaitEvent(0, idle_ms);
+
+    if ( tcp_pt.rx_bytes == last_bytes )
+    {
+      break;  // 空闲.
+    }
+
+    last_bytes = tcp_pt.rx_bytes;
+
+    if ( ( xTaskGetTickCount() - xStart ) >= pdMS_TO_TICKS(timeout_ms) )
+    {
+      break;
+    }
+  }
+
+  return last_bytes - start_bytes;
+}
+
+
+
+
+/**
+ * @brief 退出透传会话并恢复普通传输模式（CIPMODE=0）
+ *
+ * 发送单独的 "+++"（前后各保持 `ESP_TCP_PT_GUARD_MS` 静默）使模块回到 AT 命令态，
+ * 分流器恢复按行解析，最后 `AT+CIPMODE=0`。TCP 连接本身保持不变。
+ *
+ * @return ESP_TCP_OK 成功；ESP_TCP_ERR_NO_RESPONSE 模块未确认 CIPMODE=0（状态置为 ERROR）
+ */
+esp_tcp_err_t esp8266_tcp_PassthroughExit( void )
+{
+  if ( htcp8266.state != ESP_TCP_STATE_PASSTHROUGH )
+  {
+    return ESP_TCP_OK;
+  }
+
+  static const uint8_t escape[3] = { '+', '+', '+' };
+
+  vTaskDelay(pdMS_TO_TICKS(ESP_TCP_PT_GUARD_MS));
+
+  esp8266_SendRaw(escape, sizeof(escape));
+
+  // 静默期内仍可能有残余数据到达，继续交给 sink.
+  esp8266_WaitEvent(0, ESP_TCP_PT_GUARD_MS);
+
+  esp8266_SetRawMode(false);
+  esp8266_SetPayloadSink(NULL, NULL);
+
+  tcp_pt.sink = NULL;
+  tcp_pt.ctx = NULL;
+
+  if ( !esp8266_SendATConst("AT+CIPMODE=0") || !esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) )
+  {
+    esp8266_DropLastFrame();
+
+    htcp8266.state = ESP_TCP_STATE_ERROR;
+
+    LOG_WRITE(LOG_ERROR, "NULL", "Passthrough exit failed.");
+    return ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  esp8266_DropLastFrame();
+
+  htcp8266.state = ESP_TCP_STATE_CONNECTED;
+
   return ESP_TCP_OK;
 }
 
 
 
 
+static void tcp_PassthroughSink( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain )
+{
+  (void)ctx;
+
+  tcp_pt.rx_bytes += len;
+
+  if ( tcp_pt.sink != NULL )
+  {
+    tcp_pt.sink(tcp_pt.ctx, link_id, data, len, remain);
+  }
+}
+
+
+
+
+// URC 回调(在取帧任务上下文中执行，持有 xMutexEsp，不得阻塞).
+static void tcp_OnUrc( void *ctx, esp_urc_t urc, uint8_t link_id )
+{
+  (void)ctx;
+
+  if ( urc == ESP_URC_READY )
+  {
+    // 模块重启: 所有连接均已丢失，CIPMUX / CIPRECVMODE 恢复为默认的 0.
+    tcp_mux = false;
+    tcp_passive = false;
+    tcp_ResetLinks();
+
+    htcp8266.is_Connected = false;
+    htcp8266.state = ESP_TCP_STATE_DISCONNECTED;
+    esp8266_SessionSetLink(NULL, NULL, 0);
+    return;
+  }
+
+  if ( urc != ESP_URC_LINK_CLOSED )
+  {
+    return;
+  }
+
+  if ( tcp_mux )
+  {
+    if ( link_id < ESP_TCP_MAX_LINKS )
+    {
+      tcp_links[link_id].state = ESP_TCP_STATE_DISCONNECTED;
+    }
+    return;
+  }
+
+  if ( link_id != ESP_DEMUX_NO_LINK && link_id != htcp8266.conn_ID )
+  {
+    return;
+  }
+
+  htcp8266.is_Connected = false;
+  htcp8266.Port = 0;
+  htcp8266.state = ESP_TCP_STATE_DISCONNECTED;
+  memset(htcp8266.remote_IP, 0, sizeof(htcp8266.remote_IP));
+  memset(htcp8266.Host, 0, sizeof(htcp8266.Host));
+
+  esp8266_SessionSetLink(NULL, NULL, 0);
+}
+
+
+
+
+/**
+ * @brief 在多连接模式（CIPMUX=1）下打开一条 TCP 链路（类 socket 接口）
+ *
+ * 从链路表中分配最小的空闲链路号，发送 `AT+CIPSTART=<id>,"TCP","<Host>",<Port>`。
+ * 该链路之后收到的 `+IPD,<id>,<len>:` 负载按链路号路由给 `sink`，互不干扰，
+ * 因此多个请求可以先后打开、发送，再统一等待各自的响应（见 `esp8266_tcp_WaitClosed()`），
+ * 服务器处理时间得以重叠，而不是逐个串行累加。
+ *
+ * @pre 已调用 `esp8266_tcp_Init()`；单连接接口（`esp8266_tcp_Connect()`）当前无连接。
+ *
+ * @param[in]  Host     目标域名或 IP
+ * @param[in]  Port     目标端口
+ * @param[in]  Mode     TCP / TCPv6
+ * @param[in]  sink     该链路的负载消费方（可为 NULL，负载被丢弃）
+ * @param[in]  ctx      透传给 sink 的上下文
+ * @param[out] out_link 分配到的链路号
+ *
+ * @return ESP_TCP_OK 成功；
+ *         ESP_TCP_ERR_BUSY 单连接接口仍有连接或透传会话未退出；
+ *         ESP_TCP_ERR_NO_LINK 无空闲链路；
+ *         其余错误码含义同 `esp8266_tcp_Connect()`
+ *
+ * @note sink 在驱动取帧的任务上下文中执行，且持有 `xMutexEsp`，不得阻塞.
+ */
+esp_tcp_err_t esp8266_tcp_Open( const char *Host, uint16_t Port, connect_type_t Mode, esp_payload_sink_t sink, void *ctx, uint8_t *out_link )
+{
+  if ( !Host || Port == 0 || !out_link )
+  {
+    LOG_WRITE(LOG_WARNING, "NULL", "Wrong Param in esp8266_tcp_Open.");
+
+    return ESP_TCP_ERR_INVALID_ARGS;
+  }
+
+  *out_link = ESP_TCP_LINK_INVALID;
+
+  if ( htcp8266.is_Connected || htcp8266.state == ESP_TCP_STATE_PASSTHROUGH )
+  {
+    return ESP_TCP_ERR_BUSY;
+  }
+
+  // 分配链路号并登记为 CONNECTING 须在互斥量内完成，避免两个任务分到同一链路号；
+  // CIPSTART 本身经 AT 调度任务执行，等待连接期间不持有 xMutexEsp.
+  if ( xSemaphoreTakeRecursive(xMutexEsp, pdMS_TO_TICKS(ESP_TCP_CMD_TIMEOUT)) != pdPASS )
+  {
+    return ESP_TCP_ERR_TIMEOUT;
+  }
+
+  esp_tcp_err_t err = ESP_TCP_OK;
+  uint8_t id = ESP_TCP_LINK_INVALID;
+
+  if ( !tcp_mux )
+  {
+    err = tcp_SetMux(true);
+    if ( err != ESP_TCP_OK )
+    {
+      goto TCP_Open_Exit;
+    }
+  }
+
+  for ( uint8_t i = 0; i < ESP_TCP_MAX_LINKS; i++ )
+  {
+    if ( tcp_links[i].state == ESP_TCP_STATE_DISCONNECTED )
+    {
+      id = i;
+      break;
+    }
+  }
+
+  if ( id == ESP_TCP_LINK_INVALID )
+  {
+    LOG_WRITE(LOG_WARNING, "TCP", "No free link for %s.", Host);
+
+    err = ESP_TCP_ERR_NO_LINK;
+    goto TCP_Open_Exit;
+  }
+
+  char ip_buf[ESP_DNS_IP_LEN];
+  esp_dns_result_t dns = ESP_DNS_MISS;
+  const char *target = tcp_DnsTarget(Host, ip_buf, &dns);
+
+  esp_at_cmd_t at;
+  char at_cmd[ESP_AT_CIPSTART_MAX];
+  uint16_t len = esp_at_BuildCipStart(at_cmd, id, ( Mode == TCPv6 ) ? "TCPv6" : "TCP", target, Port);
+  if ( len == 0 || !esp_at_Prepare(&at, ESP_TCP_CON_TIMEOUT, "%.*s", (int)( len - 2 ), at_cmd) )
+  {
+    err = ESP_TCP_ERR_INVALID_ARGS;
+    goto TCP_Open_Exit;
+  }
+
+  esp_tcp_link_t *pLink = &tcp_links[id];
+
+  // 先登记消费方，连接建立后立即到达的数据也能正确路由.
+  pLink->link_id = id;
+  pLink->sink = sink;
+  pLink->ctx = ctx;
+  pLink->rx_bytes = 0;
+  pLink->Port = Port;
+  strncpy(pLink->Host, Host, sizeof(pLink->Host) - 1);
+  pLink->Host[sizeof(pLink->Host) - 1] = '\0';
+  pLink->state = ESP_TCP_STATE_CONNECTING;
+
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  esp_at_result_t res = esp_at_Exec(&at, ESP_AT_PRIO_NORMAL);
+
+  if ( res != ESP_AT_OK )
+  {
+    if ( res == ESP_AT_SEND_ERROR || res == ESP_AT_EXPIRED )
+    {
+      err = ESP_TCP_ERR_TIMEOUT;
+    }
+    else 
+    {
+      err = ( res == ESP_AT_FAIL || strstr(at.response, "FAIL") != NULL ) ? ESP_TCP_ERR_CONNECT_FAIL : ESP_TCP_ERR_NO_RESPONSE;
+    }
+
+    pLink->state = ESP_TCP_STATE_DISCONNECTED;
+    pLink->sink = NULL;
+
+    // 缓存地址连接失败时丢弃，下次按域名连接.
+    if ( target != Host )
+    {
+      esp_dns_Forget(Host);
+    }
+
+    LOG_WRITE(LOG_ERROR, "TCP", "Link %u connect %s failed.", id, Host);
+
+    return err;
+  }
+
+  pLink->state = ESP_TCP_STATE_CONNECTED;
+  *out_link = id;
+
+  // 连接建立后再提交后台刷新，刷新命令不会排在 CIPSTART 之前拖慢连接.
+  if ( dns == ESP_DNS_STALE )
+  {
+    esp_dns_RefreshAsync(Host);
+  }
+
+  #if defined(__DEBUG_LEVEL_1__)
+    printf("TCP link %u connect to %s\n", id, Host);
+  #endif
+
+  return ESP_TCP_OK;
+
+TCP_Open_Exit:
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  return err;
+}
+
+
+
 
+/**
+ * @brief 在指定链路上发送数据（`AT+CIPSEND=<id>,<len>`，阻塞至 "SEND OK"）
+ *
+ * @param[in] link_id  链路号
+ * @param[in] data     数据
+ * @param[in] data_len 长度（1 ~ ESP_TCP_SEND_MAX，固件单次 CIPSEND 上限）
+ *
+ * @return ESP_TCP_OK / ESP_TCP_ERR_INVALID_ARGS / ESP_TCP_ERR_NO_LINK（链路未连接）/
+ *         ESP_TCP_ERR_TIMEOUT / ESP_TCP_ERR_NO_RESPONSE
+ */
+esp_tcp_err_t esp8266_tcp_SendTo( uint8_t link_id, const uint8_t *data, uint16_t data_len )
+{
+  if ( !data || data_len == 0 || data_len > ESP_TCP_SEND_MAX )
+  {
+    return ESP_TCP_ERR_INVALID_ARGS;
+  }
+
+  if ( !tcp_mux || link_id >= ESP_TCP_MAX_LINKS || tcp_links[link_id].state != ESP_TCP_STATE_CONNECTED )
+  {
+    return ESP_TCP_ERR_NO_LINK;
+  }
+
+  // CIPSEND -> '>' -> 数据 -> SEND OK 之间不得插入其它链路的命令.
+  if ( xSemaphoreTakeRecursive(xMutexEsp, pdMS_TO_TICKS(ESP_TCP_CMD_TIMEOUT)) != pdPASS )
+  {
+    return ESP_TCP_ERR_TIMEOUT;
+  }
+
+  esp_tcp_err_t err = ESP_TCP_OK;
+
+  char cmd[ESP_AT_CIPSEND_MAX];
+  uint16_t len = esp_at_BuildCipSend(cmd, link_id, data_len);
+
+  if ( len == 0 )
+  {
+    err = ESP_TCP_ERR_INVALID_ARGS;
+    goto TCP_SendTo_Exit;
+  }
+
+  if ( !esp8266_SendRaw((const uint8_t *)cmd, len) )
+  {
+    err = ESP_TCP_ERR_TIMEOUT;
+    goto TCP_SendTo_Exit;
+  }
+
+  if ( esp8266_WaitResponse(">", ESP_TCP_CMD_TIMEOUT) == NULL )
+  {
+    esp8266_DropLastFrame();
+
+    LOG_WRITE(LOG_ERROR, "TCP", "Link %u wait '>' failed.", link_id);
+
+    err = ESP_TCP_ERR_NO_RESPONSE;
+    goto TCP_SendTo_Exit;
+  }
+
+  esp8266_DropLastFrame();
+
+  if ( !esp8266_SendRaw(data, data_len) )
+  {
+    err = ESP_TCP_ERR_TIMEOUT;
+    goto TCP_SendTo_Exit;
+  }
+
+  if ( esp8266_WaitResponse("SEND OK", ESP_TCP_CMD_TIMEOUT) == NULL )
+  {
+    LOG_WRITE(LOG_ERROR, "TCP", "Link %u not recv SEND OK.", link_id);
+
+    err = ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  esp8266_DropLastFrame();
+
+TCP_SendTo_Exit:
+  xSemaphoreGiveRecursive(xMutexEsp);
+
+  return err;
+}
+
+
+
+
+/**
+ * @brief 关闭指定链路（`AT+CIPCLOSE=<id>`），幂等
+ *
+ * @param[in] link_id 链路号
+ *
+ * @return ESP_TCP_OK / ESP_TCP_ERR_NO_LINK / ESP_TCP_ERR_TIMEOUT / ESP_TCP_ERR_NO_RESPONSE
+ */
+esp_tcp_err_t esp8266_tcp_Close( uint8_t link_id )
+{
+  if ( link_id >= ESP_TCP_MAX_LINKS )
+  {
+    return ESP_TCP_ERR_NO_LINK;
+  }
+
+  esp_tcp_link_t *pLink = &tcp_links[link_id];
+
+  if ( !tcp_mux || pLink->state == ESP_TCP_STATE_DISCONNECTED )
+  {
+    pLink->sink = NULL;
+    return ESP_TCP_OK;
+  }
+
+  char cmd[ESP_AT_CIPCLOSE_MAX];
+  uint16_t len = esp_at_BuildCipClose(cmd, link_id);
+
+  if ( len == 0 )
+  {
+    return ESP_TCP_ERR_NO_LINK;
+  }
+
+  pLink->state = ESP_TCP_STATE_DISCONNECTING;
+
+  if ( !esp8266_SendRaw((const uint8_t *)cmd, len) )
+  {
+    pLink->state = ESP_TCP_STATE_CONNECTED;
+
+    return ESP_TCP_ERR_TIMEOUT;
+  }
+
+  if ( esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) == NULL )
+  {
+    esp8266_DropLastFrame();
+
+    // 对端已先行关闭时固件回复 ERROR，链路状态已由 "<id>,CLOSED" 更新.
+    if ( pLink->state != ESP_TCP_STATE_DISCONNECTED )
+    {
+      pLink->state = ESP_TCP_STATE_ERROR;
+
+      LOG_WRITE(LOG_ERROR, "TCP", "Link %u close failed.", link_id);
+      return ESP_TCP_ERR_NO_RESPONSE;
+    }
+  }
+  else
+  {
+    esp8266_DropLastFrame();
+  }
+
+  pLink->state = ESP_TCP_STATE_DISCONNECTED;
+  pLink->sink = NULL;
+  pLink->ctx = NULL;
+
+  return ESP_TCP_OK;
+}
+
+
+
+
+/**
+ * @brief 获取链路表项的只读指针
+ *
+ * @return 链路号无效时返回 NULL
+ */
+const esp_tcp_link_t* esp8266_tcp_GetLink( uint8_t link_id )
+{
+  if ( link_id >= ESP_TCP_MAX_LINKS )
+  {
+    return NULL;
+  }
+
+  return &tcp_links[link_id];
+}
+
+
+
+
+/**
+ * @brief 等待一组链路被对端关闭（HTTP/1.0 或 "Connection: close" 的响应以关闭作为结束标志）
+ *
+ * 期间持续驱动接收，各链路的负载照常路由给各自的 sink。
+ *
+ * @param[in] link_mask  关注的链路集合（bit n 对应链路 n）
+ * @param[in] timeout_ms 总超时（毫秒）
+ *
+ * @return link_mask 中已关闭的链路集合（等于 link_mask 表示全部完成）
+ */
+uint8_t esp8266_tcp_WaitClosed( uint8_t link_mask, uint32_t timeout_ms )
+{
+  TickType_t xStart = xTaskGetTickCount();
+  TickType_t xTimeout = pdMS_TO_TICKS(timeout_ms);
+  uint8_t closed = 0;
+
+  link_mask &= (uint8_t)( ( 1U << ESP_TCP_MAX_LINKS ) - 1U );
+
+  for( ; ; )
+  {
+    closed = 0;
+
+    for ( uint8_t i = 0; i < ESP_TCP_MAX_LINKS; i++ )
+    {
+      if ( ( link_mask & ( 1U << i ) ) && tcp_links[i].state == ESP_TCP_STATE_DISCONNECTED )
+      {
+        closed |= (uint8_t)( 1U << i );
+      }
+    }
+
+    TickType_t xElapsed = xTaskGetTickCount() - xStart;
+
+    if ( closed == link_mask || xElapsed >= xTimeout )
+    {
+      break;
+    }
+
+    esp8266_WaitEvent(ESP_EVT_LINK_CLOSED | ESP_EVT_RECV_PENDING, ( xTimeout - xElapsed ) * portTICK_PERIOD_MS);
+
+    // 被动接收: 数据留在模块缓存中，须主动读取各链路才会交给 sink.
+    tcp_PullLinks(link_mask);
+  }
+
+  return closed;
+}
+
+
+
+
+/**
+ * @brief 切换接收模式（`AT+CIPRECVMODE=<0/1>`）
+ *
+ * 主动模式下模块收到数据即以 `+IPD,<len>:<data>` 推送，MCU 处理不及时（接收环被覆盖、帧池耗尽）时数据丢失；
+ * 被动模式下数据留在模块缓存（对端随之受 TCP 窗口限制），仅推送 `+IPD,<len>` 通知，
+ * 由消费方调用 `esp8266_tcp_Pull()` 按接收通路的额度分段读取，形成端到端的背压。
+ *
+ * @param[in] passive true 被动接收，false 主动接收
+ *
+ * @return ESP_TCP_OK / ESP_TCP_ERR_BUSY（透传会话中）/ ESP_TCP_ERR_TIMEOUT / ESP_TCP_ERR_NO_RESPONSE（固件不支持）
+ *
+ * @note 透传（CIPMODE=1）会话不受该设置影响，仍为原始字节流.
+ */
+esp_tcp_err_t esp8266_tcp_SetRecvMode( bool passive )
+{
+  if ( htcp8266.state == ESP_TCP_STATE_PASSTHROUGH )
+  {
+    return ESP_TCP_ERR_BUSY;
+  }
+
+  if ( !( passive ? esp8266_SendATConst("AT+CIPRECVMODE=1") : esp8266_SendATConst("AT+CIPRECVMODE=0") ) )
+  {
+    return ESP_TCP_ERR_TIMEOUT;
+  }
+
+  if ( esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) == NULL )
+  {
+    esp8266_DropLastFrame();
+
+    LOG_WRITE(LOG_WARNING, "TCP", "CIPRECVMODE=%u failed.", passive ? 1U : 0U);
+    return ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  esp8266_DropLastFrame();
+
+  tcp_passive = passive;
+
+  return ESP_TCP_OK;
+}
+
+
+
+
+/**
+ * @brief 模块当前是否处于被动接收模式
+ */
+bool esp8266_tcp_IsPassive( void )
+{
+  return tcp_passive;
+}
+
+
+
+
+/**
+ * @brief 被动接收模式下读取一段缓存数据，交给该链路的负载消费方
+ *
+ * 仅当模块已通知该链路有数据（`+IPD,[<id>,]<len>`）时才发送 `AT+CIPRECVDATA`；
+ * 单次长度为 `max_len` 与 `esp8266_RxCredit()` 中的较小者，调用方按自身处理速度调用即构成背压。
+ *
+ * @param[in]  link_id 链路号（单连接模式传 `ESP_TCP_LINK_INVALID`）
+ * @param[in]  max_len 本次最多接受的字节数
+ * @param[out] pLen    实际读取的字节数（主动模式、无待读数据或暂无额度时为 0）
+ *
+ * @return ESP_TCP_OK / ESP_TCP_ERR_INVALID_ARGS / ESP_TCP_ERR_NO_RESPONSE（读取超时）
+ */
+esp_tcp_err_t esp8266_tcp_Pull( uint8_t link_id, uint16_t max_len, uint16_t *pLen )
+{
+  if ( pLen == NULL || ( link_id != ESP_TCP_LINK_INVALID && link_id >= ESP_TCP_MAX_LINKS ) )
+  {
+    return ESP_TCP_ERR_INVALID_ARGS;
+  }
+
+  *pLen = 0;
+
+  // 单连接模式下响应与通知均不带链路号.
+  uint8_t id = tcp_mux ? link_id : ESP_DEMUX_NO_LINK;
+
+  if ( !tcp_passive || ( hesp8266.RecvPending & ESP_RECV_PENDING_BIT(id) ) == 0 )
+  {
+    return ESP_TCP_OK;
+  }
+
+  if ( !esp8266_RecvPull(id, max_len, pLen, ESP_TCP_PULL_TIMEOUT) )
+  {
+    return ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  return ESP_TCP_OK;
+}
+
+
+
+
+// 切换 CIPMUX，并同步负载路由: 多连接模式下由链路表按链路号分发.
+static esp_tcp_err_t tcp_SetMux( bool enable )
+{
+  if ( !( enable ? esp8266_SendATConst("AT+CIPMUX=1") : esp8266_SendATConst("AT+CIPMUX=0") ) )
+  {
+    return ESP_TCP_ERR_TIMEOUT;
+  }
+
+  if ( esp8266_WaitResponse("OK", ESP_TCP_CMD_TIMEOUT) == NULL )
+  {
+    esp8266_DropLastFrame();
+
+    LOG_WRITE(LOG_WARNING, "TCP", "CIPMUX=%u failed.", enable ? 1U : 0U);
+    return ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  esp8266_DropLastFrame();
+
+  tcp_mux = enable;
+
+  esp8266_SetPayloadSink(enable ? tcp_LinkSink : NULL, NULL);
+
+  return ESP_TCP_OK;
+}
+
+
+
+
+static void tcp_ResetLinks( void )
+{
+  memset(tcp_links, 0, sizeof(tcp_links));
+
+  for ( uint8_t i = 0; i < ESP_TCP_MAX_LINKS; i++ )
+  {
+    tcp_links[i].link_id = i;
+    tcp_links[i].state = ESP_TCP_STATE_DISCONNECTED;
+  }
+}
+
+
+
+
+static bool tcp_AnyLinkOpen( void )
+{
+  for ( uint8_t i = 0; i < ESP_TCP_MAX_LINKS; i++ )
+  {
+    if ( tcp_links[i].state != ESP_TCP_STATE_DISCONNECTED )
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+
+
+// 多连接模式负载路由: 按 +IPD 携带的链路号交给对应链路的消费方.
+static void tcp_LinkSink( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain )
+{
+  (void)ctx;
+
+  if ( link_id >= ESP_TCP_MAX_LINKS )
+  {
+    return;
+  }
+
+  esp_tcp_link_t *pLink = &tcp_links[link_id];
+
+  pLink->rx_bytes += len;
+
+  if ( pLink->sink != NULL )
+  {
+    pLink->sink(pLink->ctx, link_id, data, len, remain);
+  }
+}
+
+
+
+
+// 初始化脚本条件: "+CWJAP:" 中的 SSID 与状态机记录的一致.
+static bool tcp_CheckSSID( const void *arg )
+{
+  char ssid[WIFI_SSID_LENGTH];
+
+  (void)arg;
+
+  if ( hesp8266.LastReceivedFrame == NULL
+        || !at_get_string_between_quotes(hesp8266.LastReceivedFrame->RecvData, hesp8266.LastReceivedFrame->Data_Len, "+CWJAP:", ssid, sizeof(ssid)) )
+  {
+    return false;
+  }
+
+  return ( strcmp(hesp8266.WifiSSID, ssid) == 0 );
+}
+
+
+
+
+// 选择 CIPSTART 的目标: 缓存命中(含过期)时返回缓存的 IP，否则返回域名本身. 过期记录由调用者在连接建立后提交刷新.
+static const char *tcp_DnsTarget( const char *Host, char *ip_buf, esp_dns_result_t *pRes )
+{
+  *pRes = esp_dns_Lookup(Host, ip_buf, ESP_DNS_IP_LEN);
+
+  return ( *pRes == ESP_DNS_HIT || *pRes == ESP_DNS_STALE ) ? ip_buf : Host;
+}
+
+
+
+
+// 从 AT+CIPSTATUS 的响应中提取对端地址(+CIPSTATUS:<id>,"<type>","<remote IP>",... 的第二个引号字段).
+static bool tcp_ParseStatusIp( const char *resp, char *out_ip, uint8_t out_size )
+{
+  const char *p = strstr(resp, "+CIPSTATUS:");
+
+  for ( uint8_t quote = 0; p != NULL && quote < 3; quote++ )
+  {
+    p = strchr(p, '"');
+    p = ( p != NULL ) ? p + 1 : NULL;
+  }
+
+  const char *pEnd = ( p != NULL ) ? strchr(p, '"') : NULL;
+
+  if ( pEnd == NULL || pEnd - p >= out_size )
+  {
+    return false;
+  }
+
+  memcpy(out_ip, p, pEnd - p);
+  out_ip[pEnd - p] = '\0';
+
+  return true;
+}
+
+
+
+
+// 被动接收模式下读空 link_mask 中各链路在模块缓存中的数据(负载经 tcp_LinkSink 路由).
+static void tcp_PullLinks( uint8_t link_mask )
+{
+  if ( !tcp_passive )
+  {
+    return;
+  }
+
+  for ( uint8_t i = 0; i < ESP_TCP_MAX_LINKS; i++ )
+  {
+    uint16_t n = 0;
+
+    if ( ( link_mask & ( 1U << i ) ) == 0 )
+    {
+      continue;
+    }
+
+    for( ; ; )
+    {
+      if ( esp8266_tcp_Pull(i, ESP_RECV_PULL_MAX, &n) != ESP_TCP_OK || n == 0 )
+      {
+        break;
+      }
+    }
+  }
+}
+
+
+
+
+// 一次 AT+CIPSEND 往返(len <= ESP_TCP_SEND_MAX). 调用方持有 xMutexEsp.
+static esp_tcp_err_t tcp_SendChunk( const esp_tx_seg_t *segs, uint8_t seg_num, uint16_t len )
+{
+  esp_tcp_err_t err = ESP_TCP_OK;
+
+  char cmd[ESP_AT_CIPSEND_MAX];
+
+  uint16_t cmd_len = esp_at_BuildCipSend(cmd, ESP_AT_NO_LINK, len);
+
+
+  if ( !esp8266_SendRaw((const uint8_t *)cmd, cmd_len) )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("At Send error in esp8266_tcp_SendV.\n");
+    #endif    
+    
+    LOG_WRITE(LOG_ERROR, "NULL", "At Send error in esp8266_tcp_SendV.");
+    return ESP_TCP_ERR_TIMEOUT;
+  }
+
+
+  uint8_t *pReturn = (uint8_t *)esp8266_WaitResponse(">", ESP_TCP_CMD_TIMEOUT);
+  if ( pReturn == NULL )
+  {
+    esp8266_DropLastFrame();
+
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("wait error in esp8266_tcp_SendV.\n");
+    #endif  
+    
+    LOG_WRITE(LOG_ERROR, "NULL", "wait error in esp8266_tcp_SendV.");
+    return ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  esp8266_DropLastFrame();
+
+  // 负载直接由发送队列经 DMA 发出(不拷贝到 esp8266_TxBuffer)，等待期间任务让出 CPU.
+  if ( !esp8266_SendRawV(segs, seg_num) )
+  {
+    LOG_WRITE(LOG_ERROR, "NULL", "Payload send error in esp8266_tcp_SendV.");
+    return ESP_TCP_ERR_TIMEOUT;
+  }
+
+  // 对端回包(+IPD)由分流器直接交给已注册的负载消费方，此处只确认发送完成.
+  void *pRes = esp8266_WaitResponse("SEND OK", ESP_TCP_CMD_TIMEOUT);
+  if ( !pRes )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Not Recv SEND OK in esp8266_tcp_SendV.\n");
+    #endif  
+    
+    LOG_WRITE(LOG_ERROR, "NULL", "Not Recv SEND OK in esp8266_tcp_SendV.");
+    err = ESP_TCP_ERR_NO_RESPONSE;
+  }
+
+  esp8266_DropLastFrame();
+
+  return err;
+}
@@ -4,12 +4,22 @@
 
 #include "flash_log.h"
 #include "bsp_usart_debug.h"
+#include "esp8266_driver.h"
 #include <ctype.h>
 
 
 
 #define ESP_TCP_CMD_TIMEOUT       ( 500UL  )
 #define ESP_TCP_CON_TIMEOUT       ( 50000UL )
+#define ESP_TCP_SEND_MAX          ( 2048U )    // 固件单次 AT+CIPSEND 接受的最大负载，更长的数据由 esp8266_tcp_SendV() 分多次发送.
+#define ESP_TCP_PT_GUARD_MS       ( 1000UL )   // "+++" 前后须保持的静默时间(模块退出透传后亦需等待该时间).
+#define ESP_TCP_MAX_LINKS         ( 5U )       // 多连接模式(CIPMUX=1)下固件支持的链路数(ID 0~4).
+#define ESP_TCP_LINK_INVALID      ( 0xFFU )
+
+// 被动接收(AT+CIPRECVMODE=1): 数据留在模块缓存中，由 esp8266_tcp_Pull() 按接收通路的额度读取.
+// 初始化时按该配置设置模块；运行中可经 esp8266_tcp_SetRecvMode() 切换.
+#define ESP_TCP_RECV_PASSIVE      ( 0 )
+#define ESP_TCP_PULL_TIMEOUT      ( 2000UL )   // 单次 AT+CIPRECVDATA 的时限(ms).
 
 #define ESP_TCP_HOST_WEATHER      "t.weather.sojson.com"
 #define ESP_TCP_WEATHER_HOST_LEN  ( 64 )
@@ -23,7 +33,8 @@ typedef enum
   ESP_TCP_ERR_CONNECT_FAIL     = -3, 
   ESP_TCP_ERR_NO_RESPONSE      = -4,
   ESP_TCP_ERR_INVALID_ARGS     = -5,
-  ESP_TCP_ERR_CMD_BUILD_ERROR  = -6
+  ESP_TCP_ERR_CMD_BUILD_ERROR  = -6,
+  ESP_TCP_ERR_NO_LINK          = -7    // 无空闲链路号 / 链路号无效.
 } esp_tcp_err_t;
 
 
@@ -33,6 +44,7 @@ typedef enum
   ESP_TCP_STATE_CONNECTING,
   ESP_TCP_STATE_CONNECTED,
   ESP_TCP_STATE_DISCONNECTING,
+  ESP_TCP_STATE_PASSTHROUGH,   // 透传会话中(CIPMODE=1)，AT 命令不可用.
   ESP_TCP_STATE_ERROR
 } esp_tcp_state_t;
 
@@ -61,6 +73,29 @@ typedef struct
 
 
 
+/**
+ * @brief 多连接模式(CIPMUX=1)链路表项.
+ *
+ *  state：链路状态(仅使用 DISCONNECTED / CONNECTING / CONNECTED / DISCONNECTING).
+ *  link_id：链路号(即表项下标).
+ *  Port / Host：对端地址.
+ *  sink / ctx：该链路 +IPD 负载的消费方，由接收路由按 `+IPD,<id>,<len>` 分发.
+ *  rx_bytes：自打开以来收到的负载字节数.
+ */
+typedef struct
+{
+  esp_tcp_state_t state;
+  uint8_t link_id;
+  uint16_t Port;
+  char Host[64];
+  esp_payload_sink_t sink;
+  void *ctx;
+  uint32_t rx_bytes;
+
+} esp_tcp_link_t;
+
+
+
 /* *********************************************** */
 esp_tcp_err_t esp8266_tcp_Init( void );
 
@@ -70,9 +105,39 @@ esp_tcp_err_t esp8266_tcp_Connect( const char *Host, uint16_t Port, connect_type
 
 esp_tcp_err_t esp8266_tcp_Disconnect( void );
 
+esp_tcp_err_t esp8266_tcp_Adopt( const char *Host, const char *RemoteIp, uint16_t Port );
+
 esp_tcp_err_t esp8266_tcp_Send( const uint8_t *data, uint16_t data_len );
 
-esp_tcp_err_t esp8266_tcp_DNSResolve( const char *Host, char *out_ip_str, uint8_t *out_ip_size );
+esp_tcp_err_t esp8266_tcp_SendV( const esp_tx_seg_t *segs, uint8_t seg_num );
+
+esp_tcp_err_t esp8266_tcp_DNSResolve( const char *Host, char *out_ip_str, uint8_t out_ip_size );
+
+esp_tcp_err_t esp8266_tcp_PassthroughEnter( esp_payload_sink_t sink, void *ctx );
+
+esp_tcp_err_t esp8266_tcp_PassthroughWrite( const uint8_t *data, uint16_t data_len );
+
+esp_tcp_err_t esp8266_tcp_PassthroughWriteV( const esp_tx_seg_t *segs, uint8_t seg_num );
+
+uint32_t esp8266_tcp_PassthroughReceive( uint32_t idle_ms, uint32_t timeout_ms );
+
+esp_tcp_err_t esp8266_tcp_PassthroughExit( void );
+
+esp_tcp_err_t esp8266_tcp_Open( const char *Host, uint16_t Port, connect_type_t Mode, esp_payload_sink_t sink, void *ctx, uint8_t *out_link );
+
+esp_tcp_err_t esp8266_tcp_SendTo( uint8_t link_id, const uint8_t *data, uint16_t data_len );
+
+esp_tcp_err_t esp8266_tcp_Close( uint8_t link_id );
+
+const esp_tcp_link_t* esp8266_tcp_GetLink( uint8_t link_id );
+
+uint8_t esp8266_tcp_WaitClosed( uint8_t link_mask, uint32_t timeout_ms );
+
+esp_tcp_err_t esp8266_tcp_SetRecvMode( bool passive );
+
+bool esp8266_tcp_IsPassive( void );
+
+esp_tcp_err_t esp8266_tcp_Pull( uint8_t link_id, uint16_t max_len, uint16_t *pLen );
 
 /* *********************************************** */
 
@@ -0,0 +1,409 @@
+#include "esp8266_txq.h"
+#include "esp8266_driver.h"
+
+
+extern UART_HandleTypeDef esp8266_huart;
+
+
+/* ********************************************** */
+static esp_tx_req_t *txq_head = NULL;   // 队首即正在发送的请求.
+static esp_tx_req_t *txq_tail = NULL;
+/* ********************************************** */
+
+
+/* ********************************************** */
+void esp_txq_Prepare( esp_tx_req_t *pReq );
+bool esp_txq_AddSeg( esp_tx_req_t *pReq, const void *data, uint16_t len );
+bool esp_txq_Submit( esp_tx_req_t *pReq );
+bool esp_txq_Wait( esp_tx_req_t *pReq, uint32_t timeout_ms );
+void esp_txq_Cancel( esp_tx_req_t *pReq );
+uint32_t esp_txq_Bytes( const esp_tx_req_t *pReq );
+void esp_txq_TxCpltFromISR( BaseType_t *pxHigherPriorityTaskWoken );
+void esp_txq_ErrorFromISR( BaseType_t *pxHigherPriorityTaskWoken );
+static void txq_Complete( esp_tx_req_t *pReq, bool ok, BaseType_t *pxHigherPriorityTaskWoken );
+static void txq_Kick( BaseType_t *pxHigherPriorityTaskWoken );
+/* ********************************************** */
+
+
+
+
+/**
+ * @brief 初始化请求描述符（清空分段表，完成时通知当前任务）
+ *
+ * 需要完成回调时，在本函数之后、提交之前直接设置 `done` / `ctx`。
+ */
+void esp_txq_Prepare( esp_tx_req_t *pReq )
+{
+  if ( pReq == NULL )
+  {
+    return;
+  }
+
+  memset(pReq, 0, sizeof(*pReq));
+
+  pReq->notify_task = xTaskGetCurrentTaskHandle();
+  pReq->state = ESP_TXQ_IDLE;
+}
+
+
+
+
+/**
+ * @brief 追加一个分段（不拷贝数据）
+ *
+ * @retval true  成功
+ * @retval false 参数非法、分段表已满或请求已提交
+ */
+bool esp_txq_AddSeg( esp_tx_req_t *pReq, const void *data, uint16_t len )
+{
+  if ( pReq == NULL || data == NULL || len == 0 )
+  {
+    return false;
+  }
+
+  if ( pReq->seg_num >= ESP_TXQ_MAX_SEGS || pReq->state == ESP_TXQ_QUEUED || pReq->state == ESP_TXQ_ACTIVE )
+  {
+    return false;
+  }
+
+  pReq->seg[pReq->seg_num].data = (const uint8_t *)data;
+  pReq->seg[pReq->seg_num].len = len;
+  pReq->seg_num++;
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 提交发送请求（不阻塞）
+ *
+ * 请求按提交顺序排队；队列空闲时立即启动 DMA，否则由上一请求的发送完成中断接续。
+ * 各分段直接从调用方缓冲区经 DMA1_Stream4 发出，CPU 在传输期间不参与。
+ *
+ * @param[in,out] pReq 已填充分段的请求（完成前必须保持有效）
+ *
+ * @retval true  已入队（启动失败同样以 ESP_TXQ_ERROR 完成）
+ * @retval false 参数非法、无分段或请求仍在队列中
+ */
+bool esp_txq_Submit( esp_tx_req_t *pReq )
+{
+  if ( pReq == NULL || pReq->seg_num == 0 )
+  {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+
+  if ( pReq->state == ESP_TXQ_QUEUED || pReq->state == ESP_TXQ_ACTIVE )
+  {
+    taskEXIT_CRITICAL();
+
+    return false;
+  }
+
+  pReq->seg_idx = 0;
+  pReq->next = NULL;
+  pReq->state = ESP_TXQ_QUEUED;
+
+  if ( txq_tail == NULL )
+  {
+    txq_head = pReq;
+  }
+  else
+  {
+    txq_tail->next = pReq;
+  }
+
+  txq_tail = pReq;
+
+  txq_Kick(NULL);
+
+  taskEXIT_CRITICAL();
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 等待请求完成（仅限 notify_task 指定的任务调用），超时则取消
+ *
+ * @param[in] pReq       已提交的请求
+ * @param[in] timeout_ms 自调用起的时限（含排队时间）
+ *
+ * @retval true  全部分段已移入 UART
+ * @retval false 出错、被取消或超时
+ */
+bool esp_txq_Wait( esp_tx_req_t *pReq, uint32_t timeout_ms )
+{
+  if ( pReq == NULL )
+  {
+    return false;
+  }
+
+  TickType_t xStart = xTaskGetTickCount();
+  TickType_t xTimeout = pdMS_TO_TICKS(timeout_ms);
+
+  // 同一任务可能有多个请求在途，通知可能来自其它请求，需复查状态.
+  while( pReq->state == ESP_TXQ_QUEUED || pReq->state == ESP_TXQ_ACTIVE )
+  {
+    TickType_t xElapsed = xTaskGetTickCount() - xStart;
+
+    if ( xElapsed >= xTimeout )
+    {
+      esp_txq_Cancel(pReq);
+      break;
+    }
+
+    ulTaskNotifyTakeIndexed(ESP_TXQ_NOTIFY_INDEX, pdTRUE, xTimeout - xElapsed);
+  }
+
+  return ( pReq->state == ESP_TXQ_DONE );
+}
+
+
+
+
+/**
+ * @brief 取消请求：排队中的直接移出，正在发送的中止 DMA 后由下一请求接续
+ *
+ * @note 被取消的请求以 ESP_TXQ_ERROR 完成（回调 / 通知照常发出）；已完成的请求不受影响.
+ */
+void esp_txq_Cancel( esp_tx_req_t *pReq )
+{
+  if ( pReq == NULL )
+  {
+    return;
+  }
+
+  // 屏蔽 UART4 中断，保证中止期间发送完成回调不会接续同一请求.
+  HAL_NVIC_DisableIRQ(UART4_IRQn);
+
+  taskENTER_CRITICAL();
+
+  bool active = ( pReq->state == ESP_TXQ_ACTIVE );
+
+  if ( pReq->state == ESP_TXQ_QUEUED )
+  {
+    esp_tx_req_t *pPrev = NULL;
+
+    for ( esp_tx_req_t *p = txq_head; p != NULL; pPrev = p, p = p->next )
+    {
+      if ( p != pReq )
+      {
+        continue;
+      }
+
+      if ( pPrev == NULL )
+      {
+        txq_head = p->next;
+      }
+      else
+      {
+        pPrev->next = p->next;
+      }
+
+      if ( txq_tail == p )
+      {
+        txq_tail = pPrev;
+      }
+
+      break;
+    }
+
+    txq_Complete(pReq, false, NULL);
+  }
+
+  taskEXIT_CRITICAL();
+
+  if ( active )
+  {
+    HAL_UART_AbortTransmit(&esp8266_huart);
+
+    taskENTER_CRITICAL();
+
+    if ( txq_head == pReq )
+    {
+      txq_head = pReq->next;
+
+      if ( txq_head == NULL )
+      {
+        txq_tail = NULL;
+      }
+
+      txq_Complete(pReq, false, NULL);
+      txq_Kick(NULL);
+    }
+
+    taskEXIT_CRITICAL();
+  }
+
+  HAL_NVIC_EnableIRQ(UART4_IRQn);
+}
+
+
+
+
+/**
+ * @brief 请求的总字节数
+ */
+uint32_t esp_txq_Bytes( const esp_tx_req_t *pReq )
+{
+  uint32_t total = 0;
+
+  if ( pReq == NULL )
+  {
+    return 0;
+  }
+
+  for ( uint8_t i = 0; i < pReq->seg_num; i++ )
+  {
+    total += pReq->seg[i].len;
+  }
+
+  return total;
+}
+
+
+
+
+/**
+ * @brief UART 发送完成处理（在 HAL_UART_TxCpltCallback() 中调用）
+ *
+ * 当前请求还有分段时直接启动下一段，否则完成该请求并启动下一个请求。
+ */
+void esp_txq_TxCpltFromISR( BaseType_t *pxHigherPriorityTaskWoken )
+{
+  UBaseType_t uxSaved = taskENTER_CRITICAL_FROM_ISR();
+
+  esp_tx_req_t *pReq = txq_head;
+
+  if ( pReq != NULL && pReq->state == ESP_TXQ_ACTIVE )
+  {
+    if ( ++pReq->seg_idx < pReq->seg_num )
+    {
+      const esp_tx_seg_t *pSeg = &pReq->seg[pReq->seg_idx];
+
+      if ( HAL_UART_Transmit_DMA(&esp8266_huart, (uint8_t *)pSeg->data, pSeg->len) == HAL_OK )
+      {
+        taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+        return;
+      }
+
+      ISR_LOG(LOG_WARNING, "TXQ", "Segment %lu start failed.", pReq->seg_idx, 0);
+    }
+
+    bool ok = ( pReq->seg_idx >= pReq->seg_num );
+
+    txq_head = pReq->next;
+
+    if ( txq_head == NULL )
+    {
+      txq_tail = NULL;
+    }
+
+    txq_Complete(pReq, ok, pxHigherPriorityTaskWoken);
+    txq_Kick(pxHigherPriorityTaskWoken);
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+}
+
+
+
+
+/**
+ * @brief UART 错误处理（在 HAL_UART_ErrorCallback() 中调用）
+ *
+ * HAL 在 DMA 发送错误时已结束发送（gState 回到 READY）；此时仍处于 ACTIVE 的请求以错误完成，
+ * 并启动下一个请求。仅接收侧出错时发送仍在进行，不做处理。
+ */
+void esp_txq_ErrorFromISR( BaseType_t *pxHigherPriorityTaskWoken )
+{
+  UBaseType_t uxSaved = taskENTER_CRITICAL_FROM_ISR();
+
+  esp_tx_req_t *pReq = txq_head;
+
+  if ( pReq != NULL && pReq->state == ESP_TXQ_ACTIVE && esp8266_huart.gState != HAL_UART_STATE_BUSY_TX )
+  {
+    ISR_LOG(LOG_ERROR, "TXQ", "Transfer error at segment %lu.", pReq->seg_idx, 0);
+
+    txq_head = pReq->next;
+
+    if ( txq_head == NULL )
+    {
+      txq_tail = NULL;
+    }
+
+    txq_Complete(pReq, false, pxHigherPriorityTaskWoken);
+    txq_Kick(pxHigherPriorityTaskWoken);
+  }
+
+  taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+}
+
+
+
+
+// 完成一个请求(已移出队列). pxHigherPriorityTaskWoken 为 NULL 表示任务上下文.
+static void txq_Complete( esp_tx_req_t *pReq, bool ok, BaseType_t *pxHigherPriorityTaskWoken )
+{
+  // 状态一经写入，等待方即可能返回并释放描述符，须先取出通知对象.
+  TaskHandle_t notify_task = pReq->notify_task;
+  esp_txq_done_t done = pReq->done;
+  void *ctx = pReq->ctx;
+
+  pReq->next = NULL;
+  pReq->state = ok ? ESP_TXQ_DONE : ESP_TXQ_ERROR;
+
+  if ( done != NULL )
+  {
+    done(pReq, ok, ctx);
+    return;
+  }
+
+  if ( notify_task == NULL )
+  {
+    return;
+  }
+
+  if ( pxHigherPriorityTaskWoken == NULL )
+  {
+    xTaskNotifyGiveIndexed(notify_task, ESP_TXQ_NOTIFY_INDEX);
+  }
+  else
+  {
+    vTaskNotifyGiveIndexedFromISR(notify_task, ESP_TXQ_NOTIFY_INDEX, pxHigherPriorityTaskWoken);
+  }
+}
+
+
+
+
+// 队首请求尚未启动时启动其第一段；启动失败的请求以错误完成并继续尝试下一个. 须在临界区内调用.
+static void txq_Kick( BaseType_t *pxHigherPriorityTaskWoken )
+{
+  while( txq_head != NULL && txq_head->state == ESP_TXQ_QUEUED )
+  {
+    esp_tx_req_t *pReq = txq_head;
+
+    pReq->state = ESP_TXQ_ACTIVE;
+
+    if ( HAL_UART_Transmit_DMA(&esp8266_huart, (uint8_t *)pReq->seg[0].data, pReq->seg[0].len) == HAL_OK )
+    {
+      return;
+    }
+
+    txq_head = pReq->next;
+
+    if ( txq_head == NULL )
+    {
+      txq_tail = NULL;
+    }
+
+    txq_Complete(pReq, false, pxHigherPriorityTaskWoken);
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef __ESP8266_TXQ_H
+#define __ESP8266_TXQ_H
+
+#include "stm32f4xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+
+
+/* ********************************************** */
+#define ESP_TXQ_MAX_SEGS          ( 8 )        // 单个请求的最大分段数(如 头部 / 负载 / 尾部)，更多分段由 esp8266_SendRawV() 分批提交.
+#define ESP_TXQ_NOTIFY_INDEX      ( 0 )        // 完成通知使用的任务通知下标(与 AT 引擎的 1 号错开).
+/* ********************************************** */
+
+
+// 一段待发送数据. 由调用方持有，请求完成前必须保持有效(可位于 Flash).
+typedef struct
+{
+  const uint8_t *data;
+  uint16_t len;
+
+} esp_tx_seg_t;
+
+
+typedef enum
+{
+  ESP_TXQ_IDLE = 0,        // 未提交或已完成后重新初始化.
+  ESP_TXQ_QUEUED,          // 排队中.
+  ESP_TXQ_ACTIVE,          // 正在发送.
+  ESP_TXQ_DONE,            // 全部分段已移入 UART.
+  ESP_TXQ_ERROR            // 启动失败、传输错误或被取消.
+} esp_txq_state_t;
+
+
+typedef struct esp_tx_req esp_tx_req_t;
+
+// 完成回调. 在中断上下文或临界区内调用，不得阻塞；设置后不再发送任务通知.
+typedef void (*esp_txq_done_t)( esp_tx_req_t *pReq, bool ok, void *ctx );
+
+
+/**
+ * @brief 发送请求描述符（由调用方分配，完成前必须保持有效）.
+ *
+ *  seg / seg_num：分段表，按顺序链式发送，分段之间由发送完成中断直接衔接.
+ *  seg_idx：当前发送到的分段.
+ *  notify_task：完成时通知的任务(ESP_TXQ_NOTIFY_INDEX)，可为 NULL.
+ *  done / ctx：完成回调(可选，优先于任务通知).
+ *  state：见 esp_txq_state_t.
+ *  next：排队链表指针(队列内部使用).
+ */
+struct esp_tx_req
+{
+  esp_tx_seg_t seg[ESP_TXQ_MAX_SEGS];
+  uint8_t seg_num;
+  uint8_t seg_idx;
+  TaskHandle_t notify_task;
+  esp_txq_done_t done;
+  void *ctx;
+  volatile esp_txq_state_t state;
+  esp_tx_req_t *next;
+};
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  void esp_txq_Prepare( esp_tx_req_t *pReq );
+
+  bool esp_txq_AddSeg( esp_tx_req_t *pReq, const void *data, uint16_t len );
+
+  bool esp_txq_Submit( esp_tx_req_t *pReq );
+
+  bool esp_txq_Wait( esp_tx_req_t *pReq, uint32_t timeout_ms );
+
+  void esp_txq_Cancel( esp_tx_req_t *pReq );
+
+  uint32_t esp_txq_Bytes( const esp_tx_req_t *pReq );
+
+  void esp_txq_TxCpltFromISR( BaseType_t *pxHigherPriorityTaskWoken );
+
+  void esp_txq_ErrorFromISR( BaseType_t *pxHigherPriorityTaskWoken );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __ESP8266_TXQ_H
@@ -1,5 +1,6 @@
 #include "esp_http.h"
 #include "esp8266_driver.h"
+#include "boot_prof.h"
 
 /* ******************************** */
 esp_http_err_t http_Init( esp_http_t *__phttp, uint8_t method );
@@ -10,11 +11,29 @@ esp_http_err_t http_SetPath( esp_http_t *__phttp, const char *path );
 
 esp_http_err_t http_AddHeader( esp_http_t *__phttp, const char *header );
 
-esp_http_err_t http_RequestBuild( esp_http_t *__phttp, char *out_buf, uint16_t out_buf_size );
+esp_http_err_t http_AddQuery( esp_http_t *__phttp, const char *key, const char *value );
+
+esp_http_err_t http_SetBody( esp_http_t *__phttp, const char *content_type, const void *body, uint16_t body_len );
+
+esp_http_err_t http_SetTransferMode( esp_http_t *__phttp, uint8_t mode );
+
+esp_http_err_t http_SetKeepAlive( esp_http_t *__phttp, bool enable );
+
+esp_http_err_t http_SetCompression( esp_http_t *__phttp, bool enable );
+
+esp_http_err_t http_SetCache( esp_http_t *__phttp, bool enable );
+
+esp_http_err_t http_RequestBuild( esp_http_t *__phttp );
 
 esp_http_err_t http_Get( esp_http_t *__phttp, char *out_json_body, uint16_t out_json_body_buf_size );
 
-bool http_extract_json_body( const char* http_response, char *out_json, uint16_t out_json_size );
+esp_http_err_t http_Send( esp_http_t *__phttp, char *out_body, uint16_t out_body_size, uint16_t *pStatus );
+
+esp_http_err_t http_GetStream( esp_http_t *__phttp, const http_parser_ops_t *ops, void *ctx, uint16_t *pStatus );
+
+void http_GetStats( esp_http_stats_t *pStats );
+
+bool http_extract_json_body( const char* http_response, uint16_t response_len, char *out_json, uint16_t out_json_size );
 
 esp_http_err_t http_json_getCity( const char *json_body, char *out_city, uint16_t out_city_buf_len );
 
@@ -25,6 +44,42 @@ esp_http_err_t http_json_getNum( const char *json_main, const char **key_paths,
 static void safety_strncpy( char *dest, const char *source, size_t length );
 
 static bool json_util_extractQuotes( const char *source, char *out_str, uint16_t buf_len );
+
+static void http_BodySink( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain );
+
+static void http_CollectBody( void *ctx, const uint8_t *data, uint16_t len );
+
+static bool http_ReqAdd( const void *data, uint16_t len );
+
+static bool http_ReqAddQuery( const char *str );
+
+static bool http_IsUnreserved( uint8_t c );
+
+static uint16_t http_FormatLength( char *out, uint16_t value );
+
+static esp_http_err_t http_ExchangePassthrough( const esp_tx_seg_t *frag, uint8_t frag_num, http_parser_t *pParser );
+
+static esp_http_err_t http_ExchangeNormal( const esp_tx_seg_t *frag, uint8_t frag_num, http_parser_t *pParser, bool *pClosed );
+
+static bool http_PullPassive( const http_parser_t *pParser );
+
+static esp_http_err_t http_ConnAcquire( const char *host, bool *pReused );
+
+static void http_ConnRelease( const http_parser_t *pParser, bool closed, bool keep_alive );
+
+static void http_DecodeStatus( void *ctx, uint16_t code );
+
+static void http_DecodeHeader( void *ctx, const char *name, const char *value );
+
+static void http_DecodeHeadersDone( void *ctx );
+
+static void http_DecodeBody( void *ctx, const uint8_t *data, uint16_t len );
+
+static void http_DecodeComplete( void *ctx );
+
+static void http_DecodeOut( void *ctx, const uint8_t *data, uint16_t len );
+
+static esp_http_err_t http_DecodeEnd( const http_parser_t *pParser );
 /* ******************************** */
 
 
@@ -33,6 +88,74 @@ static char JsonBody[1024];
 
 extern ESP8266_HandleTypeDef hesp8266;
 
+// http_Get() 的响应体收集上下文: body 流式写入调用者缓冲区(超出部分截断).
+typedef struct
+{
+  char *out;
+  uint16_t out_size;
+  uint16_t out_len;
+
+} http_collect_t;
+
+
+static const http_parser_ops_t http_collect_ops = { NULL, NULL, NULL, http_CollectBody, NULL };
+
+
+// http_GetStream() 的解码层: 位于响应解析器与调用者的 ops 之间，按 Content-Encoding 解压响应体.
+static struct
+{
+  const http_parser_t *parser;
+  const http_parser_ops_t *ops;     // 调用者的消费方.
+  void *ctx;
+  uint8_t encoding;                 // HTTP_PARSER_ENC_*，头部结束时确定.
+  bool revalidate;                  // 请求携带了缓存的校验字段.
+  bool not_modified;                // 304: 响应本身不交给调用者，结束后改为投递缓存.
+  uint32_t body_wire;               // 解码前的响应体字节数.
+  uint32_t body;                    // 交给调用者的响应体字节数.
+
+} http_dec;
+
+static const http_parser_ops_t http_decode_ops =
+{
+  http_DecodeStatus, http_DecodeHeader, http_DecodeHeadersDone, http_DecodeBody, http_DecodeComplete
+};
+
+// 当前请求的分段表(iovec). 各段指向常量片段或调用者的字符串，由 DMA 直接发送；同一时刻仅一个请求.
+static struct
+{
+  esp_tx_seg_t frag[HTTP_REQ_FRAG_MAX];
+  uint8_t frag_num;
+  http_cache_key_t cache_key;         // 请求目标的缓存键，Hash 为 0 表示不缓存.
+  char clen[8];                       // Content-Length 的值 + "\r\n".
+  char qenc[HTTP_QUERY_ENC_MAX];      // 查询参数的百分号编码结果.
+  uint16_t qenc_len;
+
+} http_req;
+
+// 请求行的方法部分(含空格)，下标为 HTTP_METHOD_*.
+static const esp_tx_seg_t http_method_seg[] =
+{
+  { (const uint8_t *)"GET ", 4U }, { (const uint8_t *)"POST ", 5U }, { (const uint8_t *)"PUT ", 4U }
+};
+
+// 追加常量片段(字符串字面量，长度在编译期确定).
+#define HTTP_REQ_CONST(s)     http_ReqAdd((s), (uint16_t)( sizeof(s) - 1U ))
+
+static http_inflate_t http_inf;             // 解码窗口与码表(同一时刻仅一个请求).
+static bool http_inflate_ok = true;         // 解码失败(如窗口不足)后不再请求压缩.
+static esp_http_stats_t http_stats;
+
+
+// 长连接缓存. 单连接模式(CIPMUX=0)下模块只有一条 TCP 链路，按主机记录其可复用性与空闲期限.
+static struct
+{
+  char host[HTTP_HOST_MAX_LEN];
+  bool reusable;         // 上一响应已完整接收且服务器未要求关闭.
+  uint32_t idle_ms;      // 空闲复用上限.
+  TickType_t last_used;
+  uint32_t reuse_cnt;
+
+} http_conn = { { 0 }, false, HTTP_KEEPALIVE_IDLE_MS, 0, 0 };
 /* ******************************** */
 
 
@@ -123,26 +246,24 @@ static void safety_strncpy( char *dest, const char *source, size_t length )
 /**
  * @brief 初始化 HTTP 请求结构体，重置所有字段为安全默认值
  * 
- * 此函数将 __phttp 所有成员清零（包括 host/path/headers 缓冲区），并设置：
- *   - method：根据入参 method 非零值选择 HTTP_METHOD_POST 或 HTTP_METHOD_GET
+ * 此函数将 __phttp 所有成员清零（host/path/头部/查询参数/请求体引用均被清除），并设置：
+ *   - method：HTTP_METHOD_GET / HTTP_METHOD_POST / HTTP_METHOD_PUT
  *   - http_version：固定为 HTTP_VERSION_1_1（当前唯一支持版本）
  *   - total_len：初始化为 0（表示尚未构建请求）
  * 
  * ⚠️ 注意：该函数不执行任何网络操作，仅做内存初始化。
  * 
  * @param __phttp 指向待初始化的 esp_http_t 结构体指针（必须非 NULL）
- * @param method  方法标识符：
- *                - 0 → 设置为 HTTP_METHOD_GET（默认）
- *                - 非 0 → 设置为 HTTP_METHOD_POST（预留扩展，当前 GET 专用）
+ * @param method  请求方法（HTTP_METHOD_*）；POST / PUT 的请求体由 http_SetBody() 设置
  * @return ESP_HTTP_OK           成功初始化（__phttp 已就绪）
- * @return ESP_HTTP_ERR_INVALID_ARGS  __phttp 为 NULL
+ * @return ESP_HTTP_ERR_INVALID_ARGS  __phttp 为 NULL 或 method 未知
  * 
  * @note 调用后必须依次调用 http_SetHost() 和 http_SetPath() 才能构建有效请求。
  * @see http_SetHost(), http_SetPath(), http_RequestBuild()
  */
 esp_http_err_t http_Init( esp_http_t *__phttp, uint8_t method )
 {
-  if ( !__phttp )
+  if ( !__phttp || method > HTTP_METHOD_PUT )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("Wrong Param of http_Init.\n");
@@ -154,16 +275,11 @@ esp_http_err_t http_Init( esp_http_t *__phttp, uint8_t method )
 
   memset(__phttp, 0, sizeof(esp_http_t));
 
-  if ( method )
-  {
-    __phttp->method = HTTP_METHOD_POST;
-  }
-  else 
-  {
-    __phttp->method = HTTP_METHOD_GET;
-  }
-
+  __phttp->method = method;
   __phttp->http_version = HTTP_VERSION_1_1;
+  __phttp->keep_alive = 1;
+  __phttp->accept_gzip = 0;
+  __phttp->use_cache = 1;
 
   return ESP_HTTP_OK;
 }
@@ -174,25 +290,25 @@ esp_http_err_t http_Init( esp_http_t *__phttp, uint8_t method )
 /**
  * @brief 设置 HTTP 请求的目标主机（Host header 及 TCP 连接地址）
  * 
- * 此函数将 host 字符串安全拷贝至 __phttp->host 缓冲区，并执行基础校验：
+ * 此函数记录 host 字符串的指针与长度（不拷贝），并执行基础校验：
  *   - 检查指针非空；
- *   - 使用 safety_strncpy 截断防溢出（最大 HTTP_HOST_MAX_LEN-1 字节 + '\0'）；
- *   - 确保拷贝后 host 非空字符串（拒绝纯空白或空串）。
+ *   - 拒绝空串与超过 HTTP_HOST_MAX_LEN-1 字节的主机名（长连接缓存按该长度记录主机名）。
  * 
  * ⚠️ 注意：
  *   - host 不含端口（如填 "api.seniverse.com"，而非 "api.seniverse.com:80"）；
+ *   - host 须在请求完成前保持有效（请求报文直接由 DMA 从该字符串发送）；
  *   - 该值将用于：
  *         • 构建 "Host: xxx" HTTP header；
  *         • 调用 esp8266_tcp_Connect() 时作为域名参数；
- *   - 若 host 含非法字符（如空格、控制符），safety_strncpy 仍会拷贝，但后续
- *     TCP 连接或 DNS 解析可能失败（此层不校验字符合法性，由底层驱动处理）。
+ *   - 此层不校验字符合法性，由底层驱动处理。
  * 
  * @param __phttp 指向已初始化的 esp_http_t 结构体（非 NULL）
  * @param host    目标主机名字符串（非 NULL，且以 '\0' 结尾，推荐 ASCII 域名）
  * 
- * @return ESP_HTTP_OK           成功设置（host 已写入且非空）
+ * @return ESP_HTTP_OK           成功设置
  * @return ESP_HTTP_ERR_INVALID_ARGS  __phttp 或 host 为 NULL
- * @return ESP_HTTP_ERR_SET_VAL      host 拷贝后为空字符串（如传入 ""、"   "、"\t\n"）
+ * @return ESP_HTTP_ERR_SET_VAL      host 为空字符串
+ * @return ESP_HTTP_ERR_BUF_OVRFLW   host 过长
  * 
  * @note 调用前请确保已调用 http_Init() 初始化结构体。
  * @see http_Init(), http_RequestBuild(), esp8266_tcp_Connect()
@@ -209,9 +325,9 @@ esp_http_err_t http_SetHost( esp_http_t *__phttp, const char *host )
     return ESP_HTTP_ERR_INVALID_ARGS;
   } 
 
-  safety_strncpy(__phttp->host, host, sizeof(__phttp->host));
+  size_t len = strlen(host);
 
-  if ( strlen(__phttp->host) == 0 )
+  if ( len == 0 )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("Http set host error. Empty host.\n");
@@ -221,6 +337,15 @@ esp_http_err_t http_SetHost( esp_http_t *__phttp, const char *host )
     return ESP_HTTP_ERR_SET_VAL;
   } 
 
+  if ( len >= HTTP_HOST_MAX_LEN )
+  {
+    LOG_WRITE(LOG_ERROR, "HTTP", "Http set host error. Host too long (%u).", (unsigned)len);
+    return ESP_HTTP_ERR_BUF_OVRFLW;
+  }
+
+  __phttp->host = host;
+  __phttp->host_len = (uint16_t)len;
+
   return ESP_HTTP_OK;
 }
 
@@ -228,23 +353,21 @@ esp_http_err_t http_SetHost( esp_http_t *__phttp, const char *host )
 
 
 /**
- * @brief 设置 HTTP 请求路径（URL 的 path + query 部分）
+ * @brief 设置 HTTP 请求路径（URL 的 path 部分，可直接携带 query）
  * 
- * 此函数将 `path` 字符串安全拷贝至 `__phttp->path` 缓冲区，并执行以下检查：
+ * 此函数记录 `path` 的指针与长度（不拷贝），并执行以下检查：
  *   - 输入指针非 NULL；
  *   - `path` 必须以 '/' 开头（如 "/v3/weather/now.json"）；
- *   - 拷贝后自动截断并补 '\0'，防止缓冲区溢出；
- *   - 拷贝结果非空（拒绝仅含空白或全 '\0' 的输入）。
+ *   - 长度不超过 65535 字节。
  * 
  * @param __phttp 指向已初始化的 esp_http_t 结构体（必须非 NULL）
- * @param path    请求路径字符串，格式为 "/xxx"（必须以 '/' 开头），支持 query 参数  
- *                （例如："/v3/weather/now.json?key=abc&location=shanghai"）
+ * @param path    请求路径字符串，格式为 "/xxx"（必须以 '/' 开头），可直接携带已编码的 query 参数  
+ *                （例如："/v3/weather/now.json?key=abc&location=shanghai"），也可由 http_AddQuery() 追加
  * @return        ESP_HTTP_OK          成功设置  
  *                ESP_HTTP_ERR_INVALID_ARGS  输入指针为空 或 path 不以 '/' 开头  
- *                ESP_HTTP_ERR_SET_VAL       拷贝后路径为空（无效字符串）  
- *                （注：不返回 ESP_HTTP_ERR_BUF_OVRFLW —— 截断由 safety_strncpy 内部处理）
+ *                ESP_HTTP_ERR_BUF_OVRFLW    路径过长
  *
- * @note 该函数是纯内存操作，不触发网络通信；线程安全（无全局状态依赖）。
+ * @note 该函数是纯内存操作，不触发网络通信；path 须在请求完成前保持有效。
  */
 esp_http_err_t http_SetPath( esp_http_t *__phttp, const char *path )
 {
@@ -268,17 +391,16 @@ esp_http_err_t http_SetPath( esp_http_t *__phttp, const char *path )
     return ESP_HTTP_ERR_INVALID_ARGS;
   } 
 
-  safety_strncpy(__phttp->path, path, sizeof(__phttp->path));
+  size_t len = strlen(path);
 
-  if ( strlen(__phttp->path) == 0 )
+  if ( len > 0xFFFFU )
   {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("Http set path error. Empty path.\n");
-    #endif              
+    LOG_WRITE(LOG_ERROR, "HTTP", "set_path: path too long.");
+    return ESP_HTTP_ERR_BUF_OVRFLW;
+  }
 
-    LOG_WRITE(LOG_ERROR, "HTTP", "Http set path error. Empty path.");
-    return ESP_HTTP_ERR_SET_VAL;
-  } 
+  __phttp->path = path;
+  __phttp->path_len = (uint16_t)len;
 
   return ESP_HTTP_OK;
 }
@@ -289,31 +411,29 @@ esp_http_err_t http_SetPath( esp_http_t *__phttp, const char *path )
 /**
  * @brief 向 HTTP 请求中追加一条自定义请求头（Header），支持多次调用
  *
- * 此函数将 header 字符串（如 "User-Agent: WeatherClock/1.0"）安全添加到
- * __phttp->extra_headers 缓冲区末尾，并自动添加 "\r\n" 分隔符。
- * 若为首次添加，则不前置换行；若已有内容，则先追加 "\r\n" 再写入新 header。
+ * 此函数记录 header 字符串（如 "User-Agent: WeatherClock/1.0"）的指针与长度，构建请求时
+ * 作为一个分段直接发送，并在其后追加 "\r\n"。
  *
  * ✅ 特性：
- *   - 自动长度校验，防止缓冲区溢出（HTTP_EXTRA_HEAD_MAX_LEN）
+ *   - 最多 HTTP_HEADER_MAX 条，超出返回 ESP_HTTP_ERR_BUF_OVRFLW
  *   - 空指针与空字符串防护
- *   - 严格遵循 HTTP/1.1 头部格式（不添加额外空格或换行）
- *   - 零动态内存分配，全栈操作，线程安全（前提：调用者确保 __phttp 不被并发修改）
+ *   - 零拷贝：header 须在请求完成前保持有效（可为字符串常量）
  *
  * ⚠️ 注意：
- *   - header 参数 **不应包含结尾的 "\r\n"**（函数会自动添加）
+ *   - header 参数 **不应包含结尾的 "\r\n"**（构建时自动添加）
  *   - header 中若含双引号、逗号等特殊字符，需由调用者保证其符合 HTTP 字段值语法
- *   - 调用后需再次调用 http_RequestBuild() 才能使新 header 生效
+ *   - 请求体的 Content-Type / Content-Length 由 http_SetBody() 生成，无需在此添加
  *
  * @param __phttp 指向已初始化的 esp_http_t 结构体（非 NULL）
  * @param header  待添加的头部字符串，格式为 "Key: Value"（例如："Accept: application/json"）
  *
  * @return ESP_HTTP_OK           成功添加
- * @return ESP_HTTP_ERR_INVALID_ARGS  __phttp 或 header 为 NULL
- * @return ESP_HTTP_ERR_BUF_OVRFLW   缓冲区不足，无法容纳 header + "\r\n"
+ * @return ESP_HTTP_ERR_INVALID_ARGS  __phttp 或 header 为 NULL，或 header 为空串
+ * @return ESP_HTTP_ERR_BUF_OVRFLW   已达 HTTP_HEADER_MAX 条
  */
 esp_http_err_t http_AddHeader( esp_http_t *__phttp, const char *header )
 {
-  if ( !__phttp || !header )
+  if ( !__phttp || !header || header[0] == '\0' )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("Wrong Param of http_AddHeader.\n");
@@ -323,27 +443,88 @@ esp_http_err_t http_AddHeader( esp_http_t *__phttp, const char *header )
     return ESP_HTTP_ERR_INVALID_ARGS;
   }
 
-  size_t current_len = strlen(__phttp->extra_headers);
-  size_t header_len = strlen(header);
-  size_t need_len = current_len + header_len + 2; // 留出 /r/n.
-
-  if ( need_len >= sizeof(__phttp->extra_headers) )
+  if ( __phttp->header_num >= HTTP_HEADER_MAX )
   {
     #if defined(__DEBUG_LEVEL_1__)
-      printf("add_header: overflow (need %u)\n", (unsigned)need_len);
+      printf("add_header: overflow (max %u)\n", (unsigned)HTTP_HEADER_MAX);
     #endif          
 
-    LOG_WRITE(LOG_ERROR, "HTTP", "add_header: overflow (need %u)\n", (unsigned)need_len);
+    LOG_WRITE(LOG_ERROR, "HTTP", "add_header: overflow (max %u)\n", (unsigned)HTTP_HEADER_MAX);
     return ESP_HTTP_ERR_BUF_OVRFLW;
   } 
 
-  // 自动换行.
-  if ( current_len > 0 )
+  esp_tx_seg_t *pSeg = &__phttp->headers[__phttp->header_num];
+
+  pSeg->data = (const uint8_t *)header;
+  pSeg->len = (uint16_t)strlen(header);
+
+  __phttp->header_num++;
+
+  return ESP_HTTP_OK;
+}
+
+
+
+
+/**
+ * @brief 追加一个查询参数（构建时按 RFC 3986 百分号编码）
+ *
+ * 参数依次以 '?' / '&' 接在 path 之后（path 已带 '?' 时均以 '&' 连接）. 只含非保留字符
+ * （字母、数字、"-._~"）的 key / value 直接引用调用者的字符串发送，其余在构建时编码到内部缓冲区
+ * （总长上限 HTTP_QUERY_ENC_MAX）.
+ *
+ * @param[in] key   参数名（非空）
+ * @param[in] value 参数值（可为空串；须在请求完成前保持有效）
+ *
+ * @return ESP_HTTP_OK / ESP_HTTP_ERR_INVALID_ARGS / ESP_HTTP_ERR_BUF_OVRFLW（已达 HTTP_QUERY_MAX 个）
+ */
+esp_http_err_t http_AddQuery( esp_http_t *__phttp, const char *key, const char *value )
+{
+  if ( !__phttp || !key || !value || key[0] == '\0' )
+  {
+    LOG_WRITE(LOG_WARNING, "HTTP", "Wrong Param of http_AddQuery.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  }
+
+  if ( __phttp->query_num >= HTTP_QUERY_MAX )
+  {
+    LOG_WRITE(LOG_ERROR, "HTTP", "add_query: overflow (max %u)", (unsigned)HTTP_QUERY_MAX);
+    return ESP_HTTP_ERR_BUF_OVRFLW;
+  }
+
+  __phttp->query[__phttp->query_num].key = key;
+  __phttp->query[__phttp->query_num].value = value;
+  __phttp->query_num++;
+
+  return ESP_HTTP_OK;
+}
+
+
+
+
+/**
+ * @brief 设置 POST / PUT 的请求体（不拷贝，由 DMA 直接发送）
+ *
+ * 构建请求时自动生成 "Content-Length: <body_len>"，content_type 非 NULL 时生成 "Content-Type: ..."。
+ * body_len 为 0 时发送空请求体（Content-Length: 0）.
+ *
+ * @param[in] content_type 如 "application/json"（可为 NULL）
+ * @param[in] body         请求体（body_len 非 0 时非 NULL；须在请求完成前保持有效）
+ * @param[in] body_len     请求体长度
+ *
+ * @return ESP_HTTP_OK / ESP_HTTP_ERR_INVALID_ARGS（参数非法，或请求方法为 GET）
+ */
+esp_http_err_t http_SetBody( esp_http_t *__phttp, const char *content_type, const void *body, uint16_t body_len )
+{
+  if ( !__phttp || ( body == NULL && body_len != 0 ) || __phttp->method == HTTP_METHOD_GET )
   {
-    strcat(__phttp->extra_headers, "\r\n");
+    LOG_WRITE(LOG_WARNING, "HTTP", "Wrong Param of http_SetBody.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
   }
 
-  strcat(__phttp->extra_headers, header);
+  __phttp->content_type = content_type;
+  __phttp->body = (const uint8_t *)body;
+  __phttp->body_len = body_len;
 
   return ESP_HTTP_OK;
 }
@@ -352,47 +533,36 @@ esp_http_err_t http_AddHeader( esp_http_t *__phttp, const char *header )
 
 
 /**
- * @brief 构建标准 HTTP/1.1 GET 请求报文（不含请求体），用于后续 esp8266_tcp_Send()
+ * @brief 将请求组装为分段表（iovec），用于后续 esp8266_tcp_SendV()
  *
- * 此函数将当前 esp_http_t 配置（host/path/headers）组装为符合 RFC 7230 的
- * 完整 HTTP 请求行 + 头部字段，格式如下：
- *   GET /path HTTP/1.1\r\n
+ * 请求行与各头部由常量片段和调用者的字符串拼接而成，不经过 snprintf，也不拷贝到请求缓冲区：
+ *   <METHOD> /path[?k=v&...] HTTP/1.1\r\n
  *   Host: example.com\r\n
- *   Connection: close\r\n
- *   [Custom Headers...]\r\n
+ *   Connection: keep-alive\r\n            （长连接关闭或透传方式时为 close）
+ *   [Accept-Encoding: ...\r\n]            （见 http_SetCompression()）
+ *   [If-None-Match / If-Modified-Since]   （GET 且有缓存时，值直接引用缓存条目）
+ *   [Custom Headers...\r\n]
+ *   [Content-Type: ...\r\n]               （POST / PUT）
+ *   [Content-Length: n\r\n]               （POST / PUT）
  *   \r\n
+ *   [body]
  *
- * ✅ 关键保障：
- *   - 严格校验输入参数（NULL / 零长度 / TCP 连接状态）
- *   - 预计算最小所需缓冲区大小，防止 snprintf 截断或溢出
- *   - 自动添加必要头部（Host, Connection: close），无需手动设置
- *   - 支持空 extra_headers（不插入多余 "\r\n"）
- *   - 输出字符串以 '\0' 结尾，且 __phttp->total_len 精确记录有效字节数（含 '\0' 前）
- *
- * ⚠️ 重要约束：
- *   - 仅支持 GET 方法（POST 返回 ESP_HTTP_ERR_INVALID_ARGS，预留扩展）
- *   - 不生成 Content-Length 或 Transfer-Encoding（GET 无 body）
- *   - Host 字段值直接取自 __phttp->host（不自动补端口，若需端口请写为 "api.seniverse.com:80"）
- *   - out_buf 必须是可写内存，且 out_buf_size ≥ min_need + 1（snprintf 安全要求）
+ * 只有须百分号编码的查询参数与 Content-Length 的数值写入内部缓冲区. 分段表为模块内单例，
+ * 在下一次构建之前有效（同一时刻只有一个请求）.
  *
  * 📌 调用前提：
  *   - 已调用 http_Init() + http_SetHost() + http_SetPath()（至少 host/path 非空）
- *   - TCP 已处于 ESP_TCP_STATE_CONNECTED 状态（否则返回 ESP_HTTP_ERR_OFFLINE）
- *   - 若添加了自定义 header，需确保其格式合法（如 "Key: Value"，不含结尾 \r\n）
- *
- * @param __phttp     指向已配置的 esp_http_t 实例（非 NULL）
- * @param out_buf     输出缓冲区地址（用于存放构建好的 HTTP 请求字符串）
- * @param out_buf_size out_buf 总字节数（必须 ≥ 128，建议 ≥ 512）
- *
- * @return ESP_HTTP_OK              构建成功，out_buf 中已存入完整请求报文
- * @return ESP_HTTP_ERR_INVALID_ARGS 参数非法（NULL / host/path 为空 / method 非 GET）
- * @return ESP_HTTP_ERR_OFFLINE      TCP 未连接（需先调用 esp8266_tcp_Connect()）
- * @return ESP_HTTP_ERR_BUF_OVRFLW   out_buf_size 不足以容纳请求（min_need ≥ out_buf_size）
- * @return ESP_HTTP_ERR_BUILD_REQ    snprintf 内部失败（极罕见，通常因 out_buf 无效或内存损坏）
+ *   - 本函数不访问网络，连接由 http_GetStream() 在发送前建立
+ *
+ * @param __phttp 指向已配置的 esp_http_t 实例（非 NULL）
+ *
+ * @return ESP_HTTP_OK              构建成功，__phttp->total_len 为请求报文总长
+ * @return ESP_HTTP_ERR_INVALID_ARGS 参数非法（NULL / host/path 未设置 / 方法未知）
+ * @return ESP_HTTP_ERR_BUF_OVRFLW   分段表或编码缓冲区不足，或报文超过 65535 字节
  */
-esp_http_err_t http_RequestBuild( esp_http_t *__phttp, char *out_buf, uint16_t out_buf_size )
+esp_http_err_t http_RequestBuild( esp_http_t *__phttp )
 {
-  if ( !__phttp || !out_buf || out_buf_size == 0 )
+  if ( !__phttp )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("Wrong Param of http_RequestBuild.\n");
@@ -402,69 +572,199 @@ esp_http_err_t http_RequestBuild( esp_http_t *__phttp, char *out_buf, uint16_t o
     return ESP_HTTP_ERR_INVALID_ARGS;
   }
 
-  if ( esp8266_tcp_getState()->is_Connected == false || esp8266_tcp_getState()->state != ESP_TCP_STATE_CONNECTED )
+  if ( __phttp->host_len == 0 || __phttp->path_len == 0 || __phttp->method > HTTP_METHOD_PUT )
   {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("TCP Connect not detected. http_RequestBuild() called failed.\n");
-    #endif      
+    LOG_WRITE(LOG_WARNING, "HTTP", "build: host or path not set.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  }
 
-    LOG_WRITE(LOG_WARNING, "HTTP", "No TCP Con. RequestBuild() called fail.");
-    return ESP_HTTP_ERR_OFFLINE;
+  // 透传方式以接收空闲判定响应结束，不使用长连接.
+  bool keep_alive = ( __phttp->keep_alive != 0 ) && ( __phttp->transfer_mode == HTTP_TRANSFER_NORMAL );
+  bool gzip = ( __phttp->accept_gzip != 0 ) && http_inflate_ok;
+  bool has_body = ( __phttp->method != HTTP_METHOD_GET );
+  bool ok = true;
+
+  http_req.frag_num = 0;
+  http_req.qenc_len = 0;
+
+  // 请求目标: path + 查询参数. 只有 GET 响应参与缓存，键由请求目标逐段累加.
+  ok &= http_ReqAdd(http_method_seg[__phttp->method].data, http_method_seg[__phttp->method].len);
+  ok &= http_ReqAdd(__phttp->path, __phttp->path_len);
+
+  uint8_t target_first = (uint8_t)( http_req.frag_num - 1U );
+  bool has_query = ( memchr(__phttp->path, '?', __phttp->path_len) != NULL );
+
+  for ( uint8_t i = 0; i < __phttp->query_num; i++ )
+  {
+    ok &= ( has_query || i > 0 ) ? HTTP_REQ_CONST("&") : HTTP_REQ_CONST("?");
+    ok &= http_ReqAddQuery(__phttp->query[i].key);
+    ok &= HTTP_REQ_CONST("=");
+    ok &= http_ReqAddQuery(__phttp->query[i].value);
   }
 
-  if ( strlen(__phttp->host) == 0 || strlen(__phttp->path) == 0 )
+  http_cache_Key(&http_req.cache_key, ( __phttp->use_cache && !has_body ) ? __phttp->host : NULL);
+
+  for ( uint8_t i = target_first; ok && i < http_req.frag_num; i++ )
   {
-    LOG_WRITE(LOG_WARNING, "HTTP", "build: host or path not set.");
-    return ESP_HTTP_ERR_INVALID_ARGS;
+    http_cache_KeyAdd(&http_req.cache_key, http_req.frag[i].data, http_req.frag[i].len);
   }
 
-  if ( __phttp->method == HTTP_METHOD_POST )
+  ok &= HTTP_REQ_CONST(" HTTP/1.1\r\nHost: ");
+  ok &= http_ReqAdd(__phttp->host, __phttp->host_len);
+  ok &= keep_alive ? HTTP_REQ_CONST("\r\nConnection: keep-alive\r\n") : HTTP_REQ_CONST("\r\nConnection: close\r\n");
+
+  if ( gzip )
   {
-    return ESP_HTTP_ERR_INVALID_ARGS;
+    ok &= HTTP_REQ_CONST("Accept-Encoding: " HTTP_ACCEPT_ENCODING "\r\n");
+  }
+
+  // 有缓存时携带校验字段(直接引用缓存条目).
+  const char *etag = NULL;
+  const char *last_mod = NULL;
+
+  if ( http_req.cache_key.Hash != 0 && http_cache_Validators(&http_req.cache_key, &etag, &last_mod) )
+  {
+    if ( etag != NULL )
+    {
+      ok &= HTTP_REQ_CONST("If-None-Match: ");
+      ok &= http_ReqAdd(etag, (uint16_t)strlen(etag));
+      ok &= HTTP_REQ_CONST("\r\n");
+    }
+
+    if ( last_mod != NULL )
+    {
+      ok &= HTTP_REQ_CONST("If-Modified-Since: ");
+      ok &= http_ReqAdd(last_mod, (uint16_t)strlen(last_mod));
+      ok &= HTTP_REQ_CONST("\r\n");
+    }
+  }
+
+  for ( uint8_t i = 0; i < __phttp->header_num; i++ )
+  {
+    ok &= http_ReqAdd(__phttp->headers[i].data, __phttp->headers[i].len);
+    ok &= HTTP_REQ_CONST("\r\n");
+  }
+
+  if ( has_body )
+  {
+    if ( __phttp->content_type != NULL )
+    {
+      ok &= HTTP_REQ_CONST("Content-Type: ");
+      ok &= http_ReqAdd(__phttp->content_type, (uint16_t)strlen(__phttp->content_type));
+      ok &= HTTP_REQ_CONST("\r\n");
+    }
+
+    ok &= HTTP_REQ_CONST("Content-Length: ");
+    ok &= http_ReqAdd(http_req.clen, http_FormatLength(http_req.clen, __phttp->body_len));
+  }
+
+  ok &= HTTP_REQ_CONST("\r\n");
+
+  uint8_t head_num = http_req.frag_num;
+
+  if ( has_body )
+  {
+    ok &= http_ReqAdd(__phttp->body, __phttp->body_len);
   }
 
-  // "GET /path HTTP/1.1\r\nHost: ...\r\nConnection: close\r\n[headers]\r\n\r\n"
-  size_t min_need = 
-          4U +                            // "GET "
-          strlen(__phttp->path) +         // "/path"
-          11U +                           // " HTTP/1.1\r\n"
-          6U +                            // "Host: "
-          strlen(__phttp->host) + 2U +    // ".../r/n"
-          19U +                           // "Connection: close\r\n"
-          strlen(__phttp->extra_headers) +  // "[headers]"
-          2U +                              // "[\r\n]"
-          1U;                               // "'\0'"
+  uint32_t total = 0;
+
+  for ( uint8_t i = 0; i < http_req.frag_num; i++ )
+  {
+    total += http_req.frag[i].len;
+  }
 
-  if ( min_need >= out_buf_size )
+  if ( !ok || total > 0xFFFFU )
   {
     #if defined(__DEBUG_LEVEL_1__)
-      printf("build: buf too small (need %u, have %u)", (unsigned)min_need, (unsigned)out_buf_size);
+      printf("build: request too large (%u frags, %lu bytes)\n", (unsigned)http_req.frag_num, (unsigned long)total);
     #endif 
 
-    LOG_WRITE(LOG_ERROR, "HTTP", "requestbuf too small(need %u,have %u)",(unsigned)min_need, (unsigned)out_buf_size);
+    LOG_WRITE(LOG_ERROR, "HTTP", "request too large (%u frags, %lu bytes)", (unsigned)http_req.frag_num, (unsigned long)total);
     return ESP_HTTP_ERR_BUF_OVRFLW;
   } 
 
-  int len = snprintf(out_buf, out_buf_size, 
-                      "GET %s HTTP/1.1\r\n"
-                      "Host: %s\r\n"
-                      "Connection: close\r\n"
-                      "%s%s\r\n", __phttp->path, __phttp->host, (__phttp->extra_headers[0] != '\0') ? __phttp->extra_headers : "",
-                                                                  (__phttp->extra_headers[0] != '\0') ? "\r\n" : "" );
+  #if defined(__DEBUG_LEVEL_1__)
+    for ( uint8_t i = 0; i < head_num; i++ )
+    {
+      printf("%.*s", (int)http_req.frag[i].len, (const char *)http_req.frag[i].data);
+    }
+  #endif // __DEBUG_LEVEL_1__
+
+  __phttp->total_len = (uint16_t)total;
+
+  return ESP_HTTP_OK;
+}
+
+
+
+
+
+/**
+ * @brief 设置请求的传输方式
+ *
+ * @param[in] __phttp 请求对象
+ * @param[in] mode    HTTP_TRANSFER_NORMAL（默认）或 HTTP_TRANSFER_PASSTHROUGH
+ *
+ * @note 透传方式省去逐包 `+IPD` 封装与 `AT+CIPSEND` / `>` 往返，适合预报、资源下载等大响应体；
+ *       代价是进入/退出透传各需约 `ESP_TCP_PT_GUARD_MS` 的静默时间，小请求不宜使用.
+ */
+esp_http_err_t http_SetTransferMode( esp_http_t *__phttp, uint8_t mode )
+{
+  if ( !__phttp || mode > HTTP_TRANSFER_PASSTHROUGH )
+  {
+    LOG_WRITE(LOG_WARNING, "HTTP", "Wrong Param of http_SetTransferMode.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  }
+
+  __phttp->transfer_mode = mode;
+
+  return ESP_HTTP_OK;
+}
+
+
 
-  if ( len < 0 || len >= (int)out_buf_size )
+
+/**
+ * @brief 设置是否使用长连接（http_Init() 后默认开启）
+ *
+ * @note 开启时请求携带 "Connection: keep-alive"，响应按 Content-Length / 分块结束标志判定收齐，
+ *       连接留待下一次对同一主机的请求直接复用（省去 DNS、TCP 握手与 AT+CIPSTATUS 查询）；
+ *       关闭时携带 "Connection: close"，以服务器关闭连接作为响应结束标志.
+ */
+esp_http_err_t http_SetKeepAlive( esp_http_t *__phttp, bool enable )
+{
+  if ( !__phttp )
   {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("snprintf failed in http_RequestBuild");
-    #endif     
+    LOG_WRITE(LOG_WARNING, "HTTP", "Wrong Param of http_SetKeepAlive.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  }
 
-    LOG_WRITE(LOG_ERROR, "HTTP", "snprintf failed in http_RequestBuild");
-    return ESP_HTTP_ERR_BUILD_REQ;
-  } 
+  __phttp->keep_alive = enable ? 1 : 0;
 
-  printf("%s", out_buf);
+  return ESP_HTTP_OK;
+}
+
+
+
+
+/**
+ * @brief 设置是否请求压缩响应（http_Init() 后默认关闭）
+ *
+ * @note 开启时请求携带 "Accept-Encoding: " HTTP_ACCEPT_ENCODING，gzip / deflate 响应体在接收过程中
+ *       经 HTTP_INFLATE_WINDOW 字节的滑动窗口解码后再交给调用者. 服务器的压缩窗口无法经 HTTP 协商
+ *       （通常为 32KB），回溯距离超出本地窗口时本次解码失败（ESP_HTTP_ERR_DECODE），此后的请求不再携带该字段；
+ *       因此仅建议对解码后不超过 HTTP_INFLATE_WINDOW 字节的响应开启.
+ */
+esp_http_err_t http_SetCompression( esp_http_t *__phttp, bool enable )
+{
+  if ( !__phttp )
+  {
+    LOG_WRITE(LOG_WARNING, "HTTP", "Wrong Param of http_SetCompression.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  }
 
-  __phttp->total_len = (uint16_t)len;
+  __phttp->accept_gzip = enable ? 1 : 0;
 
   return ESP_HTTP_OK;
 }
@@ -472,15 +772,38 @@ esp_http_err_t http_RequestBuild( esp_http_t *__phttp, char *out_buf, uint16_t o
 
 
 
+/**
+ * @brief 设置是否使用响应缓存（http_Init() 后默认开启）
+ *
+ * @note 开启时按 URL 保存 200 响应的响应体与 ETag / Last-Modified / Cache-Control: max-age：
+ *       max-age 之内的请求直接由缓存投递，不发出请求；过期后携带 If-None-Match / If-Modified-Since
+ *       重新验证，304 Not Modified 同样由缓存投递. 条目数与响应体上限见 esp_http_cache.h.
+ */
+esp_http_err_t http_SetCache( esp_http_t *__phttp, bool enable )
+{
+  if ( !__phttp )
+  {
+    LOG_WRITE(LOG_WARNING, "HTTP", "Wrong Param of http_SetCache.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  }
+
+  __phttp->use_cache = enable ? 1 : 0;
+
+  return ESP_HTTP_OK;
+}
+
+
+
 
 /**
  * @brief 执行一次完整的 HTTP GET 请求流程（连接 → 构建 → 发送 → 接收 → JSON 提取）
  *
  * 本函数封装了从零开始发起 HTTP GET 请求所需的全部步骤，专为嵌入式资源受限场景（ESP8266 + STM32F4）优化：
- *   - ✅ 自动检测 TCP 连接状态：若未连接，则调用 esp8266_tcp_Connect() 尝试连接目标 host:80；
- *   - ✅ 安全构建请求：调用 http_RequestBuild() 生成标准 HTTP/1.1 GET 报文（含 Host、Connection: close）；
- *   - ✅ 同步发送与接收：调用 esp8266_tcp_Send() 发送请求，并复用 LastReceivedFrame 获取响应；
- *   - ✅ 智能提取 JSON body：自动跳过 HTTP headers（定位首个 "\r\n\r\n"），仅返回纯净 JSON 字符串；
+ *   - ✅ 长连接复用：到同一主机的连接仍存活且未超过空闲期限时直接发送，否则调用 esp8266_tcp_Connect() 连接 host:80；
+ *     复用的连接已被服务器关闭（发送失败或未收到任何数据即 "CLOSED"）时自动重建连接并重发一次；
+ *   - ✅ 零拷贝构建请求：http_RequestBuild() 将请求行与头部组装为分段表，由 DMA 直接从各片段发送（无 snprintf、无请求缓冲区）；
+ *   - ✅ 流式接收：发送前注册 +IPD 负载消费方，响应负载由分流器直接从接收环逐片交付，跨越多个 +IPD 分片亦可完整接收；
+ *   - ✅ 智能提取 JSON body：自动跳过 HTTP headers（跨分片匹配首个 "\r\n\r\n"），仅返回纯净 JSON 字符串；
  *   - ✅ 资源友好：全程使用栈/静态缓冲区，**零 malloc/free，零动态内存分配**；
  *   - ✅ 错误收敛：所有底层错误（AT 超时、解析失败、TCP 断连）统一映射为 esp_http_err_t，便于上层统一处理。
  *
@@ -502,11 +825,15 @@ esp_http_err_t http_RequestBuild( esp_http_t *__phttp, char *out_buf, uint16_t o
  *         - @ref ESP_HTTP_ERR_OFFLINE       : TCP 连接失败或无响应（esp8266_tcp_Connect/Send 失败）；
  *         - @ref ESP_HTTP_ERR_BUILD_REQ     : http_RequestBuild() 构建失败（host/path 未设置等）；
  *         - @ref ESP_HTTP_ERR_EXTRACT       : 无法从响应中定位 "\r\n\r\n" 或 JSON body 为空；
- *         - @ref ESP_HTTP_ERR_SEND_WAIT_FAIL: esp8266_tcp_Send() 返回非 ESP_TCP_OK。
+ *         - @ref ESP_HTTP_ERR_SEND_WAIT_FAIL: esp8266_tcp_Send() 返回非 ESP_TCP_OK；
+ *         - @ref ESP_HTTP_ERR_DECODE        : 压缩响应解码失败，且以未压缩方式重新获取仍失败。
  *
  * @note
- *   - 本函数是**可重入的（reentrant）**：内部不依赖全局静态变量（除已加锁的 hesp8266.LastReceivedFrame）；
- *   - 不会保持长连接：每次调用均在发送后隐式断开（由 esp8266_tcp_Send() 内部触发 +IPD 等待逻辑决定）；
+ *   - 基于 http_GetStream()，响应体由流式解析器逐段写入 out_json_body，超出容量的部分被丢弃；
+ *   - 同一时刻只能有一个 http_Get() 在执行（负载消费方为驱动级单例）；
+ *   - 分块编码的响应体在接收过程中逐块解码，out_json_body 中不含分块长度行；
+ *   - 长连接下以 Content-Length / 最后一个分块判定响应结束；服务器未给出长度或要求关闭时，
+ *     以服务器关闭连接（"CLOSED" URC）作为结束标志，最长等待 HTTP_RECV_TIMEOUT 毫秒；
  *   - 若需连续请求，请在上层控制重试逻辑（推荐指数退避：1s → 2s → 4s）；
  *   - 日志输出遵循 LOG_WRITE() 规范，调试信息在 __DEBUG_LEVEL_1__ 启用时打印至 USART。
  *
@@ -534,139 +861,334 @@ esp_http_err_t http_Get( esp_http_t *__phttp, char *out_json_body, uint16_t out_
     return ESP_HTTP_ERR_INVALID_ARGS;
   } 
 
-  // 检查TCP连接. 若无连接则尝试连接.
-  if ( esp8266_tcp_getState()->is_Connected == false || esp8266_tcp_getState()->state != ESP_TCP_STATE_CONNECTED )
-  {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("TCP Connect not detected. http_Get() called failed.\n");
-    #endif          
-
-    LOG_WRITE(LOG_WARNING, "HTTP", "TCP Con not detected.http_Get() call fail.");
-
-    esp_tcp_err_t err = esp8266_tcp_Connect(__phttp->host, 80, TCP );
-    if ( err != ESP_TCP_OK )
-    {
-      LOG_WRITE(LOG_ERROR, "HTTP", "auto-connect failed: %d", (int)err);
-      return ESP_HTTP_ERR_OFFLINE;
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(50));
-  } 
+  http_collect_t col = { out_json_body, out_json_body_buf_size, 0 };
 
-  if ( strlen(__phttp->host) == 0 || strlen(__phttp->path) == 0 )
-  {
-    // 传入的__phttp不合法.（未正确初始化）.
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("esp_http_t *__phttp not valid.\n");
-    #endif        
+  out_json_body[0] = '\0';
 
-    LOG_WRITE(LOG_WARNING, "HTTP", "esp_http_t *__phttp not valid.");
-    return ESP_HTTP_ERR_INVALID_ARGS;
-  } 
+  esp_http_err_t err = http_GetStream(__phttp, &http_collect_ops, &col, NULL);
 
-  static char req_buf[HTTP_REQ_BUF_MAX_LEN]; memset(req_buf, 0, sizeof(req_buf));
-  esp_http_err_t req_err = http_RequestBuild(__phttp, req_buf, sizeof(req_buf));
-  if ( req_err != ESP_HTTP_OK )
+  // 压缩响应解码失败: 此时已停用压缩，以未压缩方式重新获取一次(POST 不重发).
+  if ( err == ESP_HTTP_ERR_DECODE && __phttp->method != HTTP_METHOD_POST )
   {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("Request build error in http_Get().\n");
-    #endif            
+    col.out_len = 0;
+    out_json_body[0] = '\0';
 
-    LOG_WRITE(LOG_ERROR, "HTTP", "Request build error in http_Get().");
-    return ESP_HTTP_ERR_BUILD_REQ;
+    err = http_GetStream(__phttp, &http_collect_ops, &col, NULL);
   }
 
-
-  // esp8266_tcp_Send（）里已经包含了esp8266_WaitResponse("+IPD")，上层无需继续等待！否则将收不到数据.
-  // 注意！调用tcp_send之后并不会调用esp8266_DropLastFrame()，请在解析完数据后于上层手动调用esp8266_DropLastFrame()释放状态！
-  esp_tcp_err_t send_err = esp8266_tcp_Send((const uint8_t *)req_buf, __phttp->total_len);
-  if ( send_err != ESP_TCP_OK )
+  if ( err != ESP_HTTP_OK )
   {
-    #if defined(__DEBUG_LEVEL_1__)
-      printf("TcpSend error in http_Get().\n");
-    #endif              
-
-    LOG_WRITE(LOG_ERROR, "HTTP", "TcpSend error in http_Get().");
-    return ESP_HTTP_ERR_SEND_WAIT_FAIL;
+    return err;
   }
 
-  const uint8_t *pRet = (const uint8_t *)memmem(hesp8266.LastReceivedFrame.RecvData, hesp8266.LastReceivedFrame.Data_Len, "+IPD,", strlen("+IPD,"));
-
-  const uint8_t *recv_data = pRet;
-
-  if ( !http_extract_json_body(recv_data, out_json_body, out_json_body_buf_size) )
+  if ( col.out_len == 0 )
   {
     #if defined(__DEBUG_LEVEL_1__)
       printf("Failed to extract JSON body.\n");
     #endif        
 
-    esp8266_DropLastFrame();
     LOG_WRITE(LOG_ERROR, "HTTP", "Failed to extract JSON body.");
     return ESP_HTTP_ERR_EXTRACT;
   }
 
-  esp8266_DropLastFrame();
-
   return ESP_HTTP_OK;
 }
 
 
 
-
 /**
- * @brief 从 ESP8266 AT 模块返回的完整 HTTP 响应中，安全提取 JSON body 字符串
- * 
- * 该函数专为 AT 指令模式（+IPD）设计，自动跳过：
- *   - "+IPD,<len>:" 前缀（AT 固件封装格式）
- *   - HTTP 响应头（Headers），以首个 "\r\n\r\n" 为分隔标志
- * 
- * 提取结果为纯 JSON 字符串（不含任何 HTTP 头部、状态行或控制字符），
- * 并保证输出缓冲区以 '\0' 结尾，长度严格受控，**零内存越界风险**。
- * 
+ * @brief 执行带请求体的请求（POST / PUT，如上传遥测数据），响应体可选收集
+ *
+ * 请求由 http_Init(HTTP_METHOD_POST / HTTP_METHOD_PUT) + http_SetHost() / http_SetPath() + http_SetBody() 配置，
+ * 请求行、头部与请求体以分段方式由 DMA 直接发送（见 http_RequestBuild()）. 与 http_Get() 不同，
+ * 空响应体（如 204）视为成功，结果以 *pStatus 判断.
+ *
+ * @param[in]  __phttp       已配置的请求（方法须为 POST / PUT）
+ * @param[out] out_body      响应体输出缓冲区（以 '\0' 结尾，超出部分丢弃；可为 NULL，表示丢弃响应体）
+ * @param[in]  out_body_size out_body 总字节数
+ * @param[out] pStatus       状态码（可为 NULL）
+ *
+ * @return 同 http_GetStream()
+ *
+ * @note 非幂等请求：复用的长连接失效时，仅在请求未能发出的情况下重建连接并重发；
+ *       压缩响应解码失败时也不会像 http_Get() 那样重新请求.
+ */
+esp_http_err_t http_Send( esp_http_t *__phttp, char *out_body, uint16_t out_body_size, uint16_t *pStatus )
+{
+  if ( !__phttp || __phttp->method == HTTP_METHOD_GET || ( out_body != NULL && out_body_size == 0 ) )
+  {
+    LOG_WRITE(LOG_WARNING, "HTTP", "Wrong Param of http_Send.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  }
+
+  http_collect_t col = { out_body, out_body_size, 0 };
+
+  if ( out_body != NULL )
+  {
+    out_body[0] = '\0';
+  }
+
+  return http_GetStream(__phttp, ( out_body != NULL ) ? &http_collect_ops : NULL, &col, pStatus);
+}
+
+
+
+
+
+/**
+ * @brief 执行请求（GET / POST / PUT，见 http_Init()），响应经流式解析器逐段交给调用者的回调
+ *
+ * 连接获取、长连接复用与失效重连、透传 / 普通 / 被动接收方式均与 http_Get() 相同，区别在于响应
+ * 不经过任何整体缓冲：状态行、各头部字段与响应体分片在到达时即通过 ops 投递（见 http_parser_ops_t），
+ * 因此可处理任意大小的响应，内存占用固定。gzip / deflate 响应体在交给 on_body 之前解压（见 http_SetCompression()），
+ * on_body 收到的始终是解码后的数据。开启缓存时（见 http_SetCache()），新鲜的缓存直接投递而不发出请求，
+ * 304 响应本身不投递，改为投递缓存的响应体（均按一次 200 响应的回调顺序）。只有 GET 参与缓存，
+ * 缓存键包含 http_AddQuery() 追加的查询参数。
+ *
+ * @param[in]  __phttp 已配置 host / path 的请求
+ * @param[in]  ops     响应消费方（回调在取帧任务上下文中执行，应尽快返回，不得调用本模块接口）
+ * @param[in]  ctx     透传给回调的上下文指针
+ * @param[out] pStatus 状态码（可为 NULL）；缓存新鲜时为 200，重新验证命中时为 304
+ *
+ * @return
+ *         - @ref ESP_HTTP_OK                : 头部已完整接收（响应体是否完整见 on_complete 是否被调用）；
+ *         - @ref ESP_HTTP_ERR_INVALID_ARGS  : 参数非法或请求未配置；
+ *         - @ref ESP_HTTP_ERR_OFFLINE       : 连接失败；
+ *         - @ref ESP_HTTP_ERR_BUILD_REQ     : 请求构建失败；
+ *         - @ref ESP_HTTP_ERR_EXTRACT       : 超时或连接关闭前未收到完整的响应头；
+ *         - @ref ESP_HTTP_ERR_SEND_WAIT_FAIL: 发送失败；
+ *         - @ref ESP_HTTP_ERR_DECODE        : 压缩响应体解码失败（此后的请求不再请求压缩）。
+ *
+ * @note 失效长连接的重发仅在未收到任何响应字节时进行，回调不会看到同一响应的重复数据。
+ */
+esp_http_err_t http_GetStream( esp_http_t *__phttp, const http_parser_ops_t *ops, void *ctx, uint16_t *pStatus )
+{
+  if ( !__phttp )
+  {
+    LOG_WRITE(LOG_WARNING, "HTTP", "Wrong Param of http_GetStream.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  }
+
+  if ( __phttp->host_len == 0 || __phttp->path_len == 0 )
+  {
+    // 传入的__phttp不合法.（未正确初始化）.
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("esp_http_t *__phttp not valid.\n");
+    #endif        
+
+    LOG_WRITE(LOG_WARNING, "HTTP", "esp_http_t *__phttp not valid.");
+    return ESP_HTTP_ERR_INVALID_ARGS;
+  } 
+
+  esp_http_err_t req_err = http_RequestBuild(__phttp);
+  if ( req_err != ESP_HTTP_OK )
+  {
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Request build error in http_Get().\n");
+    #endif            
+
+    LOG_WRITE(LOG_ERROR, "HTTP", "Request build error in http_Get().");
+    return ESP_HTTP_ERR_BUILD_REQ;
+  }
+
+  http_cache_result_t cache = http_cache_Lookup(&http_req.cache_key);
+
+  http_stats.LastFromCache = 0;
+
+  // 缓存仍新鲜: 不发出请求.
+  if ( cache == HTTP_CACHE_FRESH && http_cache_Replay(&http_req.cache_key, ops, ctx) )
+  {
+    if ( pStatus != NULL )
+    {
+      *pStatus = 200;
+    }
+
+    http_stats.CacheFresh++;
+    http_stats.LastFromCache = 1;
+
+    return ESP_HTTP_OK;
+  }
+
+  // 取得连接: 可复用的长连接直接使用，否则(重新)连接.
+  bool reused = false;
+  esp_http_err_t conn_err = http_ConnAcquire(__phttp->host, &reused);
+  if ( conn_err != ESP_HTTP_OK )
+  {
+    return conn_err;
+  }
+
+
+  http_parser_t parser;
+
+  memset(&http_dec, 0, sizeof(http_dec));
+  http_dec.parser = &parser;
+  http_dec.ops = ops;
+  http_dec.ctx = ctx;
+  http_dec.revalidate = ( cache == HTTP_CACHE_STALE );
+
+  http_cache_RxBegin(&http_req.cache_key);
+
+  http_parser_Init(&parser, &http_decode_ops, &http_dec);
+
+  if ( __phttp->transfer_mode == HTTP_TRANSFER_PASSTHROUGH )
+  {
+    http_conn.reusable = false;
+
+    esp_http_err_t pt_err = http_ExchangePassthrough(http_req.frag, http_req.frag_num, &parser);
+
+    if ( pt_err != ESP_HTTP_OK )
+    {
+      return pt_err;
+    }
+
+    goto http_GetStream_Check;
+  }
+
+  for ( uint8_t attempt = 0; ; attempt++ )
+  {
+    bool closed = false;
+    esp_http_err_t x_err = http_ExchangeNormal(http_req.frag, http_req.frag_num, &parser, &closed);
+
+    // 复用的连接已失效(服务器已关闭空闲连接): 尚未收到任何响应字节时，重建连接后重发一次.
+    // POST 非幂等，仅在请求未能发出时重发.
+    bool resend = ( x_err != ESP_HTTP_OK || closed ) &&
+                  ( __phttp->method != HTTP_METHOD_POST || x_err == ESP_HTTP_ERR_SEND_WAIT_FAIL );
+
+    if ( reused && attempt == 0 && parser.rx_bytes == 0 && resend )
+    {
+      LOG_WRITE(LOG_INFO, "HTTP", "Stale keep-alive link to %s, reconnecting.", __phttp->host);
+
+      http_conn.reusable = false;
+      esp8266_tcp_Disconnect();
+
+      conn_err = http_ConnAcquire(__phttp->host, &reused);
+      if ( conn_err != ESP_HTTP_OK )
+      {
+        return conn_err;
+      }
+
+      http_parser_Init(&parser, &http_decode_ops, &http_dec);
+      continue;
+    }
+
+    http_ConnRelease(&parser, closed, __phttp->keep_alive != 0);
+
+    if ( x_err != ESP_HTTP_OK )
+    {
+      return x_err;
+    }
+
+    break;
+  }
+
+http_GetStream_Check:
+  if ( pStatus != NULL )
+  {
+    *pStatus = parser.status_code;
+  }
+
+  if ( !http_parser_HeadersDone(&parser) )
+  {
+    LOG_WRITE(LOG_ERROR, "HTTP", "No complete response header (%lu bytes).", (unsigned long)parser.rx_bytes);
+    return ESP_HTTP_ERR_EXTRACT;
+  }
+
+  if ( !http_parser_IsComplete(&parser) )
+  {
+    LOG_WRITE(LOG_WARNING, "HTTP", "Incomplete body: %lu bytes.", (unsigned long)parser.body_len);
+  }
+
+  esp_http_err_t dec_err = http_DecodeEnd(&parser);
+
+  http_cache_RxEnd(dec_err == ESP_HTTP_OK && http_parser_IsComplete(&parser));
+
+  if ( dec_err != ESP_HTTP_OK )
+  {
+    return dec_err;
+  }
+
+  // 304: 缓存已由 http_cache_RxEnd() 刷新，投递缓存的响应体.
+  if ( http_dec.not_modified && http_cache_Replay(&http_req.cache_key, ops, ctx) )
+  {
+    http_stats.CacheNotModified++;
+    http_stats.LastFromCache = 1;
+  }
+
+  // 首次成功获取即结束启动时间线(之后的调用无操作).
+  boot_prof_Finish(BOOT_PHASE_FIRST_FETCH);
+
+  return ESP_HTTP_OK;
+}
+
+
+
+
+/**
+ * @brief 读取响应统计（链路字节数与解码后字节数，用于评估压缩收益）
+ */
+void http_GetStats( esp_http_stats_t *pStats )
+{
+  if ( pStats == NULL )
+  {
+    return;
+  }
+
+  *pStats = http_stats;
+}
+
+
+
+
+/**
+ * @brief 从 ESP8266 AT 模块返回的完整 HTTP 响应中，安全提取 JSON body 字符串
+ * 
+ * 该函数专为 AT 指令模式（+IPD）设计，自动跳过：
+ *   - "+IPD,<len>:" 前缀（AT 固件封装格式）
+ *   - HTTP 状态行与响应头（Headers），以首个空行为分隔标志
+ * 
+ * 响应体经 http_parser 解码：`Transfer-Encoding: chunked` 的分块长度行、分隔符与尾部字段均被去除。
+ * 提取结果为纯 JSON 字符串（不含任何 HTTP 头部、状态行或控制字符），
+ * 并保证输出缓冲区以 '\0' 结尾，长度严格受控，**零内存越界风险**。
+ * 
  * @param http_response  指向完整响应数据的 const char*（如 "+IPD,237:HTTP/1.1 200 OK\r\nContent-Type:...\r\n\r\n{...}"）
+ * @param response_len   响应数据有效长度（接收环中的帧不以 '\0' 结尾，解析严格限定在该长度内）
  * @param out_json       输出缓冲区指针（必须非 NULL，且空间足够容纳 JSON + '\0'）
  * @param out_json_size  out_json 缓冲区总字节数（含 '\0' 占位，最小建议 256）
  * 
  * @return true  成功提取有效 JSON body（out_json 已写入且以 '\0' 结尾）
- * @return false 失败：参数非法 / 未找到 "\r\n\r\n" / JSON body 为空 / 缓冲区不足
+ * @return false 失败：参数非法 / 状态行非法 / 响应头不完整
  * 
  * @note
  *   - 本函数不依赖 heap，不调用 malloc/free，完全线程安全；
  *   - 对中文 UTF-8 字符（如 "北京"、"晴天"）完全透明，不做任何编码转换；
- *   - 若响应中存在多个 "\r\n\r\n"，仅取第一个（符合 HTTP 规范）；
+ *   - 超出 out_json_size - 1 的部分被截断；仅含部分分块的响应同样返回已解码的部分；
  *   - 建议 out_json_size ≥ 512，以兼容天气 API 典型响应（通常 200~400 字节）。
  */
-bool http_extract_json_body( const char* http_response, char *out_json, uint16_t out_json_size )
+bool http_extract_json_body( const char* http_response, uint16_t response_len, char *out_json, uint16_t out_json_size )
 {
-  if ( !http_response || !out_json || out_json_size == 0 )  return false;
+  if ( !http_response || response_len == 0 || !out_json || out_json_size == 0 )  return false;
 
   const char *body_start = http_response;
+  const char *body_end = http_response + response_len;
 
   // 跳过 "+IPD,x:" 前缀.
-  if ( strncmp(body_start, "+IPD,", 5) == 0 )
+  if ( response_len > 5 && strncmp(body_start, "+IPD,", 5) == 0 )
   {
     const char *p = body_start + 5;
-    while( *p && isdigit((unsigned char)*p) )   p++;
+    while( p < body_end && isdigit((unsigned char)*p) )   p++;
     body_start = p;
-    if ( *p == ':' )  body_start = p + 1;
+    if ( p < body_end && *p == ':' )  body_start = p + 1;
   }
 
-  // 查找 \r\n\r\n(Header结束标志).
-  const char *found = strstr(body_start, "\r\n\r\n");
-  if ( !found ) return false;
-
-  const char *json_start = found + 4;
-  size_t json_len = strlen(json_start);
+  http_collect_t col = { out_json, out_json_size, 0 };
+  http_parser_t parser;
 
-  if ( json_len >= out_json_size - 1 )
-  {
-    json_len = out_json_size - 2;
-  }
+  out_json[0] = '\0';
 
-  memcpy(out_json, json_start, json_len);
-  out_json[json_len] = '\0';
+  http_parser_Init(&parser, &http_collect_ops, &col);
+  (void)http_parser_Feed(&parser, (const uint8_t *)body_start, (uint16_t)(body_end - body_start));
 
-  return true;
+  return http_parser_HeadersDone(&parser);
 }
 
 
@@ -947,3 +1469,545 @@ esp_http_err_t http_json_getNum( const char *json_main, const char **key_paths,
   LOG_WRITE(LOG_ERROR, "HTTP", "Key not found in http_json_getNum.");
   return ESP_HTTP_ERR_UNKNOWN;
 }
+
+
+
+
+// +IPD 负载消费方(在取帧任务上下文中执行，data 仅在回调期间有效): 直接交给响应解析器.
+static void http_BodySink( void *ctx, uint8_t link_id, const uint8_t *data, uint16_t len, uint32_t remain )
+{
+  (void)link_id;
+  (void)remain;
+
+  if ( ctx == NULL )
+  {
+    return;
+  }
+
+  (void)http_parser_Feed((http_parser_t *)ctx, data, len);
+}
+
+
+
+
+// http_Get() 的 on_body: 追加至调用者缓冲区，保持 '\0' 结尾，超出部分丢弃.
+static void http_CollectBody( void *ctx, const uint8_t *data, uint16_t len )
+{
+  http_collect_t *pCol = (http_collect_t *)ctx;
+  uint16_t space = (uint16_t)( pCol->out_size - 1 - pCol->out_len );
+
+  if ( len > space )
+  {
+    len = space;
+  }
+
+  memcpy(&pCol->out[pCol->out_len], data, len);
+  pCol->out_len += len;
+  pCol->out[pCol->out_len] = '\0';
+}
+
+
+
+// 向请求分段表追加一段(不拷贝). 长度为 0 的段忽略；分段表已满时返回 false.
+static bool http_ReqAdd( const void *data, uint16_t len )
+{
+  if ( len == 0 )
+  {
+    return true;
+  }
+
+  if ( http_req.frag_num >= HTTP_REQ_FRAG_MAX )
+  {
+    return false;
+  }
+
+  http_req.frag[http_req.frag_num].data = (const uint8_t *)data;
+  http_req.frag[http_req.frag_num].len = len;
+  http_req.frag_num++;
+
+  return true;
+}
+
+
+
+
+// 追加查询参数的 key 或 value: 只含非保留字符时直接引用，否则百分号编码到 http_req.qenc 后引用.
+static bool http_ReqAddQuery( const char *str )
+{
+  static const char hex[] = "0123456789ABCDEF";
+
+  size_t len = 0;
+  bool plain = true;
+
+  for ( ; str[len] != '\0'; len++ )
+  {
+    plain = plain && http_IsUnreserved((uint8_t)str[len]);
+  }
+
+  if ( len > 0xFFFFU )
+  {
+    return false;
+  }
+
+  if ( plain )
+  {
+    return http_ReqAdd(str, (uint16_t)len);
+  }
+
+  char *out = &http_req.qenc[http_req.qenc_len];
+  uint16_t n = 0;
+
+  for ( const uint8_t *p = (const uint8_t *)str; *p != '\0'; p++ )
+  {
+    bool keep = http_IsUnreserved(*p);
+
+    if ( http_req.qenc_len + n + ( keep ? 1U : 3U ) > HTTP_QUERY_ENC_MAX )
+    {
+      return false;
+    }
+
+    if ( keep )
+    {
+      out[n++] = (char)*p;
+    }
+    else
+    {
+      out[n++] = '%';
+      out[n++] = hex[*p >> 4];
+      out[n++] = hex[*p & 0x0FU];
+    }
+  }
+
+  http_req.qenc_len += n;
+
+  return http_ReqAdd(out, n);
+}
+
+
+
+
+// RFC 3986 非保留字符(ALPHA / DIGIT / "-" / "." / "_" / "~")，查询参数中可原样发送.
+static bool http_IsUnreserved( uint8_t c )
+{
+  return ( c >= 'A' && c <= 'Z' ) || ( c >= 'a' && c <= 'z' ) || ( c >= '0' && c <= '9' ) ||
+         c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+
+
+
+// Content-Length 的值: 十进制数字 + "\r\n"(out 至少 7 字节)，返回长度.
+static uint16_t http_FormatLength( char *out, uint16_t value )
+{
+  char digits[5];
+  uint8_t n = 0;
+  uint16_t len = 0;
+
+  do
+  {
+    digits[n++] = (char)( '0' + value % 10U );
+    value /= 10U;
+  } while( value != 0 );
+
+  while( n > 0 )
+  {
+    out[len++] = digits[--n];
+  }
+
+  out[len++] = '\r';
+  out[len++] = '\n';
+
+  return len;
+}
+
+
+
+
+
+// 透传方式完成一次请求/响应交换，响应字节流直接交给 http_BodySink(). 透传下以空闲超时作为结束.
+static esp_http_err_t http_ExchangePassthrough( const esp_tx_seg_t *frag, uint8_t frag_num, http_parser_t *pParser )
+{
+  esp_tcp_err_t err = esp8266_tcp_PassthroughEnter(http_BodySink, pParser);
+  if ( err != ESP_TCP_OK )
+  {
+    LOG_WRITE(LOG_ERROR, "HTTP", "Passthrough enter failed: %d", (int)err);
+    return ESP_HTTP_ERR_SEND_WAIT_FAIL;
+  }
+
+  err = esp8266_tcp_PassthroughWriteV(frag, frag_num);
+
+  if ( err == ESP_TCP_OK )
+  {
+    uint32_t rx = esp8266_tcp_PassthroughReceive(HTTP_PT_IDLE_MS, HTTP_RECV_TIMEOUT);
+
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("Passthrough recv %lu bytes.\n", (unsigned long)rx);
+    #endif // __DEBUG_LEVEL_1__
+
+    (void)rx;
+
+    (void)http_parser_Finish(pParser);
+  }
+
+  esp8266_tcp_PassthroughExit();
+
+  if ( err != ESP_TCP_OK )
+  {
+    LOG_WRITE(LOG_ERROR, "HTTP", "Passthrough write failed: %d", (int)err);
+    return ESP_HTTP_ERR_SEND_WAIT_FAIL;
+  }
+
+  return ESP_HTTP_OK;
+}
+
+
+
+
+// 普通方式完成一次请求/响应交换. 响应按 Content-Length / 最后一个分块收齐即返回，否则等待服务器关闭连接.
+// 被动接收模式下由本函数按接收通路的额度逐段读取模块缓存，处理不及时的数据留在模块(及对端)一侧.
+static esp_http_err_t http_ExchangeNormal( const esp_tx_seg_t *frag, uint8_t frag_num, http_parser_t *pParser, bool *pClosed )
+{
+  uint32_t evt_mask = ESP_EVT_LINK_CLOSED | ESP_EVT_PAYLOAD_DONE;
+
+  *pClosed = false;
+
+  if ( esp8266_tcp_IsPassive() )
+  {
+    evt_mask |= ESP_EVT_RECV_PENDING;
+  }
+
+  // 先注册负载消费方再发送，避免回包先于注册到达.
+  esp8266_ClearEvent(evt_mask);
+  esp8266_SetPayloadSink(http_BodySink, pParser);
+
+  esp_tcp_err_t send_err = esp8266_tcp_SendV(frag, frag_num);
+  if ( send_err != ESP_TCP_OK )
+  {
+    esp8266_SetPayloadSink(NULL, NULL);
+
+    #if defined(__DEBUG_LEVEL_1__)
+      printf("TcpSend error in http_Get().\n");
+    #endif              
+
+    LOG_WRITE(LOG_ERROR, "HTTP", "TcpSend error in http_Get().");
+    return ESP_HTTP_ERR_SEND_WAIT_FAIL;
+  }
+
+  TickType_t xStart = xTaskGetTickCount();
+  TickType_t xTimeout = pdMS_TO_TICKS(HTTP_RECV_TIMEOUT);
+
+  while( !http_parser_IsComplete(pParser) && pParser->state != HTTP_PARSER_ERROR )
+  {
+    TickType_t xElapsed = xTaskGetTickCount() - xStart;
+
+    if ( xElapsed >= xTimeout )
+    {
+      LOG_WRITE(LOG_WARNING, "HTTP", "Recv timeout, body %lu bytes.", (unsigned long)pParser->body_len);
+      break;
+    }
+
+    // 模块缓存中仍有数据但本轮额度不足时，短暂等待消费进度后再读.
+    uint32_t wait_ms = http_PullPassive(pParser) ? 10U : ( xTimeout - xElapsed ) * portTICK_PERIOD_MS;
+
+    if ( http_parser_IsComplete(pParser) )
+    {
+      break;
+    }
+
+    // 每个 +IPD 负载收齐后检查一次是否已满足长度.
+    uint32_t evt = esp8266_WaitEvent(evt_mask, wait_ms);
+
+    if ( evt & ESP_EVT_LINK_CLOSED )
+    {
+      // 对端关闭前发出的数据可能仍在模块缓存中.
+      http_PullPassive(pParser);
+
+      // 未给出长度的响应以关闭作为结束.
+      (void)http_parser_Finish(pParser);
+
+      *pClosed = true;
+      break;
+    }
+  }
+
+  esp8266_SetPayloadSink(NULL, NULL);
+
+  return ESP_HTTP_OK;
+}
+
+
+
+
+// 被动接收模式下读取单连接的缓存数据，直至读空或响应收齐. 返回 true 表示仍有数据待读(本轮额度不足).
+static bool http_PullPassive( const http_parser_t *pParser )
+{
+  uint16_t n = 0;
+
+  if ( !esp8266_tcp_IsPassive() )
+  {
+    return false;
+  }
+
+  while( !http_parser_IsComplete(pParser) )
+  {
+    if ( esp8266_tcp_Pull(ESP_TCP_LINK_INVALID, ESP_RECV_PULL_MAX, &n) != ESP_TCP_OK )
+    {
+      return false;
+    }
+
+    if ( n == 0 )
+    {
+      return ( hesp8266.RecvPending & ESP_RECV_PENDING_BIT(ESP_DEMUX_NO_LINK) ) != 0;
+    }
+  }
+
+  return false;
+}
+
+
+
+
+// 取得到 host:80 的连接: 缓存的长连接仍存活且未超过空闲期限时直接复用(*pReused 置位)，否则(重新)连接.
+static esp_http_err_t http_ConnAcquire( const char *host, bool *pReused )
+{
+  const esp_tcp_handle_t *pState = esp8266_tcp_getState();
+
+  *pReused = false;
+
+  // 空闲期间到达的 "CLOSED" 仍在接收队列中，先处理以同步连接状态.
+  esp8266_PollEvent(ESP_EVT_LINK_CLOSED);
+
+  bool connected = pState->is_Connected && pState->state == ESP_TCP_STATE_CONNECTED;
+
+  if ( connected && strcmp(pState->Host, host) == 0 )
+  {
+    if ( strcmp(http_conn.host, host) != 0 )
+    {
+      // 由其它调用方建立(如初始化流程预先连接、热复位后接管)，纳入缓存. 同样可能已失效，按复用处理.
+      safety_strncpy(http_conn.host, host, sizeof(http_conn.host));
+      http_conn.idle_ms = HTTP_KEEPALIVE_IDLE_MS;
+      http_conn.last_used = xTaskGetTickCount();
+      *pReused = true;
+
+      return ESP_HTTP_OK;
+    }
+
+    if ( http_conn.reusable && ( xTaskGetTickCount() - http_conn.last_used ) < pdMS_TO_TICKS(http_conn.idle_ms) )
+    {
+      http_conn.reuse_cnt++;
+      *pReused = true;
+
+      #if defined(__DEBUG_LEVEL_1__)
+        printf("Reuse keep-alive link to %s (%lu).\n", host, (unsigned long)http_conn.reuse_cnt);
+      #endif // __DEBUG_LEVEL_1__
+
+      return ESP_HTTP_OK;
+    }
+  }
+
+  // 其它主机、上一响应不可复用或已超过空闲期限.
+  if ( connected )
+  {
+    esp8266_tcp_Disconnect();
+  }
+
+  esp_tcp_err_t err = esp8266_tcp_Connect(host, 80, TCP);
+  if ( err != ESP_TCP_OK )
+  {
+    LOG_WRITE(LOG_ERROR, "HTTP", "auto-connect failed: %d", (int)err);
+    return ESP_HTTP_ERR_OFFLINE;
+  }
+
+  vTaskDelay(pdMS_TO_TICKS(50));
+
+  safety_strncpy(http_conn.host, host, sizeof(http_conn.host));
+  http_conn.reusable = false;
+  http_conn.idle_ms = HTTP_KEEPALIVE_IDLE_MS;
+  http_conn.last_used = xTaskGetTickCount();
+
+  return ESP_HTTP_OK;
+}
+
+
+
+
+// 一次交换结束后更新缓存. 响应未收齐而连接仍在时主动断开，避免残余数据混入下一响应.
+static void http_ConnRelease( const http_parser_t *pParser, bool closed, bool keep_alive )
+{
+  bool complete = http_parser_IsComplete(pParser);
+
+  http_conn.last_used = xTaskGetTickCount();
+  http_conn.reusable = keep_alive && !closed && complete && !pParser->conn_close;
+
+  // 提前 1s 放弃，避开服务器关闭空闲连接的时刻.
+  http_conn.idle_ms = ( pParser->ka_timeout_s > 1 ) ? ( pParser->ka_timeout_s - 1 ) * 1000UL : HTTP_KEEPALIVE_IDLE_MS;
+
+  if ( !closed && !complete )
+  {
+    esp8266_tcp_Disconnect();
+  }
+}
+
+
+
+
+// 以下为解码层的 ops: 状态行 / 头部 / 完成事件转交调用者(304 重新验证命中时不转交)，响应体按 Content-Encoding
+// 解压后转交；同时交给响应缓存记录校验字段与响应体.
+static void http_DecodeStatus( void *ctx, uint16_t code )
+{
+  (void)ctx;
+
+  http_cache_RxStatus(code);
+
+  http_dec.not_modified = ( code == 304 && http_dec.revalidate );
+
+  if ( !http_dec.not_modified && http_dec.ops && http_dec.ops->on_status )
+  {
+    http_dec.ops->on_status(http_dec.ctx, code);
+  }
+}
+
+
+
+
+static void http_DecodeHeader( void *ctx, const char *name, const char *value )
+{
+  (void)ctx;
+
+  http_cache_RxHeader(name, value, http_parser_LineTruncated(http_dec.parser));
+
+  if ( !http_dec.not_modified && http_dec.ops && http_dec.ops->on_header )
+  {
+    http_dec.ops->on_header(http_dec.ctx, name, value);
+  }
+}
+
+
+
+
+static void http_DecodeHeadersDone( void *ctx )
+{
+  (void)ctx;
+
+  http_dec.encoding = http_dec.parser->content_enc;
+
+  if ( http_dec.encoding == HTTP_PARSER_ENC_GZIP || http_dec.encoding == HTTP_PARSER_ENC_DEFLATE )
+  {
+    http_inflate_Init(&http_inf, ( http_dec.encoding == HTTP_PARSER_ENC_GZIP ) ? HTTP_INFLATE_FMT_GZIP : HTTP_INFLATE_FMT_DEFLATE,
+                        http_DecodeOut, NULL);
+  }
+  else if ( http_dec.encoding == HTTP_PARSER_ENC_OTHER )
+  {
+    LOG_WRITE(LOG_WARNING, "HTTP", "Unsupported Content-Encoding, body passed through.");
+  }
+
+  http_cache_RxHeadersDone();
+
+  if ( !http_dec.not_modified && http_dec.ops && http_dec.ops->on_headers_done )
+  {
+    http_dec.ops->on_headers_done(http_dec.ctx);
+  }
+}
+
+
+
+
+static void http_DecodeBody( void *ctx, const uint8_t *data, uint16_t len )
+{
+  (void)ctx;
+
+  http_dec.body_wire += len;
+
+  if ( http_dec.encoding == HTTP_PARSER_ENC_GZIP || http_dec.encoding == HTTP_PARSER_ENC_DEFLATE )
+  {
+    // 出错后的数据丢弃，由 http_DecodeEnd() 报告.
+    if ( http_inf.status == HTTP_INFLATE_OK )
+    {
+      (void)http_inflate_Feed(&http_inf, data, len);
+    }
+
+    return;
+  }
+
+  http_DecodeOut(NULL, data, len);
+}
+
+
+
+
+static void http_DecodeComplete( void *ctx )
+{
+  (void)ctx;
+
+  if ( !http_dec.not_modified && http_dec.ops && http_dec.ops->on_complete )
+  {
+    http_dec.ops->on_complete(http_dec.ctx);
+  }
+}
+
+
+
+
+static void http_DecodeOut( void *ctx, const uint8_t *data, uint16_t len )
+{
+  (void)ctx;
+
+  http_dec.body += len;
+
+  http_cache_RxBody(data, len);
+
+  if ( len > 0 && http_dec.ops && http_dec.ops->on_body )
+  {
+    http_dec.ops->on_body(http_dec.ctx, data, len);
+  }
+}
+
+
+
+
+// 一次响应结束: 更新统计并检查解码结果. 解码失败后停用压缩.
+static esp_http_err_t http_DecodeEnd( const http_parser_t *pParser )
+{
+  bool compressed = ( http_dec.encoding == HTTP_PARSER_ENC_GZIP || http_dec.encoding == HTTP_PARSER_ENC_DEFLATE );
+
+  http_stats.Responses++;
+  http_stats.WireBytes += pParser->rx_bytes;
+  http_stats.BodyWireBytes += http_dec.body_wire;
+  http_stats.BodyBytes += http_dec.body;
+  http_stats.LastWireBytes = pParser->rx_bytes;
+  http_stats.LastBodyWireBytes = http_dec.body_wire;
+  http_stats.LastBodyBytes = http_dec.body;
+
+  if ( !compressed )
+  {
+    return ESP_HTTP_OK;
+  }
+
+  http_stats.Compressed++;
+
+  #if defined(__DEBUG_LEVEL_1__)
+    printf("HTTP body %lu -> %lu bytes (wire %lu, max dist %u).\n", (unsigned long)http_dec.body_wire,
+              (unsigned long)http_dec.body, (unsigned long)pParser->rx_bytes, http_inf.max_dist);
+  #endif // __DEBUG_LEVEL_1__
+
+  // 响应已完整而数据流未结束同样视为失败; 接收超时的不完整响应仅按不完整处理.
+  if ( http_inf.status == HTTP_INFLATE_DONE || ( http_inf.status == HTTP_INFLATE_OK && !http_parser_IsComplete(pParser) ) )
+  {
+    return ESP_HTTP_OK;
+  }
+
+  http_stats.DecodeErrors++;
+  http_inflate_ok = false;
+
+  if ( http_inf.status == HTTP_INFLATE_ERR_WINDOW )
+  {
+    LOG_WRITE(LOG_ERROR, "HTTP", "Inflate window %u too small (dist %u), compression off.",
+                (unsigned)HTTP_INFLATE_WINDOW, http_inf.max_dist);
+  }
+  else
+  {
+    LOG_WRITE(LOG_ERROR, "HTTP", "Inflate failed: %d, compression off.", (int)http_inf.status);
+  }
+
+  return ESP_HTTP_ERR_DECODE;
+}
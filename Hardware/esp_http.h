@@ -4,17 +4,29 @@
 #include <string.h>
 #include <stdlib.h>
 #include "esp8266_tcp.h"
+#include "http_parser.h"
+#include "http_inflate.h"
+#include "esp_http_cache.h"
 #include "Config.h"
 
 #define HTTP_HOST_MAX_LEN           ( 64U )
-#define HTTP_PATH__MEX_LEN          ( 256U )
-#define HTTP_EXTRA_HEAD_MAX_LEN     ( 128U )
-#define HTTP_REQ_BUF_MAX_LEN        ( 256U )
+#define HTTP_HEADER_MAX             ( 4U )       // http_AddHeader() 可追加的头部条数.
+#define HTTP_QUERY_MAX              ( 4U )       // http_AddQuery() 可追加的查询参数个数.
+#define HTTP_QUERY_ENC_MAX          ( 96U )      // 须百分号编码的查询参数，其编码结果的总长上限.
+#define HTTP_REQ_FRAG_MAX           ( 19U + 4U * HTTP_QUERY_MAX + 2U * HTTP_HEADER_MAX )  // 请求分段表容量(固定部分 + 每个参数 4 段 + 每条头部 2 段).
+#define HTTP_RECV_TIMEOUT           ( 10000U )   // 等待服务器关闭连接(响应接收完毕)的超时时间(ms).
+#define HTTP_PT_IDLE_MS             ( 500U )     // 透传接收时，无新数据超过该时间即视为响应结束(ms).
+#define HTTP_KEEPALIVE_IDLE_MS      ( 4000U )    // 服务器未给出 Keep-Alive: timeout 时，长连接空闲复用的上限(ms).
+#define HTTP_ACCEPT_ENCODING        "gzip, deflate"  // 开启压缩时请求携带的 Accept-Encoding(解码窗口见 HTTP_INFLATE_WINDOW_BITS).
 
 #define HTTP_METHOD_GET             ( 0U )
 #define HTTP_METHOD_POST            ( 1U )
+#define HTTP_METHOD_PUT             ( 2U )
 #define HTTP_VERSION_1_1            ( 0U )
 
+#define HTTP_TRANSFER_NORMAL        ( 0U )       // +IPD 封装，每次发送需 AT+CIPSEND 往返.
+#define HTTP_TRANSFER_PASSTHROUGH   ( 1U )       // 透传(CIPMODE=1)，适用于大响应体.
+
 
 
 typedef enum 
@@ -27,23 +39,85 @@ typedef enum
   ESP_HTTP_ERR_BUILD_REQ      = -5,
   ESP_HTTP_ERR_SEND_WAIT_FAIL = -6,
   ESP_HTTP_ERR_EXTRACT        = -7,
-  ESP_HTTP_ERR_UNKNOWN        = -8
+  ESP_HTTP_ERR_UNKNOWN        = -8,
+  ESP_HTTP_ERR_DECODE         = -9
 } esp_http_err_t;
 
 
+// 查询参数. key / value 按 RFC 3986 百分号编码(非保留字符原样引用，不拷贝).
+typedef struct
+{
+  const char *key;
+  const char *value;
+
+} http_query_t;
+
+
+/**
+ * @brief HTTP 请求.
+ *
+ *  host / path / 头部 / 查询参数 / 请求体均只保存调用者字符串的指针与长度，不拷贝：
+ *  请求以分段表(iovec)的形式直接由 DMA 从这些缓冲区发送，因此它们在请求完成前必须保持有效(可位于 Flash).
+ */
 typedef struct 
 {
 
-  char host[HTTP_HOST_MAX_LEN];
-  char path[HTTP_PATH__MEX_LEN];
-  char extra_headers[HTTP_EXTRA_HEAD_MAX_LEN];
+  const char *host;
+  const char *path;
+  uint16_t host_len;
+  uint16_t path_len;
+
+  esp_tx_seg_t headers[HTTP_HEADER_MAX];     // "Key: Value"(不含 "\r\n").
+  uint8_t header_num;
+
+  http_query_t query[HTTP_QUERY_MAX];
+  uint8_t query_num;
+
+  const char *content_type;                  // 请求体类型(可为 NULL).
+  const uint8_t *body;
+  uint16_t body_len;
+
   uint8_t method;
   uint8_t http_version;
+  uint8_t transfer_mode;
+  uint8_t keep_alive;
+  uint8_t accept_gzip;
+  uint8_t use_cache;
   uint16_t total_len;
 
 } esp_http_t;
 
 
+/**
+ * @brief 响应统计（累计值，Last* 为最近一次响应）.
+ *
+ *  WireBytes：链路上的响应字节数(状态行 + 头部 + 响应体，含分块编码开销).
+ *  BodyWireBytes：链路上的响应体字节数(已去除分块开销，压缩时为压缩数据).
+ *  BodyBytes：解码后交给调用者的响应体字节数.
+ *  CacheFresh：缓存新鲜、未发出请求的次数；CacheNotModified：服务器以 304 确认缓存仍有效的次数.
+ *  LastFromCache：最近一次 http_GetStream() / http_Get() 的响应体来自缓存(调用者可沿用上次的解析结果).
+ */
+typedef struct
+{
+  uint32_t Responses;
+  uint32_t Compressed;
+  uint32_t DecodeErrors;
+
+  uint32_t WireBytes;
+  uint32_t BodyWireBytes;
+  uint32_t BodyBytes;
+
+  uint32_t LastWireBytes;
+  uint32_t LastBodyWireBytes;
+  uint32_t LastBodyBytes;
+
+  uint32_t CacheFresh;
+  uint32_t CacheNotModified;
+  uint32_t LastFromCache;
+
+} esp_http_stats_t;
+
+
 esp_http_err_t http_Init( esp_http_t *__phttp, uint8_t method );
 
 esp_http_err_t http_SetHost( esp_http_t *__phttp, const char *host );
@@ -52,11 +126,29 @@ esp_http_err_t http_SetPath( esp_http_t *__phttp, const char *path );
 
 esp_http_err_t http_AddHeader( esp_http_t *__phttp, const char *header );
 
-esp_http_err_t http_RequestBuild( esp_http_t *__phttp, char *out_buf, uint16_t out_buf_size );
+esp_http_err_t http_AddQuery( esp_http_t *__phttp, const char *key, const char *value );
+
+esp_http_err_t http_SetBody( esp_http_t *__phttp, const char *content_type, const void *body, uint16_t body_len );
+
+esp_http_err_t http_SetTransferMode( esp_http_t *__phttp, uint8_t mode );
+
+esp_http_err_t http_SetKeepAlive( esp_http_t *__phttp, bool enable );
+
+esp_http_err_t http_SetCompression( esp_http_t *__phttp, bool enable );
+
+esp_http_err_t http_SetCache( esp_http_t *__phttp, bool enable );
+
+esp_http_err_t http_RequestBuild( esp_http_t *__phttp );
 
 esp_http_err_t http_Get( esp_http_t *__phttp, char *out_json_body, uint16_t out_json_body_buf_size );
 
-bool http_extract_json_body( const char* http_response, char *out_json, uint16_t out_json_size );
+esp_http_err_t http_Send( esp_http_t *__phttp, char *out_body, uint16_t out_body_size, uint16_t *pStatus );
+
+esp_http_err_t http_GetStream( esp_http_t *__phttp, const http_parser_ops_t *ops, void *ctx, uint16_t *pStatus );
+
+void http_GetStats( esp_http_stats_t *pStats );
+
+bool http_extract_json_body( const char* http_response, uint16_t response_len, char *out_json, uint16_t out_json_size );
 
 esp_http_err_t http_json_getString( const char *json_main, const char **key_paths, uint8_t path_cnt, char *out_buf, uint16_t out_size );
 
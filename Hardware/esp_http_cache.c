@@ -0,0 +1,543 @@
+#include "esp_http_cache.h"
+
+
+/* ********************************************** */
+static HttpCacheEntry_t cache_ent[HTTP_CACHE_SIZE];
+static uint32_t cache_last_use[HTTP_CACHE_SIZE];         // 最近使用序号(LRU).
+static uint32_t cache_use_seq = 0;
+
+// 正在接收的响应. 与 http_GetStream() 相同，同一时刻只有一个请求.
+static struct
+{
+  http_cache_key_t key;
+  uint16_t status;
+  int8_t slot;              // 正在写入的条目(仅 200 响应)，-1 表示不缓存.
+  bool no_store;
+  bool no_cache;
+  bool has_max_age;
+  uint32_t max_age_s;
+  char etag[HTTP_CACHE_ETAG_MAX];
+  char last_mod[HTTP_CACHE_DATE_MAX];
+
+} cache_rx = { { 0, 0, 0 }, 0, -1, false, false, false, 0, { 0 }, { 0 } };
+/* ********************************************** */
+
+
+#define CACHE_STATE_EMPTY         ( 0U )
+#define CACHE_STATE_FILLING       ( 1U )
+#define CACHE_STATE_VALID         ( 2U )
+
+
+/* ********************************************** */
+void http_cache_Key( http_cache_key_t *pKey, const char *Host );
+void http_cache_KeyAdd( http_cache_key_t *pKey, const void *data, uint16_t len );
+http_cache_result_t http_cache_Lookup( const http_cache_key_t *pKey );
+bool http_cache_Validators( const http_cache_key_t *pKey, const char **pETag, const char **pLastModified );
+bool http_cache_Replay( const http_cache_key_t *pKey, const http_parser_ops_t *ops, void *ctx );
+void http_cache_Clear( void );
+void http_cache_RxBegin( const http_cache_key_t *pKey );
+void http_cache_RxStatus( uint16_t code );
+void http_cache_RxHeader( const char *name, const char *value, bool truncated );
+void http_cache_RxHeadersDone( void );
+void http_cache_RxBody( const uint8_t *data, uint16_t len );
+void http_cache_RxEnd( bool complete );
+static int8_t cache_Find( const http_cache_key_t *pKey );
+static void cache_KeyByte( http_cache_key_t *pKey, uint8_t c );
+static bool cache_EqualCi( const char *a, const char *b );
+static const char *cache_TokenCi( const char *list, const char *token );
+static void cache_CopyValidator( char *dst, uint16_t size, const char *src );
+/* ********************************************** */
+
+
+
+
+/**
+ * @brief 计算缓存键：主机名部分（不区分大小写）
+ *
+ * 请求目标（路径与查询串）随后以 http_cache_KeyAdd() 逐段累加，分段方式不影响结果.
+ * Host 为 NULL 时得到"不缓存"的键（Hash == 0）.
+ */
+void http_cache_Key( http_cache_key_t *pKey, const char *Host )
+{
+  pKey->Hash = 2166136261UL;
+  pKey->Check = 5381UL;
+  pKey->Len = 0;
+
+  if ( Host == NULL )
+  {
+    pKey->Hash = 0;
+    return;
+  }
+
+  while( *Host != '\0' )
+  {
+    cache_KeyByte(pKey, (uint8_t)tolower((unsigned char)*Host++));
+  }
+
+  cache_KeyByte(pKey, (uint8_t)'/');
+}
+
+
+
+
+/**
+ * @brief 将一段请求目标（区分大小写）累加到缓存键
+ *
+ * "不缓存"的键保持不变；Hash 恰为 0 时改为 1（0 保留为"不缓存"）.
+ */
+void http_cache_KeyAdd( http_cache_key_t *pKey, const void *data, uint16_t len )
+{
+  const uint8_t *p = (const uint8_t *)data;
+
+  if ( pKey->Hash == 0 || p == NULL )
+  {
+    return;
+  }
+
+  while( len-- > 0 )
+  {
+    cache_KeyByte(pKey, *p++);
+  }
+
+  if ( pKey->Hash == 0 )
+  {
+    pKey->Hash = 1UL;
+  }
+}
+
+
+
+
+/**
+ * @brief 查询 URL 的缓存状态
+ *
+ * @retval HTTP_CACHE_FRESH 在新鲜期内，可直接以 http_cache_Replay() 取得响应体而不发出请求
+ * @retval HTTP_CACHE_STALE 有缓存但须重新验证（请求携带 http_cache_Validators() 给出的字段）
+ * @retval HTTP_CACHE_MISS  无缓存
+ */
+http_cache_result_t http_cache_Lookup( const http_cache_key_t *pKey )
+{
+  int8_t idx = cache_Find(pKey);
+
+  if ( idx < 0 )
+  {
+    return HTTP_CACHE_MISS;
+  }
+
+  return ( (int32_t)( cache_ent[idx].Expire - xTaskGetTickCount() ) > 0 ) ? HTTP_CACHE_FRESH : HTTP_CACHE_STALE;
+}
+
+
+
+
+/**
+ * @brief 取得条件请求的校验字段（If-None-Match / If-Modified-Since 的值）
+ *
+ * 输出指针指向缓存条目内部，直接作为请求分段发送(不拷贝)，在下一次 http_cache_RxBegin() 之前有效.
+ *
+ * @param[out] pETag         ETag 原文，无则为 NULL
+ * @param[out] pLastModified Last-Modified 原文，无则为 NULL
+ *
+ * @return 存在至少一个校验字段
+ */
+bool http_cache_Validators( const http_cache_key_t *pKey, const char **pETag, const char **pLastModified )
+{
+  int8_t idx = cache_Find(pKey);
+
+  *pETag = ( idx >= 0 && cache_ent[idx].ETag[0] != '\0' ) ? cache_ent[idx].ETag : NULL;
+  *pLastModified = ( idx >= 0 && cache_ent[idx].LastModified[0] != '\0' ) ? cache_ent[idx].LastModified : NULL;
+
+  return ( *pETag != NULL ) || ( *pLastModified != NULL );
+}
+
+
+
+
+/**
+ * @brief 将缓存的响应体按一次 200 响应投递给 ops（on_status / on_headers_done / on_body / on_complete）
+ *
+ * @retval true  已投递
+ * @retval false 无缓存
+ */
+bool http_cache_Replay( const http_cache_key_t *pKey, const http_parser_ops_t *ops, void *ctx )
+{
+  int8_t idx = cache_Find(pKey);
+
+  if ( idx < 0 )
+  {
+    return false;
+  }
+
+  cache_last_use[idx] = ++cache_use_seq;
+
+  if ( ops == NULL )
+  {
+    return true;
+  }
+
+  if ( ops->on_status )
+  {
+    ops->on_status(ctx, 200);
+  }
+
+  if ( ops->on_headers_done )
+  {
+    ops->on_headers_done(ctx);
+  }
+
+  if ( ops->on_body && cache_ent[idx].BodyLen > 0 )
+  {
+    ops->on_body(ctx, cache_ent[idx].Body, cache_ent[idx].BodyLen);
+  }
+
+  if ( ops->on_complete )
+  {
+    ops->on_complete(ctx);
+  }
+
+  return true;
+}
+
+
+
+
+/**
+ * @brief 清空缓存
+ */
+void http_cache_Clear( void )
+{
+  memset(cache_ent, 0, sizeof(cache_ent));
+  memset(cache_last_use, 0, sizeof(cache_last_use));
+
+  cache_rx.slot = -1;
+}
+
+
+
+
+/**
+ * @brief 开始接收一个响应（发出请求前调用）
+ *
+ * @param[in] pKey 请求的缓存键，NULL 或 Hash 为 0 表示本响应不缓存（未开启缓存或非 GET 请求）
+ */
+void http_cache_RxBegin( const http_cache_key_t *pKey )
+{
+  // 上一响应中途放弃时释放其条目.
+  if ( cache_rx.slot >= 0 && cache_ent[cache_rx.slot].State == CACHE_STATE_FILLING )
+  {
+    cache_ent[cache_rx.slot].State = CACHE_STATE_EMPTY;
+  }
+
+  memset(&cache_rx, 0, sizeof(cache_rx));
+
+  if ( pKey != NULL )
+  {
+    cache_rx.key = *pKey;
+  }
+
+  cache_rx.slot = -1;
+}
+
+
+
+
+/**
+ * @brief 状态行（1xx 之后的最终响应会再次调用，此时清除之前记录的字段）
+ */
+void http_cache_RxStatus( uint16_t code )
+{
+  cache_rx.status = code;
+  cache_rx.no_store = false;
+  cache_rx.no_cache = false;
+  cache_rx.has_max_age = false;
+  cache_rx.etag[0] = '\0';
+  cache_rx.last_mod[0] = '\0';
+}
+
+
+
+
+/**
+ * @brief 头部字段：记录 ETag / Last-Modified / Cache-Control
+ *
+ * @param[in] truncated 头部行是否被解析器截断（见 http_parser_LineTruncated()）. 截断的校验字段不完整，
+ *                      回送后永远无法匹配，不予记录；截断的 Cache-Control 可能丢失 no-store，按 no-store 处理.
+ */
+void http_cache_RxHeader( const char *name, const char *value, bool truncated )
+{
+  if ( name == NULL || value == NULL )
+  {
+    return;
+  }
+
+  if ( cache_EqualCi(name, "ETag") )
+  {
+    cache_CopyValidator(cache_rx.etag, sizeof(cache_rx.etag), truncated ? NULL : value);
+  }
+  else if ( cache_EqualCi(name, "Last-Modified") )
+  {
+    cache_CopyValidator(cache_rx.last_mod, sizeof(cache_rx.last_mod), truncated ? NULL : value);
+  }
+  else if ( cache_EqualCi(name, "Cache-Control") )
+  {
+    const char *v;
+
+    cache_rx.no_store |= truncated;
+
+    cache_rx.no_store |= ( cache_TokenCi(value, "no-store") != NULL );
+    cache_rx.no_cache |= ( cache_TokenCi(value, "no-cache") != NULL );
+
+    if ( ( v = cache_TokenCi(value, "max-age") ) != NULL && *v == '=' )
+    {
+      cache_rx.max_age_s = (uint32_t)strtoul(v + 1, NULL, 10);
+      cache_rx.has_max_age = true;
+    }
+  }
+}
+
+
+
+
+/**
+ * @brief 头部结束：可缓存的 200 响应分配条目，响应体随后写入
+ *
+ * 既无校验字段也无 max-age 的响应无法复用，不缓存；no-store 的响应不缓存。
+ */
+void http_cache_RxHeadersDone( void )
+{
+  if ( cache_rx.key.Hash == 0 || cache_rx.status != 200 || cache_rx.no_store )
+  {
+    return;
+  }
+
+  if ( cache_rx.etag[0] == '\0' && cache_rx.last_mod[0] == '\0' && ( !cache_rx.has_max_age || cache_rx.max_age_s == 0 ) )
+  {
+    return;
+  }
+
+  int8_t idx = cache_Find(&cache_rx.key);
+
+  if ( idx < 0 )
+  {
+    // 优先使用空条目，否则淘汰最久未使用的条目.
+    idx = 0;
+
+    for ( uint8_t i = 0; i < HTTP_CACHE_SIZE; i++ )
+    {
+      if ( cache_ent[i].State == CACHE_STATE_EMPTY )
+      {
+        idx = (int8_t)i;
+        break;
+      }
+
+      if ( cache_last_use[i] < cache_last_use[idx] )
+      {
+        idx = (int8_t)i;
+      }
+    }
+  }
+
+  // 旧内容已被新响应取代，写入期间条目不可用.
+  cache_ent[idx].Key = cache_rx.key;
+  cache_ent[idx].State = CACHE_STATE_FILLING;
+  cache_ent[idx].BodyLen = 0;
+
+  cache_rx.slot = idx;
+}
+
+
+
+
+/**
+ * @brief 一段响应体（解码后）
+ */
+void http_cache_RxBody( const uint8_t *data, uint16_t len )
+{
+  if ( cache_rx.slot < 0 )
+  {
+    return;
+  }
+
+  HttpCacheEntry_t *pEnt = &cache_ent[cache_rx.slot];
+
+  if ( len > HTTP_CACHE_BODY_MAX - pEnt->BodyLen )
+  {
+    // 超出上限: 放弃缓存该响应.
+    pEnt->State = CACHE_STATE_EMPTY;
+    cache_rx.slot = -1;
+    return;
+  }
+
+  memcpy(&pEnt->Body[pEnt->BodyLen], data, len);
+  pEnt->BodyLen += len;
+}
+
+
+
+
+/**
+ * @brief 响应结束：200 完整时写入缓存，304 时刷新已有条目的新鲜期与校验字段
+ *
+ * @param[in] complete 响应是否完整（且解码成功）
+ */
+void http_cache_RxEnd( bool complete )
+{
+  TickType_t xNow = xTaskGetTickCount();
+  int8_t idx = -1;
+
+  if ( cache_rx.status == 200 && cache_rx.slot >= 0 )
+  {
+    idx = cache_rx.slot;
+    cache_rx.slot = -1;
+
+    if ( !complete )
+    {
+      cache_ent[idx].State = CACHE_STATE_EMPTY;
+      return;
+    }
+
+    strcpy(cache_ent[idx].ETag, cache_rx.etag);
+    strcpy(cache_ent[idx].LastModified, cache_rx.last_mod);
+  }
+  else if ( cache_rx.status == 304 && cache_rx.key.Hash != 0 )
+  {
+    if ( ( idx = cache_Find(&cache_rx.key) ) < 0 )
+    {
+      return;
+    }
+
+    // 304 可携带更新后的校验字段.
+    if ( cache_rx.etag[0] != '\0' )
+    {
+      strcpy(cache_ent[idx].ETag, cache_rx.etag);
+    }
+
+    if ( cache_rx.last_mod[0] != '\0' )
+    {
+      strcpy(cache_ent[idx].LastModified, cache_rx.last_mod);
+    }
+  }
+  else
+  {
+    return;
+  }
+
+  uint32_t fresh_s = ( cache_rx.has_max_age && !cache_rx.no_cache ) ? cache_rx.max_age_s : 0;
+
+  // 节拍计数为 32 位，新鲜期上限约 24 天(1kHz).
+  if ( fresh_s > 0x7FFFFFFFUL / configTICK_RATE_HZ )
+  {
+    fresh_s = 0x7FFFFFFFUL / configTICK_RATE_HZ;
+  }
+
+  cache_ent[idx].Expire = xNow + (TickType_t)( fresh_s * configTICK_RATE_HZ );
+  cache_ent[idx].State = CACHE_STATE_VALID;
+  cache_last_use[idx] = ++cache_use_seq;
+
+  #if defined(__DEBUG_LEVEL_1__)
+    printf("HTTP cache %s slot %d, fresh %lus.\n", ( cache_rx.status == 304 ) ? "refresh" : "store", (int)idx, (unsigned long)fresh_s);
+  #endif // __DEBUG_LEVEL_1__
+}
+
+
+
+
+// 查找有效条目: 两个散列与长度须同时相等.
+static int8_t cache_Find( const http_cache_key_t *pKey )
+{
+  if ( pKey == NULL || pKey->Hash == 0 )
+  {
+    return -1;
+  }
+
+  for ( uint8_t i = 0; i < HTTP_CACHE_SIZE; i++ )
+  {
+    const http_cache_key_t *pEnt = &cache_ent[i].Key;
+
+    if ( cache_ent[i].State == CACHE_STATE_VALID && pEnt->Hash == pKey->Hash
+          && pEnt->Check == pKey->Check && pEnt->Len == pKey->Len )
+    {
+      return (int8_t)i;
+    }
+  }
+
+  return -1;
+}
+
+
+
+
+// 向键累加一个字节: FNV-1a 与 djb2 各自独立推进，长度饱和于 0xFFFF.
+static void cache_KeyByte( http_cache_key_t *pKey, uint8_t c )
+{
+  pKey->Hash ^= c;
+  pKey->Hash *= 16777619UL;
+
+  pKey->Check = ( pKey->Check << 5 ) + pKey->Check + c;
+
+  if ( pKey->Len < 0xFFFFU )
+  {
+    pKey->Len++;
+  }
+}
+
+
+
+
+// 不区分大小写的字符串比较.
+static bool cache_EqualCi( const char *a, const char *b )
+{
+  while( *a != '\0' && tolower((unsigned char)*a) == tolower((unsigned char)*b) )
+  {
+    a++;
+    b++;
+  }
+
+  return ( *a == '\0' && *b == '\0' );
+}
+
+
+
+
+// 在逗号分隔的指令列表中查找 token(不区分大小写)，返回 token 之后的位置.
+static const char *cache_TokenCi( const char *list, const char *token )
+{
+  size_t n = strlen(token);
+
+  for ( const char *p = list; *p != '\0'; p++ )
+  {
+    if ( p != list && p[-1] != ',' && p[-1] != ' ' )
+    {
+      continue;
+    }
+
+    size_t k = 0;
+
+    while( k < n && tolower((unsigned char)p[k]) == tolower((unsigned char)token[k]) )
+    {
+      k++;
+    }
+
+    if ( k == n && ( p[n] == '\0' || p[n] == ',' || p[n] == '=' || p[n] == ' ' ) )
+    {
+      return p + n;
+    }
+  }
+
+  return NULL;
+}
+
+
+
+
+// 校验字段须原样回送，超长或被截断(src 为 NULL)时整体放弃(截断的值无法匹配).
+static void cache_CopyValidator( char *dst, uint16_t size, const char *src )
+{
+  if ( src == NULL || strlen(src) >= size )
+  {
+    dst[0] = '\0';
+    return;
+  }
+
+  strcpy(dst, src);
+}
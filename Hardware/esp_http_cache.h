@@ -0,0 +1,101 @@
+#ifndef __ESP_HTTP_CACHE_H
+#define __ESP_HTTP_CACHE_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "flash_log.h"
+#include "http_parser.h"
+#include <ctype.h>
+
+
+/* ********************************************** */
+#define HTTP_CACHE_SIZE           ( 2 )        // 缓存条目数(满时淘汰最久未使用的条目).
+#define HTTP_CACHE_BODY_MAX       ( 1024U )    // 单条缓存的响应体上限(解码后)，超出的响应不缓存.
+#define HTTP_CACHE_ETAG_MAX       ( 48U )      // ETag 原文(含引号与 W/ 前缀)上限，超长的 ETag 不保存.
+#define HTTP_CACHE_DATE_MAX       ( 32U )      // Last-Modified(IMF-fixdate 29 字符).
+/* ********************************************** */
+
+
+typedef enum
+{
+  HTTP_CACHE_MISS = 0,     // 无记录.
+  HTTP_CACHE_FRESH,        // 在 max-age 之内，无需请求.
+  HTTP_CACHE_STALE         // 已过期(或 no-cache)，须携带校验字段重新验证.
+} http_cache_result_t;
+
+
+/**
+ * @brief 缓存键：主机名(不区分大小写) + 请求目标(路径与查询串)，见 http_cache_Key().
+ *
+ *  条目不保存 URL 原文，以两个相互独立的散列与总长度代替：三者须同时相等才视为同一 URL，
+ *  仅凭单个 32 位散列碰撞即返回其它 URL 响应的情况不再可能.
+ *
+ *  Hash：FNV-1a 散列，0 保留为"不缓存".
+ *  Check：djb2 散列(校验用).
+ *  Len：参与散列的总字节数.
+ */
+typedef struct
+{
+  uint32_t Hash;
+  uint32_t Check;
+  uint16_t Len;
+
+} http_cache_key_t;
+
+
+/**
+ * @brief 缓存记录.
+ *
+ *  Key：URL 的键.
+ *  State：0 空 / 1 正在写入 / 2 有效.
+ *  Expire：新鲜期截止时刻，未给出 max-age 或 no-cache 时等于写入时刻(每次使用前都须重新验证).
+ */
+typedef struct
+{
+  http_cache_key_t Key;
+  uint8_t State;
+  TickType_t Expire;
+
+  char ETag[HTTP_CACHE_ETAG_MAX];
+  char LastModified[HTTP_CACHE_DATE_MAX];
+
+  uint16_t BodyLen;
+  uint8_t Body[HTTP_CACHE_BODY_MAX];
+
+} HttpCacheEntry_t;
+
+
+#ifdef __cplusplus
+  extern "C" {
+#endif // __cplusplus
+
+  void http_cache_Key( http_cache_key_t *pKey, const char *Host );
+
+  void http_cache_KeyAdd( http_cache_key_t *pKey, const void *data, uint16_t len );
+
+  http_cache_result_t http_cache_Lookup( const http_cache_key_t *pKey );
+
+  bool http_cache_Validators( const http_cache_key_t *pKey, const char **pETag, const char **pLastModified );
+
+  bool http_cache_Replay( const http_cache_key_t *pKey, const http_parser_ops_t *ops, void *ctx );
+
+  void http_cache_Clear( void );
+
+  void http_cache_RxBegin( const http_cache_key_t *pKey );
+
+  void http_cache_RxStatus( uint16_t code );
+
+  void http_cache_RxHeader( const char *name, const char *value, bool truncated );
+
+  void http_cache_RxHeadersDone( void );
+
+  void http_cache_RxBody( const uint8_t *data, uint16_t len );
+
+  void http_cache_RxEnd( bool complete );
+
+#ifdef __cplusplus
+  }
+#endif // __cplusplus
+
+
+#endif // __ESP_HTTP_CACHE_H
@@ -27,6 +27,7 @@
 #define configUSE_MPU_WRAPPERS      1
 #define configCHECK_FOR_STACK_OVERFLOW 2
 #define configUSE_RECURSIVE_MUTEXES 1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2   // [0] UART 发送完成, [1] AT 命令完成(esp8266_at_engine).
 
 #define INCLUDE_vTaskPrioritySet		1
 #define INCLUDE_uxTaskPriorityGet		1
@@ -38,6 +39,7 @@
 #define INCLUDE_vTaskStartScheduler 1
 #define INCLUDE_xTaskGetSchedulerState 1
 #define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_xSemaphoreGetMutexHolder 1   // esp_at_Exec() 判断调用者是否已持有 xMutexEsp.
 
 #define USE_FreeRTOS_HEAP_4
 